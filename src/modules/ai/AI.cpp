@@ -7,12 +7,29 @@
 namespace ai {
 
 TreeNodePtr AI::setBehaviour(const TreeNodePtr& newBehaviour) {
+	prepareBehaviour(newBehaviour);
 	TreeNodePtr current = _behaviour;
 	_behaviour = newBehaviour;
 	_reset = true;
 	return current;
 }
 
+void AI::prepareBehaviour(const TreeNodePtr& behaviour) {
+	if (behaviour && behaviour->getStateCount() == 0) {
+		// not loaded by a tree loader
+		TreeNode::assignStateIndices(behaviour);
+	}
+}
+
+void AI::resetNodeStates(const TreeNodePtr& behaviour) {
+	_nodeDebugStates.clear();
+	if (!behaviour) {
+		_nodeStates.clear();
+		return;
+	}
+	_nodeStates.assign(behaviour->getStateCount(), NodeState());
+}
+
 void AI::update(int64_t dt, bool debuggingActive) {
 	if (isPause()) {
 		return;
@@ -25,10 +42,8 @@ void AI::update(int64_t dt, bool debuggingActive) {
 	if (_reset) {
 		// safe to do it like this, because update is not called from multiple threads
 		_reset = false;
-		_lastStatus.clear();
-		_lastExecMillis.clear();
 		_filteredEntities.clear();
-		_selectorStates.clear();
+		resetNodeStates(_behaviour);
 	}
 
 	_debuggingActive = debuggingActive;
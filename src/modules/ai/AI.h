@@ -3,7 +3,7 @@
  */
 #pragma once
 
-#include <unordered_map>
+#include <vector>
 #include <memory>
 
 #include "group/GroupId.h"
@@ -45,35 +45,44 @@ class AI : public NonCopyable, public std::enable_shared_from_this<AI> {
 	friend class Server;
 protected:
 	/**
-	 * This map is only filled if we are in debugging mode for this entity
+	 * @brief The runtime state of a single @ai{TreeNode} of the behaviour tree
 	 */
-	typedef std::unordered_map<int, TreeNodeStatus> NodeStates;
-	NodeStates _lastStatus;
+	struct NodeState {
+		/**
+		 * Often @ai{Selector} states must be stored to continue in the next step at a particular
+		 * position in the behaviour tree.
+		 */
+		int selectorState = AI_NOTHING_SELECTED;
+		/**
+		 * The amount of executions for the @ai{Limit} node
+		 */
+		int limitState = 0;
+	};
 	/**
-	 * This map is only filled if we are in debugging mode for this entity
+	 * @brief The state of a single @ai{TreeNode} that is only tracked in debugging mode
 	 */
-	typedef std::unordered_map<int, uint64_t> LastExecMap;
-	LastExecMap _lastExecMillis;
-
+	struct NodeDebugState {
+		int64_t lastExecMillis = -1L;
+		TreeNodeStatus lastStatus = UNKNOWN;
+	};
 	/**
-	 * @note The filtered entities are kept even over several ticks. The caller should decide
-	 * whether he still needs an old/previous filtered selection
-	 * @sa @ai{IFilter}
+	 * The node states are indexed by @ai{TreeNode::getStateIndex()} - all instances that share the same
+	 * behaviour tree share the same layout.
 	 */
-	mutable FilteredEntities _filteredEntities;
-
+	typedef std::vector<NodeState> NodeStates;
+	NodeStates _nodeStates;
 	/**
-	 * Often @ai{Selector} states must be stored to continue in the next step at a particular
-	 * position in the behaviour tree. This map is doing exactly this.
+	 * This is only filled if we are in debugging mode for this entity
 	 */
-	typedef std::unordered_map<int, int> SelectorStates;
-	SelectorStates _selectorStates;
+	typedef std::vector<NodeDebugState> NodeDebugStates;
+	NodeDebugStates _nodeDebugStates;
 
 	/**
-	 * This map stores the amount of execution for the @ai{Limit} node. The key is the node id
+	 * @note The filtered entities are kept even over several ticks. The caller should decide
+	 * whether he still needs an old/previous filtered selection
+	 * @sa @ai{IFilter}
 	 */
-	typedef std::unordered_map<int, int> LimitStates;
-	LimitStates _limitStates;
+	mutable FilteredEntities _filteredEntities;
 
 	TreeNodePtr _behaviour;
 	AggroMgr _aggroMgr;
@@ -88,12 +97,27 @@ protected:
 	Zone* _zone;
 
 	std::atomic_bool _reset;
+
+	/**
+	 * @brief Assigns the state indices of hand-built behaviour trees that were not loaded by a tree loader
+	 * @note This modifies the tree and must not be called from the zone tick - it's done once when the
+	 * behaviour is set on the ai.
+	 */
+	static void prepareBehaviour(const TreeNodePtr& behaviour);
+	/**
+	 * @brief Sizes the node states for the given behaviour tree
+	 */
+	void resetNodeStates(const TreeNodePtr& behaviour);
+	NodeState& nodeState(int stateIndex);
+	NodeDebugState& nodeDebugState(int stateIndex);
 public:
 	/**
 	 * @param behaviour The behaviour tree node that is applied to this ai entity
 	 */
 	explicit AI(const TreeNodePtr& behaviour) :
 			_behaviour(behaviour), _pause(false), _debuggingActive(false), _time(0L), _zone(nullptr), _reset(false) {
+		prepareBehaviour(behaviour);
+		resetNodeStates(behaviour);
 	}
 	virtual ~AI() {
 	}
@@ -146,6 +170,7 @@ public:
 	TreeNodePtr getBehaviour() const;
 	/**
 	 * @brief Set a new behaviour
+	 * @note Nodes that are added to the tree afterwards need a call to @ai{TreeNode::assignStateIndices()}
 	 * @return the old one if there was any
 	 */
 	TreeNodePtr setBehaviour(const TreeNodePtr& newBehaviour);
@@ -196,6 +221,21 @@ public:
 	}
 };
 
+inline AI::NodeState& AI::nodeState(int stateIndex) {
+	if (stateIndex >= (int)_nodeStates.size()) {
+		// a node was added to the behaviour tree after this instance was created
+		_nodeStates.resize(stateIndex + 1);
+	}
+	return _nodeStates[stateIndex];
+}
+
+inline AI::NodeDebugState& AI::nodeDebugState(int stateIndex) {
+	if (stateIndex >= (int)_nodeDebugStates.size()) {
+		_nodeDebugStates.resize((std::max)(stateIndex + 1, (int)_nodeStates.size()));
+	}
+	return _nodeDebugStates[stateIndex];
+}
+
 inline TreeNodePtr AI::getBehaviour() const {
 	return _behaviour;
 }
@@ -8,6 +8,7 @@
 #include "common/Common.h"
 #include "common/Assert.h"
 #include "AI.h"
+#include <thread>
 
 namespace ai {
 
@@ -50,6 +51,35 @@ static void luaAI_globalpointer(lua_State* s, void* pointer, const char *name) {
 	lua_setglobal(s, name);
 }
 
+static const char* luaAI_metareplica() {
+	return "__meta_replica";
+}
+
+/***
+ * The states of the worker threads are replicas of the registry state - the scripts
+ * are executed again in these states, but the factories must only be registered once.
+ * @return @c true if the given state is not the one the factories are registered in
+ */
+static bool luaAI_isreplica(lua_State* s) {
+	lua_getfield(s, LUA_REGISTRYINDEX, luaAI_metareplica());
+	const bool replica = lua_toboolean(s, -1) != 0;
+	lua_pop(s, 1);
+	return replica;
+}
+
+static bool luaAI_evaluate(lua_State* s, const char* luaBuffer, size_t size) {
+	if (luaL_loadbufferx(s, luaBuffer, size, "", nullptr) || lua_pcall(s, 0, 0, 0)) {
+		ai_log_error("%s", lua_tostring(s, -1));
+		lua_pop(s, 1);
+		return false;
+	}
+	return true;
+}
+
+static int luaAI_sharedreadonly(lua_State* s) {
+	return luaL_error(s, "SHARED is read-only - the values can only be changed by the registry");
+}
+
 /***
  * Gives you access the the light userdata for the LUAAIRegistry.
  * @return the registry userdata
@@ -122,10 +152,19 @@ static int luaAI_nodetostring(lua_State* s) {
 static int luaAI_createnode(lua_State* s) {
 	LUAAIRegistry* r = luaAI_toregistry(s);
 	const core::String type = luaL_checkstring(s, -1);
-	const LUATreeNodeFactoryPtr& factory = std::make_shared<LuaNodeFactory>(s, type);
-	const bool inserted = r->registerNodeFactory(type, *factory);
-	if (!inserted) {
-		return luaL_error(s, "tree node %s is already registered", type.c_str());
+	const bool replica = luaAI_isreplica(s);
+	LUATreeNodeFactoryPtr factory;
+	if (replica) {
+		factory = r->treeNodeFactory(type);
+		if (!factory) {
+			return luaL_error(s, "tree node %s is not registered", type.c_str());
+		}
+	} else {
+		factory = std::make_shared<LuaNodeFactory>(r, type);
+		const bool inserted = r->registerNodeFactory(type, *factory);
+		if (!inserted) {
+			return luaL_error(s, "tree node %s is already registered", type.c_str());
+		}
 	}
 
 	luaAI_newuserdata<LuaNodeFactory*>(s, factory.get());
@@ -136,7 +175,9 @@ static int luaAI_createnode(lua_State* s) {
 		{nullptr, nullptr}
 	};
 	luaAI_setupmetatable(s, type, nodes, "node");
-	r->addTreeNodeFactory(type, factory);
+	if (!replica) {
+		r->addTreeNodeFactory(type, factory);
+	}
 	return 1;
 }
 
@@ -163,10 +204,19 @@ static int luaAI_conditiontostring(lua_State* s) {
 static int luaAI_createcondition(lua_State* s) {
 	LUAAIRegistry* r = luaAI_toregistry(s);
 	const core::String type = luaL_checkstring(s, -1);
-	const LUAConditionFactoryPtr& factory = std::make_shared<LuaConditionFactory>(s, type);
-	const bool inserted = r->registerConditionFactory(type, *factory);
-	if (!inserted) {
-		return luaL_error(s, "condition %s is already registered", type.c_str());
+	const bool replica = luaAI_isreplica(s);
+	LUAConditionFactoryPtr factory;
+	if (replica) {
+		factory = r->conditionFactory(type);
+		if (!factory) {
+			return luaL_error(s, "condition %s is not registered", type.c_str());
+		}
+	} else {
+		factory = std::make_shared<LuaConditionFactory>(r, type);
+		const bool inserted = r->registerConditionFactory(type, *factory);
+		if (!inserted) {
+			return luaL_error(s, "condition %s is already registered", type.c_str());
+		}
 	}
 
 	luaAI_newuserdata<LuaConditionFactory*>(s, factory.get());
@@ -177,7 +227,9 @@ static int luaAI_createcondition(lua_State* s) {
 		{nullptr, nullptr}
 	};
 	luaAI_setupmetatable(s, type, nodes, "condition");
-	r->addConditionFactory(type, factory);
+	if (!replica) {
+		r->addConditionFactory(type, factory);
+	}
 	return 1;
 }
 
@@ -200,10 +252,19 @@ static int luaAI_filtertostring(lua_State* s) {
 static int luaAI_createfilter(lua_State* s) {
 	LUAAIRegistry* r = luaAI_toregistry(s);
 	const core::String type = luaL_checkstring(s, -1);
-	const LUAFilterFactoryPtr& factory = std::make_shared<LuaFilterFactory>(s, type);
-	const bool inserted = r->registerFilterFactory(type, *factory);
-	if (!inserted) {
-		return luaL_error(s, "filter %s is already registered", type.c_str());
+	const bool replica = luaAI_isreplica(s);
+	LUAFilterFactoryPtr factory;
+	if (replica) {
+		factory = r->filterFactory(type);
+		if (!factory) {
+			return luaL_error(s, "filter %s is not registered", type.c_str());
+		}
+	} else {
+		factory = std::make_shared<LuaFilterFactory>(r, type);
+		const bool inserted = r->registerFilterFactory(type, *factory);
+		if (!inserted) {
+			return luaL_error(s, "filter %s is already registered", type.c_str());
+		}
 	}
 
 	luaAI_newuserdata<LuaFilterFactory*>(s, factory.get());
@@ -214,7 +275,9 @@ static int luaAI_createfilter(lua_State* s) {
 		{nullptr, nullptr}
 	};
 	luaAI_setupmetatable(s, type, nodes, "filter");
-	r->addFilterFactory(type, factory);
+	if (!replica) {
+		r->addFilterFactory(type, factory);
+	}
 	return 1;
 }
 
@@ -232,10 +295,19 @@ static int luaAI_steeringtostring(lua_State* s) {
 static int luaAI_createsteering(lua_State* s) {
 	LUAAIRegistry* r = luaAI_toregistry(s);
 	const core::String type = luaL_checkstring(s, -1);
-	const LUASteeringFactoryPtr& factory = std::make_shared<LuaSteeringFactory>(s, type);
-	const bool inserted = r->registerSteeringFactory(type, *factory);
-	if (!inserted) {
-		return luaL_error(s, "steering %s is already registered", type.c_str());
+	const bool replica = luaAI_isreplica(s);
+	LUASteeringFactoryPtr factory;
+	if (replica) {
+		factory = r->steeringFactory(type);
+		if (!factory) {
+			return luaL_error(s, "steering %s is not registered", type.c_str());
+		}
+	} else {
+		factory = std::make_shared<LuaSteeringFactory>(r, type);
+		const bool inserted = r->registerSteeringFactory(type, *factory);
+		if (!inserted) {
+			return luaL_error(s, "steering %s is already registered", type.c_str());
+		}
 	}
 
 	luaAI_newuserdata<LuaSteeringFactory*>(s, factory.get());
@@ -246,7 +318,9 @@ static int luaAI_createsteering(lua_State* s) {
 		{nullptr, nullptr}
 	};
 	luaAI_setupmetatable(s, type, nodes, "steering");
-	r->addSteeringFactory(type, factory);
+	if (!replica) {
+		r->addSteeringFactory(type, factory);
+	}
 	return 1;
 }
 
@@ -254,18 +328,146 @@ LUAAIRegistry::LUAAIRegistry() {
 	init();
 }
 
+lua_State* luaAI_threadstate(LUAAIRegistry* registry) {
+	return registry->getLuaState();
+}
+
 lua_State* LUAAIRegistry::getLuaState() {
-	return _s;
+	struct ThreadStateCache {
+		uint32_t id = 0u;
+		uint32_t generation = 0u;
+		lua_State* s = nullptr;
+	};
+	AI_THREAD_LOCAL ThreadStateCache cache;
+	if (cache.s != nullptr && cache.id == _id && cache.generation == _generation.load(std::memory_order_acquire)) {
+		return cache.s;
+	}
+	cache.s = updateThreadState(cache.generation);
+	cache.id = _id;
+	return cache.s;
+}
+
+size_t LUAAIRegistry::stateCount() const {
+	ScopedReadLock scopedLock(_stateLock);
+	return _states.size();
+}
+
+namespace {
+
+/**
+ * @brief Flag that is reset when the calling thread exits
+ */
+const std::shared_ptr<std::atomic<bool>>& threadAlive() {
+	struct ThreadAlive {
+		std::shared_ptr<std::atomic<bool>> alive = std::make_shared<std::atomic<bool>>(true);
+		~ThreadAlive() {
+			*alive = false;
+		}
+	};
+	AI_THREAD_LOCAL ThreadAlive threadAlive;
+	return threadAlive.alive;
+}
+
+}
+
+void LUAAIRegistry::removeDeadThreadStates(std::vector<lua_State*>& closed) {
+	for (auto i = _states.begin(); i != _states.end();) {
+		const ThreadState& state = i->second;
+		if (state.s == _s || !state.alive || *state.alive) {
+			++i;
+			continue;
+		}
+		if (state.s != nullptr) {
+			closed.push_back(state.s);
+		}
+		i = _states.erase(i);
+	}
+}
+
+lua_State* LUAAIRegistry::updateThreadState(uint32_t& generation) {
+	const std::shared_ptr<std::atomic<bool>>& alive = threadAlive();
+	const std::thread::id threadId = std::this_thread::get_id();
+	lua_State* s;
+	uint32_t id;
+	std::vector<core::String> scripts;
+	size_t scriptCount;
+	SharedData sharedData;
+	uint32_t sharedVersion;
+	bool updateSharedData;
+	std::vector<lua_State*> closed;
+	{
+		ScopedWriteLock scopedLock(_stateLock);
+		if (_s == nullptr) {
+			return nullptr;
+		}
+		id = _id;
+		generation = _generation;
+		ThreadState& state = _states[threadId];
+		if (state.s == _s) {
+			// evaluate() and the shared data are applied to the registry state directly
+			return _s;
+		}
+		// the thread id might belong to a thread that exited - the new thread takes over the state
+		state.alive = alive;
+		s = state.s;
+		if (s == nullptr) {
+			// a new thread - a good point in time to get rid of the states of the threads that exited
+			removeDeadThreadStates(closed);
+		}
+		scripts.assign(_scripts.begin() + state.scripts, _scripts.end());
+		scriptCount = _scripts.size();
+		updateSharedData = s == nullptr || state.sharedVersion != _sharedVersion;
+		sharedVersion = _sharedVersion;
+		if (updateSharedData) {
+			sharedData = _sharedData;
+		}
+	}
+	for (lua_State* c : closed) {
+		lua_close(c);
+	}
+	// only the owning thread is touching its state - the scripts are executed without holding the lock
+	const bool created = s == nullptr;
+	if (created) {
+		s = createState(true);
+		if (s == nullptr) {
+			// the state stays empty - the next call tries again
+			return nullptr;
+		}
+	}
+	for (const core::String& script : scripts) {
+		luaAI_evaluate(s, script.c_str(), script.size());
+	}
+	if (updateSharedData) {
+		pushSharedData(s, sharedData);
+	}
+
+	ScopedWriteLock scopedLock(_stateLock);
+	if (_s == nullptr || _id != id) {
+		// shutdown() was called in the meantime and already closed the existing states
+		if (created) {
+			lua_close(s);
+		}
+		return nullptr;
+	}
+	ThreadState& state = _states[threadId];
+	state.s = s;
+	state.scripts = scriptCount;
+	if (updateSharedData) {
+		state.sharedVersion = sharedVersion;
+	}
+	return s;
 }
 
 int LUAAIRegistry::pushAIMetatable() {
-	ai_assert(_s != nullptr, "LUA state is not yet initialized");
-	return luaL_getmetatable(_s, luaAI_metaai());
+	lua_State* s = getLuaState();
+	ai_assert(s != nullptr, "LUA state is not yet initialized");
+	return luaL_getmetatable(s, luaAI_metaai());
 }
 
 int LUAAIRegistry::pushCharacterMetatable() {
-	ai_assert(_s != nullptr, "LUA state is not yet initialized");
-	return luaL_getmetatable(_s, luaAI_metacharacter());
+	lua_State* s = getLuaState();
+	ai_assert(s != nullptr, "LUA state is not yet initialized");
+	return luaL_getmetatable(s, luaAI_metacharacter());
 }
 
 static const luaL_Reg registryFuncs[] = {
@@ -276,35 +478,79 @@ static const luaL_Reg registryFuncs[] = {
 	{nullptr, nullptr}
 };
 
-bool LUAAIRegistry::init() {
-	if (_s != nullptr) {
-		return true;
-	}
-	_s = luaL_newstate();
+lua_State* LUAAIRegistry::createState(bool replica) {
+	lua_State* s = luaL_newstate();
 
-	lua_atpanic(_s, [] (lua_State* L) {
+	lua_atpanic(s, [] (lua_State* L) {
 		ai_log_error("Lua panic. Error message: %s", (lua_isnil(L, -1) ? "" : lua_tostring(L, -1)));
 		return 0;
 	});
-	lua_gc(_s, LUA_GCSTOP, 0);
-	luaL_openlibs(_s);
+	lua_gc(s, LUA_GCSTOP, 0);
+	luaL_openlibs(s);
 
-	luaAI_registerfuncs(_s, registryFuncs, "META_REGISTRY");
-	lua_setglobal(_s, "REGISTRY");
+	luaAI_registerfuncs(s, registryFuncs, "META_REGISTRY");
+	lua_setglobal(s, "REGISTRY");
 
 	// TODO: random
 
-	luaAI_globalpointer(_s, this, luaAI_metaregistry());
-	luaAI_registerAll(_s);
+	luaAI_globalpointer(s, this, luaAI_metaregistry());
+	luaAI_registerAll(s);
+
+	if (replica) {
+		lua_pushboolean(s, 1);
+		lua_setfield(s, LUA_REGISTRYINDEX, luaAI_metareplica());
+	}
+	pushSharedData(s, SharedData());
 
 	const char* script = ""
 		"UNKNOWN, CANNOTEXECUTE, RUNNING, FINISHED, FAILED, EXCEPTION = 0, 1, 2, 3, 4, 5\n";
 
-	if (luaL_loadbufferx(_s, script, SDL_strlen(script), "", nullptr) || lua_pcall(_s, 0, 0, 0)) {
-		ai_log_error("%s", lua_tostring(_s, -1));
-		lua_pop(_s, 1);
+	if (!luaAI_evaluate(s, script, SDL_strlen(script))) {
+		lua_close(s);
+		return nullptr;
+	}
+	return s;
+}
+
+void LUAAIRegistry::pushSharedData(lua_State* s, const SharedData& data) {
+	// the scripts only get a proxy table - the values are looked up via __index
+	lua_newtable(s);
+	lua_createtable(s, 0, 3);
+	lua_createtable(s, 0, (int)data.size());
+	for (const auto& e : data) {
+		if (e.second.isString) {
+			lua_pushstring(s, e.second.string.c_str());
+		} else {
+			lua_pushnumber(s, e.second.number);
+		}
+		lua_setfield(s, -2, e.first.c_str());
+	}
+	lua_setfield(s, -2, "__index");
+	lua_pushcfunction(s, luaAI_sharedreadonly);
+	lua_setfield(s, -2, "__newindex");
+	lua_pushboolean(s, 0);
+	lua_setfield(s, -2, "__metatable");
+	lua_setmetatable(s, -2);
+	lua_setglobal(s, "SHARED");
+}
+
+bool LUAAIRegistry::init() {
+	if (_s != nullptr) {
+		return true;
+	}
+	_s = createState(false);
+	if (_s == nullptr) {
 		return false;
 	}
+	static std::atomic<uint32_t> registryIds{0u};
+	_id = ++registryIds;
+
+	ScopedWriteLock scopedLock(_stateLock);
+	pushSharedData(_s, _sharedData);
+	ThreadState& state = _states[std::this_thread::get_id()];
+	state.s = _s;
+	state.sharedVersion = _sharedVersion;
+	++_generation;
 	return true;
 }
 
@@ -316,10 +562,22 @@ void LUAAIRegistry::shutdown() {
 		_filterFactories.clear();
 		_steeringFactories.clear();
 	}
+	{
+		ScopedWriteLock scopedLock(_stateLock);
+		for (const auto& e : _states) {
+			if (e.second.s != nullptr && e.second.s != _s) {
+				lua_close(e.second.s);
+			}
+		}
+		_states.clear();
+		_scripts.clear();
+		++_generation;
+	}
 	if (_s != nullptr) {
 		lua_close(_s);
 		_s = nullptr;
 	}
+	_id = 0u;
 }
 
 LUAAIRegistry::~LUAAIRegistry() {
@@ -331,14 +589,67 @@ bool LUAAIRegistry::evaluate(const char* luaBuffer, size_t size) {
 		ai_log_error("LUA state is not yet initialized");
 		return false;
 	}
-	if (luaL_loadbufferx(_s, luaBuffer, size, "", nullptr) || lua_pcall(_s, 0, 0, 0)) {
-		ai_log_error("%s", lua_tostring(_s, -1));
-		lua_pop(_s, 1);
+	if (!luaAI_evaluate(_s, luaBuffer, size)) {
 		return false;
 	}
+	ScopedWriteLock scopedLock(_stateLock);
+	_scripts.emplace_back(luaBuffer, size);
+	++_generation;
 	return true;
 }
 
+void LUAAIRegistry::setSharedValue(const core::String& name, const SharedValue& value) {
+	ScopedWriteLock scopedLock(_stateLock);
+	_sharedData[name] = value;
+	++_sharedVersion;
+	if (_s != nullptr) {
+		pushSharedData(_s, _sharedData);
+		++_generation;
+	}
+}
+
+void LUAAIRegistry::setSharedString(const core::String& name, const core::String& value) {
+	SharedValue sharedValue;
+	sharedValue.string = value;
+	sharedValue.isString = true;
+	setSharedValue(name, sharedValue);
+}
+
+void LUAAIRegistry::setSharedNumber(const core::String& name, double value) {
+	SharedValue sharedValue;
+	sharedValue.number = value;
+	setSharedValue(name, sharedValue);
+}
+
+template<class FACTORYMAP>
+static typename FACTORYMAP::mapped_type luaAI_findfactory(const FACTORYMAP& factories, const core::String& type) {
+	auto i = factories.find(type);
+	if (i == factories.end()) {
+		return typename FACTORYMAP::mapped_type();
+	}
+	return i->second;
+}
+
+LUATreeNodeFactoryPtr LUAAIRegistry::treeNodeFactory(const core::String& type) const {
+	ScopedReadLock scopedLock(_lock);
+	return luaAI_findfactory(_treeNodeFactories, type);
+}
+
+LUAConditionFactoryPtr LUAAIRegistry::conditionFactory(const core::String& type) const {
+	ScopedReadLock scopedLock(_lock);
+	return luaAI_findfactory(_conditionFactories, type);
+}
+
+LUAFilterFactoryPtr LUAAIRegistry::filterFactory(const core::String& type) const {
+	ScopedReadLock scopedLock(_lock);
+	return luaAI_findfactory(_filterFactories, type);
+}
+
+LUASteeringFactoryPtr LUAAIRegistry::steeringFactory(const core::String& type) const {
+	ScopedReadLock scopedLock(_lock);
+	return luaAI_findfactory(_steeringFactories, type);
+}
+
 void LUAAIRegistry::addTreeNodeFactory(const core::String& type, const LUATreeNodeFactoryPtr& factory) {
 	ScopedWriteLock scopedLock(_lock);
 	_treeNodeFactories.emplace(type, factory);
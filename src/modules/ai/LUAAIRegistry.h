@@ -10,6 +10,10 @@
 #include "conditions/LUACondition.h"
 #include "filter/LUAFilter.h"
 #include "movement/LUASteering.h"
+#include <atomic>
+#include <map>
+#include <unordered_map>
+#include <vector>
 
 namespace ai {
 
@@ -81,16 +85,69 @@ typedef std::map<core::String, LUASteeringFactoryPtr> SteeringFactoryMap;
  * @par AI metatable
  * There is a metatable that you can modify by calling @ai{LUAAIRegistry::pushAIMetatable()}.
  * This metatable is applied to all @ai{AI} pointers that are forwarded to the lua functions.
+ *
+ * @par Threads
+ * Every thread that executes lua nodes, conditions, filters or steerings gets its own lua state. The
+ * state of the thread that called init() is the one the factories are registered in. All scripts that
+ * were given to evaluate() are loaded into the other states once a thread executes its first lua
+ * function - so the scripts are executed once per thread and must not rely on being executed only once.
+ *
+ * @par Shared data
+ * Use setSharedString() and setSharedNumber() to make immutable values available to all states.
+ * They can be read from the read-only global @c SHARED table.
+ * @code
+ * function luacondition:evaluate(ai)
+ *   return ai:id() < SHARED.maxId
+ * end
+ * @endcode
  */
 class LUAAIRegistry : public AIRegistry {
 protected:
+	struct SharedValue {
+		core::String string;
+		double number = 0.0;
+		bool isString = false;
+	};
+	typedef std::map<core::String, SharedValue> SharedData;
+
+	struct ThreadState {
+		lua_State* s = nullptr;
+		// the amount of scripts that were loaded into this state
+		size_t scripts = 0u;
+		uint32_t sharedVersion = 0u;
+		// set to false when the owning thread exits - the state is closed once another thread creates its state
+		std::shared_ptr<std::atomic<bool>> alive;
+	};
+
+	// the state of the thread that called init() - the factories are registered here
 	lua_State* _s = nullptr;
+	// identifies this registry instance for the thread local state lookup - changes with every init()
+	uint32_t _id = 0u;
+	// changes whenever a script or shared data was added - the threads have to update their states then
+	std::atomic<uint32_t> _generation{0u};
+
+	mutable ReadWriteLock _stateLock{"luaregistrystates"};
+	std::unordered_map<std::thread::id, ThreadState> _states;
+	std::vector<core::String> _scripts;
+	SharedData _sharedData;
+	uint32_t _sharedVersion = 0u;
 
 	ReadWriteLock _lock{"luaregistry"};
 	TreeNodeFactoryMap _treeNodeFactories;
 	ConditionFactoryMap _conditionFactories;
 	FilterFactoryMap _filterFactories;
 	SteeringFactoryMap _steeringFactories;
+
+	lua_State* createState(bool replica);
+	lua_State* updateThreadState(uint32_t& generation);
+	/**
+	 * @brief Removes the states of the threads that exited
+	 * @param[out] closed The states that must be closed after the lock was released
+	 * @note The state lock must be held by the caller
+	 */
+	void removeDeadThreadStates(std::vector<lua_State*>& closed);
+	void setSharedValue(const core::String& name, const SharedValue& value);
+	static void pushSharedData(lua_State* s, const SharedData& data);
 public:
 	LUAAIRegistry();
 
@@ -99,11 +156,31 @@ public:
 	void addFilterFactory(const core::String& type, const LUAFilterFactoryPtr& factory);
 	void addSteeringFactory(const core::String& type, const LUASteeringFactoryPtr& factory);
 
+	LUATreeNodeFactoryPtr treeNodeFactory(const core::String& type) const;
+	LUAConditionFactoryPtr conditionFactory(const core::String& type) const;
+	LUAFilterFactoryPtr filterFactory(const core::String& type) const;
+	LUASteeringFactoryPtr steeringFactory(const core::String& type) const;
+
 	/**
-	 * @brief Access to the lua state.
+	 * @brief Access to the lua state of the calling thread. The state is created on first access.
 	 * @see pushAIMetatable()
 	 */
 	lua_State* getLuaState();
+	/**
+	 * @return The amount of lua states - including the ones of threads that exited but weren't cleaned up yet
+	 */
+	size_t stateCount() const;
+
+	/**
+	 * @brief Makes the given string available as @c SHARED.name in the lua states of all threads
+	 * @note The states of other threads are updated the next time they execute a lua function
+	 */
+	void setSharedString(const core::String& name, const core::String& value);
+	/**
+	 * @brief Makes the given number available as @c SHARED.name in the lua states of all threads
+	 * @note The states of other threads are updated the next time they execute a lua function
+	 */
+	void setSharedNumber(const core::String& name, double value);
 
 	/**
 	 * @brief Pushes the AI metatable onto the stack. This allows anyone to modify it
@@ -111,6 +188,7 @@ public:
 	 * lua functions.
 	 * @note lua_ctxai() can be used in your lua c callbacks to get access to the
 	 * @ai{AI} pointer: @code const AI* ai = lua_ctxai(s, 1); @endcode
+	 * @note This is the metatable of the lua state of the calling thread
 	 */
 	int pushAIMetatable();
 
@@ -141,6 +219,7 @@ public:
 	 * This can be called multiple times to e.g. load multiple files.
 	 * @return @c true if the lua script was loaded, @c false otherwise
 	 * @note you have to call init() before
+	 * @note The script is loaded into the states of the other threads the next time they execute a lua function
 	 */
 	bool evaluate(const char* luaBuffer, size_t size);
 };
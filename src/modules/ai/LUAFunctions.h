@@ -11,6 +11,7 @@ namespace ai {
 
 class AI;
 typedef std::shared_ptr<AI> AIPtr;
+class LUAAIRegistry;
 
 template<class T>
 static T* luaAI_getlightuserdata(lua_State *s, const char *name) {
@@ -66,5 +67,9 @@ extern const char* luaAI_metacharacter();
 extern void luaAI_registerfuncs(lua_State* s, const luaL_Reg* funcs, const char *name);
 extern void luaAI_registerAll(lua_State* s);
 extern int luaAI_pushai(lua_State* s, const AIPtr& ai);
+/**
+ * @return The lua state of the given registry for the calling thread
+ */
+extern lua_State* luaAI_threadstate(LUAAIRegistry* registry);
 
 }
@@ -0,0 +1,40 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "IProtocolMessage.h"
+
+namespace ai {
+
+/**
+ * @brief Message for the remote debugging interface
+ *
+ * The client acknowledges that it applied the @c AIStateDeltaMessage with the given sequence. The server
+ * stops sending new deltas to clients that fall too far behind.
+ */
+class AIStateAckMessage: public IProtocolMessage {
+private:
+	int32_t _sequence;
+
+public:
+	explicit AIStateAckMessage(int32_t sequence) :
+			IProtocolMessage(PROTO_STATEACK), _sequence(sequence) {
+	}
+
+	explicit AIStateAckMessage(streamContainer& in) :
+			IProtocolMessage(PROTO_STATEACK) {
+		_sequence = readInt(in);
+	}
+
+	void serialize(streamContainer& out) const override {
+		addByte(out, _id);
+		addInt(out, _sequence);
+	}
+
+	inline int32_t getSequence() const {
+		return _sequence;
+	}
+};
+
+}
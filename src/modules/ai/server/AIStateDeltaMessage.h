@@ -0,0 +1,143 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "IProtocolMessage.h"
+#include "AIStubTypes.h"
+#include <vector>
+
+namespace ai {
+
+/**
+ * @brief Message for the remote debugging interface
+ *
+ * The changes of the subscribed characters since the last delta. Only the changed fields of a character
+ * are serialized - see @c AIStateDelta. Characters that no longer match the @c AIStateSubscription or
+ * that were removed from the zone are part of the removed list.
+ *
+ * If the message is flagged as @c full, the client has to drop all the characters it knows before the
+ * changes are applied. The client should answer every message with an @c AIStateAckMessage.
+ */
+class AIStateDeltaMessage: public IProtocolMessage {
+private:
+	int32_t _sequence;
+	bool _full;
+	std::vector<AIStateDelta> _changes;
+	std::vector<CharacterId> _removed;
+
+	void readDelta(streamContainer& in) {
+		const CharacterId id = readInt(in);
+		const uint8_t flags = readByte(in);
+		AIStateWorld state(id, glm::vec3(0.0f), 0.0f);
+		if (flags & AIStateDelta::POSITION) {
+			const float x = readFloat(in);
+			const float y = readFloat(in);
+			const float z = readFloat(in);
+			state.setPosition(glm::vec3(x, y, z));
+		}
+		if (flags & AIStateDelta::ORIENTATION) {
+			state.setOrientation(readFloat(in));
+		}
+		if (flags & AIStateDelta::ATTRIBUTES) {
+			CharacterAttributes& attributes = state.getAttributes();
+			const int size = readShort(in);
+			attributes.reserve(size);
+			for (int i = 0; i < size; ++i) {
+				const core::String& key = readString(in);
+				const core::String& value = readString(in);
+				attributes.insert(std::make_pair(key, value));
+			}
+		}
+		_changes.emplace_back(flags, std::move(state));
+	}
+
+	void writeDelta(streamContainer& out, const AIStateDelta& delta) const {
+		const AIStateWorld& state = delta.getState();
+		const uint8_t flags = delta.getFlags();
+		addInt(out, state.getId());
+		addByte(out, flags);
+		if (flags & AIStateDelta::POSITION) {
+			const glm::vec3& position = state.getPosition();
+			addFloat(out, position.x);
+			addFloat(out, position.y);
+			addFloat(out, position.z);
+		}
+		if (flags & AIStateDelta::ORIENTATION) {
+			addFloat(out, state.getOrientation());
+		}
+		if (flags & AIStateDelta::ATTRIBUTES) {
+			const CharacterAttributes& attributes = state.getAttributes();
+			addShort(out, static_cast<int16_t>(attributes.size()));
+			for (const auto& e : attributes) {
+				addString(out, e.first);
+				addString(out, e.second);
+			}
+		}
+	}
+
+public:
+	AIStateDeltaMessage(int32_t sequence, bool full) :
+			IProtocolMessage(PROTO_STATEDELTA), _sequence(sequence), _full(full) {
+	}
+
+	explicit AIStateDeltaMessage(streamContainer& in) :
+			IProtocolMessage(PROTO_STATEDELTA) {
+		_sequence = readInt(in);
+		_full = readBool(in);
+		const int changes = readInt(in);
+		_changes.reserve(changes);
+		for (int i = 0; i < changes; ++i) {
+			readDelta(in);
+		}
+		const int removed = readInt(in);
+		_removed.reserve(removed);
+		for (int i = 0; i < removed; ++i) {
+			_removed.push_back(readInt(in));
+		}
+	}
+
+	void addChange(uint8_t flags, AIStateWorld&& state) {
+		_changes.emplace_back(flags, std::move(state));
+	}
+
+	void addRemoved(CharacterId id) {
+		_removed.push_back(id);
+	}
+
+	void serialize(streamContainer& out) const override {
+		addByte(out, _id);
+		addInt(out, _sequence);
+		addBool(out, _full);
+		addInt(out, static_cast<int32_t>(_changes.size()));
+		for (const AIStateDelta& delta : _changes) {
+			writeDelta(out, delta);
+		}
+		addInt(out, static_cast<int32_t>(_removed.size()));
+		for (CharacterId id : _removed) {
+			addInt(out, id);
+		}
+	}
+
+	inline int32_t getSequence() const {
+		return _sequence;
+	}
+
+	inline bool isFull() const {
+		return _full;
+	}
+
+	inline bool isEmpty() const {
+		return !_full && _changes.empty() && _removed.empty();
+	}
+
+	inline const std::vector<AIStateDelta>& getChanges() const {
+		return _changes;
+	}
+
+	inline const std::vector<CharacterId>& getRemoved() const {
+		return _removed;
+	}
+};
+
+}
@@ -0,0 +1,105 @@
+/**
+ * @file
+ */
+
+#include "AIStateStream.h"
+
+namespace ai {
+
+AIStateStream::AIStateStream(const AIStateSubscription& subscription) :
+		_subscription(subscription), _sequence(0), _acknowledged(0), _lastMillis(0L), _update(0u), _full(true) {
+}
+
+void AIStateStream::acknowledge(int32_t sequence) {
+	if (sequence > _acknowledged && sequence <= _sequence) {
+		_acknowledged = sequence;
+	}
+}
+
+bool AIStateStream::isDue(int64_t millis, int rate) const {
+	if (_full) {
+		return true;
+	}
+	if (_sequence - _acknowledged >= MaxUnacknowledged) {
+		return false;
+	}
+	const int clientRate = _subscription.getRate();
+	if (clientRate > 0 && (rate <= 0 || clientRate < rate)) {
+		rate = clientRate;
+	}
+	if (rate <= 0) {
+		return true;
+	}
+	return millis - _lastMillis >= 1000L / rate;
+}
+
+uint8_t AIStateStream::diff(const AIStateWorld& sent, const AIStateWorld& current, CharacterAttributes& changedAttributes) const {
+	uint8_t flags = 0u;
+	if (sent.getPosition() != current.getPosition()) {
+		flags |= AIStateDelta::POSITION;
+	}
+	if (sent.getOrientation() != current.getOrientation()) {
+		flags |= AIStateDelta::ORIENTATION;
+	}
+	const CharacterAttributes& sentAttributes = sent.getAttributes();
+	const CharacterAttributes& attributes = current.getAttributes();
+	size_t kept = 0u;
+	for (const auto& e : attributes) {
+		auto i = sentAttributes.find(e.first);
+		if (i == sentAttributes.end()) {
+			changedAttributes.insert(e);
+			continue;
+		}
+		++kept;
+		if (i->second != e.second) {
+			changedAttributes.insert(e);
+		}
+	}
+	if (kept != sentAttributes.size()) {
+		// attributes were removed - send them all
+		changedAttributes = attributes;
+		flags |= AIStateDelta::ATTRIBUTES | AIStateDelta::ATTRIBUTES_RESET;
+	} else if (!changedAttributes.empty()) {
+		flags |= AIStateDelta::ATTRIBUTES;
+	}
+	return flags;
+}
+
+AIStateDeltaMessage AIStateStream::createDelta(int64_t millis, std::vector<AIStateWorld>& states) {
+	AIStateDeltaMessage msg(_sequence + 1, _full);
+	_lastMillis = millis;
+	++_update;
+	for (AIStateWorld& state : states) {
+		const CharacterId id = state.getId();
+		auto i = _sent.find(id);
+		if (i == _sent.end()) {
+			msg.addChange(AIStateDelta::ALL, AIStateWorld(state));
+			_sent.emplace(id, SentState{std::move(state), _update});
+			continue;
+		}
+		SentState& sent = i->second;
+		sent.update = _update;
+		CharacterAttributes changedAttributes;
+		const uint8_t flags = diff(sent.state, state, changedAttributes);
+		if (flags == 0u) {
+			continue;
+		}
+		msg.addChange(flags, AIStateWorld(id, state.getPosition(), state.getOrientation(), std::move(changedAttributes)));
+		sent.state = std::move(state);
+	}
+	for (auto i = _sent.begin(); i != _sent.end();) {
+		if (i->second.update == _update) {
+			++i;
+			continue;
+		}
+		msg.addRemoved(i->first);
+		i = _sent.erase(i);
+	}
+	_full = false;
+	if (!msg.isEmpty()) {
+		++_sequence;
+	}
+	return msg;
+}
+
+}
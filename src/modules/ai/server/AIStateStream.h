@@ -0,0 +1,70 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "AIStubTypes.h"
+#include "AIStateDeltaMessage.h"
+#include <unordered_map>
+#include <vector>
+
+namespace ai {
+
+/**
+ * @brief The server side state of a client that subscribed to the @c AIStateDeltaMessage stream
+ *
+ * Remembers the @c AIStateWorld of every character that was sent to the client to only send the changes
+ * with the next delta. The stream is transported over tcp - so the client applies the deltas in the order
+ * they were created. The acknowledged sequence is used to stop sending new deltas to clients that can't
+ * keep up - the changes are accumulated in the next delta instead.
+ */
+class AIStateStream {
+private:
+	struct SentState {
+		AIStateWorld state;
+		uint32_t update;
+	};
+	typedef std::unordered_map<CharacterId, SentState> SentStates;
+	AIStateSubscription _subscription;
+	SentStates _sent;
+	int32_t _sequence;
+	int32_t _acknowledged;
+	int64_t _lastMillis;
+	uint32_t _update;
+	bool _full;
+
+	uint8_t diff(const AIStateWorld& sent, const AIStateWorld& current, CharacterAttributes& changedAttributes) const;
+public:
+	/**
+	 * @brief The amount of deltas that may be in flight before the server waits for the client
+	 */
+	static constexpr int32_t MaxUnacknowledged = 4;
+
+	explicit AIStateStream(const AIStateSubscription& subscription);
+
+	const AIStateSubscription& getSubscription() const;
+
+	void acknowledge(int32_t sequence);
+
+	/**
+	 * @param[in] millis The current server time
+	 * @param[in] rate The max amount of deltas per second the server sends to a client. @c 0 doesn't limit the rate.
+	 * @return @c true if it's time to create a new delta for this client
+	 */
+	bool isDue(int64_t millis, int rate) const;
+
+	/**
+	 * @brief Creates the delta between the states that were sent before and the given states
+	 *
+	 * @param[in] millis The current server time
+	 * @param[in] states The current states of all the characters that match the subscription.
+	 * @return The message to send to the client - don't send it if it's empty
+	 */
+	AIStateDeltaMessage createDelta(int64_t millis, std::vector<AIStateWorld>& states);
+};
+
+inline const AIStateSubscription& AIStateStream::getSubscription() const {
+	return _subscription;
+}
+
+}
@@ -4,9 +4,12 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
 #include "core/String.h"
 #include "ICharacter.h"
 #include "common/Math.h"
+#include <glm/vec2.hpp>
+#include <glm/common.hpp>
 #include "tree/TreeNode.h"
 
 namespace ai {
@@ -216,6 +219,10 @@ public:
 		return _orientation;
 	}
 
+	inline void setOrientation(float orientation) {
+		_orientation = orientation;
+	}
+
 	/**
 	 * @return The position in the world
 	 */
@@ -223,6 +230,10 @@ public:
 		return _position;
 	}
 
+	inline void setPosition(const glm::vec3& position) {
+		_position = position;
+	}
+
 	/**
 	 * @return Attributes for the entity
 	 */
@@ -238,4 +249,137 @@ public:
 	}
 };
 
+/**
+ * @brief The part of the zone a debugger client wants to receive the @c AIStateWorld updates for
+ *
+ * A character matches if it is inside the area (on the x and z axis) or if its id is part of the
+ * subscribed character ids. An empty subscription falls back to the full @c AIStateMessage broadcast.
+ */
+class AIStateSubscription {
+private:
+	bool _area;
+	glm::vec2 _mins;
+	glm::vec2 _maxs;
+	// sorted
+	std::vector<ai::CharacterId> _characterIds;
+	int16_t _rate;
+public:
+	AIStateSubscription() :
+			_area(false), _mins(0.0f), _maxs(0.0f), _rate(0) {
+	}
+
+	/**
+	 * @param mins The lower x and z coordinates of the area
+	 * @param maxs The upper x and z coordinates of the area
+	 */
+	inline void setArea(const glm::vec2& mins, const glm::vec2& maxs) {
+		_area = true;
+		_mins = (glm::min)(mins, maxs);
+		_maxs = (glm::max)(mins, maxs);
+	}
+
+	inline void addCharacterId(ai::CharacterId id) {
+		auto i = std::lower_bound(_characterIds.begin(), _characterIds.end(), id);
+		if (i == _characterIds.end() || *i != id) {
+			_characterIds.insert(i, id);
+		}
+	}
+
+	/**
+	 * @param rate The amount of updates per second the client wants to receive. @c 0 means that the
+	 * server rate is used. The server never sends more updates than its own rate allows.
+	 */
+	inline void setRate(int16_t rate) {
+		_rate = rate;
+	}
+
+	inline bool hasArea() const {
+		return _area;
+	}
+
+	inline const glm::vec2& getMins() const {
+		return _mins;
+	}
+
+	inline const glm::vec2& getMaxs() const {
+		return _maxs;
+	}
+
+	inline const std::vector<ai::CharacterId>& getCharacterIds() const {
+		return _characterIds;
+	}
+
+	inline int16_t getRate() const {
+		return _rate;
+	}
+
+	inline bool isEmpty() const {
+		return !_area && _characterIds.empty();
+	}
+
+	inline bool matches(ai::CharacterId id, const glm::vec3& position) const {
+		if (_area && position.x >= _mins.x && position.x <= _maxs.x && position.z >= _mins.y && position.z <= _maxs.y) {
+			return true;
+		}
+		return std::binary_search(_characterIds.begin(), _characterIds.end(), id);
+	}
+};
+
+/**
+ * @brief The changed parts of a @c AIStateWorld relative to the state the client already knows
+ * @sa AIStateDeltaMessage
+ */
+class AIStateDelta {
+public:
+	enum Flags : uint8_t {
+		POSITION = 1 << 0,
+		ORIENTATION = 1 << 1,
+		// the attributes only contain the changed key value pairs
+		ATTRIBUTES = 1 << 2,
+		// the client has to drop all known attributes before the attributes are applied
+		ATTRIBUTES_RESET = 1 << 3,
+
+		ALL = POSITION | ORIENTATION | ATTRIBUTES | ATTRIBUTES_RESET
+	};
+private:
+	uint8_t _flags;
+	AIStateWorld _state;
+public:
+	AIStateDelta(uint8_t flags, AIStateWorld&& state) :
+			_flags(flags), _state(std::move(state)) {
+	}
+
+	inline uint8_t getFlags() const {
+		return _flags;
+	}
+
+	/**
+	 * @return The state that only contains valid values for the fields that are marked in the flags
+	 */
+	inline const AIStateWorld& getState() const {
+		return _state;
+	}
+
+	/**
+	 * @brief Applies the changes to the state the client already knows about this character
+	 */
+	void apply(AIStateWorld& target) const {
+		if (_flags & POSITION) {
+			target.setPosition(_state.getPosition());
+		}
+		if (_flags & ORIENTATION) {
+			target.setOrientation(_state.getOrientation());
+		}
+		CharacterAttributes& attributes = target.getAttributes();
+		if (_flags & ATTRIBUTES_RESET) {
+			attributes.clear();
+		}
+		if (_flags & ATTRIBUTES) {
+			for (const auto& e : _state.getAttributes()) {
+				attributes[e.first] = e.second;
+			}
+		}
+	}
+};
+
 }
@@ -0,0 +1,65 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "IProtocolMessage.h"
+#include "AIStubTypes.h"
+
+namespace ai {
+
+/**
+ * @brief Message for the remote debugging interface
+ *
+ * Subscribes the client to the @c AIStateDeltaMessage stream for the given area and characters. The client
+ * no longer receives the full @c AIStateMessage - but only the changes of the characters that match the
+ * @c AIStateSubscription. Sending an empty subscription switches back to the full state broadcast.
+ */
+class AISubscribeMessage: public IProtocolMessage {
+private:
+	AIStateSubscription _subscription;
+
+public:
+	explicit AISubscribeMessage(const AIStateSubscription& subscription) :
+			IProtocolMessage(PROTO_SUBSCRIBE), _subscription(subscription) {
+	}
+
+	explicit AISubscribeMessage(streamContainer& in) :
+			IProtocolMessage(PROTO_SUBSCRIBE) {
+		if (readBool(in)) {
+			const float minsX = readFloat(in);
+			const float minsZ = readFloat(in);
+			const float maxsX = readFloat(in);
+			const float maxsZ = readFloat(in);
+			_subscription.setArea(glm::vec2(minsX, minsZ), glm::vec2(maxsX, maxsZ));
+		}
+		const int size = readInt(in);
+		for (int i = 0; i < size; ++i) {
+			_subscription.addCharacterId(readInt(in));
+		}
+		_subscription.setRate(readShort(in));
+	}
+
+	void serialize(streamContainer& out) const override {
+		addByte(out, _id);
+		addBool(out, _subscription.hasArea());
+		if (_subscription.hasArea()) {
+			addFloat(out, _subscription.getMins().x);
+			addFloat(out, _subscription.getMins().y);
+			addFloat(out, _subscription.getMaxs().x);
+			addFloat(out, _subscription.getMaxs().y);
+		}
+		const std::vector<CharacterId>& ids = _subscription.getCharacterIds();
+		addInt(out, static_cast<int32_t>(ids.size()));
+		for (CharacterId id : ids) {
+			addInt(out, id);
+		}
+		addShort(out, _subscription.getRate());
+	}
+
+	inline const AIStateSubscription& getSubscription() const {
+		return _subscription;
+	}
+};
+
+}
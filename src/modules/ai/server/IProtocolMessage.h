@@ -51,6 +51,9 @@ const ProtocolId PROTO_STEP = 9;
 const ProtocolId PROTO_UPDATENODE = 10;
 const ProtocolId PROTO_DELETENODE = 11;
 const ProtocolId PROTO_ADDNODE = 12;
+const ProtocolId PROTO_SUBSCRIBE = 13;
+const ProtocolId PROTO_STATEDELTA = 14;
+const ProtocolId PROTO_STATEACK = 15;
 
 /**
  * @brief A protocol message is used for the serialization of the ai states for remote debugging
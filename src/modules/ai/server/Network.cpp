@@ -41,7 +41,7 @@
 namespace ai {
 
 Network::Network(uint16_t port, const core::String& hostname) :
-		_port(port), _hostname(hostname), _socketFD(INVALID_SOCKET), _time(0L) {
+		_port(port), _hostname(hostname), _socketFD(INVALID_SOCKET), _time(0L), _nextClientId(0u) {
 	FD_ZERO(&_readFDSet);
 	FD_ZERO(&_writeFDSet);
 }
@@ -177,7 +177,7 @@ void Network::update(int64_t deltaTime) {
 		const SOCKET clientSocket = accept(_socketFD, nullptr, nullptr);
 		if (clientSocket != INVALID_SOCKET) {
 			FD_SET(clientSocket, &_readFDSet);
-			const Client c(clientSocket);
+			const Client c(_nextClientId++, clientSocket);
 			_clientSockets.push_back(c);
 			for (INetworkListener* listener : _listeners) {
 				listener->onConnect(&_clientSockets.back());
@@ -185,8 +185,7 @@ void Network::update(int64_t deltaTime) {
 		}
 	}
 
-	ClientId clientId = 0;
-	for (ClientSocketsIter i = _clientSockets.begin(); i != _clientSockets.end(); ++clientId) {
+	for (ClientSocketsIter i = _clientSockets.begin(); i != _clientSockets.end();) {
 		Client& client = *i;
 		const SOCKET clientSocket = client.socket;
 		if (clientSocket == INVALID_SOCKET) {
@@ -220,30 +219,47 @@ void Network::update(int64_t deltaTime) {
 			}
 			IProtocolHandler* handler = ProtocolHandlerRegistry::get().getHandler(*msg);
 			if (handler) {
-				handler->execute(clientId, *msg);
+				handler->execute(client.id, *msg);
 			}
 		}
 		++i;
 	}
 }
 
+void Network::enqueue(Client& client, const streamContainer& out) {
+	IProtocolMessage::addInt(client.out, static_cast<int32_t>(out.size()));
+	std::copy(out.begin(), out.end(), std::back_inserter(client.out));
+	FD_SET(client.socket, &_writeFDSet);
+}
+
 bool Network::broadcast(const IProtocolMessage& msg) {
+	static const auto all = [] (const Client&) {
+		return true;
+	};
+	return broadcast(msg, all);
+}
+
+bool Network::broadcast(const IProtocolMessage& msg, const std::function<bool(const Client&)>& filter) {
 	if (_clientSockets.empty()) {
 		return false;
 	}
 	_time = 0L;
 	streamContainer out;
-	msg.serialize(out);
+	bool serialized = false;
 	for (ClientSocketsIter i = _clientSockets.begin(); i != _clientSockets.end(); ++i) {
 		Client& client = *i;
 		if (client.socket == INVALID_SOCKET) {
 			i = closeClient(i);
 			continue;
 		}
-
-		IProtocolMessage::addInt(client.out, static_cast<int32_t>(out.size()));
-		std::copy(out.begin(), out.end(), std::back_inserter(client.out));
-		FD_SET(client.socket, &_writeFDSet);
+		if (!filter(client)) {
+			continue;
+		}
+		if (!serialized) {
+			msg.serialize(out);
+			serialized = true;
+		}
+		enqueue(client, out);
 	}
 
 	return true;
@@ -257,13 +273,19 @@ bool Network::sendToClient(Client* client, const IProtocolMessage& msg) {
 
 	streamContainer out;
 	msg.serialize(out);
-
-	IProtocolMessage::addInt(client->out, static_cast<int32_t>(out.size()));
-	std::copy(out.begin(), out.end(), std::back_inserter(client->out));
-	FD_SET(client->socket, &_writeFDSet);
+	enqueue(*client, out);
 	return true;
 }
 
+Client* Network::getClient(ClientId id) {
+	for (Client& client : _clientSockets) {
+		if (client.id == id) {
+			return &client;
+		}
+	}
+	return nullptr;
+}
+
 #undef network_cleanup
 #undef INVALID_SOCKET
 #ifndef WIN32
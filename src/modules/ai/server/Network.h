@@ -8,6 +8,7 @@
 #include "core/String.h"
 #include <stdint.h>
 #include <list>
+#include <functional>
 #ifdef WIN32
 #ifndef NOMINMAX
 #define NOMINMAX
@@ -25,9 +26,11 @@ namespace ai {
 class IProtocolMessage;
 
 struct Client {
-	explicit Client(SOCKET _socket) :
-			socket(_socket), finished(false), in(), out() {
+	Client(ClientId _id, SOCKET _socket) :
+			id(_id), socket(_socket), finished(false), in(), out() {
 	}
+	// stays the same for the whole connection - unlike the position in the client list
+	ClientId id;
 	SOCKET socket;
 	bool finished;
 	streamContainer in;
@@ -51,6 +54,7 @@ protected:
 	fd_set _readFDSet;
 	fd_set _writeFDSet;
 	int64_t _time;
+	ClientId _nextClientId;
 
 	typedef std::list<Client> ClientSockets;
 	typedef ClientSockets::iterator ClientSocketsIter;
@@ -61,6 +65,7 @@ protected:
 	Listeners _listeners;
 
 	bool sendMessage(Client& client);
+	void enqueue(Client& client, const streamContainer& out);
 public:
 	Network(uint16_t port = 10001, const core::String& hostname = "0.0.0.0");
 	virtual ~Network();
@@ -77,7 +82,16 @@ public:
 	 * @return @c false if there are no clients
 	 */
 	bool broadcast(const IProtocolMessage& msg);
+	/**
+	 * @brief Only sends the message to the clients the given filter returns @c true for
+	 * @note The message is only serialized once
+	 */
+	bool broadcast(const IProtocolMessage& msg, const std::function<bool(const Client&)>& filter);
 	bool sendToClient(Client* client, const IProtocolMessage& msg);
+	/**
+	 * @return @c nullptr if there is no connected client with the given id
+	 */
+	Client* getClient(ClientId id);
 };
 
 inline int Network::getConnectedClients() const {
@@ -11,9 +11,12 @@
 #include "AddNodeHandler.h"
 #include "DeleteNodeHandler.h"
 #include "UpdateNodeHandler.h"
+#include "SubscribeHandler.h"
+#include "StateAckHandler.h"
 
 #include "AIPauseMessage.h"
 #include "AIStateMessage.h"
+#include "AIStateDeltaMessage.h"
 #include "AINamesMessage.h"
 #include "AICharacterDetailsMessage.h"
 #include "AICharacterStaticMessage.h"
@@ -32,7 +35,8 @@ Server::Server(AIRegistry& aiRegistry, short port, const core::String& hostname)
 		_aiRegistry(aiRegistry), _network(port, hostname), _selectedCharacterId(AI_NOTHING_SELECTED), _time(0L),
 		_selectHandler(new SelectHandler(*this)), _pauseHandler(new PauseHandler(*this)), _resetHandler(new ResetHandler(*this)),
 		_stepHandler(new StepHandler(*this)), _changeHandler(new ChangeHandler(*this)), _addNodeHandler(new AddNodeHandler(*this)),
-		_deleteNodeHandler(new DeleteNodeHandler(*this)), _updateNodeHandler(new UpdateNodeHandler(*this)), _pause(false), _zone(nullptr) {
+		_deleteNodeHandler(new DeleteNodeHandler(*this)), _updateNodeHandler(new UpdateNodeHandler(*this)),
+		_subscribeHandler(new SubscribeHandler(*this)), _stateAckHandler(new StateAckHandler(*this)), _pause(false), _zone(nullptr) {
 	_network.addListener(this);
 	ProtocolHandlerRegistry& r = ai::ProtocolHandlerRegistry::get();
 	r.registerHandler(ai::PROTO_SELECT, _selectHandler);
@@ -44,6 +48,8 @@ Server::Server(AIRegistry& aiRegistry, short port, const core::String& hostname)
 	r.registerHandler(ai::PROTO_ADDNODE, _addNodeHandler);
 	r.registerHandler(ai::PROTO_DELETENODE, _deleteNodeHandler);
 	r.registerHandler(ai::PROTO_UPDATENODE, _updateNodeHandler);
+	r.registerHandler(ai::PROTO_SUBSCRIBE, _subscribeHandler);
+	r.registerHandler(ai::PROTO_STATEACK, _stateAckHandler);
 }
 
 Server::~Server() {
@@ -55,6 +61,8 @@ Server::~Server() {
 	delete _addNodeHandler;
 	delete _deleteNodeHandler;
 	delete _updateNodeHandler;
+	delete _subscribeHandler;
+	delete _stateAckHandler;
 	_network.removeListener(this);
 }
 
@@ -70,8 +78,9 @@ void Server::onConnect(Client* client) {
 	enqueueEvent(event);
 }
 
-void Server::onDisconnect(Client* /*client*/) {
+void Server::onDisconnect(Client* client) {
 	ai_log("remote debugger disconnect (%i)", _network.getConnectedClients());
+	_streams.erase(client->id);
 	Zone* zone = _zone;
 	if (zone == nullptr) {
 		return;
@@ -126,8 +135,61 @@ void Server::addChildren(const TreeNodePtr& node, AIStateNode& parent, const AIP
 	}
 }
 
-void Server::broadcastState(const Zone* zone) {
+void Server::collectStates(const Zone* zone, const AIStateSubscription& subscription, std::vector<AIStateWorld>& out) const {
+	const auto add = [&] (const AIPtr& ai) {
+		const ICharacterPtr& chr = ai->getCharacter();
+		out.emplace_back(chr->getId(), chr->getPosition(), chr->getOrientation(), chr->getAttributes());
+	};
+	if (!subscription.hasArea()) {
+		// only look up the subscribed characters instead of visiting the whole zone
+		for (CharacterId id : subscription.getCharacterIds()) {
+			const AIPtr& ai = zone->getAI(id);
+			if (ai) {
+				add(ai);
+			}
+		}
+		return;
+	}
+	auto func = [&] (const AIPtr& ai) {
+		const ICharacterPtr& chr = ai->getCharacter();
+		if (subscription.matches(chr->getId(), chr->getPosition())) {
+			add(ai);
+		}
+	};
+	zone->execute(func);
+}
+
+void Server::broadcastStateDeltas(const Zone* zone, bool throttle) {
+	std::vector<AIStateWorld> states;
+	for (auto& e : _streams) {
+		AIStateStream& stream = e.second;
+		if (throttle && !stream.isDue(_time, _stateRate)) {
+			continue;
+		}
+		Client* client = _network.getClient(e.first);
+		if (client == nullptr) {
+			continue;
+		}
+		states.clear();
+		collectStates(zone, stream.getSubscription(), states);
+		const AIStateDeltaMessage& msg = stream.createDelta(_time, states);
+		if (!msg.isEmpty()) {
+			_network.sendToClient(client, msg);
+		}
+	}
+}
+
+void Server::broadcastState(const Zone* zone, bool throttle) {
 	_broadcastMask |= SV_BROADCAST_STATE;
+	broadcastStateDeltas(zone, throttle);
+	// the clients that didn't subscribe get the full state
+	if ((int)_streams.size() >= _network.getConnectedClients()) {
+		return;
+	}
+	if (throttle && _stateRate > 0 && _time - _lastStateMillis < 1000L / _stateRate) {
+		return;
+	}
+	_lastStateMillis = _time;
 	AIStateMessage msg;
 	auto func = [&] (const AIPtr& ai) {
 		const ICharacterPtr& chr = ai->getCharacter();
@@ -135,7 +197,14 @@ void Server::broadcastState(const Zone* zone) {
 		msg.addState(b);
 	};
 	zone->execute(func);
-	_network.broadcast(msg);
+	if (_streams.empty()) {
+		_network.broadcast(msg);
+		return;
+	}
+	const auto unsubscribed = [this] (const Client& client) {
+		return _streams.find(client.id) == _streams.end();
+	};
+	_network.broadcast(msg, unsubscribed);
 }
 
 void Server::broadcastStaticCharacterDetails(const Zone* zone) {
@@ -314,6 +383,21 @@ void Server::handleEvents(Zone* zone, bool pauseState) {
 
 			break;
 		}
+		case EV_SUBSCRIBE: {
+			const ClientId clientId = event.data.clientId;
+			_streams.erase(clientId);
+			if (!event.subscription.isEmpty() && _network.getClient(clientId) != nullptr) {
+				_streams.emplace(clientId, AIStateStream(event.subscription));
+			}
+			break;
+		}
+		case EV_STATEACK: {
+			auto i = _streams.find(event.data.ack.clientId);
+			if (i != _streams.end()) {
+				i->second.acknowledge(event.data.ack.sequence);
+			}
+			break;
+		}
 		case EV_MAX:
 			break;
 		}
@@ -362,6 +446,7 @@ bool Server::updateNode(const CharacterId& characterId, int32_t nodeId, const co
 		}
 		parent->replaceChild(nodeId, newNode);
 	}
+	TreeNode::assignStateIndices(ai->getBehaviour());
 
 	Event event;
 	event.type = EV_UPDATESTATICCHRDETAILS;
@@ -399,6 +484,7 @@ bool Server::addNode(const CharacterId& characterId, int32_t parentNodeId, const
 	if (!node->addChild(newNode)) {
 		return false;
 	}
+	TreeNode::assignStateIndices(ai->getBehaviour());
 
 	Event event;
 	event.type = EV_UPDATESTATICCHRDETAILS;
@@ -478,6 +564,26 @@ void Server::pause(const ClientId& /*clientId*/, bool state) {
 	enqueueEvent(event);
 }
 
+void Server::subscribe(const ClientId& clientId, const AIStateSubscription& subscription) {
+	Event event;
+	event.type = EV_SUBSCRIBE;
+	event.data.clientId = clientId;
+	event.subscription = subscription;
+	enqueueEvent(event);
+}
+
+void Server::acknowledge(const ClientId& clientId, int32_t sequence) {
+	Event event;
+	event.type = EV_STATEACK;
+	event.data.ack.clientId = clientId;
+	event.data.ack.sequence = sequence;
+	enqueueEvent(event);
+}
+
+void Server::setStateRate(int rate) {
+	_stateRate = (std::max)(0, rate);
+}
+
 void Server::step(int64_t stepMillis) {
 	Event event;
 	event.type = EV_STEP;
@@ -497,7 +603,7 @@ void Server::update(int64_t deltaTime) {
 	if (clients > 0 && zone != nullptr) {
 		if (!pauseState) {
 			if ((_broadcastMask & SV_BROADCAST_STATE) == 0) {
-				broadcastState(zone);
+				broadcastState(zone, true);
 			}
 			if ((_broadcastMask & SV_BROADCAST_CHRDETAILS) == 0) {
 				broadcastCharacterDetails(zone);
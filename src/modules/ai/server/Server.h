@@ -6,11 +6,13 @@
 #include "common/Thread.h"
 #include "tree/TreeNode.h"
 #include <unordered_set>
+#include <unordered_map>
 #include "Network.h"
 #include "zone/Zone.h"
 #include "AIRegistry.h"
 #include "AIStubTypes.h"
 #include "ProtocolHandlerRegistry.h"
+#include "AIStateStream.h"
 #include "tree/TreeNode.h"
 
 namespace ai {
@@ -26,6 +28,8 @@ class ChangeHandler;
 class AddNodeHandler;
 class DeleteNodeHandler;
 class UpdateNodeHandler;
+class SubscribeHandler;
+class StateAckHandler;
 class NopHandler;
 
 /**
@@ -39,6 +43,11 @@ class NopHandler;
  * clients. If someone selected a particular @ai{AI} instance by sending @ai{AISelectMessage} to the server, it
  * will also broadcast an @ai{AICharacterDetailsMessage} to all connected clients.
  *
+ * Clients can subscribe to a part of the zone by sending an @ai{AISubscribeMessage}. They will then only receive
+ * an @ai{AIStateDeltaMessage} with the changes of the subscribed characters instead of the full world state - at
+ * most with the rate that was configured with @ai{setStateRate()}. This keeps the costs of an attached debugger
+ * low even for zones with a lot of characters.
+ *
  * You can only debug one @ai{Zone} at the same time. The debugging session is shared between all connected clients.
  */
 class Server: public INetworkListener {
@@ -59,6 +68,8 @@ protected:
 	AddNodeHandler *_addNodeHandler;
 	DeleteNodeHandler *_deleteNodeHandler;
 	UpdateNodeHandler *_updateNodeHandler;
+	SubscribeHandler *_subscribeHandler;
+	StateAckHandler *_stateAckHandler;
 	NopHandler _nopHandler;
 	core::AtomicBool _pause;
 	// the current active debugging zone
@@ -66,6 +77,11 @@ protected:
 	ReadWriteLock _lock = {"server"};
 	std::vector<core::String> _names;
 	uint32_t _broadcastMask = 0u;
+	// the clients that subscribed to the delta state stream
+	std::unordered_map<ClientId, AIStateStream> _streams;
+	// max state updates per second - 0 means every update
+	int _stateRate = 0;
+	int64_t _lastStateMillis = 0L;
 
 	enum EventType {
 		EV_SELECTION,
@@ -77,6 +93,8 @@ protected:
 		EV_PAUSE,
 		EV_RESET,
 		EV_SETDEBUG,
+		EV_SUBSCRIBE,
+		EV_STATEACK,
 
 		EV_MAX
 	};
@@ -87,9 +105,15 @@ protected:
 			int64_t stepMillis;
 			Zone* zone;
 			Client* newClient;
+			ClientId clientId;
 			bool pauseState;
+			struct {
+				ClientId clientId;
+				int32_t sequence;
+			} ack;
 		} data;
 		core::String strData = "";
+		AIStateSubscription subscription;
 		EventType type;
 	};
 	std::vector<Event> _events;
@@ -99,8 +123,14 @@ protected:
 	void addChildren(const TreeNodePtr& node, std::vector<AIStateNodeStatic>& out) const;
 	void addChildren(const TreeNodePtr& node, AIStateNode& parent, const AIPtr& ai) const;
 
+	void collectStates(const Zone* zone, const AIStateSubscription& subscription, std::vector<AIStateWorld>& out) const;
+
 	// only call these from the Server::update method
-	void broadcastState(const Zone* zone);
+	/**
+	 * @param throttle Only send the state if the configured state rate allows it
+	 */
+	void broadcastState(const Zone* zone, bool throttle = false);
+	void broadcastStateDeltas(const Zone* zone, bool throttle);
 	void broadcastCharacterDetails(const Zone* zone);
 	void broadcastStaticCharacterDetails(const Zone* zone);
 
@@ -203,6 +233,24 @@ public:
 	 */
 	void step(int64_t stepMillis = 1L);
 
+	/**
+	 * @brief Subscribe the client to the @ai{AIStateDeltaMessage} stream for the given area and characters
+	 *
+	 * @note An empty subscription switches the client back to the full @ai{AIStateMessage} broadcast
+	 */
+	void subscribe(const ClientId& clientId, const AIStateSubscription& subscription);
+
+	/**
+	 * @brief The client applied the @ai{AIStateDeltaMessage} with the given sequence
+	 */
+	void acknowledge(const ClientId& clientId, int32_t sequence);
+
+	/**
+	 * @brief Limits the amount of state updates that are sent to the clients per second
+	 * @param[in] rate @c 0 sends the state with every @ai{update()} call
+	 */
+	void setStateRate(int rate);
+
 	/**
 	 * @brief call this to update the server - should get called somewhere from your game tick
 	 */
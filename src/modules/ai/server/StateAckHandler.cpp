@@ -0,0 +1,19 @@
+/**
+ * @file
+ */
+
+#include "StateAckHandler.h"
+#include "Server.h"
+#include "AIStateAckMessage.h"
+
+namespace ai {
+
+StateAckHandler::StateAckHandler(Server& server) : _server(server) {
+}
+
+void StateAckHandler::execute(const ClientId& clientId, const IProtocolMessage& message) {
+	const AIStateAckMessage& msg = static_cast<const AIStateAckMessage&>(message);
+	_server.acknowledge(clientId, msg.getSequence());
+}
+
+}
@@ -0,0 +1,19 @@
+/**
+ * @file
+ */
+
+#include "SubscribeHandler.h"
+#include "Server.h"
+#include "AISubscribeMessage.h"
+
+namespace ai {
+
+SubscribeHandler::SubscribeHandler(Server& server) : _server(server) {
+}
+
+void SubscribeHandler::execute(const ClientId& clientId, const IProtocolMessage& message) {
+	const AISubscribeMessage& msg = static_cast<const AISubscribeMessage&>(message);
+	_server.subscribe(clientId, msg.getSubscription());
+}
+
+}
@@ -0,0 +1,21 @@
+/**
+ * @file
+ */
+#pragma once
+
+#include "IProtocolHandler.h"
+
+namespace ai {
+
+class Server;
+
+class SubscribeHandler: public ai::IProtocolHandler {
+private:
+	Server& _server;
+public:
+	explicit SubscribeHandler(Server& server);
+
+	void execute(const ClientId& clientId, const IProtocolMessage& message) override;
+};
+
+}
@@ -0,0 +1,99 @@
+/**
+ * @file
+ * @brief Ticks a zone with npcs that execute the behaviour trees that are shipped with the server.
+ *
+ * The server side tasks, conditions, filters and steerings are replaced by placeholders - this measures
+ * the behaviour tree traversal and the access to the node states of the ai instances.
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "TestEntity.h"
+#include "tree/ITask.h"
+#include "tree/loaders/lua/LUATreeLoader.h"
+#include "conditions/False.h"
+#include "filter/SelectEmpty.h"
+#include "movement/Wander.h"
+#include "core/io/Filesystem.h"
+#include "core/Log.h"
+
+class BehaviourTreeBenchmark: public core::AbstractBenchmark {
+protected:
+	class PlaceholderTask: public ai::ITask {
+	public:
+		TASK_CLASS(PlaceholderTask)
+		NODE_FACTORY(PlaceholderTask)
+
+		ai::TreeNodeStatus doAction(const ai::AIPtr& /*entity*/, int64_t /*deltaMillis*/) override {
+			return ai::FINISHED;
+		}
+	};
+
+	ai::AIRegistry _registry;
+	ai::LUATreeLoader _loader { _registry };
+	std::vector<core::String> _trees;
+
+	void fill(ai::Zone& zone, int n) {
+		for (int i = 0; i < n; ++i) {
+			const ai::TreeNodePtr& root = _loader.load(_trees[i % _trees.size()]);
+			const ai::ICharacterPtr character = std::make_shared<TestEntity>(i);
+			const ai::AIPtr ai = std::make_shared<ai::AI>(root);
+			ai->setCharacter(character);
+			zone.addAI(ai);
+		}
+		// apply the scheduled adds
+		zone.update(0l);
+	}
+
+	void tick(ai::Zone& zone, benchmark::State& state) {
+		for (auto _ : state) {
+			zone.update(50l);
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+
+public:
+	bool onInitApp() override {
+		const char *tasks[] = { "GoHome", "AttackOnSelection", "SetPointOfInterest", "Spawn", "Die",
+				"TriggerCooldown", "TriggerCooldownOnSelection" };
+		for (const char *task : tasks) {
+			_registry.registerNodeFactory(task, PlaceholderTask::getFactory());
+		}
+		const char *conditions[] = { "IsCloseToSelection", "IsOnCooldown", "IsSelectionAlive" };
+		for (const char *condition : conditions) {
+			_registry.registerConditionFactory(condition, ai::False::getFactory());
+		}
+		const char *filters[] = { "SelectVisible", "SelectIncreasePartner", "SelectEntitiesOfTypes" };
+		for (const char *filter : filters) {
+			_registry.registerFilterFactory(filter, ai::SelectEmpty::getFactory());
+		}
+		_registry.registerSteeringFactory("WanderAroundHome", ai::movement::Wander::getFactory());
+
+		const core::String& lua = io::filesystem()->load("behaviourtrees.lua");
+		if (!_loader.init(lua)) {
+			Log::error("Failed to load the behaviour trees: %s", _loader.getError().c_str());
+			return false;
+		}
+		_loader.getTrees(_trees);
+		return !_trees.empty();
+	}
+
+	void onCleanupApp() override {
+		_trees.clear();
+		_loader.shutdown();
+	}
+};
+
+BENCHMARK_DEFINE_F(BehaviourTreeBenchmark, updateSingleThread) (benchmark::State& state) {
+	ai::Zone zone("benchmark", 1);
+	fill(zone, (int)state.range(0));
+	tick(zone, state);
+}
+
+BENCHMARK_DEFINE_F(BehaviourTreeBenchmark, update) (benchmark::State& state) {
+	ai::Zone zone("benchmark");
+	fill(zone, (int)state.range(0));
+	tick(zone, state);
+}
+
+BENCHMARK_REGISTER_F(BehaviourTreeBenchmark, updateSingleThread)->Arg(10000)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(BehaviourTreeBenchmark, update)->Arg(10000)->UseRealTime()->Unit(benchmark::kMillisecond);
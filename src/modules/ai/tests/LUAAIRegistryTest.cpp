@@ -7,6 +7,9 @@
 #include "core/io/Filesystem.h"
 #include <fstream>
 #include <streambuf>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 class LUAAIRegistryTest: public TestSuite {
 protected:
@@ -153,3 +156,118 @@ TEST_F(LUAAIRegistryTest, testFilter_100) {
 TEST_F(LUAAIRegistryTest, testSteeringEmpty) {
 	testSteering("LuaSteeringTest");
 }
+
+TEST_F(LUAAIRegistryTest, testExecuteAfterShutdown) {
+	const ai::TreeNodeFactoryContext ctx = ai::TreeNodeFactoryContext("TreeNodeName", "", ai::True::get());
+	const ai::TreeNodePtr& node = _registry.createNode("LuaTest", ctx);
+	const ai::ConditionPtr& condition = _registry.createCondition("LuaTestTrue", ctxCondition);
+	const ai::FilterPtr& filter = _registry.createFilter("LuaFilterTest", ctxFilter);
+	const ai::SteeringPtr& steering = _registry.createSteering("LuaSteeringTest", ctxSteering);
+	ASSERT_TRUE(node && condition && filter && steering);
+	const ai::AIPtr& ai = std::make_shared<ai::AI>(node);
+	ai->setCharacter(_chr);
+
+	// there is no lua state anymore - the lua provided nodes must fail instead of crashing
+	_registry.shutdown();
+	ASSERT_EQ(nullptr, _registry.getLuaState());
+	EXPECT_EQ(ai::TreeNodeStatus::EXCEPTION, node->execute(ai, 1L));
+	EXPECT_FALSE(condition->evaluate(ai));
+	filter->filter(ai);
+	EXPECT_TRUE(ai->getFilteredEntities().empty());
+	const ai::MoveVector& mv = steering->execute(ai, 1.0f);
+	EXPECT_EQ(glm::vec3(0.0f), mv.getVector());
+	EXPECT_FLOAT_EQ(0.0f, mv.getRotation());
+}
+
+TEST_F(LUAAIRegistryTest, testWorkerThreadStates) {
+	const ai::ConditionPtr& condition = _registry.createCondition("LuaTestTrue", ctxCondition);
+	ASSERT_TRUE((bool)condition);
+	const ai::FilterPtr& filter = _registry.createFilter("LuaFilterTest", ctxFilter);
+	ASSERT_TRUE((bool)filter);
+	lua_State* mainState = _registry.getLuaState();
+	const int threadCount = 4;
+	std::vector<lua_State*> states(threadCount, nullptr);
+	std::vector<int> evaluations(threadCount, 0);
+	std::vector<std::thread> threads;
+	// the states of exited threads are closed - keep the threads alive until all of them got their state
+	std::atomic<int> ready{0};
+	for (int t = 0; t < threadCount; ++t) {
+		threads.emplace_back([&, t] () {
+			const ai::AIPtr& ai = std::make_shared<ai::AI>(ai::TreeNodePtr());
+			ai->setCharacter(std::make_shared<TestEntity>(t + 1));
+			for (int i = 0; i < 100; ++i) {
+				if (condition->evaluate(ai)) {
+					++evaluations[t];
+				}
+				filter->filter(ai);
+			}
+			states[t] = _registry.getLuaState();
+			++ready;
+			while (ready != threadCount) {
+				std::this_thread::yield();
+			}
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	for (int t = 0; t < threadCount; ++t) {
+		EXPECT_EQ(100, evaluations[t]) << "Thread " << t;
+		ASSERT_NE(nullptr, states[t]) << "Thread " << t;
+		EXPECT_NE(mainState, states[t]) << "Thread " << t << " should have its own lua state";
+		for (int o = t + 1; o < threadCount; ++o) {
+			EXPECT_NE(states[o], states[t]) << "Thread " << t << " and " << o << " share a lua state";
+		}
+	}
+}
+
+TEST_F(LUAAIRegistryTest, testExitedThreadStatesAreRemoved) {
+	_registry.getLuaState();
+	for (int i = 0; i < 10; ++i) {
+		lua_State* state = nullptr;
+		std::thread worker([&] () {
+			state = _registry.getLuaState();
+		});
+		worker.join();
+		ASSERT_NE(nullptr, state);
+	}
+	EXPECT_EQ(2u, _registry.stateCount()) << "Only the main state and the state of the last worker should be left";
+}
+
+TEST_F(LUAAIRegistryTest, testSharedData) {
+	_registry.setSharedNumber("maxId", 10.0);
+	_registry.setSharedString("name", "shared");
+	ASSERT_TRUE(_registry.evaluate(core::String(
+		"local condition = REGISTRY.createCondition(\"LuaTestShared\")\n"
+		"function condition:evaluate(ai)\n"
+		"  return SHARED.name == \"shared\" and ai:id() < SHARED.maxId\n"
+		"end\n")));
+	EXPECT_FALSE(_registry.evaluate(core::String("SHARED.maxId = 100\n"))) << "The shared data should be read-only";
+
+	const ai::ConditionPtr& condition = _registry.createCondition("LuaTestShared", ctxCondition);
+	ASSERT_TRUE((bool)condition);
+	const ai::AIPtr& ai = std::make_shared<ai::AI>(ai::TreeNodePtr());
+	ai->setCharacter(_chr);
+	EXPECT_TRUE(condition->evaluate(ai));
+
+	// the worker keeps its state between the two evaluations - it has to pick up the changed value
+	std::atomic<int> step{0};
+	bool workerResults[2] = {false, true};
+	std::thread worker([&] () {
+		workerResults[0] = condition->evaluate(ai);
+		step = 1;
+		while (step != 2) {
+			std::this_thread::yield();
+		}
+		workerResults[1] = condition->evaluate(ai);
+	});
+	while (step != 1) {
+		std::this_thread::yield();
+	}
+	_registry.setSharedNumber("maxId", 0.0);
+	EXPECT_FALSE(condition->evaluate(ai));
+	step = 2;
+	worker.join();
+	EXPECT_TRUE(workerResults[0]) << "The script and the shared data should be available in the worker thread state";
+	EXPECT_FALSE(workerResults[1]) << "The changed shared data should be visible in the worker thread state";
+}
@@ -10,6 +10,11 @@
 #include "server/AINamesMessage.h"
 #include "server/AICharacterDetailsMessage.h"
 #include "server/AIStateMessage.h"
+#include "server/AIStateDeltaMessage.h"
+#include "server/AIStateAckMessage.h"
+#include "server/AIStateStream.h"
+#include "server/AISubscribeMessage.h"
+#include "core/StringUtil.h"
 
 class MessageTest: public TestSuite {
 protected:
@@ -112,6 +117,127 @@ TEST_F(MessageTest, testAIStateMessage) {
 	ASSERT_FLOAT_EQ(1.0f, d->getStates()[0].getOrientation());
 }
 
+TEST_F(MessageTest, testAISubscribeMessage) {
+	ai::AIStateSubscription subscription;
+	subscription.setArea(glm::vec2(10.0f, -5.0f), glm::vec2(-10.0f, 5.0f));
+	subscription.addCharacterId(3);
+	subscription.addCharacterId(1);
+	subscription.addCharacterId(3);
+	subscription.setRate(5);
+	ai::AISubscribeMessage m(subscription);
+	ai::AISubscribeMessage* d = serializeDeserialize(m);
+	ASSERT_EQ(m.getId(), d->getId());
+	const ai::AIStateSubscription& s = d->getSubscription();
+	ASSERT_TRUE(s.hasArea());
+	ASSERT_FLOAT_EQ(-10.0f, s.getMins().x);
+	ASSERT_FLOAT_EQ(-5.0f, s.getMins().y);
+	ASSERT_FLOAT_EQ(10.0f, s.getMaxs().x);
+	ASSERT_FLOAT_EQ(5.0f, s.getMaxs().y);
+	ASSERT_EQ(2u, s.getCharacterIds().size());
+	ASSERT_EQ(5, s.getRate());
+	ASSERT_TRUE(s.matches(2, glm::vec3(0.0f, 100.0f, 0.0f)));
+	ASSERT_TRUE(s.matches(3, glm::vec3(100.0f, 0.0f, 0.0f)));
+	ASSERT_FALSE(s.matches(2, glm::vec3(100.0f, 0.0f, 0.0f)));
+	ASSERT_FALSE(ai::AIStateSubscription().matches(1, ai::ZERO));
+}
+
+TEST_F(MessageTest, testAIStateDeltaMessage) {
+	ai::CharacterAttributes attributes;
+	attributes.insert(std::make_pair<core::String, core::String>("Name", "Test"));
+	ai::AIStateDeltaMessage m(42, true);
+	m.addChange(ai::AIStateDelta::ALL, ai::AIStateWorld(1, glm::vec3(1.0f, 2.0f, 3.0f), 1.0f, attributes));
+	m.addChange(ai::AIStateDelta::ORIENTATION, ai::AIStateWorld(2, ai::ZERO, 2.0f));
+	m.addRemoved(3);
+
+	ai::AIStateDeltaMessage* d = serializeDeserialize(m);
+	ASSERT_EQ(m.getId(), d->getId());
+	ASSERT_EQ(42, d->getSequence());
+	ASSERT_TRUE(d->isFull());
+	ASSERT_EQ(2u, d->getChanges().size());
+	ASSERT_EQ(1u, d->getRemoved().size());
+	ASSERT_EQ(3, d->getRemoved()[0]);
+
+	ai::AIStateWorld state(1, ai::ZERO, 0.0f);
+	state.getAttributes().insert(std::make_pair<core::String, core::String>("Old", "Value"));
+	d->getChanges()[0].apply(state);
+	ASSERT_FLOAT_EQ(2.0f, state.getPosition().y);
+	ASSERT_FLOAT_EQ(1.0f, state.getOrientation());
+	ASSERT_EQ(1u, state.getAttributes().size());
+	ASSERT_EQ("Test", state.getAttributes().find("Name")->second);
+
+	d->getChanges()[1].apply(state);
+	ASSERT_EQ(2, d->getChanges()[1].getState().getId());
+	ASSERT_FLOAT_EQ(2.0f, state.getPosition().y) << "Only the orientation should have been applied";
+	ASSERT_FLOAT_EQ(2.0f, state.getOrientation());
+	ASSERT_EQ(1u, state.getAttributes().size());
+}
+
+TEST_F(MessageTest, testAIStateAckMessage) {
+	ai::AIStateAckMessage m(42);
+	ai::AIStateAckMessage* d = serializeDeserialize(m);
+	ASSERT_EQ(m.getId(), d->getId());
+	ASSERT_EQ(42, d->getSequence());
+}
+
+TEST_F(MessageTest, testAIStateStream) {
+	ai::AIStateSubscription subscription;
+	subscription.addCharacterId(1);
+	subscription.addCharacterId(2);
+	ai::AIStateStream stream(subscription);
+	ai::CharacterAttributes attributes;
+	attributes.insert(std::make_pair<core::String, core::String>("Name", "Test"));
+	attributes.insert(std::make_pair<core::String, core::String>("Health", "100"));
+	const auto states = [&] () {
+		std::vector<ai::AIStateWorld> s;
+		s.emplace_back(1, ai::ZERO, 0.0f, attributes);
+		s.emplace_back(2, ai::ZERO, 0.0f);
+		return s;
+	};
+
+	ASSERT_TRUE(stream.isDue(0L, 10));
+	std::vector<ai::AIStateWorld> current = states();
+	const ai::AIStateDeltaMessage& full = stream.createDelta(0L, current);
+	ASSERT_TRUE(full.isFull());
+	ASSERT_EQ(1, full.getSequence());
+	ASSERT_EQ(2u, full.getChanges().size());
+	ASSERT_EQ(ai::AIStateDelta::ALL, full.getChanges()[0].getFlags());
+
+	ASSERT_FALSE(stream.isDue(50L, 10)) << "The rate should only allow one delta every 100 millis";
+	ASSERT_TRUE(stream.isDue(100L, 10));
+	current = states();
+	ASSERT_TRUE(stream.createDelta(100L, current).isEmpty()) << "Nothing changed";
+
+	attributes["Health"] = "50";
+	current = states();
+	current[1].setPosition(glm::vec3(1.0f, 0.0f, 0.0f));
+	const ai::AIStateDeltaMessage& changed = stream.createDelta(200L, current);
+	ASSERT_FALSE(changed.isFull());
+	ASSERT_EQ(2, changed.getSequence());
+	ASSERT_EQ(2u, changed.getChanges().size());
+	ASSERT_EQ(ai::AIStateDelta::ATTRIBUTES, changed.getChanges()[0].getFlags());
+	ASSERT_EQ(1u, changed.getChanges()[0].getState().getAttributes().size()) << "Only the changed attribute should be sent";
+	ASSERT_EQ(ai::AIStateDelta::POSITION, changed.getChanges()[1].getFlags());
+
+	attributes.erase("Name");
+	current = states();
+	current.pop_back();
+	const ai::AIStateDeltaMessage& removed = stream.createDelta(300L, current);
+	ASSERT_EQ(1u, removed.getChanges().size());
+	ASSERT_EQ(ai::AIStateDelta::ATTRIBUTES | ai::AIStateDelta::ATTRIBUTES_RESET, removed.getChanges()[0].getFlags());
+	ASSERT_EQ(1u, removed.getRemoved().size());
+	ASSERT_EQ(2, removed.getRemoved()[0]);
+
+	// the client didn't acknowledge anything yet
+	for (int i = 0; i < ai::AIStateStream::MaxUnacknowledged; ++i) {
+		attributes["Health"] = core::string::toString(i);
+		current = states();
+		stream.createDelta(400L + i * 100L, current);
+	}
+	ASSERT_FALSE(stream.isDue(10000L, 10)) << "Too many deltas are not acknowledged yet";
+	stream.acknowledge(4);
+	ASSERT_TRUE(stream.isDue(10000L, 10));
+}
+
 TEST_F(MessageTest, testIProtocolMessageStep) {
 	ai::IProtocolMessage m(ai::PROTO_STEP);
 	ai::IProtocolMessage* d = serializeDeserialize(m);
@@ -82,6 +82,48 @@ TEST_F(NodeTest, testIdle) {
 	ASSERT_EQ(ai::FINISHED, node->execute(entity, 1000));
 }
 
+TEST_F(NodeTest, testStateIndices) {
+	ai::Sequence::Factory f;
+	ai::TreeNodeFactoryContext ctx("testsequence", "", ai::True::get());
+	ai::TreeNodePtr node = f.create(&ctx);
+
+	ai::Idle::Factory idleFac;
+	ai::TreeNodeFactoryContext idleCtx1("testidle", "2", ai::True::get());
+	ai::TreeNodePtr idle1 = idleFac.create(&idleCtx1);
+	ai::TreeNodeFactoryContext idleCtx2("testidle2", "2", ai::True::get());
+	ai::TreeNodePtr idle2 = idleFac.create(&idleCtx2);
+	node->addChild(idle1);
+	node->addChild(idle2);
+	ASSERT_EQ(-1, node->getStateIndex());
+
+	ai::AIPtr e(new ai::AI(node));
+	ai::ICharacterPtr chr(new ai::ICharacter(1));
+	e->setCharacter(chr);
+	ASSERT_EQ(3, node->getStateCount());
+	ASSERT_EQ(0, node->getStateIndex());
+	ASSERT_EQ(1, idle1->getStateIndex());
+	ASSERT_EQ(2, idle2->getStateIndex());
+
+	e->update(1, true);
+	e->getBehaviour()->execute(e, 1);
+	ASSERT_EQ(ai::RUNNING, idle1->getLastStatus(e));
+
+	// nodes that are added at runtime are appended - the existing states stay valid
+	ai::TreeNodeFactoryContext idleCtx3("testidle3", "2", ai::True::get());
+	ai::TreeNodePtr idle3 = idleFac.create(&idleCtx3);
+	node->addChild(idle3);
+	ASSERT_EQ(4, ai::TreeNode::assignStateIndices(node));
+	ASSERT_EQ(1, idle1->getStateIndex());
+	ASSERT_EQ(3, idle3->getStateIndex());
+	ASSERT_EQ(ai::RUNNING, idle1->getLastStatus(e));
+	ASSERT_EQ(ai::UNKNOWN, idle3->getLastStatus(e));
+
+	e->update(1, true);
+	e->getBehaviour()->execute(e, 1);
+	ASSERT_EQ(ai::RUNNING, idle1->getLastStatus(e));
+	ASSERT_EQ(ai::UNKNOWN, idle3->getLastStatus(e));
+}
+
 TEST_F(NodeTest, testParallel) {
 	ai::Parallel::Factory f;
 	ai::TreeNodeFactoryContext ctx("testparallel", "", ai::True::get());
@@ -174,3 +216,29 @@ TEST_F(NodeTest, testPrioritySelectorWithCondition) {
 	ASSERT_EQ(ai::CANNOTEXECUTE, idle1->getLastStatus(e));
 	ASSERT_EQ(ai::FINISHED, idle2->getLastStatus(e));
 }
+
+TEST_F(NodeTest, testStateIndicesAssignedOnSetBehaviour) {
+	ai::Idle::Factory idleFac;
+	ai::TreeNodeFactoryContext idleCtx1("testidle", "2", ai::True::get());
+	ai::AIPtr e(new ai::AI(idleFac.create(&idleCtx1)));
+	ai::ICharacterPtr chr(new ai::ICharacter(1));
+	e->setCharacter(chr);
+
+	ai::Sequence::Factory f;
+	ai::TreeNodeFactoryContext ctx("testsequence", "", ai::True::get());
+	ai::TreeNodePtr node = f.create(&ctx);
+	ai::TreeNodeFactoryContext idleCtx2("testidle2", "2", ai::True::get());
+	ai::TreeNodePtr idle2 = idleFac.create(&idleCtx2);
+	node->addChild(idle2);
+	ASSERT_EQ(-1, node->getStateIndex());
+
+	// the tree is prepared when it is set - not in the (parallel) update
+	e->setBehaviour(node);
+	ASSERT_EQ(2, node->getStateCount());
+	ASSERT_EQ(0, node->getStateIndex());
+	ASSERT_EQ(1, idle2->getStateIndex());
+
+	e->update(1, true);
+	e->getBehaviour()->execute(e, 1);
+	ASSERT_EQ(ai::RUNNING, idle2->getLastStatus(e));
+}
@@ -0,0 +1,47 @@
+/**
+ * @file
+ * @brief Measures the tick of a zone with a lot of idle npcs - the target is 50k npcs at 20 ticks per second.
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "TestEntity.h"
+#include "tree/PrioritySelector.h"
+
+class ZoneBenchmark: public core::AbstractBenchmark {
+protected:
+	void fill(ai::Zone& zone, int n) {
+		const ai::TreeNodePtr root = std::make_shared<ai::PrioritySelector>("test", "", ai::True::get());
+		for (int i = 0; i < n; ++i) {
+			const ai::ICharacterPtr character = std::make_shared<TestEntity>(i);
+			const ai::AIPtr ai = std::make_shared<ai::AI>(root);
+			ai->setCharacter(character);
+			zone.addAI(ai);
+		}
+		// apply the scheduled adds
+		zone.update(0l);
+	}
+
+	void tick(ai::Zone& zone, benchmark::State& state) {
+		for (auto _ : state) {
+			zone.update(50l);
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+};
+
+BENCHMARK_DEFINE_F(ZoneBenchmark, updateSingleThread) (benchmark::State& state) {
+	ai::Zone zone("benchmark", 1);
+	fill(zone, (int)state.range(0));
+	tick(zone, state);
+}
+
+BENCHMARK_DEFINE_F(ZoneBenchmark, update) (benchmark::State& state) {
+	ai::Zone zone("benchmark");
+	fill(zone, (int)state.range(0));
+	tick(zone, state);
+}
+
+BENCHMARK_REGISTER_F(ZoneBenchmark, updateSingleThread)->RangeMultiplier(5)->Range(2000, 50000)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(ZoneBenchmark, update)->RangeMultiplier(5)->Range(2000, 50000)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
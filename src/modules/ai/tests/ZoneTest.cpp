@@ -47,3 +47,64 @@ TEST_F(ZoneTest, testMassAdd1000000) {
 	zone.update(0l);
 	ASSERT_EQ(n, (int)zone.size());
 }
+
+TEST_F(ZoneTest, testRemoveAndDestroy) {
+	ai::Zone zone("test1", 2);
+	ai::TreeNodePtr root = std::make_shared<ai::PrioritySelector>("test", "", ai::True::get());
+	std::vector<ai::AIPtr> ais;
+	const int n = 1000;
+	for (int i = 0; i < n; ++i) {
+		ai::ICharacterPtr character = std::make_shared<TestEntity>(i);
+		ai::AIPtr ai = std::make_shared<ai::AI>(root);
+		ai->setCharacter(character);
+		ASSERT_TRUE(zone.addAI(ai)) << "Could not add ai to the zone";
+		ais.push_back(ai);
+	}
+	zone.update(0l);
+	for (int i = 0; i < n; i += 2) {
+		ASSERT_TRUE(zone.removeAI(ais[i]));
+	}
+	ASSERT_TRUE(zone.destroyAI(1));
+	zone.update(1l);
+	ASSERT_EQ(n / 2 - 1, (int)zone.size());
+	for (int i = 0; i < n; ++i) {
+		if (i % 2 == 0 || i == 1) {
+			EXPECT_FALSE(zone.getAI(i)) << "Removed ai " << i << " can still be found";
+		} else {
+			EXPECT_EQ(ais[i], zone.getAI(i)) << "Lookup of ai " << i << " failed after the removal";
+		}
+	}
+	int count = 0;
+	zone.execute([&count] (const ai::AIPtr& ai) {
+		EXPECT_NE(0, ai->getId() % 2) << "Removed ai is still ticked";
+		EXPECT_NE(1, ai->getId()) << "Destroyed ai is still ticked";
+		++count;
+	});
+	ASSERT_EQ(n / 2 - 1, count);
+	std::future<ai::CharacterId> id = zone.executeAsync(ais[3], [] (const ai::AIPtr& ai) {
+		return ai->getId();
+	});
+	ASSERT_EQ(3, id.get());
+}
+
+TEST_F(ZoneTest, testSharedScheduler) {
+	ai::TreeNodePtr root = std::make_shared<ai::PrioritySelector>("test", "", ai::True::get());
+	ai::Zone zone1("test1");
+	ai::Zone zone2("test2");
+	for (int i = 0; i < 100; ++i) {
+		for (ai::Zone* zone : {&zone1, &zone2}) {
+			ai::ICharacterPtr character = std::make_shared<TestEntity>(i);
+			ai::AIPtr ai = std::make_shared<ai::AI>(root);
+			ai->setCharacter(character);
+			ASSERT_TRUE(zone->addAI(ai));
+		}
+	}
+	zone1.update(1l);
+	zone2.update(1l);
+	EXPECT_EQ(100u, zone1.size());
+	EXPECT_EQ(100u, zone2.size());
+	std::future<ai::CharacterId> id = zone2.executeAsync(zone1.getAI(42), [] (const ai::AIPtr& ai) {
+		return ai->getId();
+	});
+	EXPECT_EQ(42, id.get());
+}
@@ -12,6 +12,42 @@ int TreeNode::getId() const {
 	return _id;
 }
 
+int TreeNode::getStateIndex() const {
+	return _stateIndex;
+}
+
+int TreeNode::getStateCount() const {
+	return _stateCount;
+}
+
+int TreeNode::getMaxStateIndex_r() const {
+	int maxIndex = _stateIndex;
+	for (auto& child : _children) {
+		maxIndex = (std::max)(maxIndex, child->getMaxStateIndex_r());
+	}
+	return maxIndex;
+}
+
+void TreeNode::assignStateIndices_r(int& nextIndex) {
+	if (_stateIndex < 0) {
+		_stateIndex = nextIndex++;
+	}
+	for (auto& child : _children) {
+		child->assignStateIndices_r(nextIndex);
+	}
+}
+
+int TreeNode::assignStateIndices(const TreeNodePtr& root) {
+	if (!root) {
+		return 0;
+	}
+	// don't reuse the slots of removed nodes - the ai instances might still have states stored there
+	int nextIndex = (std::max)(root->_stateCount, root->getMaxStateIndex_r() + 1);
+	root->assignStateIndices_r(nextIndex);
+	root->_stateCount = nextIndex;
+	return nextIndex;
+}
+
 void TreeNode::setName(const core::String& name) {
 	if (name.empty()) {
 		return;
@@ -66,41 +102,47 @@ void TreeNode::getRunningChildren(const AIPtr& /*entity*/, std::vector<bool>& ac
 }
 
 void TreeNode::setLastExecMillis(const AIPtr& entity) {
-	if (!entity->_debuggingActive) {
+	if (!entity->_debuggingActive || _stateIndex < 0) {
 		return;
 	}
-	entity->_lastExecMillis[getId()] = entity->_time;
+	entity->nodeDebugState(_stateIndex).lastExecMillis = entity->_time;
 }
 
 int TreeNode::getSelectorState(const AIPtr& entity) const {
-	AI::SelectorStates::const_iterator i = entity->_selectorStates.find(getId());
-	if (i == entity->_selectorStates.end()) {
+	if (_stateIndex < 0 || _stateIndex >= (int)entity->_nodeStates.size()) {
 		return AI_NOTHING_SELECTED;
 	}
-	return i->second;
+	return entity->_nodeStates[_stateIndex].selectorState;
 }
 
 void TreeNode::setSelectorState(const AIPtr& entity, int selected) {
-	entity->_selectorStates[getId()] = selected;
+	ai_assert(_stateIndex >= 0, "Node %s has no state index assigned", _name.c_str());
+	if (_stateIndex < 0) {
+		return;
+	}
+	entity->nodeState(_stateIndex).selectorState = selected;
 }
 
 int TreeNode::getLimitState(const AIPtr& entity) const {
-	AI::LimitStates::const_iterator i = entity->_limitStates.find(getId());
-	if (i == entity->_limitStates.end()) {
+	if (_stateIndex < 0 || _stateIndex >= (int)entity->_nodeStates.size()) {
 		return 0;
 	}
-	return i->second;
+	return entity->_nodeStates[_stateIndex].limitState;
 }
 
 void TreeNode::setLimitState(const AIPtr& entity, int amount) {
-	entity->_limitStates[getId()] = amount;
+	ai_assert(_stateIndex >= 0, "Node %s has no state index assigned", _name.c_str());
+	if (_stateIndex < 0) {
+		return;
+	}
+	entity->nodeState(_stateIndex).limitState = amount;
 }
 
 TreeNodeStatus TreeNode::state(const AIPtr& entity, TreeNodeStatus treeNodeState) {
-	if (!entity->_debuggingActive) {
+	if (!entity->_debuggingActive || _stateIndex < 0) {
 		return treeNodeState;
 	}
-	entity->_lastStatus[getId()] = treeNodeState;
+	entity->nodeDebugState(_stateIndex).lastStatus = treeNodeState;
 	return treeNodeState;
 }
 
@@ -108,22 +150,20 @@ int64_t TreeNode::getLastExecMillis(const AIPtr& entity) const {
 	if (!entity->_debuggingActive) {
 		return -1L;
 	}
-	AI::LastExecMap::const_iterator i = entity->_lastExecMillis.find(getId());
-	if (i == entity->_lastExecMillis.end()) {
+	if (_stateIndex < 0 || _stateIndex >= (int)entity->_nodeDebugStates.size()) {
 		return -1L;
 	}
-	return i->second;
+	return entity->_nodeDebugStates[_stateIndex].lastExecMillis;
 }
 
 TreeNodeStatus TreeNode::getLastStatus(const AIPtr& entity) const {
 	if (!entity->_debuggingActive) {
 		return UNKNOWN;
 	}
-	AI::NodeStates::const_iterator i = entity->_lastStatus.find(getId());
-	if (i == entity->_lastStatus.end()) {
+	if (_stateIndex < 0 || _stateIndex >= (int)entity->_nodeDebugStates.size()) {
 		return UNKNOWN;
 	}
-	return i->second;
+	return entity->_nodeDebugStates[_stateIndex].lastStatus;
 }
 
 TreeNodePtr TreeNode::getChild(int id) const {
@@ -96,6 +96,15 @@ protected:
 	 * @brief Every node has an id to identify it. It's unique per type.
 	 */
 	int _id;
+	/**
+	 * @brief The dense index of the node in the state block of the @c AI instances that execute this behaviour tree
+	 * @sa assignStateIndices()
+	 */
+	int _stateIndex = -1;
+	/**
+	 * @brief Only set for root nodes - the amount of state slots that were assigned in this behaviour tree
+	 */
+	int _stateCount = 0;
 	TreeNodes _children;
 	core::String _name;
 	core::String _type;
@@ -110,6 +119,8 @@ protected:
 	void setLastExecMillis(const AIPtr& entity);
 
 	TreeNodePtr getParent_r(const TreeNodePtr& parent, int id) const;
+	int getMaxStateIndex_r() const;
+	void assignStateIndices_r(int& nextIndex);
 
 public:
 	/**
@@ -129,6 +140,24 @@ public:
 	 */
 	int getId() const;
 
+	/**
+	 * @brief The index of the node state in the @c AI instances that execute the behaviour tree of this node
+	 * @return @c -1 if the node wasn't yet part of a behaviour tree that was assigned its state indices
+	 */
+	int getStateIndex() const;
+	/**
+	 * @brief The amount of node states an @c AI instance needs for this behaviour tree root node
+	 */
+	int getStateCount() const;
+	/**
+	 * @brief Assigns a dense index to every node of the given behaviour tree that doesn't have one yet
+	 *
+	 * The @c AI instances store the runtime states of the nodes in one contiguous block that is indexed by
+	 * these values. Nodes that already have an index keep it - this allows to modify a behaviour tree at runtime.
+	 * @return The amount of node states an @c AI instance needs for this behaviour tree
+	 */
+	static int assignStateIndices(const TreeNodePtr& root);
+
 	/**
 	 * @brief Each node can have a user defines name that can be retrieved with this method.
 	 */
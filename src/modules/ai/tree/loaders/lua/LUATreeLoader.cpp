@@ -266,6 +266,10 @@ bool LUATreeLoader::init(const core::String& luaString) {
 	{
 		ScopedReadLock scopedLock(_lock);
 		empty = _treeMap.empty();
+		// the trees are complete now - the ai instances can size their node states
+		for (auto& e : _treeMap) {
+			TreeNode::assignStateIndices(e.second);
+		}
 	}
 	if (empty) {
 		setError("No behaviour trees specified");
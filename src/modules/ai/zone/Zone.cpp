@@ -6,19 +6,47 @@
 
 namespace ai {
 
+core::TaskScheduler& Zone::sharedScheduler() {
+	struct SharedScheduler {
+		core::TaskScheduler scheduler;
+		SharedScheduler() : scheduler((std::max)(1, (int)core::cpus()), "Zone") {
+			scheduler.init();
+		}
+	};
+	static SharedScheduler shared;
+	return shared.scheduler;
+}
+
+Zone::Zone(const core::String& name, int threadCount) :
+		_name(name), _debug(false) {
+	if (threadCount >= 0) {
+		_ownScheduler.reset(new core::TaskScheduler((std::max)(1, threadCount), "Zone"));
+		_ownScheduler->init();
+		_scheduler = _ownScheduler.get();
+	} else {
+		_scheduler = &sharedScheduler();
+	}
+}
+
+Zone::~Zone() {
+	_scheduler->wait(_asyncTasks);
+	if (_ownScheduler) {
+		_ownScheduler->shutdown();
+	}
+}
+
 AIPtr Zone::getAI(CharacterId id) const {
 	ScopedReadLock scopedLock(_lock);
-	auto i = _ais.find(id);
-	if (i == _ais.end()) {
+	auto i = _aiIndices.find(id);
+	if (i == _aiIndices.end()) {
 		return AIPtr();
 	}
-	const AIPtr& ai = i->second;
-	return ai;
+	return _aiList[i->second];
 }
 
 std::size_t Zone::size() const {
 	ScopedReadLock scopedLock(_lock);
-	return _ais.size();
+	return _aiList.size();
 }
 
 bool Zone::doAddAI(const AIPtr& ai) {
@@ -26,35 +54,50 @@ bool Zone::doAddAI(const AIPtr& ai) {
 		return false;
 	}
 	const CharacterId& id = ai->getCharacter()->getId();
-	if (_ais.find(id) != _ais.end()) {
+	if (!_aiIndices.insert(std::make_pair(id, _aiList.size())).second) {
 		return false;
 	}
-	_ais.insert(std::make_pair(id, ai));
+	_aiList.push_back(ai);
+	_aiIds.push_back(id);
 	ai->setZone(this);
 	return true;
 }
 
+void Zone::eraseAI(AIIndexMapIter i) {
+	const size_t index = i->second;
+	const size_t last = _aiList.size() - 1u;
+	if (index != last) {
+		_aiList[index] = std::move(_aiList[last]);
+		_aiIds[index] = _aiIds[last];
+		_aiIndices[_aiIds[index]] = index;
+	}
+	_aiList.pop_back();
+	_aiIds.pop_back();
+	_aiIndices.erase(i);
+}
+
 bool Zone::doRemoveAI(const AIPtr& ai) {
 	if (!ai) {
 		return false;
 	}
 	const CharacterId& id = ai->getCharacter()->getId();
-	AIMapIter i = _ais.find(id);
-	if (i == _ais.end()) {
+	AIIndexMapIter i = _aiIndices.find(id);
+	if (i == _aiIndices.end()) {
 		return false;
 	}
-	i->second->setZone(nullptr);
-	_groupManager.removeFromAllGroups(i->second);
-	_ais.erase(i);
+	const AIPtr& removed = _aiList[i->second];
+	removed->setZone(nullptr);
+	_groupManager.removeFromAllGroups(removed);
+	eraseAI(i);
 	return true;
 }
 
 bool Zone::doDestroyAI(const CharacterId& id) {
-	AIMapIter i = _ais.find(id);
-	if (i == _ais.end()) {
+	AIIndexMapIter i = _aiIndices.find(id);
+	if (i == _aiIndices.end()) {
 		return false;
 	}
-	_ais.erase(i);
+	eraseAI(i);
 	return true;
 }
 
@@ -82,6 +125,20 @@ bool Zone::removeAI(const AIPtr& ai) {
 	return true;
 }
 
+void Zone::copyAIList(AICopyList& copy) const {
+	ScopedReadLock scopedLock(_lock);
+	copy.reserve(_aiList.size());
+	for (const AIPtr& ai : _aiList) {
+		copy.push_back(ai);
+	}
+}
+
+size_t Zone::batchSize(size_t aiCount) const {
+	// a few tasks per worker to balance the load - but not too small ones to keep the scheduling overhead low
+	const size_t tasks = (_scheduler->size() + 1u) * 4u;
+	return (std::max)((size_t)64u, aiCount / tasks);
+}
+
 void Zone::update(int64_t dt) {
 	{
 		AIScheduleList scheduledRemove;
@@ -101,21 +158,23 @@ void Zone::update(int64_t dt) {
 		for (const AIPtr& ai : scheduledRemove) {
 			doRemoveAI(ai);
 		}
-		scheduledRemove.clear();
 		for (auto id : scheduledDestroy) {
 			doDestroyAI(id);
 		}
+		scheduledRemove.clear();
 		scheduledDestroy.clear();
 	}
 
-	auto func = [&] (const AIPtr& ai) {
+	// the list is only modified above - so there is no need to lock or copy it here
+	const AIList& aiList = _aiList;
+	_scheduler->parallelFor(0u, aiList.size(), [&] (size_t i) {
+		const AIPtr& ai = aiList[i];
 		if (ai->isPause()) {
 			return;
 		}
 		ai->update(dt, _debug);
 		ai->getBehaviour()->execute(ai, dt);
-	};
-	executeParallel(func);
+	}, batchSize(aiList.size()));
 	_groupManager.update(dt);
 }
 
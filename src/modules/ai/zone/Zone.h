@@ -16,11 +16,15 @@
 #include "ICharacter.h"
 #include "group/GroupMgr.h"
 #include "common/Thread.h"
-#include "core/concurrent/ThreadPool.h"
+#include "core/concurrent/TaskScheduler.h"
+#include "core/concurrent/Concurrency.h"
+#include "core/FrameArena.h"
 #include "common/CharacterId.h"
 #include <unordered_map>
 #include <vector>
 #include <memory>
+#include <future>
+#include <functional>
 
 namespace ai {
 
@@ -38,15 +42,27 @@ typedef std::shared_ptr<AI> AIPtr;
  */
 class Zone {
 public:
-	typedef std::unordered_map<CharacterId, AIPtr> AIMap;
+	// maps the id of the character to the index in the dense ai list
+	typedef std::unordered_map<CharacterId, size_t> AIIndexMap;
 	typedef std::vector<AIPtr> AIScheduleList;
+	// per call copy of the ai instances - lives in the frame arena of the calling thread
+	typedef core::FrameVector<AIPtr> AICopyList;
+	typedef std::vector<AIPtr> AIList;
 	typedef std::vector<CharacterId> CharacterIdList;
-	typedef AIMap::const_iterator AIMapConstIter;
-	typedef AIMap::iterator AIMapIter;
+	typedef AIIndexMap::const_iterator AIIndexMapConstIter;
+	typedef AIIndexMap::iterator AIIndexMapIter;
 
 protected:
 	const core::String _name;
-	AIMap _ais;
+	/**
+	 * @brief Dense list of the @c AI instances in this zone - this is what is iterated in the tick. It's only
+	 * modified while the scheduled changes are applied in @c Zone::update. Removing an entry moves the last one
+	 * into its place.
+	 */
+	AIList _aiList;
+	// the character ids of the entries in @c _aiList - the character might already be gone when the ai is destroyed
+	CharacterIdList _aiIds;
+	AIIndexMap _aiIndices;
 	AIScheduleList _scheduledAdd;
 	AIScheduleList _scheduledRemove;
 	CharacterIdList _scheduledDestroy;
@@ -54,8 +70,25 @@ protected:
 	ReadWriteLock _lock {"zone"};
 	ReadWriteLock _scheduleLock {"zone-schedulelock"};
 	ai::GroupMgr _groupManager;
-	mutable core::ThreadPool _threadPool;
+	// only set if the zone got a dedicated amount of threads
+	std::unique_ptr<core::TaskScheduler> _ownScheduler;
+	core::TaskScheduler* _scheduler;
+	// the tasks of @c executeAsync
+	mutable core::TaskGroup _asyncTasks;
+
+	/**
+	 * @brief The scheduler that is shared by all zones that don't use a dedicated amount of threads
+	 */
+	static core::TaskScheduler& sharedScheduler();
 
+	/**
+	 * @brief The amount of @c AI instances that are ticked in one task of the scheduler
+	 */
+	size_t batchSize(size_t aiCount) const;
+	/**
+	 * @brief Copies the @c AI instances of this zone to execute functors on them without holding the lock
+	 */
+	void copyAIList(AICopyList& copy) const;
 	/**
 	 * @brief called in the zone update to add new @c AI instances.
 	 *
@@ -75,16 +108,18 @@ protected:
 	 * @note This doesn't lock the zone - but because @c Zone::update already does it
 	 */
 	bool doDestroyAI(const CharacterId& id);
+	/**
+	 * @brief Swaps the last @c AI instance into the given slot of the dense list
+	 */
+	void eraseAI(AIIndexMapIter i);
 
 public:
-	Zone(const core::String& name, int threadCount = (std::min)(1u, std::thread::hardware_concurrency())) :
-			_name(name), _debug(false), _threadPool(threadCount) {
-		_threadPool.init();
-	}
-
-	virtual ~Zone() {
-		_threadPool.shutdown();
-	}
+	/**
+	 * @param threadCount The amount of threads for a scheduler that is only used by this zone. By default all zones
+	 * share one scheduler with a thread per cpu - to not end up with a thread per cpu for every zone.
+	 */
+	Zone(const core::String& name, int threadCount = -1);
+	virtual ~Zone();
 
 	/**
 	 * @brief Update all the @c ICharacter and @c AI instances in this zone.
@@ -204,7 +239,19 @@ public:
 	template<typename Func>
 	inline auto executeAsync(const AIPtr& ai, const Func& func) const
 		-> std::future<typename std::result_of<Func(const AIPtr&)>::type> {
-		return _threadPool.enqueue(func, ai);
+		using return_type = typename std::result_of<Func(const AIPtr&)>::type;
+		using task_type = std::packaged_task<return_type()>;
+		task_type* task = new task_type(std::bind(func, ai));
+		std::future<return_type> res = task->get_future();
+		core::TaskScheduler::Task t;
+		t.func = [] (void* userdata, size_t, size_t) {
+			task_type* pt = (task_type*)userdata;
+			(*pt)();
+			delete pt;
+		};
+		t.userdata = (void*)task;
+		_scheduler->spawn(_asyncTasks, t);
+		return res;
 	}
 
 	template<typename Func>
@@ -250,17 +297,11 @@ public:
 	 */
 	template<typename Func>
 	void executeParallel(Func& func) {
-		std::vector<std::future<void> > results;
-		_lock.lockRead();
-		AIMap copy(_ais);
-		_lock.unlockRead();
-		for (auto i = copy.begin(); i != copy.end(); ++i) {
-			const AIPtr& ai = i->second;
-			results.emplace_back(executeAsync(ai, func));
-		}
-		for (auto & result: results) {
-			result.wait();
-		}
+		AICopyList copy;
+		copyAIList(copy);
+		_scheduler->parallelFor(0u, copy.size(), [&] (size_t i) {
+			func(copy[i]);
+		}, batchSize(copy.size()));
 	}
 
 	/**
@@ -272,17 +313,11 @@ public:
 	 */
 	template<typename Func>
 	void executeParallel(const Func& func) const {
-		std::vector<std::future<void> > results;
-		_lock.lockRead();
-		AIMap copy(_ais);
-		_lock.unlockRead();
-		for (auto i = copy.begin(); i != copy.end(); ++i) {
-			const AIPtr& ai = i->second;
-			results.emplace_back(executeAsync(ai, func));
-		}
-		for (auto & result: results) {
-			result.wait();
-		}
+		AICopyList copy;
+		copyAIList(copy);
+		_scheduler->parallelFor(0u, copy.size(), [&] (size_t i) {
+			func(copy[i]);
+		}, batchSize(copy.size()));
 	}
 
 	/**
@@ -293,11 +328,9 @@ public:
 	 */
 	template<typename Func>
 	void execute(const Func& func) const {
-		_lock.lockRead();
-		AIMap copy(_ais);
-		_lock.unlockRead();
-		for (auto i = copy.begin(); i != copy.end(); ++i) {
-			const AIPtr& ai = i->second;
+		AICopyList copy;
+		copyAIList(copy);
+		for (const AIPtr& ai : copy) {
 			func(ai);
 		}
 	}
@@ -310,11 +343,9 @@ public:
 	 */
 	template<typename Func>
 	void execute(Func& func) {
-		_lock.lockRead();
-		AIMap copy(_ais);
-		_lock.unlockRead();
-		for (auto i = copy.begin(); i != copy.end(); ++i) {
-			const AIPtr& ai = i->second;
+		AICopyList copy;
+		copyAIList(copy);
+		for (const AIPtr& ai : copy) {
 			func(ai);
 		}
 	}
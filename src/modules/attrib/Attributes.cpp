@@ -4,39 +4,9 @@
 
 #include "Attributes.h"
 #include "core/Common.h"
-#include <unordered_set>
 
 namespace attrib {
 
-typedef std::unordered_set<Type, network::EnumHash<Type> > TypeSet;
-
-TypeSet mapFindChangedValues(const Values& in1, const Values& in2) {
-	TypeSet result;
-	for (const auto& e : in1) {
-		const Type& key = e->key;
-		const auto& i = in2.find(key);
-		if (i == in2.end()) {
-			result.insert(key);
-			continue;
-		}
-		const double oldValue = i->value;
-		const double newValue = e->value;
-		if (SDL_fabs(newValue - oldValue) > (double)0.000001) {
-			result.insert(key);
-		}
-	}
-	for (const auto& e : in2) {
-		const Type& key = e->key;
-		auto i = in1.find(key);
-		if (i == in2.end()) {
-			result.insert(key);
-			continue;
-		}
-	}
-
-	return result;
-}
-
 Attributes::Attributes(Attributes* parent) :
 		_dirty(false), _lock("Attributes"), _attribLock("Attributes2"), _parent(parent) {
 }
@@ -53,50 +23,49 @@ bool Attributes::update(long dt) {
 		return updated;
 	}
 
+	// the values are stored inline - recalculating the max values doesn't touch the heap
 	Values max;
 	Values percentages;
 	calculateMax(max, percentages);
 
-	for (const auto& p : percentages) {
+	percentages.visit([&max] (Type type, double percentage) {
 		double value;
-		if (!max.get(p->key, value)) {
-			continue;
+		if (!max.get(type, value)) {
+			return;
 		}
-		value *= 1.0 + (p->value * 0.01);
-		max.put(p->key, value);
-	}
+		max.put(type, value * (1.0 + (percentage * 0.01)));
+	});
 
-	core::ScopedReadLock scopedLock(_attribLock);
+	core::ScopedWriteLock scopedLock(_attribLock);
 	if (!_listeners.empty()) {
-		const TypeSet& diff = mapFindChangedValues(_max, max);
-		for (const Type& e : diff) {
-			double value;
-			if (!max.get(e, value)) {
-				continue;
+		max.visit([this] (Type type, double value) {
+			double old;
+			if (_max.get(type, old) && SDL_fabs(value - old) <= (double)0.000001) {
+				return;
 			}
-			const DirtyValue v{e, false, value};
+			const DirtyValue v{type, false, value};
 			for (const auto& listener : _listeners) {
 				listener(v);
 			}
-		}
+		});
 	}
 	_max = max;
 
 	// cap your currents to the max allowed value
-	for (ValuesIter i = _current.begin(); i != _current.end(); ++i) {
-		ValuesIter mi = _max.find(i->key);
-		if (mi == _max.end()) {
-			continue;
+	_current.visit([this] (Type type, double& current) {
+		double maxValue;
+		if (!_max.get(type, maxValue)) {
+			return;
 		}
-		double old = i->value;
-		i->value = core_min(mi->value, i->value);
-		if (SDL_fabs(old - i->value) > (double)0.000001) {
-			const DirtyValue v{i->key, true, i->value};
+		const double old = current;
+		current = core_min(maxValue, current);
+		if (SDL_fabs(old - current) > (double)0.000001) {
+			const DirtyValue v{type, true, current};
 			for (const auto& listener : _listeners) {
 				listener(v);
 			}
 		}
-	}
+	});
 	return true;
 }
 
@@ -105,32 +74,16 @@ void Attributes::calculateMax(Values& absolutes, Values& percentages) const {
 		_parent->calculateMax(absolutes, percentages);
 	}
 
-	Containers containers;
-	{
-		core::ScopedReadLock scopedLock(_lock);
-		containers = _containers;
-	}
-	for (const auto& e : containers) {
+	core::ScopedReadLock scopedLock(_lock);
+	for (const auto& e : _containers) {
 		const Container& c = e->value;
 		const double stackCount = c.stackCount();
-		const Values& abs = c.absolute();
-		for (ValuesConstIter i = abs.begin(); i != abs.end(); ++i) {
-			auto v = absolutes.find(i->key);
-			if (v == absolutes.end()) {
-				absolutes.put(i->key, i->value * stackCount);
-			} else {
-				v->value += i->value * stackCount;
-			}
-		}
-		const Values& rel = c.percentage();
-		for (ValuesConstIter i = rel.begin(); i != rel.end(); ++i) {
-			auto v = percentages.find(i->key);
-			if (v == percentages.end()) {
-				percentages.put(i->key, i->value * stackCount);
-			} else {
-				v->value += i->value * stackCount;
-			}
-		}
+		c.absolute().visit([&absolutes, stackCount] (Type type, double value) {
+			absolutes.add(type, value * stackCount);
+		});
+		c.percentage().visit([&percentages, stackCount] (Type type, double value) {
+			percentages.add(type, value * stackCount);
+		});
 	}
 }
 
@@ -186,8 +139,8 @@ void Attributes::remove(const core::String& name) {
 
 double Attributes::setCurrent(Type type, double value) {
 	core::ScopedWriteLock scopedLock(_attribLock);
-	auto i = _max.find(type);
-	if (i == _max.end()) {
+	double max;
+	if (!_max.get(type, max)) {
 		const DirtyValue v{type, true, value};
 		_current.put(type, value);
 		for (const auto& listener : _listeners) {
@@ -195,7 +148,7 @@ double Attributes::setCurrent(Type type, double value) {
 		}
 		return value;
 	}
-	const double max = core_min(i->second, value);
+	max = core_min(max, value);
 	_current.put(type, max);
 	const DirtyValue v{type, true, max};
 	for (const auto& listener : _listeners) {
@@ -205,18 +158,18 @@ double Attributes::setCurrent(Type type, double value) {
 }
 
 void Attributes::markAsDirty() {
-	for (ValuesIter i = _current.begin(); i != _current.end(); ++i) {
-		const DirtyValue v{i->first, true, i->second};
+	_current.visit([this] (Type type, double value) {
+		const DirtyValue v{type, true, value};
 		for (const auto& listener : _listeners) {
 			listener(v);
 		}
-	}
-	for (ValuesIter i = _max.begin(); i != _max.end(); ++i) {
-		const DirtyValue v{i->first, false, i->second};
+	});
+	_max.visit([this] (Type type, double value) {
+		const DirtyValue v{type, false, value};
 		for (const auto& listener : _listeners) {
 			listener(v);
 		}
-	}
+	});
 }
 
 }
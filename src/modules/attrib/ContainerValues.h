@@ -1,17 +1,120 @@
-
 /**
  * @file
  */
 
 #pragma once
 
-#include "core/collection/Map.h"
+#include "core/Enum.h"
+#include "core/Assert.h"
 #include "AttributeType.h"
+#include <stdint.h>
 
 namespace attrib {
 
-typedef core::Map<Type, double, 8, network::EnumHash<Type> > Values;
-typedef Values::iterator ValuesConstIter;
-typedef Values::iterator ValuesIter;
+/**
+ * @brief Fixed size value storage that is indexed by the attribute type. A bitmask tells which
+ * types are set - so there is no heap allocation involved at all.
+ * @ingroup Attributes
+ */
+class Values {
+public:
+	static constexpr int Size = core::enumVal(Type::MAX) + 1;
+private:
+	static_assert(Size <= 32, "The presence mask can't hold all attribute types");
+	static_assert(core::enumVal(Type::MIN) == 0, "The attribute types must start at 0");
+	double _values[Size] {};
+	uint32_t _mask = 0u;
+
+	static inline uint32_t bit(Type type) {
+		core_assert(core::enumVal(type) >= 0 && core::enumVal(type) < Size);
+		return 1u << (uint32_t)core::enumVal(type);
+	}
+public:
+	inline bool has(Type type) const {
+		return (_mask & bit(type)) != 0u;
+	}
+
+	inline bool get(Type type, double& value) const {
+		if (!has(type)) {
+			return false;
+		}
+		value = _values[core::enumVal(type)];
+		return true;
+	}
+
+	/**
+	 * @return The value for the given type or @c 0.0 if the type is not set
+	 */
+	inline double value(Type type) const {
+		if (!has(type)) {
+			return 0.0;
+		}
+		return _values[core::enumVal(type)];
+	}
+
+	inline void put(Type type, double value) {
+		_mask |= bit(type);
+		_values[core::enumVal(type)] = value;
+	}
+
+	/**
+	 * @brief Adds the given value to the current one - or sets it if the type is not yet set
+	 */
+	inline void add(Type type, double value) {
+		if (!has(type)) {
+			put(type, value);
+			return;
+		}
+		_values[core::enumVal(type)] += value;
+	}
+
+	inline void remove(Type type) {
+		_mask &= ~bit(type);
+	}
+
+	inline void clear() {
+		_mask = 0u;
+	}
+
+	inline bool empty() const {
+		return _mask == 0u;
+	}
+
+	inline int size() const {
+		int n = 0;
+		for (uint32_t mask = _mask; mask != 0u; mask &= mask - 1u) {
+			++n;
+		}
+		return n;
+	}
+
+	inline uint32_t mask() const {
+		return _mask;
+	}
+
+	/**
+	 * @brief Calls the given functor with the type and the value of all set types
+	 */
+	template<typename Func>
+	void visit(Func&& func) const {
+		for (int idx = 0; idx < Size; ++idx) {
+			if (_mask & (1u << (uint32_t)idx)) {
+				func((Type)idx, _values[idx]);
+			}
+		}
+	}
+
+	/**
+	 * @brief Calls the given functor with the type and a reference to the value of all set types
+	 */
+	template<typename Func>
+	void visit(Func&& func) {
+		for (int idx = 0; idx < Size; ++idx) {
+			if (_mask & (1u << (uint32_t)idx)) {
+				func((Type)idx, _values[idx]);
+			}
+		}
+	}
+};
 
 }
@@ -39,19 +39,11 @@ public:
 	}
 
 	double current(Type type) const {
-		auto i = _current.find(type);
-		if (i == _current.end()) {
-			return 0.0;
-		}
-		return i->value;
+		return _current.value(type);
 	}
 
 	double max(Type type) const {
-		auto i = _max.find(type);
-		if (i == _max.end()) {
-			return 0.0;
-		}
-		return i->value;
+		return _max.value(type);
 	}
 };
 
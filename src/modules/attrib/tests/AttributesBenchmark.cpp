@@ -0,0 +1,112 @@
+/**
+ * @file
+ * @brief Measures the max value recalculation of the attributes and the memory that one entity needs for its attributes.
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "attrib/Attributes.h"
+#include <SDL_stdinc.h>
+#include <vector>
+
+namespace {
+
+SDL_malloc_func _malloc;
+SDL_calloc_func _calloc;
+SDL_realloc_func _realloc;
+SDL_free_func _free;
+size_t _allocatedBytes = 0u;
+size_t _allocations = 0u;
+
+void* countingMalloc(size_t size) {
+	_allocatedBytes += size;
+	++_allocations;
+	return _malloc(size);
+}
+
+void* countingCalloc(size_t nmemb, size_t size) {
+	_allocatedBytes += nmemb * size;
+	++_allocations;
+	return _calloc(nmemb, size);
+}
+
+void* countingRealloc(void* mem, size_t size) {
+	_allocatedBytes += size;
+	++_allocations;
+	return _realloc(mem, size);
+}
+
+}
+
+class AttributesBenchmark: public core::AbstractBenchmark {
+protected:
+	attrib::ContainerPtr _base;
+	attrib::ContainerPtr _buff;
+
+	void SetUp(benchmark::State& st) override {
+		core::AbstractBenchmark::SetUp(st);
+		attrib::ContainerBuilder base("base");
+		base.addAbsolute(attrib::Type::HEALTH, 100.0).addAbsolute(attrib::Type::SPEED, 10.0)
+			.addAbsolute(attrib::Type::VIEWDISTANCE, 50.0).addAbsolute(attrib::Type::ATTACKRANGE, 1.0)
+			.addAbsolute(attrib::Type::STRENGTH, 5.0).addAbsolute(attrib::Type::FIELDOFVIEW, 120.0);
+		_base = core::make_shared<attrib::Container>(base.create());
+		attrib::ContainerBuilder buff("buff", 4);
+		buff.addPercentage(attrib::Type::HEALTH, 10.0).addPercentage(attrib::Type::SPEED, 20.0)
+			.addAbsolute(attrib::Type::STRENGTH, 1.0);
+		_buff = core::make_shared<attrib::Container>(buff.create());
+		// the wrappers forward to the original functions - so memory that was allocated before can still be freed
+		SDL_GetMemoryFunctions(&_malloc, &_calloc, &_realloc, &_free);
+		SDL_SetMemoryFunctions(countingMalloc, countingCalloc, countingRealloc, _free);
+	}
+
+	void TearDown(benchmark::State& st) override {
+		SDL_SetMemoryFunctions(_malloc, _calloc, _realloc, _free);
+		_base = attrib::ContainerPtr();
+		_buff = attrib::ContainerPtr();
+		core::AbstractBenchmark::TearDown(st);
+	}
+};
+
+BENCHMARK_DEFINE_F(AttributesBenchmark, updateMax) (benchmark::State& state) {
+	attrib::Attributes attributes;
+	attributes.add(_base);
+	attributes.add(_buff);
+	attributes.update(0l);
+	_allocations = 0u;
+	for (auto _ : state) {
+		// adding a stack to the buff marks the attributes as dirty and forces a recalculation
+		attributes.add(*_buff);
+		attributes.update(50l);
+		attributes.remove(*_buff);
+		attributes.update(50l);
+	}
+	state.counters["heapallocs"] = benchmark::Counter((double)_allocations, benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK_DEFINE_F(AttributesBenchmark, memoryPerEntity) (benchmark::State& state) {
+	const int n = (int)state.range(0);
+	for (auto _ : state) {
+		state.PauseTiming();
+		std::vector<attrib::Attributes*> entities;
+		entities.reserve(n);
+		_allocatedBytes = 0u;
+		state.ResumeTiming();
+		for (int i = 0; i < n; ++i) {
+			attrib::Attributes* attributes = new attrib::Attributes();
+			attributes->add(_base);
+			attributes->add(_buff);
+			attributes->update(0l);
+			entities.push_back(attributes);
+		}
+		state.PauseTiming();
+		state.counters["bytesPerEntity"] = (double)(_allocatedBytes / n + sizeof(attrib::Attributes));
+		for (attrib::Attributes* attributes : entities) {
+			delete attributes;
+		}
+		state.ResumeTiming();
+	}
+}
+
+BENCHMARK_REGISTER_F(AttributesBenchmark, updateMax);
+BENCHMARK_REGISTER_F(AttributesBenchmark, memoryPerEntity)->Arg(1000);
+
+BENCHMARK_MAIN();
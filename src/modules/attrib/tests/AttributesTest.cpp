@@ -155,4 +155,29 @@ TEST_F(AttributesTest, testListeners) {
 	ASSERT_EQ(changes[static_cast<int>(Type::SPEED)], 1);
 }
 
+TEST_F(AttributesTest, testValues) {
+	Values values;
+	ASSERT_TRUE(values.empty());
+	values.put(Type::SPEED, 1.0);
+	values.add(Type::SPEED, 2.0);
+	values.add(Type::HEALTH, 10.0);
+	EXPECT_EQ(2, values.size());
+	EXPECT_DOUBLE_EQ(3.0, values.value(Type::SPEED));
+	EXPECT_DOUBLE_EQ(10.0, values.value(Type::HEALTH));
+	EXPECT_DOUBLE_EQ(0.0, values.value(Type::STRENGTH));
+	double value;
+	EXPECT_FALSE(values.get(Type::STRENGTH, value));
+	int visited = 0;
+	values.visit([&] (Type type, double) {
+		EXPECT_TRUE(type == Type::SPEED || type == Type::HEALTH);
+		++visited;
+	});
+	EXPECT_EQ(2, visited);
+	values.remove(Type::SPEED);
+	EXPECT_FALSE(values.has(Type::SPEED));
+	EXPECT_EQ(1, values.size());
+	values.clear();
+	EXPECT_TRUE(values.empty());
+}
+
 }
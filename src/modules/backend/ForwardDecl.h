@@ -12,6 +12,8 @@ typedef std::shared_ptr<WorldMgr> WorldMgrPtr;
 class WorldPager;
 typedef core::SharedPtr<WorldPager> WorldPagerPtr;
 
+class ChunkGenerator;
+
 }
 
 namespace voxelformat {
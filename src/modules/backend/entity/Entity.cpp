@@ -3,18 +3,19 @@
  */
 
 #include "Entity.h"
-#include "core/collection/Set.h"
 #include "core/ArrayLength.h"
 #include "core/Assert.h"
 #include "core/Log.h"
 #include "math/Rect.h"
 #include "core/Common.h"
+#include "core/FrameArena.h"
 #include "math/Frustum.h"
 #include "backend/world/Map.h"
 #include "poi/PoiProvider.h"
 #include "network/ServerMessageSender.h"
 #include "network/ProtocolEnum.h"
 #include "attrib/ContainerProvider.h"
+#include <glm/gtc/epsilon.hpp>
 
 namespace backend {
 
@@ -31,14 +32,16 @@ Entity::Entity(EntityId id,
 Entity::~Entity() {
 }
 
-void Entity::visibleAdd(const EntitySet& entities) {
+void Entity::visibleAdd(const EntityList& entities) {
 	for (const EntityPtr& e : entities) {
 		Log::trace("entity %i is visible for %i", (int)e->id(), (int)id());
 		sendEntitySpawn(e);
+		// the spawn doesn't include the orientation - the following updates are only sent if the entity moves
+		sendEntityUpdate(e);
 	}
 }
 
-void Entity::visibleRemove(const EntitySet& entities) {
+void Entity::visibleRemove(const EntityList& entities) {
 	for (const EntityPtr& e : entities) {
 		Log::trace("entity %i is no longer visible for %i", (int)e->id(), (int)id());
 		sendEntityRemove(e);
@@ -59,21 +62,24 @@ bool Entity::attack(EntityId victimId) {
 
 void Entity::sendToVisible(flatbuffers::FlatBufferBuilder& fbb, network::ServerMsgType type,
 		flatbuffers::Offset<void> data, bool sendToSelf, uint32_t flags) const {
-	const EntitySet& visible = visibleCopy();
-	std::vector<ENetPeer*> peers;
-	peers.reserve(visible.size() + 1);
+	// collect the peers without copying the visible set - the list only lives until the message is sent
+	core::FrameVector<ENetPeer*> peers;
 	if (sendToSelf) {
 		ENetPeer* p = peer();
 		if (p != nullptr) {
 			peers.push_back(p);
 		}
 	}
-	for (const EntityPtr& e : visible) {
-		ENetPeer* peer = e->peer();
-		if (peer == nullptr) {
-			continue;
+	{
+		core::ScopedReadLock lock(_visibleLock);
+		peers.reserve(peers.size() + _visible.size());
+		for (const EntityPtr& e : _visible) {
+			ENetPeer* peer = e->peer();
+			if (peer == nullptr) {
+				continue;
+			}
+			peers.push_back(peer);
 		}
-		peers.push_back(peer);
 	}
 	if (peers.empty()) {
 		Log::debug("don't send message of type '%s' - no peers found", network::toString(type, network::EnumNamesServerMsgType()));
@@ -168,16 +174,30 @@ bool Entity::update(long dt) {
 }
 
 void Entity::updateVisible(const EntitySet& set) {
-	_visibleLock.lockWrite();
-	const auto& stillVisible = core::setIntersection(set, _visible);
-	const EntitySet& remove = core::setDifference(stillVisible, _visible);
-	const EntitySet& add = core::setDifference(set, stillVisible);
-	_visible = core::setUnion(stillVisible, add);
-	_visibleLock.unlockWrite();
+	EntityList add;
+	EntityList remove;
+	_visibleLock.lockRead();
+	for (const EntityPtr& e : set) {
+		if (_visible.find(e) == _visible.end()) {
+			add.push_back(e);
+		}
+	}
+	for (const EntityPtr& e : _visible) {
+		if (set.find(e) == set.end()) {
+			remove.push_back(e);
+		}
+	}
+	_visibleLock.unlockRead();
+	updateVisible(add, remove);
+}
 
-	for (const auto& e : _visible) {
-		sendEntityUpdate(e);
+void Entity::updateVisible(const EntityList& add, const EntityList& remove) {
+	_visibleLock.lockWrite();
+	for (const EntityPtr& e : remove) {
+		_visible.erase(e);
 	}
+	_visible.insert(add.begin(), add.end());
+	_visibleLock.unlockWrite();
 
 	if (!add.empty()) {
 		visibleAdd(add);
@@ -187,6 +207,22 @@ void Entity::updateVisible(const EntitySet& set) {
 	}
 }
 
+void Entity::broadcastEntityUpdate() {
+	const glm::vec3& p = pos();
+	const float o = orientation();
+	const network::Animation a = animation();
+	if (a == _updateAnimation && glm::all(glm::epsilonEqual(p, _updatePos, glm::epsilon<float>()))
+			&& glm::epsilonEqual(o, _updateOrientation, glm::epsilon<float>())) {
+		return;
+	}
+	_updatePos = p;
+	_updateOrientation = o;
+	_updateAnimation = a;
+	const network::Vec3 netPos { p.x, p.y, p.z };
+	sendToVisible(_entityUpdateFBB, network::ServerMsgType::EntityUpdate,
+			network::CreateEntityUpdate(_entityUpdateFBB, id(), &netPos, o, a).Union(), false);
+}
+
 void Entity::sendEntityUpdate(const EntityPtr& entity) const {
 	if (_peer == nullptr) {
 		return;
@@ -14,11 +14,13 @@
 #include "network/IProtocolHandler.h"
 
 #include <unordered_set>
+#include <vector>
 #include <memory>
 
 namespace backend {
 
 typedef std::unordered_set<EntityPtr> EntitySet;
+typedef std::vector<EntityPtr> EntityList;
 
 /**
  * @brief Every actor in the world is an entity
@@ -58,16 +60,26 @@ protected:
 	float _orientation = 0.0f;
 	float _size = 1.0f;
 
+	// the state that was sent with the last EntityUpdate to the entities that are seeing this entity
+	glm::vec3 _updatePos { 0.0f };
+	float _updateOrientation = 0.0f;
+	network::Animation _updateAnimation = network::Animation::IDLE;
+
 	/**
-	 * @brief Called with the set of entities that just get visible for this entity
+	 * @brief Called with the entities that just get visible for this entity
 	 */
-	void visibleAdd(const EntitySet& entities);
+	void visibleAdd(const EntityList& entities);
 	/**
-	 * @brief Called with the set of entities that just get invisible for this entity
+	 * @brief Called with the entities that just get invisible for this entity
 	 */
-	void visibleRemove(const EntitySet& entities);
+	void visibleRemove(const EntityList& entities);
 
 	void broadcastAttribUpdate();
+	/**
+	 * @brief Sends one @c EntityUpdate to all entities that are seeing this entity - but only if it moved since
+	 * the last update. The message is serialized once and the packet is shared between the peers.
+	 */
+	void broadcastEntityUpdate();
 	void sendEntityUpdate(const EntityPtr& entity) const;
 	void sendEntitySpawn(const EntityPtr& entity) const;
 	void sendEntityRemove(const EntityPtr& entity) const;
@@ -155,6 +167,14 @@ public:
 	 */
 	void updateVisible(const EntitySet& set);
 
+	/**
+	 * @brief Applies the changes of the visible entities - see @c InterestGrid
+	 * @param[in] add The entities that just got visible
+	 * @param[in] remove The entities that are no longer visible
+	 * @note This is thread safe
+	 */
+	void updateVisible(const EntityList& add, const EntityList& remove);
+
 	/**
 	 * @brief The tick of the entity
 	 * @param[in] dt The delta time (in millis) since the last tick was executed
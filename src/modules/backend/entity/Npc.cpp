@@ -10,6 +10,7 @@
 #include "ai/AI.h"
 #include "ai/zone/Zone.h"
 #include "backend/world/Map.h"
+#include <list>
 
 namespace backend {
 
@@ -75,10 +76,10 @@ bool Npc::update(long dt) {
 	if (!Super::update(dt)) {
 		return false;
 	}
-	_cooldowns.update();
 	const ai::ICharacterPtr& character = _ai->getCharacter();
 	character->setSpeed(current(attrib::Type::SPEED));
 	character->setOrientation(orientation());
+	broadcastEntityUpdate();
 	return !dead();
 }
 
@@ -109,7 +109,6 @@ bool User::update(long dt) {
 	}
 
 	_stockMgr.update(dt);
-	_cooldownMgr.update();
 	_movementMgr.update(dt);
 	_logoutMgr.update(dt);
 
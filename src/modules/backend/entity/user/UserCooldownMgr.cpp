@@ -25,9 +25,10 @@ bool UserCooldownMgr::init() {
 		const cooldown::Type type = (cooldown::Type)id;
 		const uint64_t millis = model.starttime().millis();
 		const cooldown::CooldownPtr& cooldown = createCooldown(type, millis);
+		core::ScopedWriteLock lock(_lock);
 		_cooldowns[type] = cooldown;
 		if (cooldown->running()) {
-			_queue.push(cooldown);
+			scheduleExpire(cooldown);
 		}
 	})) {
 		Log::warn("Could not load cooldowns for user " PRIEntId, _user->id());
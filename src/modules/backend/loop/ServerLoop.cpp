@@ -8,6 +8,7 @@
 #include "core/command/Command.h"
 #include "core/Var.h"
 #include "core/Log.h"
+#include "core/FrameArena.h"
 #include "core/App.h"
 #include "core/io/Filesystem.h"
 #include "core/Password.h"
@@ -353,10 +354,8 @@ bool ServerLoop::init() {
 		core_trace_scoped(PersistenceTimer);
 		const ServerLoop* loop = (const ServerLoop*)handle->data;
 		const long dt = handle->repeat;
-		const persistence::PersistenceMgrPtr& persistenceMgr = loop->_persistenceMgr;
-		core::App::getInstance()->threadPool().enqueue([=] () {
-			persistenceMgr->update(dt);
-		});
+		// this only snapshots the dirty models - the database is written by the worker of the persistence manager
+		loop->_persistenceMgr->update(dt);
 	}, 10000);
 
 	_idleTimer = new uv_idle_t;
@@ -432,7 +431,12 @@ void ServerLoop::shutdown() {
 void ServerLoop::update(long dt) {
 	core_trace_scoped(ServerLoop);
 	// not everything is ticked in here directly, a lot is handled by libuv timers
+	// the messages of the world tick are coalesced per peer
+	_messageSender->beginBatch();
 	uv_run(_loop, UV_RUN_NOWAIT);
+	// expire the cooldowns of all entities in one batch - idle entities don't cost anything here
+	_cooldownProvider->timingWheel().update(_timeProvider->tickMillis());
+	_messageSender->flush();
 	_network->update();
 	_httpServer->update();
 	const int eventSkip = _eventBus->update(200);
@@ -442,10 +446,21 @@ void ServerLoop::update(long dt) {
 	}
 
 	replicateVars();
+
+	// everything that was allocated from the frame arenas during this tick is dead now
+	const core::FrameArena::Stats& frameStats = core::FrameArena::endFrame();
+	if (frameStats.allocations != _lastFrameAllocations) {
+		_metricMgr->metric()->gauge("frame.allocations", frameStats.allocations);
+		_lastFrameAllocations = frameStats.allocations;
+	}
+	if (frameStats.blockAllocations != _lastFrameBlockAllocations) {
+		_metricMgr->metric()->gauge("frame.heapallocations", frameStats.blockAllocations);
+		_lastFrameBlockAllocations = frameStats.blockAllocations;
+	}
 }
 
 void ServerLoop::replicateVars() const {
-	std::vector<core::VarPtr> vars;
+	core::FrameVector<core::VarPtr> vars;
 	core::Var::visitDirtyReplicate([&vars] (const core::VarPtr& var) {
 		vars.push_back(var);
 	});
@@ -469,6 +484,7 @@ void ServerLoop::replicateVars() const {
 void ServerLoop::onEvent(const network::DisconnectEvent& event) {
 	ENetPeer* peer = event.peer();
 	Log::info("disconnect peer: %u", peer->connectID);
+	_messageSender->removePeer(peer);
 	User* user = reinterpret_cast<User*>(peer->data);
 	if (user == nullptr) {
 		return;
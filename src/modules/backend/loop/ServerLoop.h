@@ -50,6 +50,8 @@ private:
 	uv_signal_t *_signal = nullptr;
 
 	int _lastEventSkip = 0;
+	int _lastFrameAllocations = 0;
+	int _lastFrameBlockAllocations = 0;
 	int _lastDeltaFrame = 0;
 	uint64_t _lifetimeSeconds = 0u;
 
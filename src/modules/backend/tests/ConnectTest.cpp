@@ -12,6 +12,7 @@
 #include "network/ProtocolHandlerRegistry.h"
 
 #include "network/ServerNetwork.h"
+#include "network/ServerMessageSender.h"
 
 namespace backend {
 
@@ -29,6 +30,8 @@ protected:
 	network::ClientMessageSenderPtr _clientMessageSender;
 
 	network::ServerNetworkPtr _serverNetwork;
+	network::ServerMessageSenderPtr _serverMessageSender;
+	ENetPeer* _serverPeer = nullptr;
 
 	uint16_t _port;
 	const core::String _host = "127.0.0.1";
@@ -36,6 +39,8 @@ protected:
 	int _disconnectEvent = 0;
 	int _connectEvent = 0;
 	int _userConnectHandlerCalled = 0;
+	int _entityRemoveHandlerCalled = 0;
+	std::vector<int64_t> _removedEntities;
 public:
 	void SetUp() override {
 		_clientEventBus = std::make_shared<core::EventBus>();
@@ -45,6 +50,7 @@ public:
 		_clientMessageSender = std::make_shared<network::ClientMessageSender>(_clientNetwork);
 		const metric::MetricPtr& metric = std::make_shared<metric::Metric>();
 		_serverNetwork = std::make_shared<network::ServerNetwork>(_protocolHandlerRegistry, _serverEventBus, metric);
+		_serverMessageSender = std::make_shared<network::ServerMessageSender>(_serverNetwork, metric);
 		_port = (uint16_t)((uint32_t)(intptr_t)this) + 1025;
 		Super::SetUp();
 	}
@@ -95,23 +101,43 @@ public:
 		class UserConnectHandler: public network::IProtocolHandler {
 		private:
 			int *_called;
+			ENetPeer **_peer;
 		public:
-			UserConnectHandler(int *called) : _called(called) {
+			UserConnectHandler(int *called, ENetPeer **peer) : _called(called), _peer(peer) {
 			}
 
 			void execute(ENetPeer* peer, const void* message) override {
 				(*_called)++;
+				*_peer = peer;
+			}
+		};
+
+		class EntityRemoveHandler: public network::IProtocolHandler {
+		private:
+			int *_called;
+			std::vector<int64_t> *_ids;
+		public:
+			EntityRemoveHandler(int *called, std::vector<int64_t> *ids) : _called(called), _ids(ids) {
+			}
+
+			void execute(ENetPeer* peer, const void* message) override {
+				(*_called)++;
+				_ids->push_back(((const network::EntityRemove*)message)->id());
 			}
 		};
 
 		_serverNetwork->init();
 		const network::ProtocolHandlerRegistryPtr& r = _serverNetwork->registry();
-		r->registerHandler(network::EnumNameClientMsgType(network::ClientMsgType::UserConnect), std::make_shared<UserConnectHandler>(&_userConnectHandlerCalled));
+		r->registerHandler(network::EnumNameClientMsgType(network::ClientMsgType::UserConnect), std::make_shared<UserConnectHandler>(&_userConnectHandlerCalled, &_serverPeer));
+		r->registerHandler(network::EnumNameServerMsgType(network::ServerMsgType::EntityRemove), std::make_shared<EntityRemoveHandler>(&_entityRemoveHandlerCalled, &_removedEntities));
 		_clientNetwork->init();
 
 		_disconnectEvent = 0;
 		_connectEvent = 0;
 		_userConnectHandlerCalled = 0;
+		_entityRemoveHandlerCalled = 0;
+		_removedEntities.clear();
+		_serverPeer = nullptr;
 
 		return true;
 	}
@@ -139,4 +165,72 @@ TEST_F(ConnectTest, testConnect) {
 	EXPECT_EQ(1, _userConnectHandlerCalled);
 }
 
+TEST_F(ConnectTest, testMessageBatch) {
+	ASSERT_TRUE(listen()) << "Failed to bind to port " << _port;
+	ASSERT_TRUE(connect()) << "Failed to connect to port " << _port;
+	update();
+	ASSERT_NE(nullptr, _serverPeer) << "The client didn't send the connect message";
+
+	flatbuffers::FlatBufferBuilder fbb;
+	const int n = 10;
+	_serverMessageSender->beginBatch();
+	for (int i = 0; i < n; ++i) {
+		_serverMessageSender->sendServerMessage(_serverPeer, fbb, network::ServerMsgType::EntityRemove,
+				network::CreateEntityRemove(fbb, i).Union());
+	}
+	// this one is shared between the peers - and must still arrive after the other messages
+	ENetPeer* peers[] = { _serverPeer, _serverPeer };
+	_serverMessageSender->sendServerMessage(peers, 2, fbb, network::ServerMsgType::EntityRemove,
+			network::CreateEntityRemove(fbb, n).Union());
+	EXPECT_EQ(0, _entityRemoveHandlerCalled);
+	_serverMessageSender->flush();
+	update();
+	update();
+	ASSERT_EQ(n + 2, _entityRemoveHandlerCalled);
+	for (int i = 0; i < n; ++i) {
+		ASSERT_EQ(i, _removedEntities[i]) << "The messages are not in the order they were sent";
+	}
+	EXPECT_EQ(n, _removedEntities[n]);
+	EXPECT_EQ(n, _removedEntities[n + 1]);
+}
+
+TEST_F(ConnectTest, testBroadcastKeepsOrder) {
+	ASSERT_TRUE(listen()) << "Failed to bind to port " << _port;
+	ASSERT_TRUE(connect()) << "Failed to connect to port " << _port;
+	update();
+	ASSERT_NE(nullptr, _serverPeer) << "The client didn't send the connect message";
+
+	flatbuffers::FlatBufferBuilder fbb;
+	_serverMessageSender->beginBatch();
+	_serverMessageSender->sendServerMessage(_serverPeer, fbb, network::ServerMsgType::EntityRemove,
+			network::CreateEntityRemove(fbb, 1).Union());
+	// the broadcast must not overtake the batched message
+	_serverMessageSender->broadcastServerMessage(fbb, network::ServerMsgType::EntityRemove,
+			network::CreateEntityRemove(fbb, 2).Union());
+	_serverMessageSender->flush();
+	update();
+	update();
+	ASSERT_EQ(2, _entityRemoveHandlerCalled);
+	EXPECT_EQ(1, _removedEntities[0]);
+	EXPECT_EQ(2, _removedEntities[1]);
+}
+
+TEST_F(ConnectTest, testRemovePeerDropsBatch) {
+	ASSERT_TRUE(listen()) << "Failed to bind to port " << _port;
+	ASSERT_TRUE(connect()) << "Failed to connect to port " << _port;
+	update();
+	ASSERT_NE(nullptr, _serverPeer) << "The client didn't send the connect message";
+
+	flatbuffers::FlatBufferBuilder fbb;
+	_serverMessageSender->beginBatch();
+	ENetPeer* peers[] = { _serverPeer, _serverPeer };
+	_serverMessageSender->sendServerMessage(peers, 2, fbb, network::ServerMsgType::EntityRemove,
+			network::CreateEntityRemove(fbb, 1).Union());
+	_serverMessageSender->removePeer(_serverPeer);
+	_serverMessageSender->flush();
+	update();
+	update();
+	EXPECT_EQ(0, _entityRemoveHandlerCalled);
+}
+
 }
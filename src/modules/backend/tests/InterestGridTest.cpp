@@ -0,0 +1,112 @@
+/**
+ * @file
+ */
+
+#include "NpcTest.h"
+#include "backend/world/InterestGrid.h"
+
+namespace backend {
+
+class InterestGridTest: public NpcTest {
+protected:
+	void tick(InterestGrid& grid, const std::vector<NpcPtr>& npcs) {
+		grid.updateCells();
+		for (const NpcPtr& npc : npcs) {
+			grid.updateVisible(npc);
+		}
+	}
+
+	/**
+	 * @note Creating a npc ticks the zone and thus the movement of the other npcs - so the positions
+	 * and orientations are set after all of them were created.
+	 */
+	std::vector<NpcPtr> create(const std::vector<glm::vec3>& positions) {
+		std::vector<NpcPtr> npcs;
+		for (size_t i = 0; i < positions.size(); ++i) {
+			npcs.push_back(NpcTest::create());
+		}
+		for (size_t i = 0; i < positions.size(); ++i) {
+			const NpcPtr& npc = npcs[i];
+			npc->setPos(positions[i]);
+			npc->setOrientation(0.0f);
+			npc->setCurrent(attrib::Type::FIELDOFVIEW, npc->max(attrib::Type::FIELDOFVIEW));
+		}
+		return npcs;
+	}
+};
+
+TEST_F(InterestGridTest, testVisible) {
+	InterestGrid grid(100.0f);
+	const std::vector<NpcPtr>& npcs = create({glm::vec3(0.0f), glm::vec3(10.0f, 0.0f, 10.0f), glm::vec3(50000.0f, 0.0f, 0.0f)});
+	const NpcPtr& npc1 = npcs[0];
+	const NpcPtr& npc2 = npcs[1];
+	const NpcPtr& npc3 = npcs[2];
+	for (const NpcPtr& npc : npcs) {
+		ASSERT_TRUE(grid.add(npc));
+	}
+	ASSERT_FALSE(grid.add(npc1)) << "The npc was added twice";
+	tick(grid, npcs);
+	EXPECT_EQ(3, grid.recalculated());
+	EXPECT_EQ(1, npc1->visibleCount());
+	EXPECT_EQ(1, npc2->visibleCount());
+	EXPECT_EQ(0, npc3->visibleCount());
+
+	tick(grid, npcs);
+	EXPECT_EQ(0, grid.recalculated()) << "Nothing moved - no recalculation is needed";
+	EXPECT_EQ(1, npc1->visibleCount());
+
+	npc3->setPos(glm::vec3(20.0f, 0.0f, 0.0f));
+	tick(grid, npcs);
+	EXPECT_EQ(3, grid.recalculated());
+	EXPECT_EQ(2, npc1->visibleCount());
+	EXPECT_EQ(2, npc2->visibleCount());
+	EXPECT_EQ(2, npc3->visibleCount());
+
+	npc1->setPos(glm::vec3(50000.0f, 0.0f, 0.0f));
+	tick(grid, npcs);
+	EXPECT_EQ(0, npc1->visibleCount());
+	EXPECT_EQ(1, npc2->visibleCount());
+	EXPECT_EQ(1, npc3->visibleCount());
+}
+
+TEST_F(InterestGridTest, testRemove) {
+	InterestGrid grid(100.0f);
+	const std::vector<NpcPtr>& npcs = create({glm::vec3(0.0f), glm::vec3(10.0f, 0.0f, 10.0f)});
+	const NpcPtr& npc1 = npcs[0];
+	const NpcPtr& npc2 = npcs[1];
+	ASSERT_TRUE(grid.add(npc1));
+	ASSERT_TRUE(grid.add(npc2));
+	tick(grid, { npc1, npc2 });
+	EXPECT_EQ(1, npc1->visibleCount());
+	ASSERT_TRUE(grid.remove(npc2));
+	ASSERT_FALSE(grid.remove(npc2));
+	EXPECT_EQ(1u, grid.size());
+	tick(grid, { npc1 });
+	EXPECT_EQ(0, npc1->visibleCount()) << "The removed npc is still visible";
+}
+
+TEST_F(InterestGridTest, testEmptyCellsAreRemoved) {
+	InterestGrid grid(100.0f);
+	const std::vector<NpcPtr>& npcs = create({glm::vec3(0.0f), glm::vec3(10.0f, 0.0f, 10.0f)});
+	const NpcPtr& npc1 = npcs[0];
+	const NpcPtr& npc2 = npcs[1];
+	ASSERT_TRUE(grid.add(npc1));
+	ASSERT_TRUE(grid.add(npc2));
+	tick(grid, npcs);
+	EXPECT_EQ(1u, grid.cellCount());
+	EXPECT_EQ(1, npc1->visibleCount());
+	for (int i = 1; i <= 10; ++i) {
+		npc2->setPos(glm::vec3(i * 50000.0f, 0.0f, 0.0f));
+		tick(grid, npcs);
+		EXPECT_EQ(0, npc1->visibleCount()) << "The npc left the view range in step " << i;
+		EXPECT_LE(grid.cellCount(), 3u) << "The empty cells are not removed";
+	}
+	tick(grid, npcs);
+	EXPECT_EQ(2u, grid.cellCount());
+	ASSERT_TRUE(grid.remove(npc2));
+	tick(grid, { npc1 });
+	tick(grid, { npc1 });
+	EXPECT_EQ(1u, grid.cellCount());
+}
+
+}
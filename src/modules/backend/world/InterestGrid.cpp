@@ -0,0 +1,257 @@
+/**
+ * @file
+ */
+
+#include "InterestGrid.h"
+#include "core/Assert.h"
+#include "core/Trace.h"
+#include <algorithm>
+#include <glm/common.hpp>
+
+namespace backend {
+
+bool InterestGrid::CellRange::operator==(const CellRange& other) const {
+	return minX == other.minX && minZ == other.minZ && maxX == other.maxX && maxZ == other.maxZ;
+}
+
+bool InterestGrid::CellRange::contains(int32_t x, int32_t z) const {
+	return x >= minX && x <= maxX && z >= minZ && z <= maxZ;
+}
+
+uint64_t InterestGrid::CellRange::size() const {
+	if (maxX < minX || maxZ < minZ) {
+		return 0u;
+	}
+	return (uint64_t)((int64_t)maxX - minX + 1) * (uint64_t)((int64_t)maxZ - minZ + 1);
+}
+
+InterestGrid::InterestGrid(float cellSize) :
+		_cellSize(cellSize) {
+	core_assert(_cellSize > 0.0f);
+}
+
+int32_t InterestGrid::cellCoord(float worldCoord) const {
+	return (int32_t)glm::floor(worldCoord / _cellSize);
+}
+
+uint64_t InterestGrid::cellKey(int32_t x, int32_t z) {
+	return ((uint64_t)(uint32_t)x << 32) | (uint64_t)(uint32_t)z;
+}
+
+uint64_t InterestGrid::cellKey(const glm::vec3& pos) const {
+	return cellKey(cellCoord(pos.x), cellCoord(pos.z));
+}
+
+int32_t InterestGrid::cellX(uint64_t key) {
+	return (int32_t)(uint32_t)(key >> 32);
+}
+
+int32_t InterestGrid::cellZ(uint64_t key) {
+	return (int32_t)(uint32_t)(key & 0xFFFFFFFFu);
+}
+
+InterestGrid::CellRange InterestGrid::cellRange(const math::RectFloat& rect) const {
+	// the entities are sorted into the cells by their center - but their rect might reach into the neighbour cell
+	CellRange range;
+	range.minX = cellCoord(rect.getMinX()) - 1;
+	range.minZ = cellCoord(rect.getMinZ()) - 1;
+	range.maxX = cellCoord(rect.getMaxX()) + 1;
+	range.maxZ = cellCoord(rect.getMaxZ()) + 1;
+	return range;
+}
+
+template<class FUNC>
+bool InterestGrid::visitCells(const CellRange& range, FUNC&& func) const {
+	if (range.size() > (uint64_t)_cells.size()) {
+		for (const auto& e : _cells) {
+			if (!range.contains(cellX(e.first), cellZ(e.first))) {
+				continue;
+			}
+			if (!func(e.second)) {
+				return false;
+			}
+		}
+		return true;
+	}
+	for (int32_t z = range.minZ; z <= range.maxZ; ++z) {
+		for (int32_t x = range.minX; x <= range.maxX; ++x) {
+			auto i = _cells.find(cellKey(x, z));
+			if (i == _cells.end()) {
+				continue;
+			}
+			if (!func(i->second)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void InterestGrid::insertIntoCell(const EntityPtr& entity, uint64_t key, uint64_t tick) {
+	Cell& cell = _cells[key];
+	cell.entities.push_back(entity);
+	cell.changed = tick;
+}
+
+void InterestGrid::removeFromCell(const Entity* entity, uint64_t key, uint64_t tick) {
+	auto i = _cells.find(key);
+	if (i == _cells.end()) {
+		return;
+	}
+	std::vector<EntityPtr>& entities = i->second.entities;
+	for (size_t n = 0u; n < entities.size(); ++n) {
+		if (entities[n].get() != entity) {
+			continue;
+		}
+		entities[n] = entities.back();
+		entities.pop_back();
+		break;
+	}
+	i->second.changed = tick;
+	if (entities.empty()) {
+		_emptyCells.push_back(key);
+	}
+}
+
+void InterestGrid::pruneEmptyCells() {
+	size_t n = 0u;
+	for (const uint64_t key : _emptyCells) {
+		auto i = _cells.find(key);
+		if (i == _cells.end() || !i->second.entities.empty()) {
+			continue;
+		}
+		if (i->second.changed >= _tick) {
+			// the observers didn't see the change yet
+			_emptyCells[n++] = key;
+			continue;
+		}
+		_cells.erase(i);
+	}
+	_emptyCells.resize(n);
+}
+
+bool InterestGrid::add(const EntityPtr& entity) {
+	Interest interest;
+	interest.entity = entity;
+	interest.pos = entity->pos();
+	interest.orientation = entity->orientation();
+	interest.cell = cellKey(interest.pos);
+	if (!_interests.insert(std::make_pair(entity.get(), interest)).second) {
+		return false;
+	}
+	// mark the cell for the next tick, too - this might get called after @c updateCells()
+	insertIntoCell(entity, interest.cell, _tick + 1u);
+	return true;
+}
+
+bool InterestGrid::remove(const EntityPtr& entity) {
+	auto i = _interests.find(entity.get());
+	if (i == _interests.end()) {
+		return false;
+	}
+	removeFromCell(entity.get(), i->second.cell, _tick + 1u);
+	_interests.erase(i);
+	return true;
+}
+
+void InterestGrid::clear() {
+	_interests.clear();
+	_cells.clear();
+	_emptyCells.clear();
+}
+
+void InterestGrid::updateCells() {
+	core_trace_scoped(InterestGridUpdateCells);
+	++_tick;
+	_recalculated = 0;
+	pruneEmptyCells();
+	for (auto& e : _interests) {
+		Interest& interest = e.second;
+		const EntityPtr& entity = interest.entity;
+		const glm::vec3& pos = entity->pos();
+		const float orientation = entity->orientation();
+		const CellRange& viewRange = cellRange(entity->viewRect());
+		if (!(viewRange == interest.viewRange) || orientation != interest.orientation) {
+			interest.viewRange = viewRange;
+			interest.orientation = orientation;
+			interest.dirty = true;
+		}
+		if (pos == interest.pos) {
+			continue;
+		}
+		interest.pos = pos;
+		interest.dirty = true;
+		const uint64_t key = cellKey(pos);
+		if (key == interest.cell) {
+			// the entity might get (in)visible for the observers of this cell
+			_cells[key].changed = _tick;
+			continue;
+		}
+		removeFromCell(entity.get(), interest.cell, _tick);
+		insertIntoCell(entity, key, _tick);
+		interest.cell = key;
+	}
+}
+
+bool InterestGrid::needsUpdate(const Interest& interest) const {
+	if (interest.dirty) {
+		return true;
+	}
+	const uint64_t tick = _tick;
+	// stop at the first cell that changed in this tick
+	return !visitCells(interest.viewRange, [tick] (const Cell& cell) {
+		return cell.changed < tick;
+	});
+}
+
+void InterestGrid::collectCandidates(const Interest& interest) {
+	const EntityPtr& entity = interest.entity;
+	const math::RectFloat& viewRect = entity->viewRect();
+	_candidates.clear();
+	visitCells(interest.viewRange, [&] (const Cell& cell) {
+		for (const EntityPtr& other : cell.entities) {
+			if (other == entity) {
+				continue;
+			}
+			if (!viewRect.intersectsWith(other->rect())) {
+				continue;
+			}
+			if (!entity->inFrustum(other)) {
+				continue;
+			}
+			_candidates.push_back(other);
+		}
+		return true;
+	});
+	std::sort(_candidates.begin(), _candidates.end());
+}
+
+void InterestGrid::updateVisible(const EntityPtr& entity) {
+	auto i = _interests.find(entity.get());
+	core_assert_msg(i != _interests.end(), "Entity " PRIEntId " is not part of the interest grid", entity->id());
+	_add.clear();
+	_remove.clear();
+	Interest& interest = i->second;
+	if (needsUpdate(interest)) {
+		++_recalculated;
+		interest.dirty = false;
+		collectCandidates(interest);
+		_stillVisible.assign(_candidates.size(), 0u);
+		entity->visitVisible([this] (const EntityPtr& e) {
+			auto c = std::lower_bound(_candidates.begin(), _candidates.end(), e);
+			if (c == _candidates.end() || *c != e) {
+				_remove.push_back(e);
+				return;
+			}
+			_stillVisible[c - _candidates.begin()] = 1u;
+		});
+		for (size_t n = 0u; n < _candidates.size(); ++n) {
+			if (_stillVisible[n] == 0u) {
+				_add.push_back(_candidates[n]);
+			}
+		}
+	}
+	entity->updateVisible(_add, _remove);
+}
+
+}
@@ -0,0 +1,142 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "backend/entity/Entity.h"
+#include "math/Rect.h"
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+namespace backend {
+
+/**
+ * @brief Interest management for the entities of a map. The entities are stored in a uniform grid - the visible
+ * entities are only recalculated for an entity if the entity itself moved or something changed in one of the
+ * cells that are in its view range. The deltas are handed over to @c Entity::updateVisible().
+ *
+ * A tick looks like this: call @c updateCells() once and then @c updateVisible() for every entity.
+ *
+ * @note This is not thread safe - it's only used in the tick of the @c Map
+ */
+class InterestGrid {
+public:
+	explicit InterestGrid(float cellSize = 100.0f);
+
+	/**
+	 * @brief Adds the entity at its current position to the grid
+	 * @return @c false if the entity was already added
+	 */
+	bool add(const EntityPtr& entity);
+	/**
+	 * @brief Removes the entity from the grid. The entity will be removed from the visible sets of the other
+	 * entities in their next @c updateVisible() call.
+	 */
+	bool remove(const EntityPtr& entity);
+	void clear();
+
+	/**
+	 * @brief Moves the entities into the cells of their current position and marks the cells that changed.
+	 */
+	void updateCells();
+
+	/**
+	 * @brief Recalculates the visible entities if needed and hands the deltas over to the entity
+	 * @note Call @c updateCells() before
+	 */
+	void updateVisible(const EntityPtr& entity);
+
+	size_t size() const;
+	/**
+	 * @return The amount of cells that are currently allocated. Empty cells are removed once their
+	 * change was consumed by the observers.
+	 */
+	size_t cellCount() const;
+	/**
+	 * @return The amount of entities whose visible entities were recalculated in the current tick
+	 */
+	int recalculated() const;
+
+private:
+	struct CellRange {
+		int32_t minX = 0;
+		int32_t minZ = 0;
+		int32_t maxX = -1;
+		int32_t maxZ = -1;
+
+		bool operator==(const CellRange& other) const;
+		bool contains(int32_t x, int32_t z) const;
+		uint64_t size() const;
+	};
+
+	struct Cell {
+		std::vector<EntityPtr> entities;
+		// the tick in which an entity entered, left or moved inside of this cell - the observers must
+		// recalculate their visible entities if this is >= the current tick
+		uint64_t changed = 0u;
+	};
+
+	struct Interest {
+		EntityPtr entity;
+		uint64_t cell = 0u;
+		glm::vec3 pos { 0.0f };
+		float orientation = 0.0f;
+		CellRange viewRange;
+		// the entity itself changed - recalculate the visible entities regardless of the cells
+		bool dirty = true;
+	};
+
+	const float _cellSize;
+	uint64_t _tick = 1u;
+	int _recalculated = 0;
+	std::unordered_map<uint64_t, Cell> _cells;
+	std::unordered_map<const Entity*, Interest> _interests;
+	// the keys of the cells that got empty - they are erased in the next tick
+	std::vector<uint64_t> _emptyCells;
+	// reused for every recalculation to not allocate memory in the tick
+	EntityList _candidates;
+	std::vector<uint8_t> _stillVisible;
+	EntityList _add;
+	EntityList _remove;
+
+	int32_t cellCoord(float worldCoord) const;
+	uint64_t cellKey(const glm::vec3& pos) const;
+	static uint64_t cellKey(int32_t x, int32_t z);
+	static int32_t cellX(uint64_t key);
+	static int32_t cellZ(uint64_t key);
+	CellRange cellRange(const math::RectFloat& rect) const;
+
+	void insertIntoCell(const EntityPtr& entity, uint64_t key, uint64_t tick);
+	void removeFromCell(const Entity* entity, uint64_t key, uint64_t tick);
+	/**
+	 * @brief Erases the empty cells whose change was already seen by the observers. The cells must stay
+	 * alive for the tick they changed in - otherwise the observers would not notice that an entity left them.
+	 */
+	void pruneEmptyCells();
+	bool needsUpdate(const Interest& interest) const;
+	void collectCandidates(const Interest& interest);
+
+	/**
+	 * @brief Calls the functor for every existing cell in the given range. If the range is bigger than the
+	 * amount of existing cells, the cells are iterated instead of the range.
+	 * @return @c false if the functor returned @c false and the iteration was stopped
+	 */
+	template<class FUNC>
+	bool visitCells(const CellRange& range, FUNC&& func) const;
+};
+
+inline size_t InterestGrid::size() const {
+	return _interests.size();
+}
+
+inline size_t InterestGrid::cellCount() const {
+	return _cells.size();
+}
+
+inline int InterestGrid::recalculated() const {
+	return _recalculated;
+}
+
+}
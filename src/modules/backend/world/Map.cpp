@@ -5,10 +5,10 @@
 #include "Map.h"
 #include "voxelworld/WorldPager.h"
 #include "voxelworld/WorldMgr.h"
+#include "voxelworld/ChunkGenerator.h"
 #include "core/StringUtil.h"
 #include "core/EventBus.h"
 #include "core/App.h"
-#include "math/QuadTree.h"
 #include "core/io/Filesystem.h"
 #include "backend/entity/Npc.h"
 #include "backend/entity/User.h"
@@ -22,14 +22,6 @@
 
 namespace backend {
 
-math::RectFloat Map::QuadTreeNode::getRect() const {
-	return entity->rect();
-}
-
-bool Map::QuadTreeNode::operator==(const QuadTreeNode& rhs) const {
-	return rhs.entity == entity;
-}
-
 Map::Map(MapId mapId,
 		const core::EventBusPtr& eventBus,
 		const core::TimeProviderPtr& timeProvider,
@@ -45,7 +37,7 @@ Map::Map(MapId mapId,
 		_mapId(mapId), _mapIdStr(core::string::toString(mapId)),
 		_eventBus(eventBus), _filesystem(filesystem), _persistenceMgr(persistenceMgr),
 		_volumeCache(volumeCache), _attackMgr(this),
-		_quadTree(math::RectFloat::getMaxRect(), 100.0f), _chunkPersister(chunkPersister) {
+		_chunkPersister(chunkPersister) {
 	_poiProvider = std::make_shared<poi::PoiProvider>(timeProvider);
 	_spawnMgr = std::make_shared<backend::SpawnMgr>(this, filesystem, entityStorage, messageSender,
 			timeProvider, loader, containerProvider, cooldownProvider);
@@ -59,27 +51,6 @@ bool Map::getDirtyModels(Models& models) {
 	return false;
 }
 
-bool Map::updateEntity(const EntityPtr& entity, long dt) {
-	if (!entity->update(dt)) {
-		return false;
-	}
-	const math::RectFloat& rect = entity->viewRect();
-	// TODO: maybe move into the entity instance to reduce memory allocations.
-	math::QuadTree<QuadTreeNode, float>::Contents contents;
-	_quadTree.query(rect, contents);
-	EntitySet set;
-	set.reserve(contents.size());
-	for (const QuadTreeNode& node : contents) {
-		// TODO: check the distance - the rect might contain more than the circle would...
-		if (entity->inFrustum(node.entity)) {
-			set.insert(node.entity);
-		}
-	}
-	set.erase(entity);
-	entity->updateVisible(set);
-	return true;
-}
-
 void Map::update(long dt) {
 	Log::trace("tick map %i", (int)_mapId);
 	_spawnMgr->update(dt);
@@ -88,27 +59,39 @@ void Map::update(long dt) {
 
 	for (auto i = _users.begin(); i != _users.end();) {
 		UserPtr user = i->second;
-		if (updateEntity(user, dt)) {
+		if (user->update(dt)) {
 			++i;
 			continue;
 		}
 		Log::debug("remove user " PRIEntId, user->id());
-		_quadTree.remove(QuadTreeNode { user });
+		_interestGrid.remove(user);
 		i = _users.erase(i);
-		_eventBus->enqueue(std::make_shared<EntityDeleteEvent>(user->id(), user->entityType()));
+		_eventBus->enqueue<EntityDeleteEvent>(user->id(), user->entityType());
 	}
 	for (auto i = _npcs.begin(); i != _npcs.end();) {
 		NpcPtr npc = i->second;
-		if (updateEntity(npc, dt)) {
+		if (npc->update(dt)) {
 			++i;
 			continue;
 		}
 		Log::debug("remove npc " PRIEntId, npc->id());
-		_quadTree.remove(QuadTreeNode { npc });
+		_interestGrid.remove(npc);
 		i = _npcs.erase(i);
 		_zone->removeAI(npc->ai());
-		_eventBus->enqueue(std::make_shared<EntityDeleteEvent>(npc->id(), npc->entityType()));
+		_eventBus->enqueue<EntityDeleteEvent>(npc->id(), npc->entityType());
+	}
+
+	prefetchChunks();
+
+	// the visibility is updated after all entities moved
+	_interestGrid.updateCells();
+	for (auto& e : _users) {
+		_interestGrid.updateVisible(e.second);
+	}
+	for (auto& e : _npcs) {
+		_interestGrid.updateVisible(e.second);
 	}
+	Log::trace("recalculated the visible entities of %i entities", _interestGrid.recalculated());
 }
 
 bool Map::init() {
@@ -124,7 +107,9 @@ bool Map::init() {
 
 	_pager = core::make_shared<voxelworld::WorldPager>(_volumeCache, _chunkPersister);
 	_voxelWorldMgr = new voxelworld::WorldMgr(_pager);
-	if (!_voxelWorldMgr->init()) {
+	const uint32_t volumeMemory = core::Var::get(cfg::ServerVolumeMemory, "512")->uintVal();
+	const uint32_t compressedVolumeMemory = core::Var::get(cfg::ServerVolumeCompressedMemory, "256")->uintVal();
+	if (!_voxelWorldMgr->init(volumeMemory, 256, compressedVolumeMemory)) {
 		Log::error("Failed to init map with id %i", _mapId);
 		return false;
 	}
@@ -137,6 +122,16 @@ bool Map::init() {
 	_pager->setNoiseOffset(glm::zero<glm::vec2>());
 
 	_voxelWorldMgr->setSeed(seed->uintVal());
+
+	const int chunkGeneratorThreads = core::Var::get(cfg::ServerChunkGeneratorThreads, "2")->intVal();
+	_chunkGenerator = new voxelworld::ChunkGenerator(core_max(1, chunkGeneratorThreads));
+	if (!_chunkGenerator->init(_voxelWorldMgr->volumeData())) {
+		Log::error("Failed to init the chunk generator for map with id %i", _mapId);
+		return false;
+	}
+	_chunkPrefetchRadius = core::Var::get(cfg::ServerChunkPrefetchRadius, "1");
+	// the spawn positions are picked around the origin - see WorldMgr::randomPos()
+	_chunkGenerator->prefetch(glm::ivec3(0), 1, voxelworld::ChunkGenerator::PrioritySpawn);
 	_zone = new ai::Zone(core::string::format("Zone %i", _mapId));
 
 	if (!_spawnMgr->init()) {
@@ -149,6 +144,13 @@ bool Map::init() {
 void Map::shutdown() {
 	_attackMgr.shutdown();
 	_spawnMgr->shutdown();
+	if (_chunkGenerator != nullptr) {
+		// the workers must be done before the volume and the pager go away
+		_chunkGenerator->shutdown();
+		delete _chunkGenerator;
+		_chunkGenerator = nullptr;
+	}
+	_chunkQueueSize = -1;
 	if (_pager != nullptr) {
 		_pager->shutdown();
 		_pager = voxelworld::WorldPagerPtr();
@@ -160,6 +162,7 @@ void Map::shutdown() {
 	}
 	delete _zone;
 	_zone = nullptr;
+	_interestGrid.clear();
 	_persistenceMgr->unregisterSavable(FOURCC, this);
 }
 
@@ -171,6 +174,22 @@ glm::vec3 Map::findStartPosition(const EntityPtr& entity) const {
 	return glm::vec3(randomPos());
 }
 
+void Map::prefetchChunks() {
+	if (_chunkGenerator == nullptr) {
+		return;
+	}
+	const int radius = _chunkPrefetchRadius->intVal();
+	for (const auto& e : _users) {
+		_chunkGenerator->prefetch(glm::ivec3(e.second->pos()), radius, voxelworld::ChunkGenerator::PriorityPlayer);
+	}
+	const int queueSize = _chunkGenerator->queueSize();
+	if (queueSize == _chunkQueueSize) {
+		return;
+	}
+	_chunkQueueSize = queueSize;
+	_eventBus->enqueue<metric::MetricEvent>(metric::gauge("map.chunk.queue", (uint32_t)queueSize, {{"map", _mapIdStr}}));
+}
+
 void Map::addUser(const UserPtr& user) {
 	auto i = _users.insert(std::make_pair(user->id(), user));
 	if (!i.second) {
@@ -178,8 +197,8 @@ void Map::addUser(const UserPtr& user) {
 	}
 	const glm::vec3& pos = findStartPosition(user);
 	user->setMap(ptr(), pos);
-	_quadTree.insert(QuadTreeNode { user });
-	_eventBus->enqueue(std::make_shared<EntityAddToMapEvent>(user));
+	_interestGrid.add(user);
+	_eventBus->enqueue<EntityAddToMapEvent>(user);
 	_poiProvider->add(pos, poi::Type::SPAWN);
 }
 
@@ -189,9 +208,9 @@ bool Map::removeUser(EntityId id) {
 		return false;
 	}
 	UserPtr user = i->second;
-	_quadTree.remove(QuadTreeNode { user });
+	_interestGrid.remove(user);
 	_users.erase(i);
-	_eventBus->enqueue(std::make_shared<EntityRemoveFromMapEvent>(user));
+	_eventBus->enqueue<EntityRemoveFromMapEvent>(user);
 	return true;
 }
 
@@ -212,8 +231,8 @@ bool Map::addNpc(const NpcPtr& npc) {
 	const glm::vec3& pos = findStartPosition(npc);
 	npc->setMap(ptr(), pos);
 	_zone->addAI(npc->ai());
-	_quadTree.insert(QuadTreeNode { npc });
-	_eventBus->enqueue(std::make_shared<EntityAddToMapEvent>(npc));
+	_interestGrid.add(npc);
+	_eventBus->enqueue<EntityAddToMapEvent>(npc);
 	_poiProvider->add(pos, poi::Type::SPAWN);
 	return true;
 }
@@ -224,10 +243,10 @@ bool Map::removeNpc(EntityId id) {
 		return false;
 	}
 	NpcPtr npc = i->second;
-	_quadTree.remove(QuadTreeNode { npc });
+	_interestGrid.remove(npc);
 	_npcs.erase(i);
 	_zone->removeAI(npc->ai());
-	_eventBus->enqueue(std::make_shared<EntityRemoveFromMapEvent>(npc));
+	_eventBus->enqueue<EntityRemoveFromMapEvent>(npc);
 	return true;
 }
 
@@ -241,10 +260,34 @@ NpcPtr Map::npc(EntityId id) {
 }
 
 int Map::findFloor(const glm::vec3& pos, float maxDistanceY) const {
+	if (_chunkGenerator != nullptr) {
+		// the raycast floors the coordinates, the material lookup truncates them - cover both columns
+		const int minY = (int)glm::floor(glm::max(0.0f, pos.y - maxDistanceY));
+		const int maxY = (int)glm::floor(glm::clamp(pos.y + maxDistanceY, 0.0f, (float)voxel::MAX_HEIGHT));
+		const glm::ivec3 mins((int)glm::floor(pos.x), minY, (int)glm::floor(pos.z));
+		const glm::ivec3 maxs((int)pos.x, maxY, (int)pos.z);
+		if (!_chunkGenerator->generated(mins, maxs, voxelworld::ChunkGenerator::PriorityPlayer)) {
+			// don't page in the chunks on the tick thread - keep the height until a worker generated them
+			return (int)pos.y;
+		}
+	}
 	return _voxelWorldMgr->findWalkableFloor(pos, maxDistanceY);
 }
 
 glm::ivec3 Map::randomPos() const {
+	if (_chunkGenerator != nullptr) {
+		const int attempts = 10;
+		for (int i = 0; i < attempts; ++i) {
+			glm::ivec3 pos = _voxelWorldMgr->randomColumn();
+			const glm::ivec3 maxs(pos.x, voxel::MAX_HEIGHT, pos.z);
+			if (!_chunkGenerator->generated(pos, maxs, voxelworld::ChunkGenerator::PrioritySpawn)) {
+				continue;
+			}
+			pos.y = _voxelWorldMgr->findFloor(pos.x, pos.z, voxel::isFloor);
+			return pos;
+		}
+		Log::debug("No generated chunk for a random position found - generate it on the calling thread");
+	}
 	return _voxelWorldMgr->randomPos();
 }
 
@@ -5,16 +5,16 @@
 #pragma once
 
 #include "backend/ForwardDecl.h"
-#include "math/QuadTree.h"
-#include "math/Rect.h"
 #include "core/Common.h"
 #include "ai/common/CharacterId.h"
 #include "core/IComponent.h"
+#include "core/Var.h"
 #include "backend/attack/AttackMgr.h"
 #include "persistence/ISavable.h"
 #include "persistence/ForwardDecl.h"
 #include "voxel/Constants.h"
 #include "DBChunkPersister.h"
+#include "InterestGrid.h"
 #include "MapId.h"
 #include <memory>
 #include <unordered_map>
@@ -33,6 +33,9 @@ private:
 	core::String _mapIdStr;
 	voxelworld::WorldMgr* _voxelWorldMgr = nullptr;
 	voxelworld::WorldPagerPtr _pager;
+	voxelworld::ChunkGenerator* _chunkGenerator = nullptr;
+	core::VarPtr _chunkPrefetchRadius;
+	int _chunkQueueSize = -1;
 
 	core::EventBusPtr _eventBus;
 	SpawnMgrPtr _spawnMgr;
@@ -53,21 +56,14 @@ private:
 
 	AttackMgr _attackMgr;
 
-	struct QuadTreeNode {
-		EntityPtr entity;
-
-		math::RectFloat getRect() const;
-		bool operator==(const QuadTreeNode& rhs) const;
-	};
-
-	math::QuadTree<QuadTreeNode, float> _quadTree;
+	InterestGrid _interestGrid;
 	DBChunkPersisterPtr _chunkPersister;
-	/**
-	 * @return @c false if the entity should be removed from the server.
-	 */
-	bool updateEntity(const EntityPtr& entity, long dt);
 
 	glm::vec3 findStartPosition(const EntityPtr& entity) const;
+	/**
+	 * @brief Generates the chunks around the users ahead of time and reports the queue size
+	 */
+	void prefetchChunks();
 
 public:
 	Map(MapId mapId,
@@ -120,6 +116,7 @@ public:
 
 	const voxelworld::WorldPagerPtr& pager() const;
 	voxelworld::WorldMgr* worldMgr();
+	voxelworld::ChunkGenerator* chunkGenerator();
 	ai::Zone* zone() const;
 	MapId id() const;
 	const core::String& idStr() const;
@@ -154,6 +151,10 @@ inline voxelworld::WorldMgr* Map::worldMgr() {
 	return _voxelWorldMgr;
 }
 
+inline voxelworld::ChunkGenerator* Map::chunkGenerator() {
+	return _chunkGenerator;
+}
+
 inline const AttackMgr& Map::attackMgr() const {
 	return _attackMgr;
 }
@@ -37,6 +37,10 @@ void World::update(long dt) {
 		const MapPtr& map = e.second;
 		map->update(dt);
 	}
+	if (_aiDebugStateRate->isDirty()) {
+		_aiServer->setStateRate(_aiDebugStateRate->intVal());
+		_aiDebugStateRate->markClean();
+	}
 	_aiServer->update(dt);
 }
 
@@ -97,6 +101,9 @@ bool World::init() {
 	}
 
 	_aiServer = new ai::Server(*_registry, aiDebugServerPort, aiDebugServerInterface);
+	_aiDebugStateRate = core::Var::get(cfg::ServerAIDebugStateRate, "10");
+	_aiServer->setStateRate(_aiDebugStateRate->intVal());
+	_aiDebugStateRate->markClean();
 	if (_aiServer->start()) {
 		Log::info("Start the ai debug server on %s:%i", aiDebugServerInterface, aiDebugServerPort);
 	} else {
@@ -6,6 +6,7 @@
 
 #include "Map.h"
 #include "core/IComponent.h"
+#include "core/Var.h"
 #include "backend/ForwardDecl.h"
 #include "ai/server/Server.h"
 #include <unordered_map>
@@ -22,6 +23,7 @@ private:
 	core::EventBusPtr _eventBus;
 	io::FilesystemPtr _filesystem;
 	ai::Server* _aiServer = nullptr;
+	core::VarPtr _aiDebugStateRate;
 	std::unordered_map<MapId, MapPtr> _maps;
 public:
 	World(const MapProviderPtr& mapProvider, const AIRegistryPtr& registry,
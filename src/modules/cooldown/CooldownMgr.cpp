@@ -13,6 +13,50 @@ CooldownMgr::CooldownMgr(const core::TimeProviderPtr& timeProvider, const cooldo
 		_timeProvider(timeProvider), _cooldownProvider(cooldownProvider), _lock("CooldownMgr") {
 }
 
+CooldownMgr::~CooldownMgr() {
+	core::TimingWheel& wheel = _cooldownProvider->timingWheel();
+	for (const auto& e : _timers) {
+		wheel.cancel(e.second);
+	}
+}
+
+void CooldownMgr::scheduleExpire(const CooldownPtr& cooldown) {
+	const Type type = cooldown->type();
+	cancelExpire(type);
+	const uint64_t expireMillis = cooldown->startMillis() + cooldown->duration();
+	_timers[type] = _cooldownProvider->timingWheel().schedule(expireMillis, [this, type] () {
+		onExpire(type);
+	});
+}
+
+void CooldownMgr::cancelExpire(Type type) {
+	auto i = _timers.find(type);
+	if (i == _timers.end()) {
+		return;
+	}
+	_cooldownProvider->timingWheel().cancel(i->second);
+	_timers.erase(i);
+}
+
+void CooldownMgr::onExpire(Type type) {
+	CooldownPtr cooldown;
+	{
+		core::ScopedWriteLock lock(_lock);
+		auto i = _cooldowns.find(type);
+		if (i == _cooldowns.end()) {
+			return;
+		}
+		cooldown = i->second;
+		// the cooldown might have been canceled or restarted while the timer was already handed out
+		if (!cooldown->started() || cooldown->running()) {
+			return;
+		}
+		_timers.erase(type);
+	}
+	Log::debug("Cooldown of type %i has just expired", core::enumVal(type));
+	cooldown->expire();
+}
+
 CooldownPtr CooldownMgr::createCooldown(Type type, long startMillis) const {
 	const unsigned long duration = defaultDuration(type);
 	long expireMillis;
@@ -26,6 +70,8 @@ CooldownPtr CooldownMgr::createCooldown(Type type, long startMillis) const {
 }
 
 CooldownTriggerState CooldownMgr::triggerCooldown(Type type, const CooldownCallback& callback) {
+	// the wheel is only advanced by its owner - an expire time that the wheel already passed is executed
+	// in the next update of the wheel
 	core::ScopedWriteLock lock(_lock);
 	CooldownPtr cooldown = _cooldowns[type];
 	if (!cooldown) {
@@ -36,7 +82,7 @@ CooldownTriggerState CooldownMgr::triggerCooldown(Type type, const CooldownCallb
 		return CooldownTriggerState::ALREADY_RUNNING;
 	}
 	cooldown->start(callback);
-	_queue.push(cooldown);
+	scheduleExpire(cooldown);
 	Log::debug("Triggered the cooldown of type %i (expires in %lims, started at %li)",
 			core::enumVal(type), cooldown->duration(), cooldown->startMillis());
 	return CooldownTriggerState::SUCCESS;
@@ -60,6 +106,10 @@ bool CooldownMgr::resetCooldown(Type type) {
 	if (!c) {
 		return false;
 	}
+	{
+		core::ScopedWriteLock lock(_lock);
+		cancelExpire(type);
+	}
 	c->reset();
 	return true;
 }
@@ -69,6 +119,10 @@ bool CooldownMgr::cancelCooldown(Type type) {
 	if (!c) {
 		return false;
 	}
+	{
+		core::ScopedWriteLock lock(_lock);
+		cancelExpire(type);
+	}
 	c->cancel();
 	return true;
 }
@@ -84,24 +138,4 @@ bool CooldownMgr::isCooldown(Type type) {
 	return true;
 }
 
-void CooldownMgr::update() {
-	for (;;) {
-		_lock.lockRead();
-		if (_queue.empty()) {
-			_lock.unlockRead();
-			break;
-		}
-		CooldownPtr cooldown = _queue.top();
-		_lock.unlockRead();
-		if (cooldown->running()) {
-			break;
-		}
-
-		_lock.lockWrite();
-		_queue.pop();
-		_lock.unlockWrite();
-		Log::debug("Cooldown of type %i has just expired", core::enumVal(cooldown->type()));
-		cooldown->expire();
-	}
-}
 }
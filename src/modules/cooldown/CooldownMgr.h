@@ -12,7 +12,6 @@
 
 #include <memory>
 #include <unordered_map>
-#include <queue>
 #include <functional>
 #include <vector>
 
@@ -20,6 +19,9 @@ namespace cooldown {
 
 /**
  * @brief Cooldown manager that handles cooldowns for one entity
+ *
+ * The cooldowns expire in the timing wheel of the @c CooldownProvider. Only the owner of the provider advances
+ * the wheel - once per tick for all cooldown managers - so the expire callbacks are executed there.
  * @ingroup Cooldowns
  */
 class CooldownMgr: public core::IComponent {
@@ -28,24 +30,30 @@ protected:
 	cooldown::CooldownProviderPtr _cooldownProvider;
 	core::ReadWriteLock _lock;
 
-	struct CooldownComparatorLess {
-		inline bool operator()(const CooldownPtr& x, const CooldownPtr& y) const {
-			return std::less<Cooldown>()(*x.get(), *y.get());
-		}
-	};
+	typedef std::unordered_map<Type, CooldownPtr, network::EnumHash<Type> > Cooldowns;
+	/**
+	 * @brief This is a pool of @c Cooldown instances.
+	 */
+	Cooldowns _cooldowns;
 
-	typedef std::priority_queue<CooldownPtr, std::vector<CooldownPtr>, CooldownComparatorLess> CooldownQueue;
+	typedef std::unordered_map<Type, core::TimerId, network::EnumHash<Type> > Timers;
 	/**
-	 * @brief Running cooldowns - sorted by expire time. There can only be one cooldown of the same
-	 * type at the same time.
+	 * @brief The timers of the running cooldowns in the timing wheel of the @c CooldownProvider. There can only
+	 * be one cooldown of the same type at the same time.
 	 */
-	CooldownQueue _queue;
+	Timers _timers;
 
-	typedef std::unordered_map<Type, CooldownPtr, network::EnumHash<Type> > Cooldowns;
 	/**
-	 * @brief This is a pool of @c Cooldown instances.
+	 * @brief Schedules the expiration of the given running cooldown
+	 * @note The write lock must be held
 	 */
-	Cooldowns _cooldowns;
+	void scheduleExpire(const CooldownPtr& cooldown);
+	/**
+	 * @brief Removes the timer for the given type from the timing wheel
+	 * @note The write lock must be held
+	 */
+	void cancelExpire(Type type);
+	void onExpire(Type type);
 
 	/**
 	 * @brief Create @c Cooldown instances for the pool
@@ -56,7 +64,7 @@ protected:
 	CooldownPtr createCooldown(Type type, long startMillis = -1l) const;
 public:
 	CooldownMgr(const core::TimeProviderPtr& timeProvider, const cooldown::CooldownProviderPtr& cooldownProvider);
-	virtual ~CooldownMgr() {}
+	virtual ~CooldownMgr();
 
 	/**
 	 * @brief Tries to trigger the specified cooldown for the given entity
@@ -90,11 +98,6 @@ public:
 
 	virtual void shutdown() override {
 	}
-
-	/**
-	 * @brief Update cooldown states
-	 */
-	void update();
 };
 
 typedef std::shared_ptr<CooldownMgr> CooldownMgrPtr;
@@ -6,6 +6,7 @@
 #include "core/Common.h"
 #include "CooldownType.h"
 #include "core/Enum.h"
+#include "core/TimingWheel.h"
 #include <memory>
 
 namespace cooldown {
@@ -24,6 +25,7 @@ private:
 	bool _initialized = false;
 	long _durations[core::enumVal<Type>(Type::MAX) + 1];
 	core::String _error;
+	core::TimingWheel _timingWheel;
 public:
 	/**
 	 * @brief Ctor to init all available cooldowns to the DefaultDuration
@@ -57,12 +59,22 @@ public:
 	 * @sa init()
 	 */
 	const core::String& error() const;
+
+	/**
+	 * @brief The timers of all running cooldowns of all @c CooldownMgr instances that share this provider.
+	 * The owner of the provider has to advance it with the current tick millis.
+	 */
+	core::TimingWheel& timingWheel();
 };
 
 inline const core::String& CooldownProvider::error() const {
 	return _error;
 }
 
+inline core::TimingWheel& CooldownProvider::timingWheel() {
+	return _timingWheel;
+}
+
 typedef std::shared_ptr<CooldownProvider> CooldownProviderPtr;
 
 }
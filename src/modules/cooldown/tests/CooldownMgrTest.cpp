@@ -28,6 +28,11 @@ public:
 		const core::String& cooldowns = io::filesystem()->load("cooldowns.lua");
 		_cooldownProvider->init(cooldowns);
 	}
+
+	// the owner of the provider advances the wheel for all managers
+	void update() {
+		_cooldownProvider->timingWheel().update(_timeProvider->tickMillis());
+	}
 };
 
 TEST_F(CooldownMgrTest, testTriggerCooldown) {
@@ -47,13 +52,13 @@ TEST_F(CooldownMgrTest, testExpireCooldown) {
 	ASSERT_TRUE(_mgr.cooldown(Type::LOGOUT)->started()) << "Cooldown is not started";
 	ASSERT_TRUE(_mgr.cooldown(Type::LOGOUT)->running()) << "Cooldown is not running";
 	ASSERT_TRUE(_mgr.isCooldown(Type::LOGOUT));
-	_mgr.update();
+	update();
 	ASSERT_TRUE(_mgr.cooldown(Type::LOGOUT)->started()) << "Cooldown is not started";
 	ASSERT_TRUE(_mgr.cooldown(Type::LOGOUT)->running()) << "Cooldown is not running";
 	ASSERT_TRUE(_mgr.isCooldown(Type::LOGOUT));
 	_timeProvider->update(_mgr.defaultDuration(Type::LOGOUT));
 	ASSERT_FALSE(_mgr.isCooldown(Type::LOGOUT));
-	_mgr.update();
+	update();
 	ASSERT_FALSE(_mgr.cooldown(Type::LOGOUT)->running()) << "Cooldown is still running";
 	ASSERT_FALSE(_mgr.isCooldown(Type::LOGOUT));
 	ASSERT_TRUE(_mgr.resetCooldown(Type::LOGOUT)) << "Failed to reset the logout cooldown";
@@ -65,7 +70,7 @@ TEST_F(CooldownMgrTest, testMultipleCooldown) {
 	ASSERT_EQ(CooldownTriggerState::SUCCESS, _mgr.triggerCooldown(Type::INCREASE)) << "Increase cooldown couldn't get triggered";
 	ASSERT_TRUE(_mgr.isCooldown(Type::LOGOUT));
 	ASSERT_TRUE(_mgr.isCooldown(Type::INCREASE));
-	_mgr.update();
+	update();
 	ASSERT_TRUE(_mgr.isCooldown(Type::LOGOUT));
 	ASSERT_TRUE(_mgr.isCooldown(Type::INCREASE));
 
@@ -74,12 +79,12 @@ TEST_F(CooldownMgrTest, testMultipleCooldown) {
 
 	if (logoutDuration > increaseDuration) {
 		_timeProvider->update(increaseDuration);
-		_mgr.update();
+		update();
 		ASSERT_TRUE(_mgr.isCooldown(Type::LOGOUT));
 		ASSERT_FALSE(_mgr.isCooldown(Type::INCREASE));
 	} else {
 		_timeProvider->update(logoutDuration);
-		_mgr.update();
+		update();
 		ASSERT_TRUE(_mgr.isCooldown(Type::INCREASE));
 		ASSERT_FALSE(_mgr.isCooldown(Type::LOGOUT));
 	}
@@ -90,4 +95,49 @@ TEST_F(CooldownMgrTest, testTriggerCooldownTwice) {
 	ASSERT_EQ(CooldownTriggerState::ALREADY_RUNNING, _mgr.triggerCooldown(Type::LOGOUT)) << "Logout cooldown was triggered twice";
 }
 
+TEST_F(CooldownMgrTest, testExpireCallback) {
+	_timeProvider->update(0ul);
+	int started = 0;
+	int expired = 0;
+	ASSERT_EQ(CooldownTriggerState::SUCCESS, _mgr.triggerCooldown(Type::LOGOUT, [&] (CallbackType type) {
+		if (type == CallbackType::Started) {
+			++started;
+		} else if (type == CallbackType::Expired) {
+			++expired;
+		}
+	}));
+	EXPECT_EQ(1, started);
+	_timeProvider->update(_mgr.defaultDuration(Type::LOGOUT) - 1ul);
+	update();
+	EXPECT_EQ(0, expired);
+	_timeProvider->update(_mgr.defaultDuration(Type::LOGOUT));
+	update();
+	EXPECT_EQ(1, expired);
+	EXPECT_EQ(0u, _cooldownProvider->timingWheel().size());
+}
+
+TEST_F(CooldownMgrTest, testTriggerDoesntExpire) {
+	_timeProvider->update(0ul);
+	int expired = 0;
+	ASSERT_EQ(CooldownTriggerState::SUCCESS, _mgr.triggerCooldown(Type::LOGOUT, [&] (CallbackType type) {
+		if (type == CallbackType::Expired) {
+			++expired;
+		}
+	}));
+	_timeProvider->update(_mgr.defaultDuration(Type::LOGOUT));
+	// triggering a cooldown must not execute the expire callbacks on the calling thread
+	ASSERT_EQ(CooldownTriggerState::SUCCESS, _mgr.triggerCooldown(Type::INCREASE));
+	EXPECT_EQ(0, expired);
+	update();
+	EXPECT_EQ(1, expired);
+}
+
+TEST_F(CooldownMgrTest, testCancelRemovesTimer) {
+	_timeProvider->update(0ul);
+	ASSERT_EQ(CooldownTriggerState::SUCCESS, _mgr.triggerCooldown(Type::LOGOUT));
+	EXPECT_EQ(1u, _cooldownProvider->timingWheel().size());
+	ASSERT_TRUE(_mgr.cancelCooldown(Type::LOGOUT));
+	EXPECT_EQ(0u, _cooldownProvider->timingWheel().size());
+}
+
 }
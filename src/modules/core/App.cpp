@@ -249,6 +249,7 @@ AppState App::onConstruct() {
 	}
 
 	core::Var::get(cfg::MetricFlavor, "telegraf");
+	core::Var::get(cfg::MetricFlushInterval, "1000");
 	const core::String& host = core::Var::get(cfg::MetricHost, "127.0.0.1")->strVal();
 	const int port = core::Var::get(cfg::MetricPort, "8125")->intVal();
 	_metricSender = std::make_shared<metric::UDPMetricSender>(host, port);
@@ -623,12 +624,13 @@ AppState App::onCleanup() {
 
 	core_trace_shutdown();
 
-	if (_metricSender) {
-		_metricSender->shutdown();
-	}
+	// the metric sends the aggregated values on shutdown
 	if (_metric) {
 		_metric->shutdown();
 	}
+	if (_metricSender) {
+		_metricSender->shutdown();
+	}
 
 #if defined(HAVE_SYS_RESOURCE_H)
 #if defined(HAVE_SYS_TIME_H)
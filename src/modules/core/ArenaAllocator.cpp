@@ -0,0 +1,117 @@
+/**
+ * @file
+ */
+
+#include "ArenaAllocator.h"
+#include "Assert.h"
+#include <SDL_stdinc.h>
+
+namespace core {
+
+ArenaAllocator::ArenaAllocator(size_t blockSize) :
+		_blockSize(blockSize) {
+}
+
+ArenaAllocator::~ArenaAllocator() {
+	shutdown();
+}
+
+ArenaAllocator::Block* ArenaAllocator::newBlock(size_t size) {
+	Block* block = (Block*)SDL_malloc(sizeof(Block) + size);
+	core_assert_always(block != nullptr);
+	block->next = nullptr;
+	block->size = size;
+	block->used = 0u;
+	++_blockAllocations;
+	return block;
+}
+
+void* ArenaAllocator::alloc(size_t size, size_t alignment) {
+	core_assert_msg((alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+	if (size == 0u) {
+		size = 1u;
+	}
+	Block* block = _current;
+	Block* last = nullptr;
+	while (block != nullptr) {
+		const uintptr_t top = (uintptr_t)(block->data() + block->used);
+		const size_t padding = (alignment - (top & (alignment - 1))) & (alignment - 1);
+		if (block->used + padding + size <= block->size) {
+			block->used += padding + size;
+			_current = block;
+			++_live;
+			_allocatedBytes += size;
+			return (void*)(top + padding);
+		}
+		last = block;
+		block = block->next;
+	}
+
+	// oversized requests get a block of their own - it's kept for later frames, too
+	const size_t needed = size + alignment;
+	block = newBlock(needed > _blockSize ? needed : _blockSize);
+	if (last != nullptr) {
+		last->next = block;
+	} else {
+		_first = block;
+	}
+	_current = block;
+	const uintptr_t top = (uintptr_t)block->data();
+	const size_t padding = (alignment - (top & (alignment - 1))) & (alignment - 1);
+	block->used = padding + size;
+	++_live;
+	_allocatedBytes += size;
+	return (void*)(top + padding);
+}
+
+void ArenaAllocator::free(void* ptr, size_t size) {
+	if (ptr == nullptr) {
+		return;
+	}
+	core_assert_msg(_live > 0, "More frees than allocations in the arena");
+	if (size == 0u) {
+		size = 1u;
+	}
+	Block* block = _current;
+	if (block != nullptr && (uint8_t*)ptr + size == block->data() + block->used) {
+		// the last allocation can be rolled back - this is what growing containers hit
+		block->used = (uint8_t*)ptr - block->data();
+		_allocatedBytes -= size;
+	}
+	if (--_live == 0) {
+		reset();
+	}
+}
+
+void ArenaAllocator::reset() {
+	for (Block* block = _first; block != nullptr; block = block->next) {
+		block->used = 0u;
+	}
+	_current = _first;
+	_live = 0;
+	_allocatedBytes = 0u;
+}
+
+void ArenaAllocator::shutdown() {
+	core_assert_msg(_live == 0, "There are still %i allocations alive in the arena", _live);
+	Block* block = _first;
+	while (block != nullptr) {
+		Block* next = block->next;
+		SDL_free(block);
+		block = next;
+	}
+	_first = nullptr;
+	_current = nullptr;
+	_live = 0;
+	_allocatedBytes = 0u;
+}
+
+size_t ArenaAllocator::capacity() const {
+	size_t size = 0u;
+	for (const Block* block = _first; block != nullptr; block = block->next) {
+		size += block->size;
+	}
+	return size;
+}
+
+}
@@ -0,0 +1,93 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "NonCopyable.h"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core {
+
+/**
+ * @brief Linear allocator that bumps a pointer through a list of memory blocks.
+ *
+ * Single allocations can't be given back individually (except the most recent one) - the
+ * whole arena is rewound with @c reset(). The blocks are kept and reused after a reset, so
+ * an arena that has seen its peak usage once doesn't touch the heap anymore.
+ *
+ * @note Not thread safe.
+ */
+class ArenaAllocator : public NonCopyable {
+private:
+	struct Block {
+		Block* next;
+		size_t size;
+		size_t used;
+
+		inline uint8_t* data() {
+			return (uint8_t*)(this + 1);
+		}
+	};
+
+	Block* _first = nullptr;
+	Block* _current = nullptr;
+	const size_t _blockSize;
+	// amount of allocations that were not yet handed back via free()
+	int _live = 0;
+	// amount of blocks that were requested from the heap
+	int _blockAllocations = 0;
+	size_t _allocatedBytes = 0u;
+
+	Block* newBlock(size_t size);
+public:
+	ArenaAllocator(size_t blockSize = 64u * 1024u);
+	~ArenaAllocator();
+
+	/**
+	 * @param[in] size The amount of bytes to allocate
+	 * @param[in] alignment Power of two alignment of the returned memory
+	 * @return Never @c nullptr
+	 */
+	void* alloc(size_t size, size_t alignment = alignof(max_align_t));
+	/**
+	 * @brief Hands back the memory of an allocation. The memory is only reused if this was the
+	 * last allocation. If no allocation is alive anymore, the arena is rewound.
+	 */
+	void free(void* ptr, size_t size);
+
+	/**
+	 * @brief Rewinds all blocks. Every pointer that was handed out before is invalid afterwards.
+	 */
+	void reset();
+	/**
+	 * @brief Gives all blocks back to the heap
+	 */
+	void shutdown();
+
+	int live() const;
+	int blockAllocations() const;
+	/**
+	 * @return The amount of bytes in use since the last reset
+	 */
+	size_t allocatedBytes() const;
+	/**
+	 * @return The amount of bytes that are reserved in all blocks
+	 */
+	size_t capacity() const;
+};
+
+inline int ArenaAllocator::live() const {
+	return _live;
+}
+
+inline int ArenaAllocator::blockAllocations() const {
+	return _blockAllocations;
+}
+
+inline size_t ArenaAllocator::allocatedBytes() const {
+	return _allocatedBytes;
+}
+
+}
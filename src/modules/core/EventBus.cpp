@@ -4,12 +4,19 @@
 
 #include "EventBus.h"
 #include "Log.h"
+#include <atomic>
 
 namespace core {
 
+ClassTypeId nextEventBusTypeId() {
+	static std::atomic<ClassTypeId> typeIds { 0 };
+	return typeIds++;
+}
+
 EventBus::EventBus(const int initialHandlerSize) :
 		_lock("EventBus") {
 	_handlers.reserve(initialHandlerSize);
+	_queues.reserve(initialHandlerSize);
 }
 
 EventBus::~EventBus() {
@@ -18,6 +25,9 @@ EventBus::~EventBus() {
 
 void EventBus::subscribe(ClassTypeId index, void *handler, const IEventBusTopic* topic) {
 	ScopedWriteLock lock(_lock);
+	if ((int)_handlers.size() <= index) {
+		_handlers.resize(index + 1);
+	}
 	EventBusHandlerReferences& handlers = _handlers[index];
 	const EventBusHandlerReference registration(handler, topic);
 	handlers.push_back(registration);
@@ -26,10 +36,13 @@ void EventBus::subscribe(ClassTypeId index, void *handler, const IEventBusTopic*
 int EventBus::unsubscribe(ClassTypeId index, void* handler, const IEventBusTopic* topic) {
 	int unsubscribedHandlers = 0;
 	ScopedWriteLock lock(_lock);
+	if ((int)_handlers.size() <= index) {
+		return 0;
+	}
 	EventBusHandlerReferences& handlers = _handlers[index];
 	for (EventBusHandlerReferences::iterator i = handlers.begin(); i != handlers.end();) {
 		EventBusHandlerReference& r = *i;
-		if (r.getHandler() != reinterpret_cast<IEventBusHandler<IEventBusEvent>*>(handler)) {
+		if (r.handler() != handler) {
 			++i;
 			continue;
 		}
@@ -49,24 +62,61 @@ int EventBus::unsubscribe(ClassTypeId index, void* handler, const IEventBusTopic
 	return unsubscribedHandlers;
 }
 
+EventBus::IEventQueue* EventBus::queue(ClassTypeId index) const {
+	ScopedLock lock(_queueLock);
+	return _queues[index].get();
+}
+
+int EventBus::dispatch(ClassTypeId index, int limit) {
+	IEventQueue* queue = this->queue(index);
+	// see publish() for the reason of the lock
+	ScopedReadLock lock(_lock);
+	if ((int)_handlers.size() <= index) {
+		static const EventBusHandlerReferences empty;
+		return queue->dispatch(empty, limit);
+	}
+	return queue->dispatch(_handlers[index], limit);
+}
+
 int EventBus::update(int limit) {
-	int i = 0;
-	IEventBusEventPtr event;
-	while (_queue.pop(event)) {
-		publish(*event);
-		if (limit > 0 && ++i >= limit) {
+	if (_dispatchTypeIndex >= _dispatchTypes.size()) {
+		// the last frame is done - collect the events of the next one
+		_dispatchTypes.clear();
+		_dispatchTypeIndex = 0u;
+		ScopedLock lock(_queueLock);
+		_dispatchTypes.swap(_queuedTypes);
+		for (ClassTypeId index : _dispatchTypes) {
+			_queues[index]->swap();
+		}
+	}
+
+	const bool limited = limit > 0;
+	int remaining = limit;
+	while (_dispatchTypeIndex < _dispatchTypes.size()) {
+		if (limited && remaining <= 0) {
 			break;
 		}
+		const ClassTypeId index = _dispatchTypes[_dispatchTypeIndex];
+		IEventQueue* queue = this->queue(index);
+		remaining -= dispatch(index, limited ? remaining : -1);
+		if (queue->pending() == 0) {
+			queue->reset();
+			++_dispatchTypeIndex;
+		}
 	}
-	return _queue.size();
+	return size();
 }
 
 int EventBus::size() const {
-	return  _queue.size();
-}
-
-void EventBus::enqueue(const IEventBusEventPtr& e) {
-	_queue.push(e);
+	int n = 0;
+	ScopedLock lock(_queueLock);
+	for (size_t i = _dispatchTypeIndex; i < _dispatchTypes.size(); ++i) {
+		n += _queues[_dispatchTypes[i]]->pending();
+	}
+	for (ClassTypeId index : _queuedTypes) {
+		n += _queues[index]->queued();
+	}
+	return n;
 }
 
 int EventBus::publish(const IEventBusEvent& e) {
@@ -76,24 +126,17 @@ int EventBus::publish(const IEventBusEvent& e) {
 	// if someone would unsubscribe he would maybe still get notified otherwise - or even worse,
 	// the pointer we are iterating over is already freed.
 	ScopedReadLock lock(_lock);
-	EventBusHandlerReferenceMap::iterator i = _handlers.find(index);
-	if (i == _handlers.end()) {
+	if ((int)_handlers.size() <= index) {
 		return 0;
 	}
 
 	int notifiedHandlers = 0;
-	EventBusHandlerReferences& handlers = i->second;
-	for (auto& r : handlers) {
-		if (r.getTopic() != nullptr) {
-			const IEventBusTopic* topic = e.getTopic();
-			if (topic == nullptr) {
-				continue;
-			}
-			if (!(*r.getTopic() == *topic)) {
-				continue;
-			}
+	const EventBusHandlerReferences& handlers = _handlers[index];
+	for (const EventBusHandlerReference& r : handlers) {
+		if (!r.accepts(e.getTopic())) {
+			continue;
 		}
-		IEventBusHandler<IEventBusEvent>* handler = r.getHandler();
+		IEventBusHandler<IEventBusEvent>* handler = r.getHandler<IEventBusEvent>();
 		handler->dispatch(e);
 		++notifiedHandlers;
 	}
@@ -4,21 +4,27 @@
 
 #pragma once
 
-#include <unordered_map>
-#include <list>
+#include <vector>
 #include <type_traits>
 #include <memory>
 #include "core/Log.h"
 #include "core/Common.h"
+#include "core/concurrent/Lock.h"
 #include "core/concurrent/ReadWriteLock.h"
-#include "core/collection/ConcurrentQueue.h"
 
 namespace core {
 
-using ClassTypeId = intptr_t;
+/**
+ * @brief Dense id of the event and topic classes - used as index into the handler tables of the EventBus
+ */
+using ClassTypeId = int;
+
+/**
+ * @brief Hands out the next free type id - see @c EVENTBUSTYPEID
+ */
+extern ClassTypeId nextEventBusTypeId();
 
 class IEventBusEvent;
-typedef std::shared_ptr<IEventBusEvent> IEventBusEventPtr;
 
 /**
  * @brief The handler will get notified for every published IEventBusEvent that it is registered for.
@@ -79,16 +85,15 @@ private:
 
 
 /**
- * @brief Used to identify different classes by their types
+ * @brief Used to identify different classes by their types. The ids are dense and assigned on first use.
  */
 #define EVENTBUSTYPEID(name) \
 	virtual ::core::ClassTypeId typeId() const override { \
-		static char _typeId; \
-		return (::core::ClassTypeId)&_typeId; \
+		return classTypeId(); \
 	} \
 	static ::core::ClassTypeId classTypeId() { \
-		static name _instance; \
-		return _instance.typeId(); \
+		static const ::core::ClassTypeId _typeId = ::core::nextEventBusTypeId(); \
+		return _typeId; \
 	}
 
 #define EVENTBUSTOPIC(name) \
@@ -104,7 +109,6 @@ class name: public ::core::IEventBusEvent { \
 public: \
 	EVENTBUSTYPEID(name) \
 	name(const ::core::IEventBusTopic* const topic = nullptr) : ::core::IEventBusEvent(topic) { \
-		Log::debug(CORE_STRINGIFY(name)); \
 	} \
 }
 
@@ -117,7 +121,6 @@ private: \
 public: \
 	EVENTBUSTYPEID(name) \
 	name(payload p, const ::core::IEventBusTopic* const topic = nullptr) : ::core::IEventBusEvent(topic), _p(p) { \
-		Log::debug(CORE_STRINGIFY(name)); \
 	} \
 	inline payload get() const { \
 		return _p; \
@@ -128,19 +131,17 @@ public: \
  * @brief EventBus with topic (IEventBusTopic) support
  *
  * Use subscribe() and unsubscribe() to manage your @c IEventBusHandler instances.
+ *
+ * Queued events are stored in one arena per event type that is reset once all events of a frame were
+ * dispatched - so enqueue() doesn't allocate once the arenas are warmed up. The events of one type are
+ * dispatched in the order they were queued, the event types in the order their first event of the frame
+ * was queued. update() hands all events of one type to a handler before the next handler is notified.
  */
 class EventBus {
 private:
-	class EventBusHandlerReference;
-	typedef std::list<EventBusHandlerReference> EventBusHandlerReferences;
-	typedef std::unordered_map<ClassTypeId, EventBusHandlerReferences> EventBusHandlerReferenceMap;
-	core::ReadWriteLock _lock;
-
-	core::ConcurrentQueue<IEventBusEventPtr, std::less<IEventBusEventPtr> > _queue;
-
 	class EventBusHandlerReference {
 	private:
-		void* const _handler;
+		void* _handler;
 		const IEventBusTopic *_topic;
 
 	public:
@@ -148,24 +149,137 @@ private:
 				_handler(handler), _topic(topic) {
 		}
 
-		inline IEventBusHandler<IEventBusEvent>* getHandler() const {
-			return static_cast<IEventBusHandler<IEventBusEvent>*>(_handler);
+		template<class T>
+		inline IEventBusHandler<T>* getHandler() const {
+			return static_cast<IEventBusHandler<T>*>(_handler);
+		}
+
+		inline void* handler() const {
+			return _handler;
 		}
 
 		inline const IEventBusTopic* getTopic() const {
 			return _topic;
 		}
+
+		/**
+		 * @return @c true if the handler should get notified about an event that was published with the given topic
+		 */
+		inline bool accepts(const IEventBusTopic* topic) const {
+			if (_topic == nullptr) {
+				return true;
+			}
+			if (topic == nullptr) {
+				return false;
+			}
+			return *_topic == *topic;
+		}
 	};
+	typedef std::vector<EventBusHandlerReference> EventBusHandlerReferences;
 
-	EventBusHandlerReferenceMap _handlers;
+	/**
+	 * @brief Type erased interface to the event arena of one event type
+	 */
+	class IEventQueue {
+	public:
+		virtual ~IEventQueue() = default;
+		/**
+		 * @brief Moves the queued events into the dispatch buffer
+		 */
+		virtual void swap() = 0;
+		/**
+		 * @brief Destroys the dispatched events but keeps the memory for the next frame
+		 */
+		virtual void reset() = 0;
+		/**
+		 * @brief Notifies the handlers about at most @c limit events of the dispatch buffer
+		 * @return The amount of dispatched events
+		 */
+		virtual int dispatch(const EventBusHandlerReferences& handlers, int limit) = 0;
+		virtual int pending() const = 0;
+		virtual int queued() const = 0;
+	};
+
+	template<class T>
+	class EventQueue : public IEventQueue {
+	private:
+		std::vector<T> _queued;
+		std::vector<T> _dispatch;
+		size_t _dispatchPos = 0u;
+	public:
+		template<typename ... ARGS>
+		inline void emplace(ARGS&&... args) {
+			_queued.emplace_back(core::forward<ARGS>(args)...);
+		}
+
+		inline bool empty() const {
+			return _queued.empty();
+		}
+
+		void swap() override {
+			_dispatchPos = 0u;
+			_dispatch.swap(_queued);
+		}
+
+		void reset() override {
+			_dispatch.clear();
+			_dispatchPos = 0u;
+		}
+
+		int dispatch(const EventBusHandlerReferences& handlers, int limit) override {
+			const size_t begin = _dispatchPos;
+			size_t end = _dispatch.size();
+			if (limit >= 0 && begin + (size_t)limit < end) {
+				end = begin + (size_t)limit;
+			}
+			for (const EventBusHandlerReference& r : handlers) {
+				IEventBusHandler<T>* handler = r.getHandler<T>();
+				for (size_t i = begin; i < end; ++i) {
+					const T& e = _dispatch[i];
+					if (r.accepts(e.getTopic())) {
+						handler->onEvent(e);
+					}
+				}
+			}
+			_dispatchPos = end;
+			return (int)(end - begin);
+		}
+
+		int pending() const override {
+			return (int)(_dispatch.size() - _dispatchPos);
+		}
+
+		int queued() const override {
+			return (int)_queued.size();
+		}
+	};
+
+	core::ReadWriteLock _lock;
+	// index is the ClassTypeId of the event
+	std::vector<EventBusHandlerReferences> _handlers;
+
+	core::Lock _queueLock;
+	// index is the ClassTypeId of the event
+	std::vector<std::unique_ptr<IEventQueue>> _queues;
+	// the event types in the order of the first queued event - guarded by _queueLock
+	std::vector<ClassTypeId> _queuedTypes;
+	// the event types of the frame that is currently dispatched - only touched by update()
+	std::vector<ClassTypeId> _dispatchTypes;
+	size_t _dispatchTypeIndex = 0u;
 
 	int unsubscribe(ClassTypeId index, void* handler, const IEventBusTopic* topic);
 	void subscribe(ClassTypeId index, void *handler, const IEventBusTopic* topic);
+	int dispatch(ClassTypeId index, int limit);
+	/**
+	 * @brief Looks up the queue of the given event type under the queue lock - enqueue() might resize the
+	 * queue table from another thread. The queue itself is never moved.
+	 */
+	IEventQueue* queue(ClassTypeId index) const;
 
 public:
 	/**
 	 * @param[in] initialHandlerSize Used to calculate the amount of memory that is reserved in the
-	 * handler map to reduce memory allocations.
+	 * handler tables to reduce memory allocations.
 	 */
 	EventBus(const int initialHandlerSize = 64);
 	~EventBus();
@@ -212,15 +326,35 @@ public:
 	 * @param[in] limit Limit the amount of executed events - if there are too many. If -1 is given here,
 	 * all events are handled.
 	 * @return the amount of events that are still in the queue (due to the limit)
+	 * @note Must only be called from one thread. Events that are queued while the handlers are executed
+	 * are dispatched with the next frame.
 	 */
 	int update(int limit = -1);
 
 	int size() const;
 
 	/**
-	 * @brief Execute in the main thread in the next tick
+	 * @brief Constructs the event in the arena of its type - the handlers are executed in the main thread
+	 * in the next tick
 	 */
-	void enqueue(const IEventBusEventPtr& e);
+	template<class T, typename ... ARGS>
+	void enqueue(ARGS&&... args) {
+		static_assert(std::is_base_of<IEventBusEvent, T>::value, "Wrong type given, must extend IEventBusEvent");
+		const ClassTypeId index = T::classTypeId();
+		core::ScopedLock lock(_queueLock);
+		if ((int)_queues.size() <= index) {
+			_queues.resize(index + 1);
+		}
+		std::unique_ptr<IEventQueue>& queue = _queues[index];
+		if (!queue) {
+			queue = std::unique_ptr<IEventQueue>(new EventQueue<T>());
+		}
+		EventQueue<T>* typedQueue = static_cast<EventQueue<T>*>(queue.get());
+		if (typedQueue->empty()) {
+			_queuedTypes.push_back(index);
+		}
+		typedQueue->emplace(core::forward<ARGS>(args)...);
+	}
 };
 
 typedef std::shared_ptr<EventBus> EventBusPtr;
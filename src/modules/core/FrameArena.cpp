@@ -0,0 +1,44 @@
+/**
+ * @file
+ */
+
+#include "FrameArena.h"
+#include "ArenaAllocator.h"
+#include "Assert.h"
+#include "concurrent/Atomic.h"
+
+namespace core {
+
+namespace {
+
+thread_local ArenaAllocator _arena;
+AtomicInt _allocations { 0 };
+AtomicInt _blockAllocations { 0 };
+
+}
+
+void* FrameArena::alloc(size_t size, size_t alignment) {
+	const int blocks = _arena.blockAllocations();
+	void* ptr = _arena.alloc(size, alignment);
+	++_allocations;
+	if (blocks != _arena.blockAllocations()) {
+		++_blockAllocations;
+	}
+	return ptr;
+}
+
+void FrameArena::free(void* ptr, size_t size) {
+	_arena.free(ptr, size);
+}
+
+FrameArena::Stats FrameArena::endFrame() {
+	// rewinding the arena while allocations are alive would hand out their memory again
+	core_assert_msg(_arena.live() == 0, "%i frame arena allocations are still alive at the end of the frame", _arena.live());
+	_arena.reset();
+	Stats stats;
+	stats.allocations = _allocations.exchange(0);
+	stats.blockAllocations = _blockAllocations.exchange(0);
+	return stats;
+}
+
+}
@@ -0,0 +1,79 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+#include <new>
+
+namespace core {
+
+/**
+ * @brief Thread local arenas for temporaries that don't survive the current frame (e.g. a server tick).
+ *
+ * Every thread gets its own @c ArenaAllocator - so allocating doesn't need any locking. An arena
+ * is rewound as soon as all of its allocations were handed back and at the latest when
+ * @c endFrame() is called on the owning thread.
+ *
+ * @note Memory from the frame arena must be freed on the thread that allocated it and must not
+ * be kept beyond the end of the frame.
+ * @see FrameAllocator
+ */
+class FrameArena {
+public:
+	struct Stats {
+		// allocations that were served by the frame arenas
+		int allocations = 0;
+		// allocations that needed a new block from the heap
+		int blockAllocations = 0;
+	};
+
+	static void* alloc(size_t size, size_t alignment);
+	static void free(void* ptr, size_t size);
+
+	/**
+	 * @brief Rewinds the arena of the calling thread
+	 * @note All allocations of the calling thread must have been freed before
+	 * @return The statistics of all frame arenas since the last call
+	 */
+	static Stats endFrame();
+};
+
+/**
+ * @brief STL compatible allocator adapter for the @c FrameArena
+ */
+template<class T>
+class FrameAllocator {
+public:
+	using value_type = T;
+
+	FrameAllocator() noexcept = default;
+	template<class U>
+	FrameAllocator(const FrameAllocator<U>&) noexcept {
+	}
+
+	T* allocate(size_t n) {
+		return (T*)FrameArena::alloc(n * sizeof(T), alignof(T));
+	}
+
+	void deallocate(T* ptr, size_t n) noexcept {
+		FrameArena::free(ptr, n * sizeof(T));
+	}
+
+	template<class U>
+	bool operator==(const FrameAllocator<U>&) const noexcept {
+		return true;
+	}
+
+	template<class U>
+	bool operator!=(const FrameAllocator<U>&) const noexcept {
+		return false;
+	}
+};
+
+template<class T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+}
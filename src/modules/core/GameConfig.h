@@ -52,6 +52,16 @@ constexpr const char *ServerPostgresLib = "sv_postgreslib";
 constexpr const char *ServerHttpPort = "sv_httpport";
 // the download urls for the chunks
 constexpr const char *ServerChunkBaseUrl = "sv_httpchunkurl";
+// the memory in megabytes for the uncompressed chunks of a map volume
+constexpr const char *ServerVolumeMemory = "sv_volumememory";
+// the memory in megabytes for the compressed in-memory chunks of a map volume - 0 disables the compressed tier
+constexpr const char *ServerVolumeCompressedMemory = "sv_volumecompressedmemory";
+// the amount of worker threads that generate the chunks of a map volume
+constexpr const char *ServerChunkGeneratorThreads = "sv_chunkgeneratorthreads";
+// the radius in chunks around the players that is generated ahead
+constexpr const char *ServerChunkPrefetchRadius = "sv_chunkprefetchradius";
+// the max amount of state updates per second that are sent to the connected ai debuggers - 0 sends them every tick
+constexpr const char *ServerAIDebugStateRate = "sv_aidebugstaterate";
 
 constexpr const char *ConsoleCurses = "con_curses";
 
@@ -75,5 +85,6 @@ constexpr const char *AppBasePath = "app_basepath";
 constexpr const char *MetricPort = "metric_port";
 constexpr const char *MetricHost = "metric_host";
 constexpr const char *MetricFlavor = "metric_flavor";
+constexpr const char *MetricFlushInterval = "metric_flushinterval";
 
 }
@@ -0,0 +1,211 @@
+/**
+ * @file
+ */
+
+#include "TimingWheel.h"
+#include "Assert.h"
+
+namespace core {
+
+TimingWheel::TimingWheel(uint64_t resolutionMillis) :
+		_resolutionMillis(resolutionMillis > 0u ? resolutionMillis : 1u) {
+	for (uint32_t i = 0u; i < RootSlots; ++i) {
+		_root[i] = -1;
+	}
+	for (int l = 0; l < Levels - 1; ++l) {
+		for (uint32_t i = 0u; i < LevelSlots; ++i) {
+			_levels[l][i] = -1;
+		}
+	}
+	for (int l = 0; l < Levels; ++l) {
+		_counts[l] = 0u;
+	}
+}
+
+void TimingWheel::link(int32_t idx) {
+	Timer& timer = _timers[idx];
+	const uint64_t delta = timer.expireTick - _currentTick;
+	int32_t* head;
+	if (delta < RootSlots) {
+		head = &_root[timer.expireTick & (RootSlots - 1u)];
+		timer.level = 0;
+	} else {
+		head = nullptr;
+		for (int l = 0; l < Levels - 1; ++l) {
+			const int shift = RootBits + (l + 1) * LevelBits;
+			if (l == Levels - 2 || delta < (uint64_t(1u) << shift)) {
+				uint64_t tick = timer.expireTick;
+				if (delta >= (uint64_t(1u) << shift)) {
+					// out of range - park it in the last slot that is in range, it's cascaded again from there
+					tick = _currentTick + (uint64_t(1u) << shift) - 1u;
+				}
+				head = &_levels[l][(tick >> (RootBits + l * LevelBits)) & (LevelSlots - 1u)];
+				timer.level = l + 1;
+				break;
+			}
+		}
+	}
+	++_counts[timer.level];
+	timer.head = head;
+	timer.prev = -1;
+	timer.next = *head;
+	if (*head != -1) {
+		_timers[*head].prev = idx;
+	}
+	*head = idx;
+}
+
+void TimingWheel::unlink(int32_t idx) {
+	Timer& timer = _timers[idx];
+	--_counts[timer.level];
+	if (timer.prev != -1) {
+		_timers[timer.prev].next = timer.next;
+	} else {
+		*timer.head = timer.next;
+	}
+	if (timer.next != -1) {
+		_timers[timer.next].prev = timer.prev;
+	}
+	timer.prev = -1;
+	timer.next = -1;
+	timer.head = nullptr;
+}
+
+void TimingWheel::release(int32_t idx) {
+	Timer& timer = _timers[idx];
+	timer.callback = Callback();
+	// invalidates all handles that are still around
+	++timer.generation;
+	_freeTimers.push_back(idx);
+	--_active;
+}
+
+TimerId TimingWheel::schedule(uint64_t expireMillis, const Callback& callback) {
+	core::ScopedLock lock(_lock);
+	// round up - a timer must never fire before its expire time
+	uint64_t expireTick = (expireMillis + _resolutionMillis - 1u) / _resolutionMillis;
+	if (expireTick <= _currentTick) {
+		expireTick = _currentTick + 1u;
+	}
+	int32_t idx;
+	if (_freeTimers.empty()) {
+		idx = (int32_t)_timers.size();
+		_timers.emplace_back();
+	} else {
+		idx = _freeTimers.back();
+		_freeTimers.pop_back();
+	}
+	Timer& timer = _timers[idx];
+	timer.callback = callback;
+	timer.expireTick = expireTick;
+	link(idx);
+	++_active;
+	return ((TimerId)timer.generation << 32) | (TimerId)(idx + 1);
+}
+
+bool TimingWheel::cancel(TimerId id) {
+	if (id == InvalidTimer) {
+		return false;
+	}
+	const int32_t idx = (int32_t)(id & 0xFFFFFFFFu) - 1;
+	const uint32_t generation = (uint32_t)(id >> 32);
+	core::ScopedLock lock(_lock);
+	if (idx < 0 || idx >= (int32_t)_timers.size()) {
+		return false;
+	}
+	Timer& timer = _timers[idx];
+	if (timer.generation != generation || timer.head == nullptr) {
+		return false;
+	}
+	unlink(idx);
+	release(idx);
+	return true;
+}
+
+void TimingWheel::cascade(int level) {
+	int32_t* head = &_levels[level][(_currentTick >> (RootBits + level * LevelBits)) & (LevelSlots - 1u)];
+	int32_t idx = *head;
+	*head = -1;
+	while (idx != -1) {
+		const int32_t next = _timers[idx].next;
+		--_counts[level + 1];
+		link(idx);
+		idx = next;
+	}
+}
+
+void TimingWheel::advance() {
+	++_currentTick;
+	// move the timers of the coarser wheels down once the finer wheel wrapped
+	if ((_currentTick & (RootSlots - 1u)) == 0u) {
+		for (int l = 0; l < Levels - 1; ++l) {
+			cascade(l);
+			if (((_currentTick >> (RootBits + l * LevelBits)) & (LevelSlots - 1u)) != 0u) {
+				break;
+			}
+		}
+	}
+	int32_t* head = &_root[_currentTick & (RootSlots - 1u)];
+	int32_t idx = *head;
+	*head = -1;
+	while (idx != -1) {
+		Timer& timer = _timers[idx];
+		const int32_t next = timer.next;
+		--_counts[0];
+		if (timer.expireTick > _currentTick) {
+			// parked out of range timer
+			link(idx);
+		} else {
+			timer.head = nullptr;
+			_expired.emplace_back(std::move(timer.callback));
+			release(idx);
+		}
+		idx = next;
+	}
+}
+
+int TimingWheel::update(uint64_t nowMillis) {
+	std::vector<Callback> expired;
+	{
+		core::ScopedLock lock(_lock);
+		const uint64_t targetTick = nowMillis / _resolutionMillis;
+		if (targetTick <= _currentTick) {
+			return 0;
+		}
+		if (_active == 0u) {
+			// nothing is waiting - skip the idle ticks
+			_currentTick = targetTick;
+			return 0;
+		}
+		while (_currentTick < targetTick && _active > 0u) {
+			// nothing can expire before the next cascade of the first wheel that holds timers - skip the ticks in between
+			int shift = 0;
+			for (int l = 0; l < Levels && _counts[l] == 0u; ++l) {
+				shift = RootBits + l * LevelBits;
+			}
+			if (shift > 0) {
+				const uint64_t boundary = ((_currentTick >> shift) + 1u) << shift;
+				_currentTick = (boundary < targetTick ? boundary : targetTick) - 1u;
+			}
+			advance();
+		}
+		_currentTick = targetTick;
+		// hand the batch over - the callbacks might update the wheel again
+		expired.swap(_expired);
+	}
+	for (const Callback& callback : expired) {
+		callback();
+	}
+	const int n = (int)expired.size();
+	expired.clear();
+	{
+		core::ScopedLock lock(_lock);
+		if (_expired.empty()) {
+			// keep the capacity for the next batch
+			_expired.swap(expired);
+		}
+	}
+	return n;
+}
+
+}
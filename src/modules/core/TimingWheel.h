@@ -0,0 +1,112 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "NonCopyable.h"
+#include "concurrent/Lock.h"
+#include <stdint.h>
+#include <functional>
+#include <vector>
+
+namespace core {
+
+/**
+ * @brief Handle of a timer that was scheduled in a @c TimingWheel. @c TimingWheel::InvalidTimer is never handed out.
+ */
+typedef uint64_t TimerId;
+
+/**
+ * @brief Hierarchical timing wheel for a lot of timers with millisecond resolution.
+ *
+ * Scheduling and canceling a timer is O(1) - the timers are kept in intrusive lists of the wheel slots.
+ * Timers that are too far in the future for the first wheel are kept in coarser wheels and cascaded down
+ * once they come into range. @c update() only advances over the elapsed ticks, so the costs don't depend
+ * on the amount of timers that are waiting, but only on the amount of timers that expire.
+ *
+ * The callbacks of all timers that expired in one @c update() call are executed as one batch after
+ * the internal lock was released - so they are allowed to schedule or cancel timers.
+ *
+ * @note This is thread safe
+ */
+class TimingWheel : public NonCopyable {
+public:
+	using Callback = std::function<void()>;
+	static constexpr TimerId InvalidTimer = 0u;
+private:
+	static constexpr int Levels = 4;
+	// the first wheel has the highest resolution
+	static constexpr int RootBits = 8;
+	static constexpr int LevelBits = 6;
+	static constexpr uint32_t RootSlots = 1u << RootBits;
+	static constexpr uint32_t LevelSlots = 1u << LevelBits;
+
+	struct Timer {
+		Callback callback;
+		uint64_t expireTick = 0u;
+		uint32_t generation = 0u;
+		int32_t prev = -1;
+		int32_t next = -1;
+		int32_t* head = nullptr;
+		// 0 is the first wheel
+		int level = 0;
+	};
+
+	const uint64_t _resolutionMillis;
+	// the wheel starts at time 0 - it doesn't guess the time from the first timer
+	uint64_t _currentTick = 0u;
+	size_t _active = 0u;
+	std::vector<Timer> _timers;
+	std::vector<int32_t> _freeTimers;
+	int32_t _root[RootSlots];
+	int32_t _levels[Levels - 1][LevelSlots];
+	// the amount of timers per wheel - empty wheels are skipped in update()
+	size_t _counts[Levels];
+	std::vector<Callback> _expired;
+	core::Lock _lock;
+
+	void link(int32_t idx);
+	void unlink(int32_t idx);
+	void release(int32_t idx);
+	void cascade(int level);
+	void advance();
+public:
+	/**
+	 * @param[in] resolutionMillis The duration of one tick of the first wheel. Timers never fire before their
+	 * expire time, but up to one tick late.
+	 */
+	TimingWheel(uint64_t resolutionMillis = 1u);
+
+	/**
+	 * @brief Schedule a callback that is executed in the @c update() call that reaches the given time.
+	 * @note The wheel doesn't know any other time source than @c update() and starts at time @c 0 - timers that
+	 * are scheduled before the first @c update() are measured from there. Timers that already expired are executed
+	 * in the next @c update() call.
+	 * @return The handle to cancel the timer.
+	 */
+	TimerId schedule(uint64_t expireMillis, const Callback& callback);
+
+	/**
+	 * @return @c false if the timer is unknown, was already canceled or its callback was already executed.
+	 */
+	bool cancel(TimerId id);
+
+	/**
+	 * @brief Advances the wheel to the given time and executes the callbacks of all timers that expired.
+	 * @return The amount of executed callbacks
+	 */
+	int update(uint64_t nowMillis);
+
+	/**
+	 * @return The amount of timers that are waiting for their expiration
+	 */
+	size_t size() const;
+};
+
+inline size_t TimingWheel::size() const {
+	core::ScopedLock lock(_lock);
+	return _active;
+}
+
+}
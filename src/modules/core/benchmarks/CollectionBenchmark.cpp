@@ -1,10 +1,107 @@
 #include "core/benchmark/AbstractBenchmark.h"
 #include "core/collection/Map.h"
+#include "core/collection/FlatMap.h"
 #include "core/Assert.h"
 #include <unordered_map>
 #include <map>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
 
 class MapBenchmark: public core::AbstractBenchmark {
+protected:
+	template<class MAP>
+	void insert(MAP& map, benchmark::State& state) {
+		const int64_t n = state.range(0);
+		for (auto _ : state) {
+			map.clear();
+			for (int64_t i = 0; i < n; ++i) {
+				map.put(i, i);
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * n);
+	}
+
+	template<class MAP>
+	void lookup(MAP& map, benchmark::State& state) {
+		const int64_t n = state.range(0);
+		for (int64_t i = 0; i < n; ++i) {
+			map.put(i, i);
+		}
+		for (auto _ : state) {
+			for (int64_t i = 0; i < n; ++i) {
+				int64_t value;
+				if (!map.get(i, value) || value != i) {
+					state.SkipWithError("Failed!");
+					break;
+				}
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * n);
+	}
+
+	/**
+	 * @brief Same as @c insert() but via the interface of the std containers
+	 */
+	template<class MAP>
+	void insertStd(MAP& map, benchmark::State& state) {
+		const int64_t n = state.range(0);
+		for (auto _ : state) {
+			map.clear();
+			for (int64_t i = 0; i < n; ++i) {
+				map[i] = i;
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * n);
+	}
+
+	template<class MAP>
+	void lookupStd(MAP& map, benchmark::State& state) {
+		const int64_t n = state.range(0);
+		for (int64_t i = 0; i < n; ++i) {
+			map[i] = i;
+		}
+		for (auto _ : state) {
+			for (int64_t i = 0; i < n; ++i) {
+				auto iter = map.find(i);
+				if (iter == map.end() || iter->second != i) {
+					state.SkipWithError("Failed!");
+					break;
+				}
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * n);
+	}
+
+	/**
+	 * @brief Chunk positions of a world - the keys of the @c voxel::PagedVolume chunk map
+	 */
+	template<class MAP>
+	void lookupIVec3(MAP& map, benchmark::State& state) {
+		const int n = (int)state.range(0);
+		const int sideLength = (int)glm::sqrt((float)n / 8.0f);
+		int entries = 0;
+		for (int x = 0; x < sideLength; ++x) {
+			for (int y = 0; y < 8; ++y) {
+				for (int z = 0; z < sideLength; ++z) {
+					map.put(glm::ivec3(x, y, z), entries++);
+				}
+			}
+		}
+		for (auto _ : state) {
+			for (int x = 0; x < sideLength; ++x) {
+				for (int y = 0; y < 8; ++y) {
+					for (int z = 0; z < sideLength; ++z) {
+						int value;
+						if (!map.get(glm::ivec3(x, y, z), value)) {
+							state.SkipWithError("Failed!");
+							break;
+						}
+					}
+				}
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * entries);
+	}
 };
 
 BENCHMARK_DEFINE_F(MapBenchmark, compareToMapStd) (benchmark::State& state) {
@@ -53,8 +150,75 @@ BENCHMARK_DEFINE_F(MapBenchmark, compareToMapCore) (benchmark::State& state) {
 	}
 }
 
+BENCHMARK_DEFINE_F(MapBenchmark, compareToFlatMapCore) (benchmark::State& state) {
+	core::FlatMap<int64_t, int64_t, std::hash<int64_t>> map;
+	for (auto _ : state) {
+		const int64_t n = state.range(0);
+		for (int64_t i = 0; i < n; ++i) {
+			map.put(i, i);
+			int64_t value;
+			const bool found = map.get(i, value);
+			if (!found || value != i) {
+				state.SkipWithError("Failed!");
+				break;
+			}
+		}
+	}
+}
+
+BENCHMARK_DEFINE_F(MapBenchmark, insertMapCore) (benchmark::State& state) {
+	core::Map<int64_t, int64_t, 4096, std::hash<int64_t>> map((int)state.range(0));
+	insert(map, state);
+}
+
+BENCHMARK_DEFINE_F(MapBenchmark, insertFlatMapCore) (benchmark::State& state) {
+	core::FlatMap<int64_t, int64_t, std::hash<int64_t>> map;
+	insert(map, state);
+}
+
+BENCHMARK_DEFINE_F(MapBenchmark, insertUnorderedMapStd) (benchmark::State& state) {
+	std::unordered_map<int64_t, int64_t, std::hash<int64_t>> map;
+	insertStd(map, state);
+}
+
+BENCHMARK_DEFINE_F(MapBenchmark, lookupMapCore) (benchmark::State& state) {
+	core::Map<int64_t, int64_t, 4096, std::hash<int64_t>> map((int)state.range(0));
+	lookup(map, state);
+}
+
+BENCHMARK_DEFINE_F(MapBenchmark, lookupFlatMapCore) (benchmark::State& state) {
+	core::FlatMap<int64_t, int64_t, std::hash<int64_t>> map;
+	lookup(map, state);
+}
+
+BENCHMARK_DEFINE_F(MapBenchmark, lookupUnorderedMapStd) (benchmark::State& state) {
+	std::unordered_map<int64_t, int64_t, std::hash<int64_t>> map;
+	lookupStd(map, state);
+}
+
+BENCHMARK_DEFINE_F(MapBenchmark, lookupIVec3MapCore) (benchmark::State& state) {
+	// the bucket size of the chunk map in the PagedVolume before it was replaced
+	core::Map<glm::ivec3, int, 64, std::hash<glm::ivec3>> map((int)state.range(0));
+	lookupIVec3(map, state);
+}
+
+BENCHMARK_DEFINE_F(MapBenchmark, lookupIVec3FlatMapCore) (benchmark::State& state) {
+	core::FlatMap<glm::ivec3, int, std::hash<glm::ivec3>> map;
+	lookupIVec3(map, state);
+}
+
 BENCHMARK_REGISTER_F(MapBenchmark, compareToMapCore)->RangeMultiplier(2)->Range(8, 512);
 BENCHMARK_REGISTER_F(MapBenchmark, compareToMapStd)->RangeMultiplier(2)->Range(8, 512);
 BENCHMARK_REGISTER_F(MapBenchmark, compareToUnorderedMapStd)->RangeMultiplier(2)->Range(8, 512);
+BENCHMARK_REGISTER_F(MapBenchmark, compareToFlatMapCore)->RangeMultiplier(2)->Range(8, 512);
+// the pool allocator of the core::Map can't hold more than 65535 entries
+BENCHMARK_REGISTER_F(MapBenchmark, insertMapCore)->Arg(1000)->Arg(65000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(MapBenchmark, insertFlatMapCore)->Arg(1000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(MapBenchmark, insertUnorderedMapStd)->Arg(1000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(MapBenchmark, lookupMapCore)->Arg(1000)->Arg(65000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(MapBenchmark, lookupFlatMapCore)->Arg(1000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(MapBenchmark, lookupUnorderedMapStd)->Arg(1000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(MapBenchmark, lookupIVec3MapCore)->Arg(1000)->Arg(65000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_REGISTER_F(MapBenchmark, lookupIVec3FlatMapCore)->Arg(1000)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
 
 BENCHMARK_MAIN();
@@ -0,0 +1,74 @@
+/**
+ * @file
+ * @brief Measures the throughput of queued events - one iteration is a frame with a million events
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "core/EventBus.h"
+
+namespace {
+
+EVENTBUSPAYLOADEVENT(BenchmarkEvent, int);
+EVENTBUSPAYLOADEVENT(BenchmarkOtherEvent, int);
+
+class BenchmarkHandler : public core::IEventBusHandler<BenchmarkEvent>, public core::IEventBusHandler<BenchmarkOtherEvent> {
+public:
+	int64_t _sum = 0;
+
+	void onEvent(const BenchmarkEvent& e) override {
+		_sum += e.get();
+	}
+
+	void onEvent(const BenchmarkOtherEvent& e) override {
+		_sum -= e.get();
+	}
+};
+
+}
+
+class EventBusBenchmark: public core::AbstractBenchmark {
+protected:
+	core::EventBus _eventBus;
+	BenchmarkHandler _handler;
+
+	void onCleanupApp() override {
+		_eventBus.unsubscribe<BenchmarkEvent>(_handler);
+		_eventBus.unsubscribe<BenchmarkOtherEvent>(_handler);
+	}
+
+	bool onInitApp() override {
+		_eventBus.subscribe<BenchmarkEvent>(_handler);
+		_eventBus.subscribe<BenchmarkOtherEvent>(_handler);
+		return true;
+	}
+};
+
+BENCHMARK_DEFINE_F(EventBusBenchmark, enqueueAndUpdate) (benchmark::State& state) {
+	const int n = (int)state.range(0);
+	for (auto _ : state) {
+		for (int i = 0; i < n; ++i) {
+			if (i & 1) {
+				_eventBus.enqueue<BenchmarkOtherEvent>(i);
+			} else {
+				_eventBus.enqueue<BenchmarkEvent>(i);
+			}
+		}
+		_eventBus.update();
+	}
+	benchmark::DoNotOptimize(_handler._sum);
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK_DEFINE_F(EventBusBenchmark, publish) (benchmark::State& state) {
+	const int n = (int)state.range(0);
+	for (auto _ : state) {
+		for (int i = 0; i < n; ++i) {
+			_eventBus.publish(BenchmarkEvent(i));
+		}
+	}
+	benchmark::DoNotOptimize(_handler._sum);
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK_REGISTER_F(EventBusBenchmark, enqueueAndUpdate)->Arg(1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(EventBusBenchmark, publish)->Arg(1000000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,72 @@
+/**
+ * @file
+ * @brief Compares the per call overhead of the string based metrics with the aggregated metric handles
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "core/metric/Metric.h"
+#include "core/metric/IMetricSender.h"
+#include "core/GameConfig.h"
+#include "core/Var.h"
+
+namespace {
+
+class NullSender : public metric::IMetricSender {
+public:
+	bool send(const char*) const override {
+		return true;
+	}
+};
+
+}
+
+class MetricBenchmark: public core::AbstractBenchmark {
+protected:
+	metric::Metric _metric;
+
+	void onCleanupApp() override {
+		_metric.shutdown();
+	}
+
+	bool onInitApp() override {
+		core::Var::get(cfg::MetricFlavor, "telegraf");
+		// flush manually - the benchmark should only measure the recording
+		core::Var::get(cfg::MetricFlushInterval, "0");
+		return _metric.init("benchmark", std::make_shared<NullSender>());
+	}
+};
+
+BENCHMARK_DEFINE_F(MetricBenchmark, countString) (benchmark::State& state) {
+	for (auto _ : state) {
+		const metric::TagMap& tags {{"direction", "out"}, {"type", "EntityUpdate"}};
+		_metric.count("network_packet_count", 1, tags);
+		_metric.count("network_packet_size", 64, tags);
+	}
+	state.SetItemsProcessed(state.iterations() * 2);
+}
+
+BENCHMARK_DEFINE_F(MetricBenchmark, countHandle) (benchmark::State& state) {
+	const metric::TagMap& tags {{"direction", "out"}, {"type", "EntityUpdate"}};
+	const metric::MetricHandle packetCount = _metric.registerCounter("network_packet_count", tags);
+	const metric::MetricHandle packetSize = _metric.registerCounter("network_packet_size", tags);
+	for (auto _ : state) {
+		_metric.increment(packetCount);
+		_metric.count(packetSize, 64);
+	}
+	_metric.flush();
+	state.SetItemsProcessed(state.iterations() * 2);
+}
+
+BENCHMARK_DEFINE_F(MetricBenchmark, histogramHandle) (benchmark::State& state) {
+	const metric::MetricHandle handle = _metric.registerHistogram("frame");
+	uint32_t value = 0u;
+	for (auto _ : state) {
+		_metric.histogram(handle, value++ & 31u);
+	}
+	_metric.flush();
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_REGISTER_F(MetricBenchmark, countString);
+BENCHMARK_REGISTER_F(MetricBenchmark, countHandle);
+BENCHMARK_REGISTER_F(MetricBenchmark, histogramHandle);
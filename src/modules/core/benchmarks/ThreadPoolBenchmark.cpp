@@ -0,0 +1,88 @@
+/**
+ * @file
+ * @brief Compares the ThreadPool with the TaskScheduler for the ai::Zone pattern - thousands of tiny tasks per tick
+ * and waiting for all of them.
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "core/concurrent/ThreadPool.h"
+#include "core/concurrent/TaskScheduler.h"
+#include "core/concurrent/Atomic.h"
+#include <vector>
+#include <future>
+
+class ThreadPoolBenchmark: public core::AbstractBenchmark {
+protected:
+	static constexpr int Threads = 4;
+
+	struct Entity {
+		int value = 0;
+	};
+
+	// something that is roughly as cheap as a behaviour tree tick of an idle npc
+	static inline void tick(Entity& entity) {
+		for (int i = 0; i < 16; ++i) {
+			entity.value = entity.value * 31 + i;
+		}
+	}
+};
+
+BENCHMARK_DEFINE_F(ThreadPoolBenchmark, threadPool) (benchmark::State& state) {
+	core::ThreadPool pool(Threads, "benchmark");
+	pool.init();
+	std::vector<Entity> entities(state.range(0));
+	std::vector<std::future<void>> results;
+	results.reserve(entities.size());
+	for (auto _ : state) {
+		for (Entity& e : entities) {
+			results.emplace_back(pool.enqueue([&e] () {
+				tick(e);
+			}));
+		}
+		for (auto& r : results) {
+			r.wait();
+		}
+		results.clear();
+	}
+	pool.shutdown();
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(ThreadPoolBenchmark, taskSchedulerRun) (benchmark::State& state) {
+	core::TaskScheduler scheduler(Threads, "benchmark");
+	scheduler.init();
+	std::vector<Entity> entities(state.range(0));
+	std::vector<std::function<void()>> funcs;
+	funcs.reserve(entities.size());
+	for (Entity& e : entities) {
+		funcs.emplace_back([&e] () {
+			tick(e);
+		});
+	}
+	for (auto _ : state) {
+		core::TaskGroup group;
+		for (auto& f : funcs) {
+			scheduler.run(group, f);
+		}
+		scheduler.wait(group);
+	}
+	scheduler.shutdown();
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(ThreadPoolBenchmark, taskSchedulerParallelFor) (benchmark::State& state) {
+	core::TaskScheduler scheduler(Threads, "benchmark");
+	scheduler.init();
+	std::vector<Entity> entities(state.range(0));
+	for (auto _ : state) {
+		scheduler.parallelFor(0u, entities.size(), [&entities] (size_t i) {
+			tick(entities[i]);
+		}, 32u);
+	}
+	scheduler.shutdown();
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_REGISTER_F(ThreadPoolBenchmark, threadPool)->RangeMultiplier(4)->Range(256, 4096)->UseRealTime();
+BENCHMARK_REGISTER_F(ThreadPoolBenchmark, taskSchedulerRun)->RangeMultiplier(4)->Range(256, 4096)->UseRealTime();
+BENCHMARK_REGISTER_F(ThreadPoolBenchmark, taskSchedulerParallelFor)->RangeMultiplier(4)->Range(256, 4096)->UseRealTime();
@@ -22,6 +22,14 @@ struct Less {
 	}
 };
 
+/**
+ * @brief Priority queue that is guarded by one mutex. The comparator can be changed at any time - the heap is
+ * only rebuilt once on the next access, no matter how often the comparator was changed in between.
+ *
+ * @note If you don't need a priority, use the lock-free @c ConcurrentRingQueue.
+ *
+ * @ingroup Collections
+ */
 template<class Data, class Comparator = Less<Data>>
 class ConcurrentQueue {
 private:
@@ -31,6 +39,23 @@ private:
 	core::ConditionVariable _conditionVariable;
 	core::AtomicBool _abort { false };
 	Comparator _comparator;
+	// the comparator was changed and the heap must be rebuilt
+	bool _dirty = false;
+
+	inline void rebuildIfDirty() {
+		if (!_dirty) {
+			return;
+		}
+		std::make_heap(_data.begin(), _data.end(), _comparator);
+		_dirty = false;
+	}
+
+	inline void popFront(Data& poppedValue) {
+		rebuildIfDirty();
+		std::pop_heap(_data.begin(), _data.end(), _comparator);
+		poppedValue = core::move(_data.back());
+		_data.pop_back();
+	}
 public:
 	using Key = Data;
 
@@ -44,13 +69,17 @@ public:
 		abortWait();
 	}
 
+	/**
+	 * @brief Re-keys the queue - the heap is rebuilt lazily on the next access
+	 */
 	void setComparator(Comparator comparator) {
 		core::ScopedLock lock(_mutex);
 		_comparator = comparator;
-		std::make_heap(const_cast<Data*>(&_data.front()), const_cast<Data*>(&_data.front()) + _data.size(), _comparator);
+		_dirty = true;
 	}
 
 	void abortWait() {
+		core::ScopedLock lock(_mutex);
 		_abort = true;
 		_conditionVariable.signalAll();
 	}
@@ -62,15 +91,17 @@ public:
 	void clear() {
 		core::ScopedLock lock(_mutex);
 		_data = Collection();
+		_dirty = false;
 	}
 
 	void sort() {
 		core::ScopedLock lock(_mutex);
-		std::make_heap(const_cast<Data*>(&_data.front()), const_cast<Data*>(&_data.front()) + _data.size(), _comparator);
+		_dirty = true;
 	}
 
 	void push(Data const& data) {
 		core::ScopedLock lock(_mutex);
+		rebuildIfDirty();
 		_data.push_back(data);
 		std::push_heap(_data.begin(), _data.end(), _comparator);
 		_conditionVariable.signalOne();
@@ -78,6 +109,7 @@ public:
 
 	void push(Data&& data) {
 		core::ScopedLock lock(_mutex);
+		rebuildIfDirty();
 		_data.push_back(core::move(data));
 		std::push_heap(_data.begin(), _data.end(), _comparator);
 		_conditionVariable.signalOne();
@@ -86,6 +118,7 @@ public:
 	template<typename ... _Args>
 	void emplace(_Args&&... __args) {
 		core::ScopedLock lock(_mutex);
+		rebuildIfDirty();
 		_data.emplace_back(core::forward<_Args>(__args)...);
 		std::push_heap(_data.begin(), _data.end(), _comparator);
 		_conditionVariable.signalOne();
@@ -106,26 +139,24 @@ public:
 		if (_data.empty()) {
 			return false;
 		}
-
-		poppedValue = core::move(_data.front());
-		std::pop_heap(_data.begin(), _data.end(), _comparator);
-		_data.pop_back();
+		popFront(poppedValue);
 		return true;
 	}
 
 	bool waitAndPop(Data& poppedValue) {
 		core::ScopedLock lock(_mutex);
-		if (_data.empty()) {
+		while (_data.empty() && !_abort) {
 			_conditionVariable.wait(_mutex);
 		}
 		if (_abort) {
 			return false;
 		}
-		poppedValue = core::move(_data.front());
-		std::pop_heap(_data.begin(), _data.end(), _comparator);
-		_data.pop_back();
+		popFront(poppedValue);
 		return true;
 	}
 };
 
+template<class Data, class Comparator = Less<Data>>
+using ConcurrentPriorityQueue = ConcurrentQueue<Data, Comparator>;
+
 }
@@ -0,0 +1,268 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/NonCopyable.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <new>
+
+namespace core {
+
+/**
+ * @brief Bounded lock-free multi producer multi consumer fifo queue.
+ *
+ * The elements are stored in a ring buffer. Every slot has a sequence number that tells the producers and
+ * consumers whether the slot is free for the current round - so @c push() and @c pop() only need one
+ * compare and swap on the shared positions. The mutex is only touched if a thread has to block in
+ * @c waitAndPop() or @c waitAndPush().
+ *
+ * Use this for work queues that don't need a priority - see @c ConcurrentPriorityQueue for the other ones.
+ *
+ * @ingroup Collections
+ */
+template<class Data>
+class ConcurrentRingQueue : public core::NonCopyable {
+private:
+	static constexpr size_t CacheLineSize = 64u;
+
+	struct Cell {
+		std::atomic<size_t> sequence;
+		alignas(Data) uint8_t storage[sizeof(Data)];
+
+		inline Data* data() {
+			return (Data*)storage;
+		}
+	};
+
+	Cell* _buffer;
+	const size_t _mask;
+	alignas(CacheLineSize) std::atomic<size_t> _enqueuePos { 0u };
+	alignas(CacheLineSize) std::atomic<size_t> _dequeuePos { 0u };
+	alignas(CacheLineSize) std::atomic<int> _popWaiters { 0 };
+	std::atomic<int> _pushWaiters { 0 };
+	core::Lock _mutex;
+	core::ConditionVariable _notEmpty;
+	core::ConditionVariable _notFull;
+	core::AtomicBool _abort { false };
+
+	static size_t roundCapacity(size_t capacity) {
+		size_t size = 2u;
+		while (size < capacity) {
+			size <<= 1u;
+		}
+		return size;
+	}
+
+	template<class T>
+	bool tryPushInternal(T&& data, bool locked = false) {
+		size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+		for (;;) {
+			Cell* cell = &_buffer[pos & _mask];
+			const size_t seq = cell->sequence.load(std::memory_order_acquire);
+			const intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+			if (diff == 0) {
+				if (_enqueuePos.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed)) {
+					new (cell->storage) Data(core::forward<T>(data));
+					cell->sequence.store(pos + 1u, std::memory_order_release);
+					notify(_popWaiters, _notEmpty, locked);
+					return true;
+				}
+			} else if (diff < 0) {
+				// full
+				return false;
+			} else {
+				pos = _enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	template<class T>
+	bool waitAndPushInternal(T&& data) {
+		if (tryPushInternal(core::forward<T>(data))) {
+			return true;
+		}
+		core::ScopedLock lock(_mutex);
+		++_pushWaiters;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		while (!_abort) {
+			// the data is only moved if the push succeeded
+			if (tryPushInternal(core::forward<T>(data), true)) {
+				--_pushWaiters;
+				return true;
+			}
+			_notFull.wait(_mutex);
+		}
+		--_pushWaiters;
+		return false;
+	}
+
+	template<class FUNC>
+	bool popInternal(FUNC&& func, bool locked = false) {
+		size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+		for (;;) {
+			Cell* cell = &_buffer[pos & _mask];
+			const size_t seq = cell->sequence.load(std::memory_order_acquire);
+			const intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1u);
+			if (diff == 0) {
+				if (_dequeuePos.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed)) {
+					Data* data = cell->data();
+					func(*data);
+					data->~Data();
+					// the slot is free for the next round of the producers
+					cell->sequence.store(pos + _mask + 1u, std::memory_order_release);
+					notify(_pushWaiters, _notFull, locked);
+					return true;
+				}
+			} else if (diff < 0) {
+				// empty
+				return false;
+			} else {
+				pos = _dequeuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/**
+	 * @brief Wakes up one of the waiting threads - the lock is needed to not signal between the check and
+	 * the wait call of the waiting thread.
+	 * @param[in] locked @c true if the caller already holds the lock
+	 */
+	inline void notify(std::atomic<int>& waiters, core::ConditionVariable& condition, bool locked) {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (waiters.load(std::memory_order_relaxed) <= 0) {
+			return;
+		}
+		if (locked) {
+			condition.signalOne();
+			return;
+		}
+		core::ScopedLock lock(_mutex);
+		condition.signalOne();
+	}
+
+	inline bool popValue(Data& poppedValue, bool locked) {
+		return popInternal([&poppedValue] (Data& data) {
+			poppedValue = core::move(data);
+		}, locked);
+	}
+
+public:
+	/**
+	 * @param[in] capacity The max amount of elements in the queue - rounded up to the next power of two
+	 */
+	ConcurrentRingQueue(size_t capacity = 1024u) :
+			_mask(roundCapacity(capacity) - 1u) {
+		_buffer = new Cell[_mask + 1u];
+		for (size_t i = 0u; i <= _mask; ++i) {
+			_buffer[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	~ConcurrentRingQueue() {
+		abortWait();
+		clear();
+		delete[] _buffer;
+	}
+
+	inline size_t capacity() const {
+		return _mask + 1u;
+	}
+
+	/**
+	 * @brief Wakes up all blocking threads and let them return @c false
+	 */
+	void abortWait() {
+		core::ScopedLock lock(_mutex);
+		_abort = true;
+		_notEmpty.signalAll();
+		_notFull.signalAll();
+	}
+
+	void reset() {
+		_abort = false;
+	}
+
+	void clear() {
+		while (popInternal([] (Data&) {})) {
+		}
+	}
+
+	/**
+	 * @return @c false if the queue is full
+	 */
+	inline bool push(const Data& data) {
+		return tryPushInternal(data);
+	}
+
+	/**
+	 * @return @c false if the queue is full - @c data is not moved in this case
+	 */
+	inline bool push(Data&& data) {
+		return tryPushInternal(core::move(data));
+	}
+
+	/**
+	 * @brief Blocks until there is space in the queue
+	 * @return @c false if @c abortWait() was called
+	 */
+	inline bool waitAndPush(const Data& data) {
+		return waitAndPushInternal(data);
+	}
+
+	inline bool waitAndPush(Data&& data) {
+		return waitAndPushInternal(core::move(data));
+	}
+
+	inline bool pop(Data& poppedValue) {
+		return popValue(poppedValue, false);
+	}
+
+	/**
+	 * @brief Blocks until there is an element in the queue
+	 * @return @c false if @c abortWait() was called
+	 */
+	bool waitAndPop(Data& poppedValue) {
+		if (pop(poppedValue)) {
+			return true;
+		}
+		core::ScopedLock lock(_mutex);
+		++_popWaiters;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		while (!_abort) {
+			if (popValue(poppedValue, true)) {
+				--_popWaiters;
+				return true;
+			}
+			_notEmpty.wait(_mutex);
+		}
+		--_popWaiters;
+		return false;
+	}
+
+	/**
+	 * @note This is only a snapshot - other threads might have changed the queue already
+	 */
+	inline uint32_t size() const {
+		const size_t enqueuePos = _enqueuePos.load(std::memory_order_acquire);
+		const size_t dequeuePos = _dequeuePos.load(std::memory_order_acquire);
+		if (enqueuePos <= dequeuePos) {
+			return 0u;
+		}
+		return (uint32_t)(enqueuePos - dequeuePos);
+	}
+
+	inline bool empty() const {
+		return size() == 0u;
+	}
+};
+
+}
@@ -0,0 +1,389 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/collection/Map.h"
+#include "core/Assert.h"
+#include "core/Common.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <utility>
+#include <initializer_list>
+
+namespace core {
+
+/**
+ * @brief Hash map with open addressing (robin hood hashing with linear probing) that grows with its load factor.
+ *
+ * The entries are stored in one flat array - a lookup only touches a few neighbouring slots instead of walking
+ * a linked list of pool allocated nodes. The interface is the same as the one of @c core::Map. The hash value
+ * is mixed before it is used, so weak hashers like @c priv::DefaultHasher or @c std::hash<glm::ivec3> are fine.
+ *
+ * @note Inserting and removing entries invalidates the iterators and the pointers to the entries.
+ *
+ * @ingroup Collections
+ */
+template<typename KEYTYPE, typename VALUETYPE, typename HASHER = priv::DefaultHasher, typename COMPARE = priv::EqualCompare>
+class FlatMap {
+public:
+	struct KeyValue {
+		inline KeyValue(const KEYTYPE& _key, const VALUETYPE& _value) :
+				key(_key), value(_value), first(key), second(value) {
+		}
+
+		inline KeyValue(const KEYTYPE& _key, VALUETYPE&& _value) :
+				key(_key), value(std::move(_value)), first(key), second(value) {
+		}
+
+		inline KeyValue(KeyValue &&other) :
+				key(std::move(other.key)), value(std::move(other.value)), first(key), second(value) {
+		}
+
+		KEYTYPE key;
+		VALUETYPE value;
+		const KEYTYPE &first;
+		const VALUETYPE &second;
+	};
+private:
+	static constexpr size_t MinCapacity = 16u;
+	// the probe distance is stored in one byte - the map grows before it's exceeded
+	static constexpr uint8_t MaxDistance = 0xFFu;
+
+	// the probe distance + 1 of the entry in the slot - 0 means the slot is empty
+	uint8_t* _distances = nullptr;
+	KeyValue* _slots = nullptr;
+	size_t _capacity = 0u;
+	size_t _size = 0u;
+	int _shift = 64;
+	HASHER _hasher;
+
+	inline size_t index(const KEYTYPE& key) const {
+		// fibonacci hashing - the upper bits of the product are used as index
+		const uint64_t hashValue = (uint64_t)_hasher(key) * UINT64_C(0x9E3779B97F4A7C15);
+		return (size_t)(hashValue >> _shift);
+	}
+
+	inline size_t next(size_t idx) const {
+		return (idx + 1u) & (_capacity - 1u);
+	}
+
+	size_t findIndex(const KEYTYPE& key) const {
+		if (_size == 0u) {
+			return _capacity;
+		}
+		size_t idx = index(key);
+		for (uint32_t distance = 1u;; ++distance) {
+			const uint8_t slotDistance = _distances[idx];
+			// robin hood invariant: the key would have displaced this entry
+			if (slotDistance < distance) {
+				return _capacity;
+			}
+			if (slotDistance == distance && COMPARE()(_slots[idx].key, key)) {
+				return idx;
+			}
+			idx = next(idx);
+		}
+	}
+
+	inline bool needsGrow() const {
+		// max load factor of 0.8
+		return (_size + 1u) * 5u > _capacity * 4u;
+	}
+
+	void rehash(size_t capacity) {
+		uint8_t* oldDistances = _distances;
+		KeyValue* oldSlots = _slots;
+		const size_t oldCapacity = _capacity;
+
+		_capacity = capacity;
+		_shift = 64;
+		for (size_t c = capacity; c > 1u; c >>= 1u) {
+			--_shift;
+		}
+		_distances = (uint8_t*)core_malloc(_capacity);
+		_slots = (KeyValue*)core_malloc(_capacity * sizeof(KeyValue));
+		core_memset(_distances, 0, _capacity);
+		_size = 0u;
+
+		for (size_t i = 0u; i < oldCapacity; ++i) {
+			if (oldDistances[i] == 0u) {
+				continue;
+			}
+			insertNew(std::move(oldSlots[i]));
+			oldSlots[i].~KeyValue();
+		}
+		core_free(oldDistances);
+		core_free(oldSlots);
+	}
+
+	void grow() {
+		rehash(_capacity == 0u ? MinCapacity : _capacity * 2u);
+	}
+
+	/**
+	 * @brief Inserts an entry whose key is not yet part of the map
+	 */
+	void insertNew(KeyValue&& entry) {
+		if (needsGrow()) {
+			grow();
+		}
+		KeyValue carry(std::move(entry));
+		size_t idx = index(carry.key);
+		uint8_t distance = 1u;
+		for (;;) {
+			if (_distances[idx] == 0u) {
+				new (&_slots[idx]) KeyValue(std::move(carry));
+				_distances[idx] = distance;
+				++_size;
+				return;
+			}
+			if (_distances[idx] < distance) {
+				// take the slot of the entry that is closer to its home slot and carry that one further
+				std::swap(_slots[idx].key, carry.key);
+				std::swap(_slots[idx].value, carry.value);
+				std::swap(_distances[idx], distance);
+			}
+			idx = next(idx);
+			if (++distance == MaxDistance) {
+				// the probe sequence got too long - grow and insert the carried entry again
+				rehash(_capacity * 2u);
+				insertNew(std::move(carry));
+				return;
+			}
+		}
+	}
+
+	void eraseIndex(size_t idx) {
+		_slots[idx].~KeyValue();
+		// backward shift deletion - no tombstones are needed
+		size_t nextIdx = next(idx);
+		while (_distances[nextIdx] > 1u) {
+			new (&_slots[idx]) KeyValue(std::move(_slots[nextIdx]));
+			_slots[nextIdx].~KeyValue();
+			_distances[idx] = _distances[nextIdx] - 1u;
+			idx = nextIdx;
+			nextIdx = next(nextIdx);
+		}
+		_distances[idx] = 0u;
+		--_size;
+	}
+
+	void release() {
+		clear();
+		core_free(_distances);
+		core_free(_slots);
+		_distances = nullptr;
+		_slots = nullptr;
+		_capacity = 0u;
+		_shift = 64;
+	}
+
+public:
+	FlatMap(std::initializer_list<KeyValue> other, int initialCapacity = 0) {
+		reserve((size_t)initialCapacity);
+		for (auto i = other.begin(); i != other.end(); ++i) {
+			put(i->key, i->value);
+		}
+	}
+	/**
+	 * @param[in] initialCapacity The amount of entries that can be put into the map before it has to grow
+	 */
+	FlatMap(int initialCapacity = 0) {
+		reserve((size_t)initialCapacity);
+	}
+	FlatMap(const FlatMap& other) {
+		reserve(other.size());
+		for (auto i = other.begin(); i != other.end(); ++i) {
+			put(i->key, i->value);
+		}
+	}
+	FlatMap(FlatMap&& other) noexcept :
+			_distances(other._distances), _slots(other._slots), _capacity(other._capacity), _size(other._size), _shift(other._shift) {
+		other._distances = nullptr;
+		other._slots = nullptr;
+		other._capacity = 0u;
+		other._size = 0u;
+		other._shift = 64;
+	}
+	~FlatMap() {
+		release();
+	}
+
+	FlatMap& operator=(const FlatMap& other) {
+		if (&other == this) {
+			return *this;
+		}
+		clear();
+		reserve(other.size());
+		for (auto i = other.begin(); i != other.end(); ++i) {
+			put(i->key, i->value);
+		}
+		return *this;
+	}
+
+	FlatMap& operator=(FlatMap&& other) noexcept {
+		if (&other == this) {
+			return *this;
+		}
+		release();
+		std::swap(_distances, other._distances);
+		std::swap(_slots, other._slots);
+		std::swap(_capacity, other._capacity);
+		std::swap(_size, other._size);
+		std::swap(_shift, other._shift);
+		return *this;
+	}
+
+	class iterator {
+	private:
+		friend class FlatMap;
+		const FlatMap* _map;
+		size_t _idx;
+	public:
+		constexpr iterator() :
+			_map(nullptr), _idx(0u) {
+		}
+
+		iterator(const FlatMap* map, size_t idx) :
+				_map(map), _idx(idx) {
+		}
+
+		inline KeyValue* operator*() const {
+			return &_map->_slots[_idx];
+		}
+
+		iterator& operator++() {
+			for (++_idx; _idx < _map->_capacity; ++_idx) {
+				if (_map->_distances[_idx] != 0u) {
+					return *this;
+				}
+			}
+			// the end iterator
+			_map = nullptr;
+			_idx = 0u;
+			return *this;
+		}
+
+		inline KeyValue* operator->() const {
+			return &_map->_slots[_idx];
+		}
+
+		inline bool operator!=(const iterator& rhs) const {
+			return _map != rhs._map || _idx != rhs._idx;
+		}
+
+		inline bool operator==(const iterator& rhs) const {
+			return _map == rhs._map && _idx == rhs._idx;
+		}
+	};
+
+	inline size_t size() const {
+		return _size;
+	}
+
+	inline bool empty() const {
+		return _size == 0u;
+	}
+
+	/**
+	 * @return The amount of slots - the map grows before all of them are used
+	 */
+	inline size_t capacity() const {
+		return _capacity;
+	}
+
+	/**
+	 * @brief Makes sure that the given amount of entries fits into the map without growing it
+	 */
+	void reserve(size_t entries) {
+		if (entries == 0u) {
+			return;
+		}
+		size_t capacity = MinCapacity;
+		while (entries * 5u >= capacity * 4u) {
+			capacity *= 2u;
+		}
+		if (capacity > _capacity) {
+			rehash(capacity);
+		}
+	}
+
+	bool get(const KEYTYPE& key, VALUETYPE& value) const {
+		const size_t idx = findIndex(key);
+		if (idx == _capacity) {
+			return false;
+		}
+		value = _slots[idx].value;
+		return true;
+	}
+
+	iterator find(const KEYTYPE& key) const {
+		const size_t idx = findIndex(key);
+		if (idx == _capacity) {
+			return end();
+		}
+		return iterator(this, idx);
+	}
+
+	void emplace(const KEYTYPE& key, VALUETYPE&& value) {
+		const size_t idx = findIndex(key);
+		if (idx != _capacity) {
+			_slots[idx].value = std::move(value);
+			return;
+		}
+		insertNew(KeyValue(key, std::move(value)));
+	}
+
+	void put(const KEYTYPE& key, const VALUETYPE& value) {
+		const size_t idx = findIndex(key);
+		if (idx != _capacity) {
+			_slots[idx].value = value;
+			return;
+		}
+		insertNew(KeyValue(key, value));
+	}
+
+	iterator begin() const {
+		for (size_t i = 0u; i < _capacity; ++i) {
+			if (_distances[i] != 0u) {
+				return iterator(this, i);
+			}
+		}
+		return end();
+	}
+
+	constexpr iterator end() const {
+		return iterator();
+	}
+
+	void clear() {
+		if (_size == 0u) {
+			return;
+		}
+		for (size_t i = 0u; i < _capacity; ++i) {
+			if (_distances[i] != 0u) {
+				_slots[i].~KeyValue();
+				_distances[i] = 0u;
+			}
+		}
+		_size = 0u;
+	}
+
+	inline void erase(const iterator& iter) {
+		eraseIndex(iter._idx);
+	}
+
+	bool remove(const KEYTYPE& key) {
+		const size_t idx = findIndex(key);
+		if (idx == _capacity) {
+			return false;
+		}
+		eraseIndex(idx);
+		return true;
+	}
+};
+
+}
@@ -0,0 +1,208 @@
+/**
+ * @file
+ */
+
+#include "TaskScheduler.h"
+#include "core/concurrent/Concurrency.h"
+#include "core/StringUtil.h"
+#include "core/Trace.h"
+#include "core/Assert.h"
+
+namespace core {
+
+namespace {
+// the scheduler and worker index of the current thread - used to push spawned tasks to the own deque
+thread_local const TaskScheduler* _currentScheduler = nullptr;
+thread_local int _currentWorkerIndex = -1;
+}
+
+bool TaskScheduler::Deque::push(const Task& task) {
+	SDL_AtomicLock(&lock);
+	if (bottom - top >= DequeSize) {
+		SDL_AtomicUnlock(&lock);
+		return false;
+	}
+	tasks[bottom & (DequeSize - 1u)] = task;
+	++bottom;
+	SDL_AtomicUnlock(&lock);
+	return true;
+}
+
+bool TaskScheduler::Deque::pop(Task& task) {
+	SDL_AtomicLock(&lock);
+	if (bottom == top) {
+		SDL_AtomicUnlock(&lock);
+		return false;
+	}
+	--bottom;
+	task = tasks[bottom & (DequeSize - 1u)];
+	SDL_AtomicUnlock(&lock);
+	return true;
+}
+
+bool TaskScheduler::Deque::steal(Task& task) {
+	SDL_AtomicLock(&lock);
+	if (bottom == top) {
+		SDL_AtomicUnlock(&lock);
+		return false;
+	}
+	task = tasks[top & (DequeSize - 1u)];
+	++top;
+	SDL_AtomicUnlock(&lock);
+	return true;
+}
+
+TaskScheduler::TaskScheduler(size_t threads, const char *name) :
+		_threads(threads), _name(name) {
+	if (_name == nullptr) {
+		_name = "TaskScheduler";
+	}
+}
+
+TaskScheduler::~TaskScheduler() {
+	shutdown();
+}
+
+void TaskScheduler::init() {
+	core_assert_msg(_deques == nullptr, "TaskScheduler was already initialized");
+	_stop = false;
+	_deques = new Deque[_threads + 1];
+	_workers.reserve(_threads);
+	for (size_t i = 0; i < _threads; ++i) {
+		_workers.emplace_back([this, i] {
+			const core::String n = core::string::format("%s-%i-%i", this->_name, (int)i, (int)getThreadId());
+			setThreadName(n.c_str());
+			core_trace_thread(n.c_str());
+			workerLoop((int)i);
+		});
+	}
+}
+
+void TaskScheduler::shutdown() {
+	if (_deques == nullptr) {
+		return;
+	}
+	_stop = true;
+	{
+		core::ScopedLock lock(_sleepLock);
+		_sleepCondition.signalAll();
+	}
+	for (std::thread &worker : _workers) {
+		worker.join();
+	}
+	_workers.clear();
+	// execute the tasks that are still pending - groups might still wait for them
+	Task task;
+	while (findTask(-1, task)) {
+		execute(task);
+	}
+	delete[] _deques;
+	_deques = nullptr;
+}
+
+int TaskScheduler::currentWorker() const {
+	if (_currentScheduler != this) {
+		return -1;
+	}
+	return _currentWorkerIndex;
+}
+
+void TaskScheduler::spawn(TaskGroup& group, const Task& task) {
+	Task t = task;
+	t.group = &group;
+	group._pending.increment(1);
+	if (_deques == nullptr) {
+		execute(t);
+		return;
+	}
+	const int worker = currentWorker();
+	Deque& deque = _deques[worker == -1 ? _threads : (size_t)worker];
+	if (!deque.push(t)) {
+		// the deque is full - don't wait for a free slot but execute it directly
+		execute(t);
+		return;
+	}
+	_pendingTasks.increment(1);
+	wakeUp();
+}
+
+void TaskScheduler::wakeUp() {
+	if (_sleepingWorkers > 0) {
+		core::ScopedLock lock(_sleepLock);
+		_sleepCondition.signalOne();
+	}
+}
+
+bool TaskScheduler::findTask(int worker, Task& task) {
+	if (_pendingTasks <= 0) {
+		return false;
+	}
+	// the own deque first - that's the most recently spawned task and the data is most likely still in the cache
+	if (worker != -1 && _deques[worker].pop(task)) {
+		_pendingTasks.decrement(1);
+		return true;
+	}
+	if (_deques[_threads].steal(task)) {
+		_pendingTasks.decrement(1);
+		return true;
+	}
+	const size_t start = worker == -1 ? 0u : (size_t)worker + 1u;
+	for (size_t i = 0u; i < _threads; ++i) {
+		const size_t victim = (start + i) % _threads;
+		if ((int)victim == worker) {
+			continue;
+		}
+		if (_deques[victim].steal(task)) {
+			_pendingTasks.decrement(1);
+			return true;
+		}
+	}
+	return false;
+}
+
+void TaskScheduler::execute(const Task& task) {
+	task.func(task.userdata, task.begin, task.end);
+	task.group->_pending.decrement(1);
+}
+
+void TaskScheduler::wait(TaskGroup& group) {
+	const int worker = currentWorker();
+	Task task;
+	while (!group.done()) {
+		if (_deques != nullptr && findTask(worker, task)) {
+			execute(task);
+			continue;
+		}
+		// the remaining tasks of the group are executed by other threads
+		std::this_thread::yield();
+	}
+}
+
+void TaskScheduler::workerLoop(int worker) {
+	_currentScheduler = this;
+	_currentWorkerIndex = worker;
+	Task task;
+	for (;;) {
+		if (findTask(worker, task)) {
+			core_trace_scoped(TaskSchedulerWorker);
+			execute(task);
+			continue;
+		}
+		if (_stop) {
+			break;
+		}
+		core::ScopedLock lock(_sleepLock);
+		// announce the sleeping worker before checking for tasks - a spawn either sees the
+		// sleeping worker or the worker sees the new task
+		_sleepingWorkers.increment(1);
+		if (_pendingTasks <= 0 && !_stop) {
+			_sleepCondition.wait(_sleepLock);
+		}
+		_sleepingWorkers.decrement(1);
+	}
+	Log::debug(logid, "Shutdown worker thread for %i", (int)getThreadId());
+	_currentScheduler = nullptr;
+	_currentWorkerIndex = -1;
+}
+
+}
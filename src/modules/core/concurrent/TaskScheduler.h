@@ -0,0 +1,169 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/NonCopyable.h"
+#include "core/Log.h"
+#include <vector>
+#include <thread>
+#include <stddef.h>
+
+namespace core {
+
+/**
+ * @brief Tracks the tasks that were spawned for the group. Use @c TaskScheduler::wait() to wait for all of them.
+ * @note The group must outlive the tasks that were spawned for it.
+ */
+class TaskGroup : public core::NonCopyable {
+	friend class TaskScheduler;
+private:
+	core::AtomicInt _pending { 0 };
+public:
+	/**
+	 * @return @c true if all tasks of this group were executed
+	 */
+	bool done() const;
+};
+
+inline bool TaskGroup::done() const {
+	return _pending == 0;
+}
+
+/**
+ * @brief Work-stealing task scheduler. Every worker has its own deque - tasks that are spawned from a worker
+ * are pushed to the deque of that worker and idle workers steal from the other end of the deques. Tasks that
+ * are spawned from outside the scheduler end up in a shared deque.
+ *
+ * Tasks are plain values that are copied into the deques - there is no heap allocation per task. The functors
+ * are referenced, not copied - they must stay valid until the group was waited for.
+ *
+ * @note This is meant to replace @c core::ThreadPool - the users can be moved over one at a time.
+ */
+class TaskScheduler final : public core::NonCopyable {
+private:
+	static constexpr auto logid = Log::logid("TaskScheduler");
+public:
+	typedef void (*TaskFunc)(void* userdata, size_t begin, size_t end);
+
+	struct Task {
+		TaskFunc func = nullptr;
+		void* userdata = nullptr;
+		size_t begin = 0u;
+		size_t end = 0u;
+		TaskGroup* group = nullptr;
+	};
+
+	explicit TaskScheduler(size_t threads, const char *name = nullptr);
+	~TaskScheduler();
+
+	void init();
+	void shutdown();
+	size_t size() const;
+
+	/**
+	 * @brief Spawn a task for the given group. If the deque is full, the task is executed directly.
+	 */
+	void spawn(TaskGroup& group, const Task& task);
+
+	/**
+	 * @brief Executes the functor in one of the workers.
+	 * @note The functor is not copied - it must stay valid until @c wait() returned for the given group.
+	 */
+	template<class F>
+	void run(TaskGroup& group, F& func);
+
+	/**
+	 * @brief Waits until all tasks of the group were executed. The calling thread executes pending tasks
+	 * while it's waiting.
+	 */
+	void wait(TaskGroup& group);
+
+	/**
+	 * @brief Calls the functor for every index in the range [begin, end) and waits for all of them.
+	 * @param grainSize The amount of indices that are handled in one task
+	 */
+	template<class F>
+	void parallelFor(size_t begin, size_t end, const F& func, size_t grainSize = 1u);
+
+private:
+	static constexpr uint32_t DequeSize = 4096u;
+
+	/**
+	 * @brief Bounded deque. The owner pushes and pops at the bottom, thieves steal from the top.
+	 */
+	struct alignas(64) Deque {
+		Task tasks[DequeSize];
+		uint32_t top = 0u;
+		uint32_t bottom = 0u;
+		SDL_SpinLock lock = 0;
+
+		bool push(const Task& task);
+		bool pop(Task& task);
+		bool steal(Task& task);
+	};
+
+	const size_t _threads;
+	const char *_name;
+	std::vector<std::thread> _workers;
+	// one deque per worker and one more for the tasks that are spawned from outside the scheduler
+	Deque* _deques = nullptr;
+	core::AtomicInt _pendingTasks { 0 };
+	core::AtomicInt _sleepingWorkers { 0 };
+	core::AtomicBool _stop { false };
+	core::Lock _sleepLock;
+	core::ConditionVariable _sleepCondition;
+
+	int currentWorker() const;
+	bool findTask(int worker, Task& task);
+	void execute(const Task& task);
+	void wakeUp();
+	void workerLoop(int worker);
+};
+
+inline size_t TaskScheduler::size() const {
+	return _threads;
+}
+
+template<class F>
+void TaskScheduler::run(TaskGroup& group, F& func) {
+	Task task;
+	task.func = [] (void* userdata, size_t, size_t) {
+		(*(F*)userdata)();
+	};
+	task.userdata = (void*)&func;
+	spawn(group, task);
+}
+
+template<class F>
+void TaskScheduler::parallelFor(size_t begin, size_t end, const F& func, size_t grainSize) {
+	if (begin >= end) {
+		return;
+	}
+	if (grainSize == 0u) {
+		grainSize = 1u;
+	}
+	Task task;
+	task.func = [] (void* userdata, size_t taskBegin, size_t taskEnd) {
+		const F& f = *(const F*)userdata;
+		for (size_t i = taskBegin; i < taskEnd; ++i) {
+			f(i);
+		}
+	};
+	task.userdata = (void*)&func;
+	TaskGroup group;
+	// the calling thread executes the first range itself
+	for (size_t i = begin + grainSize; i < end; i += grainSize) {
+		task.begin = i;
+		task.end = i + grainSize < end ? i + grainSize : end;
+		spawn(group, task);
+	}
+	task.func(task.userdata, begin, begin + grainSize < end ? begin + grainSize : end);
+	wait(group);
+}
+
+}
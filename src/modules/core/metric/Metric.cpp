@@ -6,14 +6,113 @@
 #include "core/Log.h"
 #include "core/Var.h"
 #include "core/Assert.h"
+#include "core/Trace.h"
+#include "core/Common.h"
 #include <stdio.h>
 #include <string.h>
 #include <SDL_stdinc.h>
 
 namespace metric {
 
+namespace {
+std::atomic<uint32_t> _nextId { 1u };
+
+// cache the values of the last used metric instance for the current thread
+struct ThreadCache {
+	uint32_t id = 0u;
+	void *values = nullptr;
+};
+thread_local ThreadCache _threadCache;
+}
+
+Metric::Metric() :
+		_id(_nextId.fetch_add(1u)) {
+	for (int i = 0; i < MaxHandles; ++i) {
+		_gauges[i].store(-1);
+	}
+}
+
 Metric::~Metric() {
 	shutdown();
+	for (ThreadValues* values : _threadValues) {
+		delete values;
+	}
+	_threadValues.clear();
+}
+
+Metric::ThreadValues::Value& Metric::value(MetricHandle handle) const {
+	if (_threadCache.id == _id) {
+		return ((ThreadValues*)_threadCache.values)->values[handle.id];
+	}
+	const std::thread::id self = std::this_thread::get_id();
+	ThreadValues* values = nullptr;
+	{
+		core::ScopedLock lock(_lock);
+		for (ThreadValues* v : _threadValues) {
+			if (v->thread == self) {
+				values = v;
+				break;
+			}
+		}
+		if (values == nullptr) {
+			values = new ThreadValues();
+			values->thread = self;
+			_threadValues.push_back(values);
+		}
+	}
+	_threadCache.id = _id;
+	_threadCache.values = values;
+	return values->values[handle.id];
+}
+
+bool Metric::sameRegistration(const Registration& r, const char *key, HandleType type, const TagMap& tags) {
+	if (r.type != type || r.key != key || r.tags.size() != tags.size()) {
+		return false;
+	}
+	for (const auto& e : tags) {
+		core::String value;
+		if (!r.tags.get(e->key, value) || value != e->value) {
+			return false;
+		}
+	}
+	return true;
+}
+
+MetricHandle Metric::registerHandle(const char *key, HandleType type, const TagMap& tags) {
+	core::ScopedLock lock(_lock);
+	const int id = _handles.load();
+	for (int i = 0; i < id; ++i) {
+		if (sameRegistration(_registrations[i], key, type, tags)) {
+			MetricHandle handle;
+			handle.id = i;
+			return handle;
+		}
+	}
+	if (id >= MaxHandles) {
+		Log::warn("Could not register metric %s - max handles reached", key);
+		return MetricHandle();
+	}
+	Registration& r = _registrations[id];
+	r.key = key;
+	r.tags = tags;
+	r.type = type;
+	// publish the handle after the registration was written - flush() might already iterate the handles
+	_handles.store(id + 1, std::memory_order_release);
+	MetricHandle handle;
+	handle.id = id;
+	return handle;
+}
+
+MetricHandle Metric::registerCounter(const char *key, const TagMap& tags) {
+	return registerHandle(key, HandleType::Counter, tags);
+}
+
+MetricHandle Metric::registerGauge(const char *key, const TagMap& tags) {
+	return registerHandle(key, HandleType::Gauge, tags);
+}
+
+MetricHandle Metric::registerHistogram(const char *key, const TagMap& tags) {
+	return registerHandle(key, HandleType::Histogram, tags);
 }
 
 bool Metric::init(const char *prefix, const IMetricSenderPtr& messageSender) {
@@ -35,13 +134,112 @@ bool Metric::init(const char *prefix, const IMetricSenderPtr& messageSender) {
 		Log::warn("Invalid %s given - using telegraf", cfg::MetricFlavor);
 	}
 	_messageSender = messageSender;
+	const int flushInterval = core::Var::get(cfg::MetricFlushInterval, "1000")->intVal();
+	if (flushInterval > 0 && !_flushThread.joinable()) {
+		_stopFlushThread = false;
+		_flushThread = std::thread(&Metric::flushThread, this, (uint32_t)flushInterval);
+	}
 	return true;
 }
 
 void Metric::shutdown() {
+	if (_flushThread.joinable()) {
+		{
+			core::ScopedLock lock(_flushLock);
+			_stopFlushThread = true;
+			_flushCondition.signalAll();
+		}
+		_flushThread.join();
+	}
+	flush();
 	_messageSender = IMetricSenderPtr();
 }
 
+void Metric::flushThread(uint32_t intervalMillis) {
+	core_trace_thread("MetricFlush");
+	core::ScopedLock lock(_flushLock);
+	while (!_stopFlushThread) {
+		_flushCondition.waitTimeout(_flushLock, intervalMillis);
+		if (_stopFlushThread) {
+			break;
+		}
+		flush();
+	}
+}
+
+void Metric::sendDatagram() {
+	if (_datagram.empty()) {
+		return;
+	}
+	_datagram.push_back('\0');
+	_messageSender->send(_datagram.data());
+	_datagram.clear();
+}
+
+void Metric::append(const char *key, int64_t value, const char *type, const TagMap& tags) {
+	char buffer[256];
+	const int written = format(buffer, sizeof(buffer), key, value, type, tags);
+	if (written < 0) {
+		Log::debug("Could not format metric %s", key);
+		return;
+	}
+	if (!_datagram.empty() && _datagram.size() + 1u + (size_t)written > MaxDatagramSize) {
+		sendDatagram();
+	}
+	if (!_datagram.empty()) {
+		_datagram.push_back('\n');
+	}
+	_datagram.insert(_datagram.end(), buffer, buffer + written);
+}
+
+void Metric::flush() {
+	core_trace_scoped(MetricFlush);
+	if (!_messageSender) {
+		return;
+	}
+	const int handles = _handles.load(std::memory_order_acquire);
+	core::ScopedLock lock(_lock);
+	for (int i = 0; i < handles; ++i) {
+		const Registration& r = _registrations[i];
+		if (r.type == HandleType::Gauge) {
+			const int64_t gauge = _gauges[i].exchange(-1, std::memory_order_relaxed);
+			if (gauge >= 0) {
+				append(r.key.c_str(), gauge, "g", r.tags);
+			}
+			continue;
+		}
+		int64_t sum = 0;
+		int64_t count = 0;
+		int64_t max = 0;
+		for (ThreadValues* values : _threadValues) {
+			ThreadValues::Value& v = values->values[i];
+			sum += v.sum.exchange(0, std::memory_order_relaxed);
+			if (r.type == HandleType::Histogram) {
+				count += v.count.exchange(0, std::memory_order_relaxed);
+				const int64_t threadMax = v.max.exchange(0, std::memory_order_relaxed);
+				max = core_max(max, threadMax);
+			}
+		}
+		if (r.type == HandleType::Counter) {
+			if (sum != 0) {
+				append(r.key.c_str(), sum, "c", r.tags);
+			}
+			continue;
+		}
+		if (count == 0) {
+			continue;
+		}
+		char key[128];
+		SDL_snprintf(key, sizeof(key), "%s_count", r.key.c_str());
+		append(key, count, "c", r.tags);
+		SDL_snprintf(key, sizeof(key), "%s_avg", r.key.c_str());
+		append(key, sum / count, "g", r.tags);
+		SDL_snprintf(key, sizeof(key), "%s_max", r.key.c_str());
+		append(key, max, "g", r.tags);
+	}
+	sendDatagram();
+}
+
 bool Metric::createTags(char* buffer, size_t len, const TagMap& tags, const char* sep, const char* preamble, const char *split) {
 	if (tags.empty()) {
 		return true;
@@ -77,40 +275,47 @@ bool Metric::createTags(char* buffer, size_t len, const TagMap& tags, const char
 	return true;
 }
 
-bool Metric::assemble(const char* key, int value, const char* type, const TagMap& tags) const {
-	if (!_messageSender) {
-		return false;
-	}
-	constexpr int metricSize = 256;
-	char buffer[metricSize];
+int Metric::format(char *buffer, size_t len, const char* key, int64_t value, const char* type, const TagMap& tags) const {
 	constexpr int tagsSize = 256;
 	char tagsBuffer[tagsSize] = "";
+	const long long v = (long long)value;
 	int written;
 	switch (_flavor) {
 	case Flavor::Etsy:
-		written = SDL_snprintf(buffer, sizeof(buffer), "%s.%s:%i|%s", _prefix.c_str(), key, value, type);
+		written = SDL_snprintf(buffer, len, "%s.%s:%lld|%s", _prefix.c_str(), key, v, type);
 		break;
 	case Flavor::Datadog:
 		if (!createTags(tagsBuffer, sizeof(tagsBuffer), tags, ":", "|#", ",")) {
-			return false;
+			return -1;
 		}
-		written = SDL_snprintf(buffer, sizeof(buffer), "%s.%s:%i|%s%s", _prefix.c_str(), key, value, type, tagsBuffer);
+		written = SDL_snprintf(buffer, len, "%s.%s:%lld|%s%s", _prefix.c_str(), key, v, type, tagsBuffer);
 		break;
 	case Flavor::Influx:
 		if (!createTags(tagsBuffer, sizeof(tagsBuffer), tags, "=", ",", ",")) {
-			return false;
+			return -1;
 		}
-		written = SDL_snprintf(buffer, sizeof(buffer), "%s_%s,type=%s%s value=%i", _prefix.c_str(), key, type, tagsBuffer, value);
+		written = SDL_snprintf(buffer, len, "%s_%s,type=%s%s value=%lld", _prefix.c_str(), key, type, tagsBuffer, v);
 		break;
 	case Flavor::Telegraf:
 	default:
 		if (!createTags(tagsBuffer, sizeof(tagsBuffer), tags, "=", ",", ",")) {
-			return false;
+			return -1;
 		}
-		written = SDL_snprintf(buffer, sizeof(buffer), "%s.%s%s:%i|%s", _prefix.c_str(), key, tagsBuffer, value, type);
+		written = SDL_snprintf(buffer, len, "%s.%s%s:%lld|%s", _prefix.c_str(), key, tagsBuffer, v, type);
 		break;
 	}
-	if (written >= metricSize) {
+	if (written < 0 || (size_t)written >= len) {
+		return -1;
+	}
+	return written;
+}
+
+bool Metric::assemble(const char* key, int value, const char* type, const TagMap& tags) const {
+	if (!_messageSender) {
+		return false;
+	}
+	char buffer[256];
+	if (format(buffer, sizeof(buffer), key, value, type, tags) < 0) {
 		return false;
 	}
 	return _messageSender->send(buffer);
@@ -13,7 +13,12 @@
 #include "IMetricSender.h"
 #include "core/NonCopyable.h"
 #include "core/collection/StringMap.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ConditionVariable.h"
+#include <atomic>
 #include <memory>
+#include <thread>
+#include <vector>
 #include <stdint.h>
 
 namespace metric {
@@ -33,15 +38,93 @@ enum class Flavor {
  */
 using TagMap = core::StringMap<core::String, 4>;
 
+/**
+ * @brief Handle of a metric that was registered at the @c Metric instance. Recording a value for a handle
+ * doesn't need any string formatting - the values are aggregated and sent by @c Metric::flush()
+ */
+struct MetricHandle {
+	int id = -1;
+
+	inline bool valid() const {
+		return id >= 0;
+	}
+};
+
 /**
  * @brief The Metric class generates and publishes metrics
  */
 class Metric : public core::NonCopyable {
+public:
+	/**
+	 * @brief The max amount of metric handles that can get registered
+	 */
+	static constexpr int MaxHandles = 256;
 private:
+	/**
+	 * @brief The max size of the datagram that is handed over to the @c IMetricSender in @c flush()
+	 */
+	static constexpr size_t MaxDatagramSize = 1400u;
+
+	enum class HandleType : uint8_t {
+		Counter, Gauge, Histogram
+	};
+
+	struct Registration {
+		core::String key;
+		TagMap tags;
+		HandleType type = HandleType::Counter;
+	};
+
+	/**
+	 * @brief The aggregated values of one thread. Only the owning thread writes to them, @c flush() takes the
+	 * values over - so there is no contention on the atomics.
+	 */
+	struct ThreadValues {
+		struct alignas(8) Value {
+			std::atomic<int64_t> sum { 0 };
+			std::atomic<int64_t> count { 0 };
+			std::atomic<int64_t> max { 0 };
+		};
+		std::thread::id thread;
+		Value values[MaxHandles];
+	};
+
 	core::String _prefix;
 	Flavor _flavor = Flavor::Telegraf;
 	IMetricSenderPtr _messageSender;
 
+	// unique per instance - used to find the thread values of this instance in the thread local cache
+	const uint32_t _id;
+	mutable core::Lock _lock;
+	Registration _registrations[MaxHandles];
+	std::atomic<int> _handles { 0 };
+	// gauges are not aggregated - the last value wins. -1 means there is no new value since the last flush.
+	mutable std::atomic<int64_t> _gauges[MaxHandles];
+	mutable std::vector<ThreadValues*> _threadValues;
+
+	core::Lock _flushLock;
+	core::ConditionVariable _flushCondition;
+	std::thread _flushThread;
+	bool _stopFlushThread = false;
+	std::vector<char> _datagram;
+
+	ThreadValues::Value& value(MetricHandle handle) const;
+	static bool sameRegistration(const Registration& r, const char *key, HandleType type, const TagMap& tags);
+	/**
+	 * @brief Returns the existing handle if the same metric was already registered
+	 */
+	MetricHandle registerHandle(const char *key, HandleType type, const TagMap& tags);
+	void flushThread(uint32_t intervalMillis);
+	/**
+	 * @brief Appends the formatted metric to the datagram and sends the datagram if it's full
+	 */
+	void append(const char *key, int64_t value, const char *type, const TagMap& tags);
+	void sendDatagram();
+	/**
+	 * @return The amount of characters that were written or @c -1 if the buffer was not big enough
+	 */
+	int format(char *buffer, size_t len, const char* key, int64_t value, const char* type, const TagMap& tags) const;
+
 	/**
 	 * @brief Create the needed tag list if it is supported by the specified flavor
 	 * @param[out] buffer The buffer to write the tag list into
@@ -54,15 +137,48 @@ private:
 	static bool createTags(char *buffer, size_t len, const TagMap& tags, const char* sep, const char* preamble, const char *split = ",");
 	bool assemble(const char* key, int value, const char* type, const TagMap& tags = {}) const;
 public:
+	Metric();
 	~Metric();
 
 	/**
 	 * @param[in] messageSender @c IMessageSender - must already be initialized
-	 * @note Reads the @c metric_flavor cvar to configure the flavor.
+	 * @note Reads the @c metric_flavor cvar to configure the flavor and the @c metric_flushinterval cvar to
+	 * start the thread that sends the aggregated metrics. A value of @c 0 disables the thread - @c flush()
+	 * must be called manually then.
 	 */
 	bool init(const char *prefix, const IMetricSenderPtr& messageSender);
 	void shutdown();
 
+	/**
+	 * @brief Registers a counter. The deltas that are recorded for the handle are summed up until the next @c flush()
+	 * @note Handles can be registered before @c init() was called. Registering the same key and tags again returns
+	 * the same handle. If there are already @c MaxHandles registered,
+	 * an invalid handle is returned and the recorded values are ignored.
+	 */
+	MetricHandle registerCounter(const char *key, const TagMap& tags = {});
+	/**
+	 * @brief Registers a gauge. The last value that is recorded before the next @c flush() is sent.
+	 */
+	MetricHandle registerGauge(const char *key, const TagMap& tags = {});
+	/**
+	 * @brief Registers a histogram. The recorded values are sent as @c <key>_count, @c <key>_avg and @c <key>_max
+	 * on the next @c flush()
+	 */
+	MetricHandle registerHistogram(const char *key, const TagMap& tags = {});
+
+	/**
+	 * @brief Adds the delta to the counter - this is lock free and doesn't allocate or format anything
+	 */
+	void count(MetricHandle handle, int delta) const;
+	void increment(MetricHandle handle) const;
+	void gauge(MetricHandle handle, uint32_t value) const;
+	void histogram(MetricHandle handle, uint32_t value) const;
+
+	/**
+	 * @brief Sends the aggregated values of all registered handles in as few datagrams as possible and resets them
+	 */
+	void flush();
+
 	/**
 	 * @brief Increments the key
 	 */
@@ -152,6 +268,37 @@ inline bool Metric::histogram(const char* key, uint32_t millis, const TagMap& ta
 	return assemble(key, millis, "h", tags);
 }
 
+inline void Metric::count(MetricHandle handle, int delta) const {
+	if (!handle.valid()) {
+		return;
+	}
+	value(handle).sum.fetch_add(delta, std::memory_order_relaxed);
+}
+
+inline void Metric::increment(MetricHandle handle) const {
+	count(handle, 1);
+}
+
+inline void Metric::gauge(MetricHandle handle, uint32_t value) const {
+	if (!handle.valid()) {
+		return;
+	}
+	_gauges[handle.id].store(value, std::memory_order_relaxed);
+}
+
+inline void Metric::histogram(MetricHandle handle, uint32_t val) const {
+	if (!handle.valid()) {
+		return;
+	}
+	ThreadValues::Value& v = value(handle);
+	v.sum.fetch_add(val, std::memory_order_relaxed);
+	v.count.fetch_add(1, std::memory_order_relaxed);
+	// only this thread writes the max - flush() might reset it in between, but then only this one value is lost
+	if ((int64_t)val > v.max.load(std::memory_order_relaxed)) {
+		v.max.store(val, std::memory_order_relaxed);
+	}
+}
+
 inline bool Metric::meter(const char* key, int value, const TagMap& tags) const {
 	return assemble(key, value, "m", tags);
 }
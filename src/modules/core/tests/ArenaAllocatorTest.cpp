@@ -0,0 +1,61 @@
+/**
+ * @file
+ */
+
+#include "core/ArenaAllocator.h"
+#include "AbstractTest.h"
+
+namespace core {
+
+class ArenaAllocatorTest: public AbstractTest {
+};
+
+TEST_F(ArenaAllocatorTest, testAlignment) {
+	ArenaAllocator arena(128u);
+	void* a = arena.alloc(1u, 1u);
+	void* b = arena.alloc(8u, 16u);
+	EXPECT_EQ(0u, (uintptr_t)b & 15u);
+	EXPECT_NE(a, b);
+	arena.free(b, 8u);
+	arena.free(a, 1u);
+	EXPECT_EQ(0, arena.live());
+}
+
+TEST_F(ArenaAllocatorTest, testReuseBlocksAfterReset) {
+	ArenaAllocator arena(128u);
+	for (int i = 0; i < 10; ++i) {
+		arena.alloc(100u, 8u);
+	}
+	const int blocks = arena.blockAllocations();
+	EXPECT_EQ(10, blocks);
+	arena.reset();
+	for (int i = 0; i < 10; ++i) {
+		arena.alloc(100u, 8u);
+	}
+	EXPECT_EQ(blocks, arena.blockAllocations()) << "The blocks should get reused after a reset";
+	arena.reset();
+}
+
+TEST_F(ArenaAllocatorTest, testOversized) {
+	ArenaAllocator arena(128u);
+	void* ptr = arena.alloc(1024u, 8u);
+	ASSERT_NE(nullptr, ptr);
+	EXPECT_GE(arena.capacity(), 1024u);
+	arena.free(ptr, 1024u);
+}
+
+TEST_F(ArenaAllocatorTest, testFreeLast) {
+	ArenaAllocator arena(128u);
+	void* keep = arena.alloc(16u, 8u);
+	void* a = arena.alloc(16u, 8u);
+	EXPECT_EQ(32u, arena.allocatedBytes());
+	arena.free(a, 16u);
+	EXPECT_EQ(16u, arena.allocatedBytes());
+	void* b = arena.alloc(16u, 8u);
+	EXPECT_EQ(a, b) << "The last allocation should be rolled back on free";
+	arena.free(b, 16u);
+	arena.free(keep, 16u);
+	EXPECT_EQ(0u, arena.allocatedBytes());
+}
+
+}
@@ -5,6 +5,7 @@
 #include <gtest/gtest.h>
 #include "core/collection/ConcurrentQueue.h"
 #include <thread>
+#include <functional>
 
 namespace collection {
 
@@ -104,4 +105,22 @@ TEST_F(ConcurrentQueueTest, testSort) {
 	}
 }
 
+TEST_F(ConcurrentQueueTest, testSetComparator) {
+	core::ConcurrentPriorityQueue<int, std::function<bool(int, int)>> queue(std::less<int>{});
+	queue.setComparator(std::greater<int>{});
+	for (int i = 0; i < 10; ++i) {
+		queue.push(i);
+	}
+	int val = -1;
+	ASSERT_TRUE(queue.pop(val));
+	EXPECT_EQ(0, val);
+	// re-key several times - the heap is only rebuilt on the next access
+	queue.setComparator(std::greater<int>{});
+	queue.setComparator(std::less<int>{});
+	ASSERT_TRUE(queue.pop(val));
+	EXPECT_EQ(9, val);
+	ASSERT_TRUE(queue.waitAndPop(val));
+	EXPECT_EQ(8, val);
+}
+
 }
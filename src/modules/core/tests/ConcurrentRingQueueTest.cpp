@@ -0,0 +1,117 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/collection/ConcurrentRingQueue.h"
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace collection {
+
+class ConcurrentRingQueueTest : public testing::Test {
+};
+
+TEST_F(ConcurrentRingQueueTest, testPushPopFifo) {
+	core::ConcurrentRingQueue<int> queue(1000);
+	EXPECT_EQ(1024u, queue.capacity());
+	const int n = 1000;
+	for (int i = 0; i < n; ++i) {
+		ASSERT_TRUE(queue.push(i));
+	}
+	ASSERT_EQ((int)queue.size(), n);
+	for (int i = 0; i < n; ++i) {
+		int v;
+		ASSERT_TRUE(queue.pop(v));
+		ASSERT_EQ(i, v);
+	}
+	int v;
+	EXPECT_FALSE(queue.pop(v));
+	EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(ConcurrentRingQueueTest, testFull) {
+	core::ConcurrentRingQueue<int> queue(4);
+	for (int i = 0; i < 4; ++i) {
+		ASSERT_TRUE(queue.push(i));
+	}
+	EXPECT_FALSE(queue.push(4));
+	int v;
+	ASSERT_TRUE(queue.pop(v));
+	EXPECT_EQ(0, v);
+	EXPECT_TRUE(queue.push(4));
+}
+
+TEST_F(ConcurrentRingQueueTest, testClearDestructsElements) {
+	auto ptr = std::make_shared<int>(42);
+	{
+		core::ConcurrentRingQueue<std::shared_ptr<int>> queue(8);
+		queue.push(ptr);
+		queue.push(ptr);
+		EXPECT_EQ(3, (int)ptr.use_count());
+		queue.clear();
+		EXPECT_EQ(1, (int)ptr.use_count());
+		queue.push(ptr);
+	}
+	EXPECT_EQ(1, (int)ptr.use_count());
+}
+
+TEST_F(ConcurrentRingQueueTest, testMultipleProducersAndConsumers) {
+	// small capacity to also block the producers
+	core::ConcurrentRingQueue<int> queue(16);
+	const int producers = 4;
+	const int consumers = 4;
+	const int n = 10000;
+	std::vector<std::thread> threads;
+	std::vector<int64_t> sums(consumers, 0);
+	std::vector<int> counts(consumers, 0);
+	for (int c = 0; c < consumers; ++c) {
+		threads.emplace_back([&, c] () {
+			int v;
+			while (queue.waitAndPop(v)) {
+				sums[c] += v;
+				++counts[c];
+			}
+		});
+	}
+	std::vector<std::thread> producerThreads;
+	for (int p = 0; p < producers; ++p) {
+		producerThreads.emplace_back([&] () {
+			for (int i = 1; i <= n; ++i) {
+				ASSERT_TRUE(queue.waitAndPush(i));
+			}
+		});
+	}
+	for (std::thread& t : producerThreads) {
+		t.join();
+	}
+	while (!queue.empty()) {
+		std::this_thread::yield();
+	}
+	queue.abortWait();
+	for (std::thread& t : threads) {
+		t.join();
+	}
+	int64_t sum = 0;
+	int count = 0;
+	for (int c = 0; c < consumers; ++c) {
+		sum += sums[c];
+		count += counts[c];
+	}
+	EXPECT_EQ(producers * n, count);
+	EXPECT_EQ((int64_t)producers * n * (n + 1) / 2, sum);
+}
+
+TEST_F(ConcurrentRingQueueTest, testAbortWait) {
+	core::ConcurrentRingQueue<int> queue;
+	std::thread threadWait([&] () {
+		int v;
+		ASSERT_FALSE(queue.waitAndPop(v));
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	queue.abortWait();
+	threadWait.join();
+}
+
+}
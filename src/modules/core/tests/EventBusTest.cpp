@@ -4,6 +4,7 @@
 
 #include "core/tests/AbstractTest.h"
 #include "core/EventBus.h"
+#include <vector>
 
 namespace core {
 
@@ -31,6 +32,12 @@ class HandlerTest: public CountHandlerTest<TestEvent> {
 class EventBusTest : public core::AbstractTest {
 };
 
+#define EVENTTOPICHANDLER(event, topic, handler) \
+EVENTBUSTOPIC(topic); \
+topic __##topic; \
+EVENTBUSEVENT(event); \
+class handler: public CountHandlerTest<event> {}
+
 TEST_F(EventBusTest, testSubscribeAndPublish_1) {
 	EventBus eventBus;
 	HandlerTest handler;
@@ -51,7 +58,7 @@ TEST_F(EventBusTest, testSubscribeAndQueue_1) {
 	TestEvent event;
 
 	eventBus.subscribe(handler);
-	eventBus.enqueue(std::make_shared<TestEvent>());
+	eventBus.enqueue<TestEvent>();
 	ASSERT_EQ(0, handler.getCount()) << "Expected the handler to be not yet notified";
 
 	ASSERT_EQ(0, eventBus.update());
@@ -64,14 +71,76 @@ TEST_F(EventBusTest, testSubscribeAndQueuePendingLeft) {
 	TestEvent event;
 
 	eventBus.subscribe(handler);
-	eventBus.enqueue(std::make_shared<TestEvent>());
-	eventBus.enqueue(std::make_shared<TestEvent>());
+	eventBus.enqueue<TestEvent>();
+	eventBus.enqueue<TestEvent>();
 	ASSERT_EQ(0, handler.getCount()) << "Expected the handler to be not yet notified";
 
 	ASSERT_EQ(1, eventBus.update(1)) << "Expected to still have one pending event left in the queue";
 	ASSERT_EQ(1, handler.getCount()) << "Expected the handler to be notified once";
 }
 
+EVENTBUSPAYLOADEVENT(TestPayloadEvent, int);
+EVENTBUSPAYLOADEVENT(TestOtherPayloadEvent, int);
+
+class RecordHandlerTest: public IEventBusHandler<TestPayloadEvent>, public IEventBusHandler<TestOtherPayloadEvent> {
+public:
+	std::vector<int> _values;
+
+	void onEvent(const TestPayloadEvent& e) override {
+		_values.push_back(e.get());
+	}
+
+	void onEvent(const TestOtherPayloadEvent& e) override {
+		_values.push_back(-e.get());
+	}
+};
+
+TEST_F(EventBusTest, testQueueOrder) {
+	EventBus eventBus;
+	RecordHandlerTest handler;
+	eventBus.subscribe<TestPayloadEvent>(handler);
+	eventBus.subscribe<TestOtherPayloadEvent>(handler);
+	eventBus.enqueue<TestPayloadEvent>(1);
+	eventBus.enqueue<TestOtherPayloadEvent>(1);
+	eventBus.enqueue<TestPayloadEvent>(2);
+	eventBus.enqueue<TestOtherPayloadEvent>(2);
+	eventBus.enqueue<TestPayloadEvent>(3);
+	ASSERT_EQ(5, eventBus.size());
+	ASSERT_EQ(0, eventBus.update());
+	// the events of one type are dispatched in a batch
+	const std::vector<int> expected {1, 2, 3, -1, -2};
+	ASSERT_EQ(expected, handler._values);
+}
+
+TEST_F(EventBusTest, testQueueLimit) {
+	EventBus eventBus;
+	RecordHandlerTest handler;
+	eventBus.subscribe<TestPayloadEvent>(handler);
+	for (int i = 0; i < 10; ++i) {
+		eventBus.enqueue<TestPayloadEvent>(i);
+	}
+	ASSERT_EQ(7, eventBus.update(3));
+	// events that are queued while a frame is dispatched are handled in the next frame
+	eventBus.enqueue<TestPayloadEvent>(10);
+	ASSERT_EQ(1, eventBus.update());
+	ASSERT_EQ(0, eventBus.update());
+	ASSERT_EQ(11, (int)handler._values.size());
+	for (int i = 0; i < 11; ++i) {
+		ASSERT_EQ(i, handler._values[i]);
+	}
+}
+
+TEST_F(EventBusTest, testQueueTopic) {
+	EVENTTOPICHANDLER(Topic1Event, Topic1, Topic1EventHandler);
+	EventBus eventBus;
+	Topic1EventHandler handler;
+	eventBus.subscribe(handler, &__Topic1);
+	eventBus.enqueue<Topic1Event>(&__Topic1);
+	eventBus.enqueue<Topic1Event>();
+	ASSERT_EQ(0, eventBus.update());
+	ASSERT_EQ(1, handler.getCount()) << "Unexpected handler notification amount - topic filtering isn't working";
+}
+
 TEST_F(EventBusTest, DISABLED_testMassSubscribeAndPublish_10000000) {
 	EventBus eventBus;
 	HandlerTest handler;
@@ -117,12 +186,6 @@ TEST_F(EventBusTest, testMassPublish_10000) {
 	ASSERT_EQ(n, handler.getCount()) << "Expected the handler not to be notified again because we unsubscribed it before we published the event";
 }
 
-#define EVENTTOPICHANDLER(event, topic, handler) \
-EVENTBUSTOPIC(topic); \
-topic __##topic; \
-EVENTBUSEVENT(event); \
-class handler: public CountHandlerTest<event> {}
-
 TEST_F(EventBusTest, testTopic_1) {
 	EVENTTOPICHANDLER(Topic1Event, Topic1, Topic1EventHandler);
 	EventBus eventBus;
@@ -0,0 +1,142 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/collection/FlatMap.h"
+#include "core/SharedPtr.h"
+#include "core/String.h"
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+namespace core {
+
+TEST(FlatMapTest, testPutGet) {
+	core::FlatMap<int64_t, int64_t, std::hash<int64_t>> map;
+	map.put(1, 1);
+	map.put(1, 2);
+	map.put(2, 1);
+	map.put(3, 1337);
+	int64_t value;
+	EXPECT_TRUE(map.get(1, value));
+	EXPECT_EQ(2, value);
+	EXPECT_TRUE(map.get(2, value));
+	EXPECT_EQ(1, value);
+	EXPECT_TRUE(map.get(3, value));
+	EXPECT_EQ(1337, value);
+	EXPECT_FALSE(map.get(4, value));
+	EXPECT_EQ(3u, map.size());
+}
+
+TEST(FlatMapTest, testGrow) {
+	core::FlatMap<int64_t, int64_t> map;
+	EXPECT_EQ(0u, map.capacity());
+	for (int64_t i = 0; i < 100000; ++i) {
+		map.put(i, i * 2);
+	}
+	EXPECT_EQ(100000u, map.size());
+	EXPECT_GE(map.capacity(), map.size());
+	int64_t value;
+	for (int64_t i = 0; i < 100000; ++i) {
+		ASSERT_TRUE(map.get(i, value)) << i;
+		ASSERT_EQ(i * 2, value);
+	}
+}
+
+TEST(FlatMapTest, testReserve) {
+	core::FlatMap<int64_t, int64_t> map(1000);
+	const size_t capacity = map.capacity();
+	for (int64_t i = 0; i < 1000; ++i) {
+		map.put(i, i);
+	}
+	EXPECT_EQ(capacity, map.capacity());
+}
+
+TEST(FlatMapTest, testRemove) {
+	core::FlatMap<int64_t, int64_t> map;
+	for (int64_t i = 0; i < 1024; ++i) {
+		map.put(i, i);
+	}
+	for (int64_t i = 0; i < 1024; i += 2) {
+		EXPECT_TRUE(map.remove(i));
+	}
+	EXPECT_FALSE(map.remove(0));
+	EXPECT_EQ(512u, map.size());
+	int64_t value;
+	for (int64_t i = 0; i < 1024; ++i) {
+		EXPECT_EQ(i % 2 == 1, map.get(i, value)) << i;
+	}
+	auto iter = map.find(1);
+	ASSERT_NE(map.end(), iter);
+	map.erase(iter);
+	EXPECT_EQ(map.end(), map.find(1));
+	EXPECT_EQ(511u, map.size());
+}
+
+TEST(FlatMapTest, testIterate) {
+	core::FlatMap<int64_t, int64_t> map;
+	EXPECT_EQ(map.begin(), map.end());
+	EXPECT_EQ(map.end(), map.find(42));
+	for (int64_t i = 0; i < 1024; ++i) {
+		map.put(i, i);
+	}
+	int cnt = 0;
+	for (auto iter : map) {
+		EXPECT_EQ(iter->key, iter->value);
+		EXPECT_EQ(iter->first, iter->second);
+		++cnt;
+	}
+	EXPECT_EQ(1024, cnt);
+	map.clear();
+	EXPECT_TRUE(map.empty());
+	EXPECT_EQ(map.begin(), map.end());
+}
+
+TEST(FlatMapTest, testIVec3) {
+	core::FlatMap<glm::ivec3, int, std::hash<glm::ivec3>> map;
+	int n = 0;
+	for (int x = -16; x < 16; ++x) {
+		for (int y = -4; y < 4; ++y) {
+			for (int z = -16; z < 16; ++z) {
+				map.put(glm::ivec3(x, y, z), n++);
+			}
+		}
+	}
+	EXPECT_EQ((size_t)n, map.size());
+	n = 0;
+	int value;
+	for (int x = -16; x < 16; ++x) {
+		for (int y = -4; y < 4; ++y) {
+			for (int z = -16; z < 16; ++z) {
+				ASSERT_TRUE(map.get(glm::ivec3(x, y, z), value));
+				ASSERT_EQ(n++, value);
+			}
+		}
+	}
+}
+
+TEST(FlatMapTest, testSharedPtrCopyAndMove) {
+	core::FlatMap<int, core::SharedPtr<core::String>> map;
+	auto foobar = core::SharedPtr<core::String>::create("foobar");
+	for (int i = 0; i < 100; ++i) {
+		map.put(i, foobar);
+	}
+	map.emplace(100, core::SharedPtr<core::String>::create("barfoo"));
+	auto map2 = map;
+	EXPECT_EQ(101u, map2.size());
+	core::FlatMap<int, core::SharedPtr<core::String>> map3(std::move(map2));
+	EXPECT_EQ(101u, map3.size());
+	EXPECT_TRUE(map2.empty());
+	for (int i = 0; i < 50; ++i) {
+		map.remove(i);
+	}
+	map3.clear();
+	EXPECT_EQ(51u, map.size());
+	auto iter = map.find(100);
+	ASSERT_NE(map.end(), iter);
+	EXPECT_EQ(*iter->value.get(), "barfoo");
+	map.clear();
+	foobar = core::SharedPtr<core::String>();
+}
+
+}
@@ -0,0 +1,43 @@
+/**
+ * @file
+ */
+
+#include "core/FrameArena.h"
+#include "AbstractTest.h"
+
+namespace core {
+
+class FrameArenaTest: public AbstractTest {
+};
+
+TEST_F(FrameArenaTest, testVector) {
+	FrameArena::endFrame();
+	{
+		FrameVector<int> v;
+		for (int i = 0; i < 1000; ++i) {
+			v.push_back(i);
+		}
+		for (int i = 0; i < 1000; ++i) {
+			ASSERT_EQ(i, v[i]);
+		}
+	}
+	const FrameArena::Stats& stats = FrameArena::endFrame();
+	EXPECT_GT(stats.allocations, 0);
+}
+
+TEST_F(FrameArenaTest, testNoHeapAllocationsInSteadyState) {
+	FrameArena::endFrame();
+	for (int frame = 0; frame < 3; ++frame) {
+		{
+			FrameVector<int> v;
+			v.reserve(4096);
+			v.push_back(frame);
+		}
+		const FrameArena::Stats& stats = FrameArena::endFrame();
+		if (frame > 0) {
+			EXPECT_EQ(0, stats.blockAllocations) << "Frame " << frame << " should reuse the arena blocks";
+		}
+	}
+}
+
+}
@@ -6,6 +6,9 @@
 #include "core/metric/Metric.h"
 #include "core/metric/IMetricSender.h"
 #include "core/Var.h"
+#include "core/GameConfig.h"
+#include <thread>
+#include <vector>
 
 namespace metric {
 
@@ -35,6 +38,8 @@ protected:
 		Super::SetUp();
 		sender = std::make_shared<BufferSender>();
 		ASSERT_TRUE(sender->init());
+		// the aggregated metrics are flushed manually in the tests
+		core::Var::get(cfg::MetricFlushInterval, "0")->setVal(0);
 	}
 
 	void TearDown() override {
@@ -126,4 +131,72 @@ TEST_F(MetricTest, DISABLED_testTimingMultipleTags) {
 		<< "Expected to get tags after type in datadog flavor";
 }
 
+TEST_F(MetricTest, testHandleCounter) {
+	setFlavor(Flavor::Etsy);
+	Metric m;
+	const MetricHandle handle = m.registerCounter("test");
+	ASSERT_TRUE(handle.valid());
+	m.init(PREFIX, sender);
+	m.increment(handle);
+	m.count(handle, 2);
+	m.flush();
+	EXPECT_EQ(sender->metricLine(), PREFIX ".test:3|c");
+}
+
+TEST_F(MetricTest, testHandleRegisterTwice) {
+	Metric m;
+	const MetricHandle handle1 = m.registerCounter("test", {{"key1", "value1"}});
+	const MetricHandle handle2 = m.registerCounter("test", {{"key1", "value1"}});
+	const MetricHandle handle3 = m.registerCounter("test", {{"key1", "value2"}});
+	EXPECT_EQ(handle1.id, handle2.id);
+	EXPECT_NE(handle1.id, handle3.id);
+}
+
+TEST_F(MetricTest, testHandleGaugeLastValueWins) {
+	setFlavor(Flavor::Etsy);
+	Metric m;
+	const MetricHandle handle = m.registerGauge("test");
+	m.init(PREFIX, sender);
+	m.gauge(handle, 1);
+	m.gauge(handle, 5);
+	m.flush();
+	EXPECT_EQ(sender->metricLine(), PREFIX ".test:5|g");
+}
+
+TEST_F(MetricTest, testHandleHistogram) {
+	setFlavor(Flavor::Etsy);
+	Metric m;
+	const MetricHandle handle = m.registerHistogram("test");
+	m.init(PREFIX, sender);
+	m.histogram(handle, 2);
+	m.histogram(handle, 10);
+	m.histogram(handle, 6);
+	m.flush();
+	EXPECT_EQ(sender->metricLine(), PREFIX ".test_count:3|c\n" PREFIX ".test_avg:6|g\n" PREFIX ".test_max:10|g");
+}
+
+TEST_F(MetricTest, testHandleCounterThreads) {
+	setFlavor(Flavor::Telegraf);
+	Metric m;
+	const MetricHandle handle = m.registerCounter("test", {{"key1", "value1"}});
+	m.init(PREFIX, sender);
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 4; ++i) {
+		threads.emplace_back([&m, handle] () {
+			for (int j = 0; j < 1000; ++j) {
+				m.increment(handle);
+			}
+		});
+	}
+	for (std::thread& t : threads) {
+		t.join();
+	}
+	m.flush();
+	EXPECT_EQ(sender->metricLine(), PREFIX ".test,key1=value1:4000|c");
+	// nothing changed since the last flush
+	sender->send("");
+	m.flush();
+	EXPECT_EQ(sender->metricLine(), "");
+}
+
 }
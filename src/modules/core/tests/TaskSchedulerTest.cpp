@@ -0,0 +1,82 @@
+/**
+ * @file
+ */
+
+#include "AbstractTest.h"
+#include "core/concurrent/TaskScheduler.h"
+#include "core/concurrent/Atomic.h"
+#include <vector>
+
+namespace core {
+
+class TaskSchedulerTest: public AbstractTest {
+};
+
+TEST_F(TaskSchedulerTest, testRun) {
+	core::TaskScheduler scheduler(2);
+	scheduler.init();
+	core::TaskGroup group;
+	core::AtomicInt count { 0 };
+	auto func = [&count] () {
+		count.increment(1);
+	};
+	const int n = 1000;
+	for (int i = 0; i < n; ++i) {
+		scheduler.run(group, func);
+	}
+	scheduler.wait(group);
+	EXPECT_TRUE(group.done());
+	EXPECT_EQ(n, count);
+}
+
+TEST_F(TaskSchedulerTest, testParallelFor) {
+	core::TaskScheduler scheduler(3);
+	scheduler.init();
+	std::vector<int> values(10000, 0);
+	scheduler.parallelFor(0u, values.size(), [&values] (size_t i) {
+		values[i] = (int)i;
+	}, 64u);
+	for (size_t i = 0u; i < values.size(); ++i) {
+		ASSERT_EQ((int)i, values[i]);
+	}
+}
+
+TEST_F(TaskSchedulerTest, testNestedParallelFor) {
+	core::TaskScheduler scheduler(2);
+	scheduler.init();
+	core::AtomicInt count { 0 };
+	scheduler.parallelFor(0u, 16u, [&] (size_t) {
+		scheduler.parallelFor(0u, 100u, [&] (size_t) {
+			count.increment(1);
+		});
+	});
+	EXPECT_EQ(1600, count);
+}
+
+TEST_F(TaskSchedulerTest, testMoreTasksThanDequeSlots) {
+	core::TaskScheduler scheduler(1);
+	scheduler.init();
+	core::AtomicInt count { 0 };
+	scheduler.parallelFor(0u, 20000u, [&count] (size_t) {
+		count.increment(1);
+	});
+	EXPECT_EQ(20000, count);
+}
+
+TEST_F(TaskSchedulerTest, testShutdownExecutesPendingTasks) {
+	core::TaskScheduler scheduler(1);
+	scheduler.init();
+	core::TaskGroup group;
+	core::AtomicInt count { 0 };
+	auto func = [&count] () {
+		count.increment(1);
+	};
+	for (int i = 0; i < 100; ++i) {
+		scheduler.run(group, func);
+	}
+	scheduler.shutdown();
+	EXPECT_TRUE(group.done());
+	EXPECT_EQ(100, count);
+}
+
+}
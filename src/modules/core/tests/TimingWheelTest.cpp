@@ -0,0 +1,101 @@
+/**
+ * @file
+ */
+
+#include "core/TimingWheel.h"
+#include "AbstractTest.h"
+
+namespace core {
+
+class TimingWheelTest: public AbstractTest {
+};
+
+TEST_F(TimingWheelTest, testExpire) {
+	TimingWheel wheel;
+	wheel.update(1000u);
+	int fired = 0;
+	wheel.schedule(1010u, [&] () { ++fired; });
+	EXPECT_EQ(1u, wheel.size());
+	EXPECT_EQ(0, wheel.update(1009u));
+	EXPECT_EQ(0, fired);
+	EXPECT_EQ(1, wheel.update(1010u));
+	EXPECT_EQ(1, fired);
+	EXPECT_EQ(0u, wheel.size());
+	EXPECT_EQ(0, wheel.update(2000u));
+}
+
+TEST_F(TimingWheelTest, testCancel) {
+	TimingWheel wheel;
+	wheel.update(0u);
+	int fired = 0;
+	const TimerId id = wheel.schedule(100u, [&] () { ++fired; });
+	EXPECT_TRUE(wheel.cancel(id));
+	EXPECT_FALSE(wheel.cancel(id)) << "A timer can only be canceled once";
+	EXPECT_EQ(0, wheel.update(200u));
+	EXPECT_EQ(0, fired);
+	// the slot is reused - but the old handle must stay invalid
+	const TimerId id2 = wheel.schedule(300u, [&] () { ++fired; });
+	EXPECT_NE(id, id2);
+	EXPECT_FALSE(wheel.cancel(id));
+	EXPECT_EQ(1, wheel.update(300u));
+	EXPECT_FALSE(wheel.cancel(id2)) << "The timer already fired";
+}
+
+TEST_F(TimingWheelTest, testCascade) {
+	TimingWheel wheel(10u);
+	wheel.update(10u);
+	// spread the timers over all wheels - including one that is out of range for the last wheel
+	const uint64_t expires[] = { 20u, 2560u, 2570u, 90000u, 5000000u, 900000000u, 50000000000u };
+	std::vector<uint64_t> fired;
+	for (uint64_t expire : expires) {
+		wheel.schedule(expire, [&fired, expire] () { fired.push_back(expire); });
+	}
+	uint64_t now = 10u;
+	for (uint64_t expire : expires) {
+		// advance in a few steps - not only exactly onto the expire time
+		while (now < expire - 1u) {
+			now += (expire - now) / 2u + 1u;
+			if (now >= expire) {
+				now = expire - 1u;
+			}
+			wheel.update(now);
+		}
+		ASSERT_FALSE(!fired.empty() && fired.back() == expire) << "Timer " << expire << " fired too early";
+		now = expire;
+		wheel.update(now);
+		ASSERT_FALSE(fired.empty());
+		ASSERT_EQ(expire, fired.back());
+	}
+	EXPECT_EQ(SDL_arraysize(expires), fired.size());
+	EXPECT_EQ(0u, wheel.size());
+}
+
+TEST_F(TimingWheelTest, testScheduleFromCallback) {
+	TimingWheel wheel;
+	wheel.update(0u);
+	int fired = 0;
+	wheel.schedule(10u, [&] () {
+		++fired;
+		wheel.schedule(20u, [&] () { ++fired; });
+	});
+	EXPECT_EQ(1, wheel.update(10u));
+	EXPECT_EQ(1u, wheel.size());
+	EXPECT_EQ(1, wheel.update(20u));
+	EXPECT_EQ(2, fired);
+}
+
+TEST_F(TimingWheelTest, testScheduleBeforeUpdate) {
+	TimingWheel wheel;
+	int fired = 0;
+	// the wheel starts at 0 - the first timer must not define the time base for the later ones
+	wheel.schedule(100u, [&] () { ++fired; });
+	wheel.schedule(50u, [&] () { ++fired; });
+	EXPECT_EQ(2u, wheel.size());
+	EXPECT_EQ(0, wheel.update(49u));
+	EXPECT_EQ(1, wheel.update(50u));
+	EXPECT_EQ(1, fired);
+	EXPECT_EQ(1, wheel.update(100u));
+	EXPECT_EQ(2, fired);
+}
+
+}
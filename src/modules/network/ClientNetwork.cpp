@@ -20,6 +20,38 @@ void ClientNetwork::shutdown() {
 	Super::shutdown();
 }
 
+bool ClientNetwork::handleMessage(ENetPeer* peer, const ServerMessage* msg) {
+	const ServerMsgType type = msg->data_type();
+	ProtocolHandlerPtr handler = _protocolHandlerRegistry->getHandler(EnumNameServerMsgType(type));
+	if (!handler) {
+		Log::error("No handler for server msg type %s", EnumNameServerMsgType(type));
+		return false;
+	}
+	Log::debug("Received %s", EnumNameServerMsgType(type));
+	handler->execute(peer, reinterpret_cast<const flatbuffers::Table*>(msg->data()));
+	return true;
+}
+
+bool ClientNetwork::handleBatch(ENetPeer* peer, const MessageBatch* batch) {
+	for (const BatchedMessage* batchedMsg : *batch->messages()) {
+		const flatbuffers::Vector<uint8_t>* data = batchedMsg->data();
+		flatbuffers::Verifier v(data->Data(), data->size());
+		if (!VerifyServerMessageBuffer(v)) {
+			Log::error("Illegal server message in batch with length: %i", (int)data->size());
+			return false;
+		}
+		const ServerMessage *msg = batchedMsg->data_nested_root();
+		if (msg->data_type() == ServerMsgType::MessageBatch) {
+			Log::error("Nested message batches are not supported");
+			return false;
+		}
+		if (!handleMessage(peer, msg)) {
+			return false;
+		}
+	}
+	return true;
+}
+
 bool ClientNetwork::packetReceived(ENetEvent& event) {
 	flatbuffers::Verifier v(event.packet->data, event.packet->dataLength);
 
@@ -28,15 +60,10 @@ bool ClientNetwork::packetReceived(ENetEvent& event) {
 		return false;
 	}
 	const ServerMessage *req = GetServerMessage(event.packet->data);
-	ServerMsgType type = req->data_type();
-	ProtocolHandlerPtr handler = _protocolHandlerRegistry->getHandler(EnumNameServerMsgType(type));
-	if (!handler) {
-		Log::error("No handler for server msg type %s", EnumNameServerMsgType(type));
-		return false;
+	if (req->data_type() == ServerMsgType::MessageBatch) {
+		return handleBatch(event.peer, req->data_as_MessageBatch());
 	}
-	Log::debug("Received %s", EnumNameServerMsgType(type));
-	handler->execute(event.peer, reinterpret_cast<const flatbuffers::Table*>(req->data()));
-	return true;
+	return handleMessage(event.peer, req);
 }
 
 ENetPeer* ClientNetwork::connect(uint16_t port, const core::String& hostname, int maxChannels) {
@@ -8,11 +8,20 @@
 
 namespace network {
 
+struct ServerMessage;
+struct MessageBatch;
+
 class ClientNetwork : public Network {
 private:
 	ENetHost* _client = nullptr;
 	ENetPeer* _peer = nullptr;
 	using Super = Network;
+
+	bool handleMessage(ENetPeer* peer, const ServerMessage* msg);
+	/**
+	 * @brief Dispatches the messages of a batch in the order they were sent by the server
+	 */
+	bool handleBatch(ENetPeer* peer, const MessageBatch* batch);
 public:
 	ClientNetwork(const ProtocolHandlerRegistryPtr& protocolHandlerRegistry, const core::EventBusPtr& eventBus);
 
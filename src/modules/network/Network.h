@@ -49,19 +49,27 @@ public:
 
 	const ProtocolHandlerRegistryPtr& registry();
 
+	/**
+	 * @note The packet is destroyed if it couldn't be sent and nobody else holds a reference to it
+	 */
 	bool sendMessage(ENetPeer* peer, ENetPacket* packet, int channel = 0);
 };
 
 inline bool Network::sendMessage(ENetPeer* peer, ENetPacket* packet, int channel) {
 	if (packet->dataLength >= peer->host->maximumPacketSize) {
 		Log::error("Packet is too big: %i - max allowed is %i", (int)packet->dataLength, (int)peer->host->maximumPacketSize);
-		enet_packet_destroy(packet);
+		if (packet->referenceCount == 0) {
+			enet_packet_destroy(packet);
+		}
 		return false;
 	}
 	if (enet_peer_send(peer, channel, packet) == 0) {
 		return true;
 	}
-	enet_packet_destroy(packet);
+	// shared packets are still referenced by the other peers
+	if (packet->referenceCount == 0) {
+		enet_packet_destroy(packet);
+	}
 	return false;
 }
 
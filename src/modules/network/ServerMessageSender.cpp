@@ -7,16 +7,16 @@
 #include "core/Common.h"
 #include "core/Assert.h"
 #include "core/StringUtil.h"
+#include "core/Trace.h"
 
 namespace network {
 
 ENetPacket* ServerMessageSender::createServerPacket(ServerMsgType type, const void * data, size_t dataLength, uint32_t flags) {
 	ENetPacket* packet = enet_packet_create(data, dataLength, flags);
-	const char *msgType = EnumNameServerMsgType(type);
-	Log::trace(logid, "Create server package: %s - size %u", msgType, (unsigned int)dataLength);
-	const metric::TagMap& tags {{"direction", "out"}, {"type", msgType}};
-	_metric->count("network_packet_count", 1, tags);
-	_metric->count("network_packet_size", (int)dataLength, tags);
+	Log::trace(logid, "Create server package: %s - size %u", EnumNameServerMsgType(type), (unsigned int)dataLength);
+	const TypeMetrics& metrics = _typeMetrics[(int)type];
+	_metric->increment(metrics.packetCount);
+	_metric->count(metrics.packetSize, (int)dataLength);
 	return packet;
 }
 
@@ -28,6 +28,30 @@ ENetPacket* ServerMessageSender::createServerPacket(FlatBufferBuilder& fbb, Serv
 
 ServerMessageSender::ServerMessageSender(const ServerNetworkPtr& network, const metric::MetricPtr& metric) :
 		_network(network), _metric(metric) {
+	for (ServerMsgType type : EnumValuesServerMsgType()) {
+		const char *msgType = EnumNameServerMsgType(type);
+		const metric::TagMap& tags {{"direction", "out"}, {"type", msgType}};
+		TypeMetrics& metrics = _typeMetrics[(int)type];
+		metrics.packetCount = _metric->registerCounter("network_packet_count", tags);
+		metrics.packetSize = _metric->registerCounter("network_packet_size", tags);
+		metrics.sent = _metric->registerCounter("network_sent", tags);
+		metrics.notSent = _metric->registerCounter("network_not_sent", tags);
+		metrics.broadcast = _metric->registerCounter("network_sent", {{"direction", "broadcast"}, {"type", msgType}});
+	}
+	const metric::TagMap& tags {{"direction", "out"}};
+	_batchedMessages = _metric->registerCounter("network_batched_messages", tags);
+	_batchedPackets = _metric->registerCounter("network_batched_packets", tags);
+}
+
+bool ServerMessageSender::sendPacket(ENetPeer* peer, ENetPacket* packet, int channel, ServerMsgType type) {
+	const TypeMetrics& metrics = _typeMetrics[(int)type];
+	if (!_network->sendMessage(peer, packet, channel)) {
+		_metric->increment(metrics.notSent);
+		Log::trace(logid, "Could not send message of type %s on channel %i", EnumNameServerMsgType(type), channel);
+		return false;
+	}
+	_metric->increment(metrics.sent);
+	return true;
 }
 
 bool ServerMessageSender::sendServerMessage(ENetPeer* peer, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags) {
@@ -39,34 +63,169 @@ bool ServerMessageSender::sendServerMessage(ENetPeer** peers, int numPeers, Flat
 	const char *msgType = network::EnumNameServerMsgType(type);
 	Log::debug(logid, "Send %s to %i peers", msgType, numPeers);
 	core_assert(numPeers > 0);
+	core::ScopedLock lock(_batchLock);
+	if (_batching) {
+		auto msg = CreateServerMessage(fbb, type, data);
+		FinishServerMessageBuffer(fbb, msg);
+		// the messages are sent on the same channel as the unbatched ones
+		QueuedMessage queued { nullptr, 0u, (uint32_t)fbb.GetSize(), flags, type, 0 };
+		if (numPeers > 1) {
+			// serialize it only once and share the packet between the peers
+			queued.packet = createServerPacket(type, fbb.GetBufferPointer(), fbb.GetSize(), flags);
+			++queued.packet->referenceCount;
+			_sharedPackets.push_back(queued.packet);
+		}
+		for (int i = 0; i < numPeers; ++i) {
+			queue(peers[i], queued, fbb.GetBufferPointer());
+		}
+		fbb.Clear();
+		return true;
+	}
 	int sent = 0;
 	auto packet = createServerPacket(fbb, type, data, flags);
-	const metric::TagMap& tags {{"direction", "out"}, {"type", msgType}};
-	{
-		// TODO: lock
-		for (int i = 0; i < numPeers; ++i) {
-			if (!_network->sendMessage(peers[i], packet)) {
-				_metric->count("network_not_sent", 1, tags);
-				Log::trace(logid, "Could not send message of type %s to peer %i", msgType, i);
-			} else {
-				_metric->count("network_sent", 1, tags);
-				++sent;
-			}
+	// hold a reference - a failed send must not destroy the packet for the remaining peers
+	++packet->referenceCount;
+	for (int i = 0; i < numPeers; ++i) {
+		if (sendPacket(peers[i], packet, 0, type)) {
+			++sent;
 		}
 	}
+	if (--packet->referenceCount == 0) {
+		enet_packet_destroy(packet);
+	}
 	fbb.Clear();
 	return sent == numPeers;
 }
 
+void ServerMessageSender::queue(ENetPeer* peer, const QueuedMessage& msg, const uint8_t* data) {
+	PeerQueue& peerQueue = _queues[peer];
+	QueuedMessage queued = msg;
+	if (queued.packet == nullptr) {
+		queued.offset = (uint32_t)peerQueue.data.size();
+		peerQueue.data.insert(peerQueue.data.end(), data, data + queued.size);
+	}
+	peerQueue.messages.push_back(queued);
+}
+
+int ServerMessageSender::sendBatch(ENetPeer* peer, const PeerQueue& peerQueue, size_t begin, size_t end) {
+	if (begin >= end) {
+		return 0;
+	}
+	const QueuedMessage& first = peerQueue.messages[begin];
+	if (end - begin == 1u) {
+		// a single message doesn't need the batch overhead
+		const uint8_t* buf = &peerQueue.data[first.offset];
+		return sendPacket(peer, createServerPacket(first.type, buf, first.size, first.flags), first.channel, first.type) ? 1 : 0;
+	}
+	_batchFBB.Clear();
+	_batchOffsets.clear();
+	for (size_t i = begin; i < end; ++i) {
+		const QueuedMessage& msg = peerQueue.messages[i];
+		// the nested buffer must be aligned like a root buffer
+		_batchFBB.ForceVectorAlignment(msg.size, sizeof(uint8_t), sizeof(int64_t));
+		auto buf = _batchFBB.CreateVector(&peerQueue.data[msg.offset], msg.size);
+		_batchOffsets.push_back(CreateBatchedMessage(_batchFBB, buf));
+	}
+	auto batch = CreateMessageBatch(_batchFBB, _batchFBB.CreateVector(_batchOffsets));
+	ENetPacket* packet = createServerPacket(_batchFBB, ServerMsgType::MessageBatch, batch.Union(), first.flags);
+	_batchFBB.Clear();
+	const bool sent = sendPacket(peer, packet, first.channel, ServerMsgType::MessageBatch);
+	// record the batched messages like they were sent one by one
+	for (size_t i = begin; i < end; ++i) {
+		const TypeMetrics& metrics = _typeMetrics[(int)peerQueue.messages[i].type];
+		_metric->increment(sent ? metrics.sent : metrics.notSent);
+	}
+	return sent ? 1 : 0;
+}
+
+void ServerMessageSender::beginBatch() {
+	core::ScopedLock lock(_batchLock);
+	_batching = true;
+}
+
+void ServerMessageSender::flush() {
+	core_trace_scoped(ServerMessageSenderFlush);
+	core::ScopedLock lock(_batchLock);
+	_batching = false;
+	sendQueues();
+}
+
+void ServerMessageSender::removePeer(ENetPeer* peer) {
+	core::ScopedLock lock(_batchLock);
+	auto i = _queues.find(peer);
+	if (i == _queues.end()) {
+		return;
+	}
+	// the shared packets are released with the next flush
+	Log::debug(logid, "Drop %i queued messages of a disconnected peer", (int)i->second.messages.size());
+	_queues.erase(i);
+}
+
+void ServerMessageSender::sendQueues() {
+	int messages = 0;
+	int packets = 0;
+	for (auto i = _queues.begin(); i != _queues.end();) {
+		PeerQueue& peerQueue = i->second;
+		if (peerQueue.messages.empty()) {
+			// the peer didn't get any message since the last flush - release the memory
+			i = _queues.erase(i);
+			continue;
+		}
+		ENetPeer* peer = i->first;
+		size_t begin = 0u;
+		size_t batchSize = 0u;
+		const size_t n = peerQueue.messages.size();
+		for (size_t m = 0u; m < n; ++m) {
+			const QueuedMessage& msg = peerQueue.messages[m];
+			if (msg.packet != nullptr) {
+				// keep the order of the messages
+				packets += sendBatch(peer, peerQueue, begin, m);
+				begin = m + 1u;
+				batchSize = 0u;
+				// we still hold a reference - the packet is not destroyed if it can't be sent
+				if (sendPacket(peer, msg.packet, msg.channel, msg.type)) {
+					++packets;
+				}
+				continue;
+			}
+			if (m > begin) {
+				const QueuedMessage& prev = peerQueue.messages[m - 1u];
+				if (msg.flags != prev.flags || msg.channel != prev.channel || batchSize + msg.size > MaxBatchSize) {
+					packets += sendBatch(peer, peerQueue, begin, m);
+					begin = m;
+					batchSize = 0u;
+				}
+			}
+			batchSize += msg.size;
+		}
+		packets += sendBatch(peer, peerQueue, begin, n);
+		messages += (int)n;
+		peerQueue.messages.clear();
+		peerQueue.data.clear();
+		++i;
+	}
+	for (ENetPacket* packet : _sharedPackets) {
+		if (--packet->referenceCount == 0) {
+			enet_packet_destroy(packet);
+		}
+	}
+	_sharedPackets.clear();
+	_metric->count(_batchedMessages, messages);
+	_metric->count(_batchedPackets, packets);
+}
+
 bool ServerMessageSender::broadcastServerMessage(FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, int channel, uint32_t flags) {
 	const char *msgType = network::EnumNameServerMsgType(type);
 	Log::debug(logid, "Broadcast %s on channel %i", msgType, channel);
 	bool success = false;
 	{
-		// TODO: lock
+		core::ScopedLock lock(_batchLock);
+		if (_batching) {
+			// the broadcast must not overtake the messages that were collected before
+			sendQueues();
+		}
 		success = _network->broadcast(createServerPacket(fbb, type, data, flags), channel);
-		const metric::TagMap& tags {{"direction", "broadcast"}, {"type", msgType}};
-		_metric->count("network_sent", 1, tags);
+		_metric->increment(_typeMetrics[(int)type].broadcast);
 	}
 	fbb.Clear();
 	return success;
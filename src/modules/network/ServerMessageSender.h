@@ -7,7 +7,10 @@
 #include "ServerMessages_generated.h"
 #include "ServerNetwork.h"
 #include "core/metric/Metric.h"
+#include "core/concurrent/Lock.h"
 #include "core/Log.h"
+#include <unordered_map>
+#include <vector>
 #include <memory>
 
 namespace network {
@@ -16,13 +19,76 @@ using namespace flatbuffers;
 
 /**
  * @brief Send messages from the server to the client(s)
+ *
+ * Between @c beginBatch() and @c flush() the messages are not sent directly, but collected per peer. On
+ * @c flush() the messages of a peer are coalesced into @c MessageBatch packets. Messages that are sent to several
+ * peers at once are serialized once and the packet is shared between the peers.
  */
 class ServerMessageSender {
 private:
 	static constexpr auto logid = Log::logid("ServerMessageSender");
+	/**
+	 * @brief The max payload of a @c MessageBatch - stay below the mtu to not fragment the packets
+	 */
+	static constexpr size_t MaxBatchSize = 1200u;
+
 	ServerNetworkPtr _network;
 	metric::MetricPtr _metric;
 
+	/**
+	 * @brief The metrics are registered once per message type - there is no string formatting when they are recorded
+	 */
+	struct TypeMetrics {
+		metric::MetricHandle packetCount;
+		metric::MetricHandle packetSize;
+		metric::MetricHandle sent;
+		metric::MetricHandle notSent;
+		metric::MetricHandle broadcast;
+	};
+	TypeMetrics _typeMetrics[(int)ServerMsgType::MAX + 1];
+	metric::MetricHandle _batchedMessages;
+	metric::MetricHandle _batchedPackets;
+
+	/**
+	 * @brief Either a finished @c ServerMessage buffer in @c PeerQueue::data or a shared packet
+	 */
+	struct QueuedMessage {
+		ENetPacket* packet;
+		uint32_t offset;
+		uint32_t size;
+		uint32_t flags;
+		ServerMsgType type;
+		int channel;
+	};
+
+	struct PeerQueue {
+		std::vector<QueuedMessage> messages;
+		std::vector<uint8_t> data;
+	};
+
+	core::Lock _batchLock;
+	bool _batching = false;
+	std::unordered_map<ENetPeer*, PeerQueue> _queues;
+	// the packets that are shared between peers - we hold one reference until they were handed over to enet
+	std::vector<ENetPacket*> _sharedPackets;
+	FlatBufferBuilder _batchFBB;
+	std::vector<Offset<BatchedMessage>> _batchOffsets;
+
+	void queue(ENetPeer* peer, const QueuedMessage& msg, const uint8_t* data);
+	/**
+	 * @brief Sends the collected messages of all peers
+	 * @note The batch lock must be held
+	 */
+	void sendQueues();
+	/**
+	 * @brief Sends the packet and records the sent metrics of the given message type
+	 */
+	bool sendPacket(ENetPeer* peer, ENetPacket* packet, int channel, ServerMsgType type);
+	/**
+	 * @return The amount of packets that were sent
+	 */
+	int sendBatch(ENetPeer* peer, const PeerQueue& queue, size_t begin, size_t end);
+
 public:
 	ENetPacket* createServerPacket(ServerMsgType type, const void * data, size_t dataLength, uint32_t flags);
 	ENetPacket* createServerPacket(FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags);
@@ -32,6 +98,20 @@ public:
 	bool sendServerMessage(std::vector<ENetPeer*> peers, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
 	bool sendServerMessage(ENetPeer** peers, int numPeers, FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
 	bool broadcastServerMessage(FlatBufferBuilder& fbb, ServerMsgType type, Offset<void> data, int channel = 0, uint32_t flags = ENET_PACKET_FLAG_RELIABLE);
+
+	/**
+	 * @brief Collect the messages that are sent to peers until @c flush() is called
+	 * @note Broadcasts are not batched - the collected messages are sent before the broadcast to keep the order
+	 */
+	void beginBatch();
+	/**
+	 * @brief Sends the collected messages in as few packets as possible and stops batching
+	 */
+	void flush();
+	/**
+	 * @brief Drops the collected messages of a disconnected peer - enet reuses the peer for new connections
+	 */
+	void removePeer(ENetPeer* peer);
 };
 
 typedef std::shared_ptr<ServerMessageSender> ServerMessageSenderPtr;
@@ -2,7 +2,6 @@
  * @file
  */
 
-#include "ClientMessages_generated.h"
 #include "ServerNetwork.h"
 #include "core/Trace.h"
 #include "core/Log.h"
@@ -12,6 +11,11 @@ namespace network {
 ServerNetwork::ServerNetwork(const ProtocolHandlerRegistryPtr& protocolHandlerRegistry,
 		const core::EventBusPtr& eventBus, const metric::MetricPtr& metric) :
 		Super(protocolHandlerRegistry, eventBus), _metric(metric) {
+	for (ClientMsgType type : EnumValuesClientMsgType()) {
+		const metric::TagMap& tags {{"direction", "in"}, {"type", EnumNameClientMsgType(type)}};
+		_packetCount[(int)type] = _metric->registerCounter("network_packet_count", tags);
+		_packetSize[(int)type] = _metric->registerCounter("network_packet_size", tags);
+	}
 }
 
 bool ServerNetwork::packetReceived(ENetEvent& event) {
@@ -29,9 +33,8 @@ bool ServerNetwork::packetReceived(ENetEvent& event) {
 		Log::error("No handler for client msg type %s", clientMsgType);
 		return false;
 	}
-	const metric::TagMap& tags  {{"direction", "in"}, {"type", clientMsgType}};
-	_metric->count("network_packet_count", 1, tags);
-	_metric->count("network_packet_size", (int)event.packet->dataLength, tags);
+	_metric->increment(_packetCount[(int)type]);
+	_metric->count(_packetSize[(int)type], (int)event.packet->dataLength);
 
 	Log::debug("Received %s", clientMsgType);
 	handler->execute(event.peer, reinterpret_cast<const flatbuffers::Table*>(req->data()));
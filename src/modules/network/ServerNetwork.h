@@ -5,6 +5,7 @@
 #pragma once
 
 #include "Network.h"
+#include "ClientMessages_generated.h"
 #include "core/metric/Metric.h"
 
 namespace network {
@@ -13,6 +14,8 @@ class ServerNetwork : public Network {
 private:
 	ENetHost* _server = nullptr;
 	metric::MetricPtr _metric;
+	metric::MetricHandle _packetCount[(int)ClientMsgType::MAX + 1];
+	metric::MetricHandle _packetSize[(int)ClientMsgType::MAX + 1];
 	using Super = Network;
 public:
 	ServerNetwork(const ProtocolHandlerRegistryPtr& protocolHandlerRegistry,
@@ -0,0 +1,122 @@
+/**
+ * @file
+ */
+
+#include "SimplexBatch.h"
+#include "SimplexBatchKernel.h"
+#include "Simplex.h"
+#include "core/Log.h"
+#include <SDL_cpuinfo.h>
+#include <math.h>
+
+namespace noise {
+namespace batch {
+namespace details {
+
+struct LanesScalar {
+	using F = float;
+	using I = int;
+	using M = bool;
+	static constexpr int Width = 1;
+
+	static inline F load(const float* v) { return *v; }
+	static inline void store(float* v, F f) { *v = f; }
+	static inline F zero() { return 0.0f; }
+	static inline F set1(float v) { return v; }
+	static inline F add(F a, F b) { return a + b; }
+	static inline F sub(F a, F b) { return a - b; }
+	static inline F mul(F a, F b) { return a * b; }
+	static inline F neg(F a) { return -a; }
+	static inline M lt(F a, F b) { return a < b; }
+	static inline M gt(F a, F b) { return a > b; }
+	static inline M ge(F a, F b) { return a >= b; }
+	static inline M mand(M a, M b) { return a && b; }
+	static inline M mor(M a, M b) { return a || b; }
+	static inline M mnot(M a) { return !a; }
+	static inline F select(M m, F a, F b) { return m ? a : b; }
+	static inline I mtoi(M m) { return m ? 1 : 0; }
+	static inline I ifloor(F a) { return (int)floorf(a); }
+	static inline F itof(I a) { return (float)a; }
+	static inline I iset1(int v) { return v; }
+	static inline I iadd(I a, I b) { return a + b; }
+	static inline I iand(I a, int b) { return a & b; }
+	static inline M ieq(I a, int b) { return a == b; }
+	static inline M ilt(I a, int b) { return a < b; }
+	static inline M itest(I a, int bit) { return (a & bit) != 0; }
+	static inline I gather(const int* table, I idx) { return table[idx]; }
+};
+
+const Kernels* kernelsScalar() {
+	return KernelImpl<LanesScalar>::kernels("scalar");
+}
+
+}
+
+namespace {
+
+const details::Kernels* selectKernels() {
+	const details::Kernels* kernels = nullptr;
+	if (SDL_HasAVX2()) {
+		kernels = details::kernelsAVX2();
+	}
+	if (kernels == nullptr && SDL_HasSSE41()) {
+		kernels = details::kernelsSSE41();
+	}
+	if (kernels == nullptr) {
+		kernels = details::kernelsScalar();
+	}
+	Log::debug("Use %s noise kernels", kernels->name);
+	return kernels;
+}
+
+inline const details::Kernels* kernels() {
+	static const details::Kernels* k = selectKernels();
+	return k;
+}
+
+/**
+ * @brief The kernels need the permutation table with int entries to be able to gather them
+ */
+struct PermTable {
+	int perm[512];
+
+	PermTable() {
+		for (int i = 0; i < 512; ++i) {
+			perm[i] = noise::details::perm[i];
+		}
+	}
+};
+
+/**
+ * @brief Built once from the default permutation table - @c noise::seed() is never called for the copy of
+ * the table in this translation unit.
+ */
+inline const int* permTable() {
+	static const PermTable table;
+	return table.perm;
+}
+
+}
+
+void noise(const float* x, const float* y, float* out, int amount) {
+	kernels()->noise2(permTable(), x, y, out, amount);
+}
+
+void noise(const float* x, const float* y, const float* z, float* out, int amount) {
+	kernels()->noise3(permTable(), x, y, z, out, amount);
+}
+
+void fBm(const float* x, const float* y, float* out, int amount, uint8_t octaves, float lacunarity, float gain) {
+	kernels()->fBm2(permTable(), x, y, out, amount, octaves, lacunarity, gain);
+}
+
+void fBm(const float* x, const float* y, const float* z, float* out, int amount, uint8_t octaves, float lacunarity, float gain) {
+	kernels()->fBm3(permTable(), x, y, z, out, amount, octaves, lacunarity, gain);
+}
+
+const char* kernelName() {
+	return kernels()->name;
+}
+
+}
+}
@@ -0,0 +1,56 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace noise {
+
+/**
+ * @brief Batched simplex noise kernels
+ *
+ * The coordinates are given as structure of arrays and the values for all of them are computed in one call.
+ * This is used to fill whole voxel columns or 2d tiles at once. The best kernel for the cpu (AVX2, SSE4.1 or
+ * the scalar fallback) is picked on the first call.
+ *
+ * @note All kernels produce the same values - but these are not bit-identical to the scalar functions of
+ * @c Simplex.h as those are partly evaluated in double precision. Don't mix both for the same data.
+ *
+ * @note The kernels always use the default permutation table. @c noise::seed() doesn't affect them, as the table
+ * in @c Simplex.h is a @c static @c thread_local - every translation unit and thread has its own copy.
+ */
+namespace batch {
+
+/**
+ * @brief 2d simplex noise in the range [-1,1]
+ * @param[in] x The x coordinates of @c amount positions
+ * @param[in] y The y coordinates of @c amount positions
+ * @param[out] out Must have space for @c amount values
+ */
+void noise(const float* x, const float* y, float* out, int amount);
+
+/**
+ * @brief 3d simplex noise in the range [-1,1]
+ */
+void noise(const float* x, const float* y, const float* z, float* out, int amount);
+
+/**
+ * @brief 2d fractional Brownian motion - same parameters as @c noise::fBm()
+ */
+void fBm(const float* x, const float* y, float* out, int amount, uint8_t octaves = 4, float lacunarity = 2.0f, float gain = 0.5f);
+
+/**
+ * @brief 3d fractional Brownian motion - same parameters as @c noise::fBm()
+ */
+void fBm(const float* x, const float* y, const float* z, float* out, int amount, uint8_t octaves = 4, float lacunarity = 2.0f, float gain = 0.5f);
+
+/**
+ * @return The name of the kernel that is used - @c avx2, @c sse4.1 or @c scalar
+ */
+const char* kernelName();
+
+}
+
+}
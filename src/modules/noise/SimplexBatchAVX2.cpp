@@ -0,0 +1,70 @@
+/**
+ * @file
+ * @note This file must be compiled with AVX2 support - see the CMakeLists.txt
+ */
+
+#include "SimplexBatchKernel.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+namespace noise {
+namespace batch {
+namespace details {
+
+struct LanesAVX2 {
+	using F = __m256;
+	using I = __m256i;
+	using M = __m256;
+	static constexpr int Width = 8;
+
+	static inline F load(const float* v) { return _mm256_loadu_ps(v); }
+	static inline void store(float* v, F f) { _mm256_storeu_ps(v, f); }
+	static inline F zero() { return _mm256_setzero_ps(); }
+	static inline F set1(float v) { return _mm256_set1_ps(v); }
+	static inline F add(F a, F b) { return _mm256_add_ps(a, b); }
+	static inline F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+	static inline F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+	static inline F neg(F a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+	static inline M lt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	static inline M gt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+	static inline M ge(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+	static inline M mand(M a, M b) { return _mm256_and_ps(a, b); }
+	static inline M mor(M a, M b) { return _mm256_or_ps(a, b); }
+	static inline M mnot(M a) { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+	static inline F select(M m, F a, F b) { return _mm256_blendv_ps(b, a, m); }
+	static inline I mtoi(M m) { return _mm256_and_si256(_mm256_castps_si256(m), _mm256_set1_epi32(1)); }
+	static inline I ifloor(F a) { return _mm256_cvttps_epi32(_mm256_floor_ps(a)); }
+	static inline F itof(I a) { return _mm256_cvtepi32_ps(a); }
+	static inline I iset1(int v) { return _mm256_set1_epi32(v); }
+	static inline I iadd(I a, I b) { return _mm256_add_epi32(a, b); }
+	static inline I iand(I a, int b) { return _mm256_and_si256(a, _mm256_set1_epi32(b)); }
+	static inline M ieq(I a, int b) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, _mm256_set1_epi32(b))); }
+	static inline M ilt(I a, int b) { return _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(b), a)); }
+	static inline M itest(I a, int bit) { return mnot(ieq(iand(a, bit), 0)); }
+	static inline I gather(const int* table, I idx) { return _mm256_i32gather_epi32(table, idx, 4); }
+};
+
+const Kernels* kernelsAVX2() {
+	return KernelImpl<LanesAVX2>::kernels("avx2");
+}
+
+}
+}
+}
+
+#else
+
+namespace noise {
+namespace batch {
+namespace details {
+
+const Kernels* kernelsAVX2() {
+	return nullptr;
+}
+
+}
+}
+}
+
+#endif
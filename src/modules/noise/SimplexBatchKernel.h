@@ -0,0 +1,254 @@
+/**
+ * @file
+ * @brief Lane width independent implementation of the batched simplex noise - see @c SimplexBatch.h
+ *
+ * The kernel is instantiated once per instruction set in its own translation unit, so only that unit has to be
+ * compiled with the matching compiler flags. A lane type @c L must provide the vector types @c F (float),
+ * @c I (int) and @c M (mask) together with the static operations that are used below.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+namespace noise {
+namespace batch {
+namespace details {
+
+struct Kernels {
+	const char* name;
+	void (*noise2)(const int* perm, const float* x, const float* y, float* out, int amount);
+	void (*noise3)(const int* perm, const float* x, const float* y, const float* z, float* out, int amount);
+	void (*fBm2)(const int* perm, const float* x, const float* y, float* out, int amount, uint8_t octaves, float lacunarity, float gain);
+	void (*fBm3)(const int* perm, const float* x, const float* y, const float* z, float* out, int amount, uint8_t octaves, float lacunarity, float gain);
+};
+
+/**
+ * @return @c nullptr if the kernel wasn't compiled in
+ */
+const Kernels* kernelsAVX2();
+const Kernels* kernelsSSE41();
+const Kernels* kernelsScalar();
+
+static constexpr float BatchF2 = 0.366025403f;
+static constexpr float BatchG2 = 0.211324865f;
+static constexpr float BatchF3 = 0.333333333f;
+static constexpr float BatchG3 = 0.166666667f;
+
+template<class L>
+inline typename L::F grad2(typename L::I hash, typename L::F x, typename L::F y) {
+	const typename L::I h = L::iand(hash, 7);
+	const typename L::M low = L::ilt(h, 4);
+	const typename L::F u = L::select(low, x, y);
+	const typename L::F v = L::select(low, y, x);
+	const typename L::F v2 = L::add(v, v);
+	return L::add(L::select(L::itest(h, 1), L::neg(u), u), L::select(L::itest(h, 2), L::neg(v2), v2));
+}
+
+template<class L>
+inline typename L::F grad3(typename L::I hash, typename L::F x, typename L::F y, typename L::F z) {
+	const typename L::I h = L::iand(hash, 15);
+	const typename L::F u = L::select(L::ilt(h, 8), x, y);
+	const typename L::F v = L::select(L::ilt(h, 4), y, L::select(L::mor(L::ieq(h, 12), L::ieq(h, 14)), x, z));
+	return L::add(L::select(L::itest(h, 1), L::neg(u), u), L::select(L::itest(h, 2), L::neg(v), v));
+}
+
+template<class L>
+inline typename L::F falloff(typename L::F t, typename L::F g) {
+	const typename L::F t2 = L::mul(t, t);
+	return L::select(L::lt(t, L::zero()), L::zero(), L::mul(L::mul(t2, t2), g));
+}
+
+template<class L>
+inline typename L::F noise2(const int* perm, typename L::F x, typename L::F y) {
+	using F = typename L::F;
+	using I = typename L::I;
+	using M = typename L::M;
+
+	const F s = L::mul(L::add(x, y), L::set1(BatchF2));
+	const I i = L::ifloor(L::add(x, s));
+	const I j = L::ifloor(L::add(y, s));
+	const F t = L::mul(L::itof(L::iadd(i, j)), L::set1(BatchG2));
+	const F x0 = L::sub(x, L::sub(L::itof(i), t));
+	const F y0 = L::sub(y, L::sub(L::itof(j), t));
+
+	const M lower = L::gt(x0, y0);
+	const I i1 = L::mtoi(lower);
+	const I j1 = L::mtoi(L::mnot(lower));
+
+	const F g2 = L::set1(BatchG2);
+	const F x1 = L::add(L::sub(x0, L::itof(i1)), g2);
+	const F y1 = L::add(L::sub(y0, L::itof(j1)), g2);
+	const F lastOffset = L::set1(-1.0f + 2.0f * BatchG2);
+	const F x2 = L::add(x0, lastOffset);
+	const F y2 = L::add(y0, lastOffset);
+
+	const I ii = L::iand(i, 0xff);
+	const I jj = L::iand(j, 0xff);
+	const I one = L::iset1(1);
+
+	const I h0 = L::gather(perm, L::iadd(ii, L::gather(perm, jj)));
+	const I h1 = L::gather(perm, L::iadd(L::iadd(ii, i1), L::gather(perm, L::iadd(jj, j1))));
+	const I h2 = L::gather(perm, L::iadd(L::iadd(ii, one), L::gather(perm, L::iadd(jj, one))));
+
+	const F half = L::set1(0.5f);
+	const F n0 = falloff<L>(L::sub(L::sub(half, L::mul(x0, x0)), L::mul(y0, y0)), grad2<L>(h0, x0, y0));
+	const F n1 = falloff<L>(L::sub(L::sub(half, L::mul(x1, x1)), L::mul(y1, y1)), grad2<L>(h1, x1, y1));
+	const F n2 = falloff<L>(L::sub(L::sub(half, L::mul(x2, x2)), L::mul(y2, y2)), grad2<L>(h2, x2, y2));
+	return L::mul(L::set1(40.0f), L::add(L::add(n0, n1), n2));
+}
+
+template<class L>
+inline typename L::F noise3(const int* perm, typename L::F x, typename L::F y, typename L::F z) {
+	using F = typename L::F;
+	using I = typename L::I;
+	using M = typename L::M;
+
+	const F s = L::mul(L::add(L::add(x, y), z), L::set1(BatchF3));
+	const I i = L::ifloor(L::add(x, s));
+	const I j = L::ifloor(L::add(y, s));
+	const I k = L::ifloor(L::add(z, s));
+	const F t = L::mul(L::itof(L::iadd(L::iadd(i, j), k)), L::set1(BatchG3));
+	const F x0 = L::sub(x, L::sub(L::itof(i), t));
+	const F y0 = L::sub(y, L::sub(L::itof(j), t));
+	const F z0 = L::sub(z, L::sub(L::itof(k), t));
+
+	// the same simplex selection as the branches in noise::noise(const glm::vec3&)
+	const M xy = L::ge(x0, y0);
+	const M yz = L::ge(y0, z0);
+	const M xz = L::ge(x0, z0);
+	const I i1 = L::mtoi(L::mand(xy, L::mor(yz, xz)));
+	const I j1 = L::mtoi(L::mand(L::mnot(xy), yz));
+	const I k1 = L::mtoi(L::mand(L::mnot(yz), L::mor(L::mnot(xy), L::mnot(xz))));
+	const I i2 = L::mtoi(L::mor(xy, L::mand(yz, xz)));
+	const I j2 = L::mtoi(L::mor(L::mnot(xy), yz));
+	const I k2 = L::mtoi(L::mor(L::mnot(yz), L::mand(L::mnot(xy), L::mnot(xz))));
+
+	const F g3 = L::set1(BatchG3);
+	const F g32 = L::set1(2.0f * BatchG3);
+	const F x1 = L::add(L::sub(x0, L::itof(i1)), g3);
+	const F y1 = L::add(L::sub(y0, L::itof(j1)), g3);
+	const F z1 = L::add(L::sub(z0, L::itof(k1)), g3);
+	const F x2 = L::add(L::sub(x0, L::itof(i2)), g32);
+	const F y2 = L::add(L::sub(y0, L::itof(j2)), g32);
+	const F z2 = L::add(L::sub(z0, L::itof(k2)), g32);
+	const F lastOffset = L::set1(-1.0f + 3.0f * BatchG3);
+	const F x3 = L::add(x0, lastOffset);
+	const F y3 = L::add(y0, lastOffset);
+	const F z3 = L::add(z0, lastOffset);
+
+	const I ii = L::iand(i, 0xff);
+	const I jj = L::iand(j, 0xff);
+	const I kk = L::iand(k, 0xff);
+	const I one = L::iset1(1);
+
+	const I h0 = L::gather(perm, L::iadd(ii, L::gather(perm, L::iadd(jj, L::gather(perm, kk)))));
+	const I h1 = L::gather(perm, L::iadd(L::iadd(ii, i1), L::gather(perm, L::iadd(L::iadd(jj, j1), L::gather(perm, L::iadd(kk, k1))))));
+	const I h2 = L::gather(perm, L::iadd(L::iadd(ii, i2), L::gather(perm, L::iadd(L::iadd(jj, j2), L::gather(perm, L::iadd(kk, k2))))));
+	const I h3 = L::gather(perm, L::iadd(L::iadd(ii, one), L::gather(perm, L::iadd(L::iadd(jj, one), L::gather(perm, L::iadd(kk, one))))));
+
+	const F r = L::set1(0.6f);
+	const F n0 = falloff<L>(L::sub(L::sub(L::sub(r, L::mul(x0, x0)), L::mul(y0, y0)), L::mul(z0, z0)), grad3<L>(h0, x0, y0, z0));
+	const F n1 = falloff<L>(L::sub(L::sub(L::sub(r, L::mul(x1, x1)), L::mul(y1, y1)), L::mul(z1, z1)), grad3<L>(h1, x1, y1, z1));
+	const F n2 = falloff<L>(L::sub(L::sub(L::sub(r, L::mul(x2, x2)), L::mul(y2, y2)), L::mul(z2, z2)), grad3<L>(h2, x2, y2, z2));
+	const F n3 = falloff<L>(L::sub(L::sub(L::sub(r, L::mul(x3, x3)), L::mul(y3, y3)), L::mul(z3, z3)), grad3<L>(h3, x3, y3, z3));
+	return L::mul(L::set1(32.0f), L::add(L::add(L::add(n0, n1), n2), n3));
+}
+
+template<class L>
+inline typename L::F fBm2(const int* perm, typename L::F x, typename L::F y, uint8_t octaves, float lacunarity, float gain) {
+	typename L::F sum = L::zero();
+	float freq = 1.0f;
+	float amp = 0.5f;
+	for (uint8_t o = 0; o < octaves; ++o) {
+		const typename L::F f = L::set1(freq);
+		sum = L::add(sum, L::mul(noise2<L>(perm, L::mul(x, f), L::mul(y, f)), L::set1(amp)));
+		freq *= lacunarity;
+		amp *= gain;
+	}
+	return sum;
+}
+
+template<class L>
+inline typename L::F fBm3(const int* perm, typename L::F x, typename L::F y, typename L::F z, uint8_t octaves, float lacunarity, float gain) {
+	typename L::F sum = L::zero();
+	float freq = 1.0f;
+	float amp = 0.5f;
+	for (uint8_t o = 0; o < octaves; ++o) {
+		const typename L::F f = L::set1(freq);
+		sum = L::add(sum, L::mul(noise3<L>(perm, L::mul(x, f), L::mul(y, f), L::mul(z, f)), L::set1(amp)));
+		freq *= lacunarity;
+		amp *= gain;
+	}
+	return sum;
+}
+
+/**
+ * @brief Executes the given functor for all full lanes and pads the remaining positions with zeros
+ */
+template<class L, int N, class FUNC>
+inline void forEachLane(const float* const (&in)[N], float* out, int amount, FUNC&& func) {
+	int i = 0;
+	for (; i + L::Width <= amount; i += L::Width) {
+		typename L::F lanes[N];
+		for (int c = 0; c < N; ++c) {
+			lanes[c] = L::load(in[c] + i);
+		}
+		L::store(out + i, func(lanes));
+	}
+	const int remaining = amount - i;
+	if (remaining <= 0) {
+		return;
+	}
+	float buf[N][L::Width];
+	float result[L::Width];
+	typename L::F lanes[N];
+	for (int c = 0; c < N; ++c) {
+		memset(buf[c], 0, sizeof(buf[c]));
+		memcpy(buf[c], in[c] + i, remaining * sizeof(float));
+		lanes[c] = L::load(buf[c]);
+	}
+	L::store(result, func(lanes));
+	memcpy(out + i, result, remaining * sizeof(float));
+}
+
+template<class L>
+struct KernelImpl {
+	static void noise2(const int* perm, const float* x, const float* y, float* out, int amount) {
+		const float* const in[2] = {x, y};
+		forEachLane<L>(in, out, amount, [perm] (const typename L::F* v) {
+			return details::noise2<L>(perm, v[0], v[1]);
+		});
+	}
+
+	static void noise3(const int* perm, const float* x, const float* y, const float* z, float* out, int amount) {
+		const float* const in[3] = {x, y, z};
+		forEachLane<L>(in, out, amount, [perm] (const typename L::F* v) {
+			return details::noise3<L>(perm, v[0], v[1], v[2]);
+		});
+	}
+
+	static void fBm2(const int* perm, const float* x, const float* y, float* out, int amount, uint8_t octaves, float lacunarity, float gain) {
+		const float* const in[2] = {x, y};
+		forEachLane<L>(in, out, amount, [=] (const typename L::F* v) {
+			return details::fBm2<L>(perm, v[0], v[1], octaves, lacunarity, gain);
+		});
+	}
+
+	static void fBm3(const int* perm, const float* x, const float* y, const float* z, float* out, int amount, uint8_t octaves, float lacunarity, float gain) {
+		const float* const in[3] = {x, y, z};
+		forEachLane<L>(in, out, amount, [=] (const typename L::F* v) {
+			return details::fBm3<L>(perm, v[0], v[1], v[2], octaves, lacunarity, gain);
+		});
+	}
+
+	static const Kernels* kernels(const char* name) {
+		static const Kernels k = {name, noise2, noise3, fBm2, fBm3};
+		return &k;
+	}
+};
+
+}
+}
+}
@@ -0,0 +1,73 @@
+/**
+ * @file
+ * @note This file must be compiled with SSE4.1 support - see the CMakeLists.txt
+ */
+
+#include "SimplexBatchKernel.h"
+
+#if defined(__SSE4_1__) || (defined(_MSC_VER) && defined(_M_X64))
+#include <smmintrin.h>
+
+namespace noise {
+namespace batch {
+namespace details {
+
+struct LanesSSE41 {
+	using F = __m128;
+	using I = __m128i;
+	using M = __m128;
+	static constexpr int Width = 4;
+
+	static inline F load(const float* v) { return _mm_loadu_ps(v); }
+	static inline void store(float* v, F f) { _mm_storeu_ps(v, f); }
+	static inline F zero() { return _mm_setzero_ps(); }
+	static inline F set1(float v) { return _mm_set1_ps(v); }
+	static inline F add(F a, F b) { return _mm_add_ps(a, b); }
+	static inline F sub(F a, F b) { return _mm_sub_ps(a, b); }
+	static inline F mul(F a, F b) { return _mm_mul_ps(a, b); }
+	static inline F neg(F a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+	static inline M lt(F a, F b) { return _mm_cmplt_ps(a, b); }
+	static inline M gt(F a, F b) { return _mm_cmpgt_ps(a, b); }
+	static inline M ge(F a, F b) { return _mm_cmpge_ps(a, b); }
+	static inline M mand(M a, M b) { return _mm_and_ps(a, b); }
+	static inline M mor(M a, M b) { return _mm_or_ps(a, b); }
+	static inline M mnot(M a) { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+	static inline F select(M m, F a, F b) { return _mm_blendv_ps(b, a, m); }
+	static inline I mtoi(M m) { return _mm_and_si128(_mm_castps_si128(m), _mm_set1_epi32(1)); }
+	static inline I ifloor(F a) { return _mm_cvttps_epi32(_mm_floor_ps(a)); }
+	static inline F itof(I a) { return _mm_cvtepi32_ps(a); }
+	static inline I iset1(int v) { return _mm_set1_epi32(v); }
+	static inline I iadd(I a, I b) { return _mm_add_epi32(a, b); }
+	static inline I iand(I a, int b) { return _mm_and_si128(a, _mm_set1_epi32(b)); }
+	static inline M ieq(I a, int b) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, _mm_set1_epi32(b))); }
+	static inline M ilt(I a, int b) { return _mm_castsi128_ps(_mm_cmplt_epi32(a, _mm_set1_epi32(b))); }
+	static inline M itest(I a, int bit) { return mnot(ieq(iand(a, bit), 0)); }
+	static inline I gather(const int* table, I idx) {
+		return _mm_set_epi32(table[_mm_extract_epi32(idx, 3)], table[_mm_extract_epi32(idx, 2)],
+				table[_mm_extract_epi32(idx, 1)], table[_mm_extract_epi32(idx, 0)]);
+	}
+};
+
+const Kernels* kernelsSSE41() {
+	return KernelImpl<LanesSSE41>::kernels("sse4.1");
+}
+
+}
+}
+}
+
+#else
+
+namespace noise {
+namespace batch {
+namespace details {
+
+const Kernels* kernelsSSE41() {
+	return nullptr;
+}
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "noise/Simplex.h"
+#include "noise/SimplexBatch.h"
+#include "noise/SimplexBatchKernel.h"
+#include "core/GLM.h"
+#include <SDL_cpuinfo.h>
+#include <vector>
+
+namespace noise {
+
+class SimplexBatchTest: public core::AbstractTest {
+protected:
+	// not a multiple of the lane widths to also check the remaining positions
+	static constexpr int Amount = 1021;
+	std::vector<float> _x;
+	std::vector<float> _y;
+	std::vector<float> _z;
+	std::vector<int> _perm;
+
+	void SetUp() override {
+		core::AbstractTest::SetUp();
+		_x.resize(Amount);
+		_y.resize(Amount);
+		_z.resize(Amount);
+		for (int i = 0; i < Amount; ++i) {
+			_x[i] = (float)(i % 37) * 0.73f - 11.0f;
+			_y[i] = (float)(i / 37) * 0.37f - 3.1f;
+			_z[i] = (float)i * 0.011f - 5.0f;
+		}
+		_perm.resize(512);
+		for (int i = 0; i < 512; ++i) {
+			_perm[i] = noise::details::perm[i];
+		}
+	}
+
+	void compareKernels(const batch::details::Kernels* kernels) {
+		if (kernels == nullptr) {
+			return;
+		}
+		const batch::details::Kernels* scalar = batch::details::kernelsScalar();
+		std::vector<float> expected(Amount);
+		std::vector<float> actual(Amount);
+
+		scalar->fBm2(_perm.data(), _x.data(), _y.data(), expected.data(), Amount, 4, 2.0f, 0.5f);
+		kernels->fBm2(_perm.data(), _x.data(), _y.data(), actual.data(), Amount, 4, 2.0f, 0.5f);
+		for (int i = 0; i < Amount; ++i) {
+			ASSERT_EQ(expected[i], actual[i]) << kernels->name << " differs at " << i;
+		}
+
+		scalar->fBm3(_perm.data(), _x.data(), _y.data(), _z.data(), expected.data(), Amount, 4, 2.0f, 0.5f);
+		kernels->fBm3(_perm.data(), _x.data(), _y.data(), _z.data(), actual.data(), Amount, 4, 2.0f, 0.5f);
+		for (int i = 0; i < Amount; ++i) {
+			ASSERT_EQ(expected[i], actual[i]) << kernels->name << " differs at " << i;
+		}
+	}
+};
+
+TEST_F(SimplexBatchTest, testNoise2) {
+	std::vector<float> values(Amount);
+	batch::noise(_x.data(), _y.data(), values.data(), Amount);
+	for (int i = 0; i < Amount; ++i) {
+		ASSERT_NEAR(noise::noise(glm::vec2(_x[i], _y[i])), values[i], 0.0001f) << "with kernel " << batch::kernelName();
+	}
+}
+
+TEST_F(SimplexBatchTest, testNoise3) {
+	std::vector<float> values(Amount);
+	batch::noise(_x.data(), _y.data(), _z.data(), values.data(), Amount);
+	for (int i = 0; i < Amount; ++i) {
+		ASSERT_NEAR(noise::noise(glm::vec3(_x[i], _y[i], _z[i])), values[i], 0.0001f) << "with kernel " << batch::kernelName();
+	}
+}
+
+TEST_F(SimplexBatchTest, testfBm3) {
+	std::vector<float> values(Amount);
+	batch::fBm(_x.data(), _y.data(), _z.data(), values.data(), Amount, 3, 2.1f, 0.4f);
+	for (int i = 0; i < Amount; ++i) {
+		ASSERT_NEAR(noise::fBm(glm::vec3(_x[i], _y[i], _z[i]), 3, 2.1f, 0.4f), values[i], 0.0001f) << "with kernel " << batch::kernelName();
+	}
+}
+
+TEST_F(SimplexBatchTest, testKernelsSSE41) {
+	if (!SDL_HasSSE41()) {
+		return;
+	}
+	compareKernels(batch::details::kernelsSSE41());
+}
+
+TEST_F(SimplexBatchTest, testKernelsAVX2) {
+	if (!SDL_HasAVX2()) {
+		return;
+	}
+	compareKernels(batch::details::kernelsAVX2());
+}
+
+}
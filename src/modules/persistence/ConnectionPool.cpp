@@ -82,7 +82,12 @@ Connection* ConnectionPool::addConnection() {
 		return nullptr;
 	}
 
-	_connections.push(c);
+	if (!_connections.push(c)) {
+		Log::error("Too many connections - the pool can only hold %i", (int)_connections.capacity());
+		c->disconnect();
+		delete c;
+		return nullptr;
+	}
 	++_connectionAmount;
 	return c;
 }
@@ -91,7 +96,12 @@ void ConnectionPool::giveBack(Connection* c) {
 	if (c == nullptr) {
 		return;
 	}
-	_connections.push(c);
+	if (!_connections.push(c)) {
+		Log::error("Too many connections - the pool can only hold %i", (int)_connections.capacity());
+		c->disconnect();
+		--_connectionAmount;
+		delete c;
+	}
 }
 
 Connection* ConnectionPool::connection() {
@@ -7,7 +7,7 @@
 #include "Connection.h"
 #include "core/Var.h"
 #include "core/Trace.h"
-#include "core/collection/ConcurrentQueue.h"
+#include "core/collection/ConcurrentRingQueue.h"
 #include "core/IComponent.h"
 #include "core/concurrent/Atomic.h"
 
@@ -30,7 +30,7 @@ protected:
 	core::VarPtr _minConnections;
 	core::VarPtr _maxConnections;
 
-	core::ConcurrentQueue<Connection*> _connections;
+	core::ConcurrentRingQueue<Connection*> _connections;
 
 public:
 	ConnectionPool();
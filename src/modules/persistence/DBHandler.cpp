@@ -5,7 +5,10 @@
 #include "DBHandler.h"
 #include "core/Assert.h"
 #include "core/Log.h"
+#include "core/Common.h"
 #include "postgres/PQSymbol.h"
+#include <algorithm>
+#include <unordered_map>
 
 namespace persistence {
 
@@ -52,30 +55,91 @@ bool DBHandler::update(Model& model, const DBCondition& condition) const {
 }
 
 bool DBHandler::insert(Model& model) const {
-	BindParam param(10);
-	const core::String& query = createInsertStatement(model, &param);
-	return execInternalWithParameters(query, model, param).result;
+	ScopedConnection scoped(_connectionPool, connection());
+	if (!scoped) {
+		Log::error(logid, "Could not insert model - could not acquire connection");
+		return false;
+	}
+	const Model* models[] = { &model };
+	State s = execStatement(scoped.connection(), StatementType::Insert, models, 1u);
+	if (s.affectedRows <= 0) {
+		Log::trace(logid, "No rows affected, can't fill model values");
+		return s.result;
+	}
+	model.fillModelValues(s);
+	return s.result;
 }
 
 bool DBHandler::insert(Model&& model) const {
-	BindParam param(10);
-	const core::String& query = createInsertStatement(model, &param);
-	return execInternalWithParameters(query, model, param).result;
+	return insert(model);
 }
 
 bool DBHandler::insert(std::vector<const Model*>& models) const {
-	BindParam param(10 * models.size());
-	const core::String& query = createInsertStatement(models, &param);
-	return execInternalWithParameters(query, param).result;
+	return persist(models, {});
 }
 
 bool DBHandler::deleteModels(std::vector<const Model*>& models) const {
+	return persist({}, models);
+}
+
+static bool sameColumns(const Model& a, const Model& b) {
+	if (&a.fields() != &b.fields()) {
+		return false;
+	}
+	for (const Field& f : a.fields()) {
+		if (a.isValid(f) != b.isValid(f)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool DBHandler::persist(const std::vector<const Model*>& insertOrUpdate, const std::vector<const Model*>& toDelete) const {
+	if (insertOrUpdate.empty() && toDelete.empty()) {
+		return true;
+	}
+	ScopedConnection scoped(_connectionPool, connection());
+	if (!scoped) {
+		Log::error(logid, "Could not persist %i models - could not acquire connection", (int)(insertOrUpdate.size() + toDelete.size()));
+		return false;
+	}
+	Connection* c = scoped.connection();
+	if (!execOnConnection(c, createTransactionBegin())) {
+		return false;
+	}
+	// group the models by table to combine them into multi row statements - the tables keep the order
+	// in which they were first enqueued, this keeps e.g. the foreign key dependencies intact
+	std::unordered_map<const Fields*, size_t> tableOrder;
+	tableOrder.reserve(insertOrUpdate.size());
+	for (const Model* model : insertOrUpdate) {
+		tableOrder.emplace(&model->fields(), tableOrder.size());
+	}
+	std::vector<const Model*> sorted(insertOrUpdate);
+	std::stable_sort(sorted.begin(), sorted.end(), [&tableOrder] (const Model* a, const Model* b) {
+		return tableOrder.find(&a->fields())->second < tableOrder.find(&b->fields())->second;
+	});
 	bool state = true;
-	// TODO: prepared statement
-	for (const Model* m : models) {
-		state &= deleteModel(*m);
+	std::vector<const Model*> batch;
+	batch.reserve(sorted.size());
+	for (size_t i = 0u; i < sorted.size() && state;) {
+		batch.clear();
+		batch.push_back(sorted[i++]);
+		while (i < sorted.size() && sameColumns(*batch.front(), *sorted[i])) {
+			batch.push_back(sorted[i++]);
+		}
+		for (size_t offset = 0u; offset < batch.size() && state; offset += MaxRowsPerStatement) {
+			const size_t amount = core_min(MaxRowsPerStatement, batch.size() - offset);
+			state = execStatement(c, StatementType::Insert, &batch[offset], amount).result;
+		}
+	}
+	for (size_t i = 0u; i < toDelete.size() && state; ++i) {
+		state = execStatement(c, StatementType::Delete, &toDelete[i], 1u).result;
 	}
-	return state;
+	if (!state) {
+		execOnConnection(c, createTransactionRollback());
+		return false;
+	}
+	return execOnConnection(c, createTransactionCommit());
 }
 
 bool DBHandler::truncate(const Model& model) const {
@@ -241,6 +305,89 @@ State DBHandler::execInternalWithParameters(const core::String& query, Model& mo
 	return s;
 }
 
+bool DBHandler::execOnConnection(Connection* connection, const core::String& query, const BindParam* param) const {
+	State s(connection);
+	Log::debug(logid, "Execute query '%s'", query.c_str());
+	if (param == nullptr) {
+		if (!s.exec(query.c_str())) {
+			Log::warn(logid, "Failed to execute query: '%s'", query.c_str());
+			return false;
+		}
+		return true;
+	}
+	if (!s.exec(query.c_str(), param->position, &param->values[0], &param->lengths[0], &param->formats[0])) {
+		Log::warn(logid, "Failed to execute query: '%s'", query.c_str());
+		return false;
+	}
+	return true;
+}
+
+core::String DBHandler::createStatement(StatementType type, const Model* const* models, size_t amount) {
+	if (type == StatementType::Delete) {
+		core_assert(amount == 1u);
+		return createDeleteStatement(*models[0]);
+	}
+	const std::vector<const Model*> rows(models, models + amount);
+	return createInsertStatement(rows);
+}
+
+State DBHandler::execStatement(Connection* connection, StatementType type, const Model* const* models, size_t amount) const {
+	core_assert(amount > 0u);
+	const Model& model = *models[0];
+	core::String key;
+	key += type == StatementType::Insert ? "insert:" : "delete:";
+	key += model.schema();
+	key += ".";
+	key += model.tableName();
+	BindParam param((int)(model.fields().size() * amount));
+	for (size_t i = 0u; i < amount; ++i) {
+		key += ":";
+		createStatementKey(*models[i], key);
+		if (type == StatementType::Insert) {
+			createInsertParameters(*models[i], param);
+		} else {
+			createDeleteParameters(*models[i], param);
+		}
+	}
+
+	// the entries are never removed - the pointer stays valid after the lock is released
+	const PreparedStatement* statement = nullptr;
+	{
+		core::ScopedLock lock(_statementLock);
+		auto i = _statements.find(key);
+		if (i != _statements.end()) {
+			statement = &i->second;
+		} else if (_statements.size() < MaxPreparedStatements) {
+			PreparedStatement stmt;
+			stmt.name = core::string::format("stmt%i", (int)_statements.size());
+			stmt.query = createStatement(type, models, amount);
+			statement = &_statements.emplace(key, stmt).first->second;
+		}
+	}
+
+	State s(connection);
+	if (statement == nullptr) {
+		const core::String& query = createStatement(type, models, amount);
+		Log::debug(logid, "Execute unprepared query '%s' with %i parameters", query.c_str(), param.position);
+		if (!s.exec(query.c_str(), param.position, &param.values[0], &param.lengths[0], &param.formats[0])) {
+			Log::warn(logid, "Failed to execute query: '%s'", query.c_str());
+		}
+		return s;
+	}
+	if (!connection->hasPreparedStatement(statement->name)) {
+		State prepareState(connection);
+		if (!prepareState.prepare(statement->name.c_str(), statement->query.c_str(), param.position)) {
+			Log::warn(logid, "Failed to prepare query: '%s'", statement->query.c_str());
+			return prepareState;
+		}
+	}
+	Log::debug(logid, "Execute prepared query '%s' with %i parameters", statement->name.c_str(), param.position);
+	if (!s.execPrepared(statement->name.c_str(), param.position, &param.values[0], &param.lengths[0], &param.formats[0])) {
+		Log::warn(logid, "Failed to execute prepared query: '%s'", statement->query.c_str());
+	}
+	return s;
+}
+
 State DBHandler::execInternalWithParameters(const core::String& query, const BindParam& param) const {
 	ScopedConnection scoped(_connectionPool, connection());
 	if (!scoped) {
@@ -21,8 +21,10 @@
 #include "SQLGenerator.h"
 #include "DBCondition.h"
 #include "OrderBy.h"
+#include "core/concurrent/Lock.h"
 #include <memory>
 #include <vector>
+#include <unordered_map>
 
 namespace persistence {
 
@@ -41,6 +43,40 @@ private:
 	State execInternalWithParameters(const core::String& query, Model& model, const BindParam& param) const;
 	State execInternalWithCondition(const core::String& query, BindParam& params, int conditionOffset, const DBCondition& condition) const;
 	State execInternalWithParameters(const core::String& query, const BindParam& param) const;
+	/**
+	 * @brief Executes the query on the given connection - used to execute several statements in one transaction
+	 */
+	bool execOnConnection(Connection* connection, const core::String& query, const BindParam* param = nullptr) const;
+
+	/**
+	 * @brief The max amount of rows that are written in one multi row insert statement
+	 */
+	static constexpr size_t MaxRowsPerStatement = 128u;
+	/**
+	 * @brief The max amount of cached statements - other statements are executed without preparing them
+	 */
+	static constexpr size_t MaxPreparedStatements = 1024u;
+
+	enum class StatementType : uint8_t {
+		Insert, Delete
+	};
+
+	struct PreparedStatement {
+		core::String name;
+		core::String query;
+	};
+
+	mutable core::Lock _statementLock;
+	// the statements are keyed by the operation, the table and the valid and null fields of the models. The
+	// connections prepare them on first use.
+	mutable std::unordered_map<core::String, PreparedStatement, core::StringHash> _statements;
+
+	static core::String createStatement(StatementType type, const Model* const* models, size_t amount);
+	/**
+	 * @brief Executes the insert or delete statement for the given models as prepared statement on the given connection
+	 * @note The models must be of the same table and must have the same valid fields
+	 */
+	State execStatement(Connection* connection, StatementType type, const Model* const* models, size_t amount) const;
 
 	mutable ConnectionPool _connectionPool;
 
@@ -210,6 +246,11 @@ public:
 
 	bool insert(Model&& model) const;
 
+	/**
+	 * @brief Inserts or updates the models in one transaction. Models of the same table with the same valid fields
+	 * are written with multi row statements.
+	 * @see persist()
+	 */
 	bool insert(std::vector<const Model*>& models) const;
 
 	template<class MODEL>
@@ -224,17 +265,29 @@ public:
 
 	template<class MODEL>
 	bool deleteModels(std::vector<MODEL>& models) const {
-		// TODO: prepared statement
-		for (auto& m : models) {
-			if (!deleteModel(m)) {
-				return false;
-			}
+		std::vector<const Model*> converted(models.size());
+		const size_t size = models.size();
+		for (size_t i = 0u; i < size; ++i) {
+			converted[i] = &models[i];
 		}
-		return true;
+		return deleteModels(converted);
 	}
 
+	/**
+	 * @brief Deletes the models in one transaction
+	 * @see persist()
+	 */
 	bool deleteModels(std::vector<const Model*>& models) const;
 
+	/**
+	 * @brief Inserts (or updates) and deletes the given models in one transaction on one connection. Models of the
+	 * same table with the same set of valid fields are written in multi row statements. All statements are
+	 * executed as cached prepared statements.
+	 * @note The models must not contain the same database entry twice - merge them before.
+	 * @return @c true if the transaction was committed, @c false if it was rolled back.
+	 */
+	bool persist(const std::vector<const Model*>& insertOrUpdate, const std::vector<const Model*>& toDelete) const;
+
 	/**
 	 * @brief Truncate the table for the given @c persistence::Model
 	 * @param[in] model The model that identifies the table that should be truncated
@@ -34,11 +34,11 @@ void MassQuery::commit() {
 
 void MassQuery::add(ISavable* savable) {
 	core_assert(savable != nullptr);
-	std::vector<const Model*> models;
-	if (!savable->getDirtyModels(models)) {
+	_models.clear();
+	if (!savable->getDirtyModels(_models)) {
 		return;
 	}
-	for (const Model* m : models) {
+	for (const Model* m : _models) {
 		if (m->shouldBeDeleted()) {
 			_delete.push_back(m);
 		} else {
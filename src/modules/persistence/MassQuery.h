@@ -22,6 +22,8 @@ private:
 	const size_t _commitSize;
 	std::vector<const Model*> _insertOrUpdate;
 	std::vector<const Model*> _delete;
+	// the dirty models of the savable that is currently added - kept to reuse the capacity
+	std::vector<const Model*> _models;
 	friend class DBHandler;
 	MassQuery(const DBHandler* dbHandler, size_t amount = 1000);
 
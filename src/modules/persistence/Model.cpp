@@ -9,6 +9,7 @@
 #include "core/Singleton.h"
 #include "core/Assert.h"
 #include <algorithm>
+#include <SDL_stdinc.h>
 
 namespace persistence {
 
@@ -163,4 +164,136 @@ bool Model::isNull(const Field& f) const {
 	return *targetValue;
 }
 
+void Model::copyValue(const Field& f, const Model& source) {
+	core_assert(f.offset >= 0);
+	uint8_t* target = _membersPointer + f.offset;
+	const uint8_t* src = source._membersPointer + f.offset;
+	switch (f.type) {
+	case FieldType::STRING:
+	case FieldType::TEXT:
+	case FieldType::PASSWORD:
+		*(core::String*)target = *(const core::String*)src;
+		break;
+	case FieldType::TIMESTAMP:
+		*(Timestamp*)target = *(const Timestamp*)src;
+		break;
+	case FieldType::BLOB:
+		*(Blob*)target = *(const Blob*)src;
+		break;
+	case FieldType::LONG:
+		*(int64_t*)target = *(const int64_t*)src;
+		break;
+	case FieldType::INT:
+		*(int32_t*)target = *(const int32_t*)src;
+		break;
+	case FieldType::SHORT:
+		*(int16_t*)target = *(const int16_t*)src;
+		break;
+	case FieldType::BYTE:
+		*(uint8_t*)target = *(const uint8_t*)src;
+		break;
+	case FieldType::BOOLEAN:
+		*(bool*)target = *(const bool*)src;
+		break;
+	case FieldType::DOUBLE:
+		*(double*)target = *(const double*)src;
+		break;
+	case FieldType::MAX:
+		break;
+	}
+	setIsNull(f, source.isNull(f));
+	setValid(f, true);
+}
+
+bool Model::addValue(const Field& f, const Model& source) {
+	core_assert(f.offset >= 0);
+	uint8_t* target = _membersPointer + f.offset;
+	const uint8_t* src = source._membersPointer + f.offset;
+	switch (f.type) {
+	case FieldType::LONG:
+		*(int64_t*)target += *(const int64_t*)src;
+		return true;
+	case FieldType::INT:
+		*(int32_t*)target += *(const int32_t*)src;
+		return true;
+	case FieldType::SHORT:
+		*(int16_t*)target += *(const int16_t*)src;
+		return true;
+	case FieldType::DOUBLE:
+		*(double*)target += *(const double*)src;
+		return true;
+	default:
+		break;
+	}
+	return false;
+}
+
+void Model::merge(const Model& newer) {
+	core_assert(_s == newer._s);
+	// relative updates can't be added to a deleted row
+	const bool deleted = _flagToDelete;
+	_flagToDelete = newer._flagToDelete;
+	for (const Field& f : fields()) {
+		if (!newer.isValid(f)) {
+			continue;
+		}
+		const bool relative = f.updateOperator == Operator::ADD || f.updateOperator == Operator::SUBTRACT;
+		if (relative && !deleted && !_flagToDelete && isValid(f) && !isNull(f) && !newer.isNull(f) && addValue(f, newer)) {
+			continue;
+		}
+		copyValue(f, newer);
+	}
+}
+
+core::String Model::primaryKeyValues() const {
+	core::String key = schema();
+	key += ".";
+	key += tableName();
+	char buf[64];
+	for (const Field& f : fields()) {
+		if (!f.isPrimaryKey()) {
+			continue;
+		}
+		key += "|";
+		if (!isValid(f)) {
+			// not set - e.g. an auto increment key - this can't be matched with other models
+			SDL_snprintf(buf, sizeof(buf), "%p", (const void*)this);
+			key += buf;
+			continue;
+		}
+		const uint8_t* src = _membersPointer + f.offset;
+		switch (f.type) {
+		case FieldType::STRING:
+		case FieldType::TEXT:
+		case FieldType::PASSWORD:
+			key += *(const core::String*)src;
+			continue;
+		case FieldType::LONG:
+			SDL_snprintf(buf, sizeof(buf), "%lld", (long long)*(const int64_t*)src);
+			break;
+		case FieldType::INT:
+			SDL_snprintf(buf, sizeof(buf), "%i", (int)*(const int32_t*)src);
+			break;
+		case FieldType::SHORT:
+			SDL_snprintf(buf, sizeof(buf), "%i", (int)*(const int16_t*)src);
+			break;
+		case FieldType::BYTE:
+			SDL_snprintf(buf, sizeof(buf), "%i", (int)*(const uint8_t*)src);
+			break;
+		case FieldType::BOOLEAN:
+			SDL_snprintf(buf, sizeof(buf), "%i", *(const bool*)src ? 1 : 0);
+			break;
+		case FieldType::TIMESTAMP:
+			SDL_snprintf(buf, sizeof(buf), "%llu", (unsigned long long)((const Timestamp*)src)->seconds());
+			break;
+		default:
+			// doubles and blobs are no sane primary keys
+			SDL_snprintf(buf, sizeof(buf), "%p", (const void*)this);
+			break;
+		}
+		key += buf;
+	}
+	return key;
+}
+
 }
@@ -63,10 +63,40 @@ protected:
 	 */
 	bool fillModelValues(State& state);
 
+	/**
+	 * @brief Copies the value, the null and the valid state of the field from the given model
+	 */
+	void copyValue(const Field& f, const Model& source);
+	/**
+	 * @brief Adds the value of the field from the given model - only for the numeric field types
+	 * @return @c false if the field type doesn't support this
+	 */
+	bool addValue(const Field& f, const Model& source);
+
 public:
 	Model(const Meta* s);
 	virtual ~Model();
 
+	/**
+	 * @brief Creates a copy of the model including the delete flag. The memory ownership is given to the caller.
+	 * @note Used to snapshot the models of an @c ISavable for the write-behind in the @c PersistenceMgr
+	 */
+	virtual Model* clone() const = 0;
+
+	/**
+	 * @brief Merges a newer state of the same database entry into this model. The valid fields of the given model
+	 * overwrite the values of this model - except for relative updates (see @c Operator::ADD and
+	 * @c Operator::SUBTRACT), the deltas are summed up in that case.
+	 * @note Both models must belong to the same table and must have the same primary key values.
+	 */
+	void merge(const Model& newer);
+
+	/**
+	 * @return A string that identifies the database entry of this model by the table and the primary key values.
+	 * Two models with the same key are updating the same row.
+	 */
+	core::String primaryKeyValues() const;
+
 	/**
 	 * @return The table name without schema
 	 * @see schema()
@@ -4,14 +4,42 @@
 
 #include "PersistenceMgr.h"
 #include "DBHandler.h"
-#include "MassQuery.h"
+#include "Model.h"
 #include "core/Common.h"
 #include "core/Trace.h"
+#include "core/concurrent/Concurrency.h"
+#include <SDL_timer.h>
 
 namespace persistence {
 
-PersistenceMgr::PersistenceMgr(const DBHandlerPtr& dbHandler) :
-		_lock("persistencemgr"), _dbHandler(dbHandler) {
+PersistenceMgr::PersistenceMgr(const DBHandlerPtr& dbHandler, const metric::MetricPtr& metric) :
+		_lock("persistencemgr"), _dbHandler(dbHandler), _metric(metric) {
+	if (_metric) {
+		_queueSize = _metric->registerGauge("persistence_queue_size");
+		_mergedModels = _metric->registerCounter("persistence_merged_models");
+		_writtenModels = _metric->registerCounter("persistence_written_models");
+		_failedModels = _metric->registerCounter("persistence_failed_models");
+		_writeMillis = _metric->registerHistogram("persistence_write_millis");
+	}
+}
+
+PersistenceMgr::~PersistenceMgr() {
+	// the savables might already be gone - but the snapshots that were already queued are written
+	stopWorker();
+	flush();
+}
+
+void PersistenceMgr::stopWorker() {
+	if (!_worker.joinable()) {
+		return;
+	}
+	{
+		core::ScopedLock lock(_queueLock);
+		_stop = true;
+		_queueCondition.signalAll();
+	}
+	// the worker writes the remaining snapshots before it quits
+	_worker.join();
 }
 
 bool PersistenceMgr::registerSavable(uint32_t fourcc, ISavable *savable) {
@@ -33,10 +61,16 @@ bool PersistenceMgr::unregisterSavable(uint32_t fourcc, ISavable *savable) {
 	auto s = i->second.find(savable);
 	if (s != i->second.end()) {
 		i->second.erase(s);
-		// make sure to persist the dirty state
-		MassQuery stmt = _dbHandler->massQuery();
-		stmt.add(savable);
-		stmt.commit();
+		// make sure to persist the dirty state - the snapshot outlives the savable
+		{
+			core::ScopedLock queueLock(_queueLock);
+			enqueue(savable);
+		}
+		if (!_worker.joinable()) {
+			flush();
+		} else {
+			_queueCondition.signalOne();
+		}
 		Log::trace(logid, "Removed savable (fourcc: %u, savable: %p)", fourcc, savable);
 		return true;
 	}
@@ -45,30 +79,148 @@ bool PersistenceMgr::unregisterSavable(uint32_t fourcc, ISavable *savable) {
 }
 
 bool PersistenceMgr::init() {
+	core::ScopedLock lock(_queueLock);
+	if (!_worker.joinable()) {
+		_stop = false;
+		_worker = std::thread(&PersistenceMgr::workerLoop, this);
+	}
 	return true;
 }
 
 void PersistenceMgr::shutdown() {
 	core_trace_scoped(PersistenceMgrShutdown);
 	update(0l);
+	stopWorker();
+	// if the worker was never started
+	flush();
 	core::ScopedWriteLock lock(_lock);
 	_savables.clear();
 }
 
+void PersistenceMgr::enqueue(ISavable* savable) {
+	_dirtyModels.clear();
+	if (!savable->getDirtyModels(_dirtyModels)) {
+		return;
+	}
+	for (const Model* model : _dirtyModels) {
+		_queue.push_back(model->clone());
+	}
+}
+
 void PersistenceMgr::update(long dt) {
 	core_trace_scoped(PersistenceMgrUpdate);
-	core::ScopedReadLock lock(_lock);
-	for (auto& collection : _savables) {
-		if (collection.second.empty()) {
+	size_t queueSize;
+	{
+		core::ScopedReadLock lock(_lock);
+		core::ScopedLock queueLock(_queueLock);
+		for (auto& collection : _savables) {
+			for (ISavable *savable : collection.second) {
+				enqueue(savable);
+			}
+		}
+		queueSize = _queue.size();
+	}
+	Log::debug(logid, "Queued dirty states of %i savable types (%i models queued)", (int)_savables.size(), (int)queueSize);
+	if (_metric) {
+		_metric->gauge(_queueSize, (uint32_t)queueSize);
+	}
+	if (queueSize >= QueueWarnSize) {
+		Log::warn(logid, "The database can't keep up - %i models are queued", (int)queueSize);
+	}
+	if (!_worker.joinable()) {
+		flush();
+		return;
+	}
+	_queueCondition.signalOne();
+}
+
+void PersistenceMgr::flush() {
+	if (!_worker.joinable()) {
+		// no worker - write on the calling thread
+		std::vector<Model*> snapshots;
+		{
+			core::ScopedLock lock(_queueLock);
+			snapshots.swap(_queue);
+		}
+		write(snapshots);
+		return;
+	}
+	core::ScopedLock lock(_queueLock);
+	// the snapshots that are queued now are picked up by the next write of the worker
+	const uint64_t target = _queue.empty() ? _queued : _queued + 1u;
+	_queueCondition.signalOne();
+	while (_written < target && _worker.joinable()) {
+		_flushedCondition.wait(_queueLock);
+	}
+}
+
+void PersistenceMgr::workerLoop() {
+	core::setThreadName("persistence");
+	core_trace_thread("PersistenceMgr");
+	std::vector<Model*> snapshots;
+	core::ScopedLock lock(_queueLock);
+	for (;;) {
+		if (_queue.empty()) {
+			if (_stop) {
+				break;
+			}
+			_queueCondition.wait(_queueLock);
+			continue;
+		}
+		snapshots.swap(_queue);
+		++_queued;
+		_queueLock.unlock();
+		write(snapshots);
+		snapshots.clear();
+		_queueLock.lock();
+		_written = _queued;
+		_flushedCondition.signalAll();
+	}
+	_flushedCondition.signalAll();
+}
+
+void PersistenceMgr::write(std::vector<Model*>& snapshots) {
+	if (snapshots.empty()) {
+		return;
+	}
+	core_trace_scoped(PersistenceMgrWrite);
+	const uint64_t start = SDL_GetTicks();
+	// merge the snapshots of the same database entry - the order of the first occurrence is kept
+	std::unordered_map<core::String, Model*, core::StringHash> merged;
+	merged.reserve(snapshots.size());
+	Models insertOrUpdate;
+	Models toDelete;
+	std::vector<Model*> unique;
+	unique.reserve(snapshots.size());
+	for (Model* model : snapshots) {
+		auto result = merged.emplace(model->primaryKeyValues(), model);
+		if (!result.second) {
+			result.first->second->merge(*model);
+			delete model;
 			continue;
 		}
-		MassQuery stmt = _dbHandler->massQuery();
-		for (ISavable *savable : collection.second) {
-			stmt.add(savable);
+		unique.push_back(model);
+	}
+	for (const Model* model : unique) {
+		if (model->shouldBeDeleted()) {
+			toDelete.push_back(model);
+		} else {
+			insertOrUpdate.push_back(model);
 		}
-		stmt.commit();
 	}
-	Log::debug(logid, "Persisted dirty states of %i savables", (int)_savables.size());
+	const bool success = _dbHandler->persist(insertOrUpdate, toDelete);
+	if (!success) {
+		Log::error(logid, "Failed to persist %i models", (int)unique.size());
+	}
+	if (_metric) {
+		_metric->count(_mergedModels, (int)(snapshots.size() - unique.size()));
+		_metric->count(success ? _writtenModels : _failedModels, (int)unique.size());
+		_metric->histogram(_writeMillis, (uint32_t)(SDL_GetTicks() - start));
+	}
+	for (Model* model : unique) {
+		delete model;
+	}
+	snapshots.clear();
 }
 
 }
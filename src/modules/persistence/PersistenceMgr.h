@@ -6,41 +6,107 @@
 
 #include <memory>
 #include <map>
+#include <unordered_map>
 #include <unordered_set>
+#include <thread>
+#include <vector>
 #include "ISavable.h"
 #include "DBHandler.h"
 #include "core/IComponent.h"
 #include "core/concurrent/ReadWriteLock.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/metric/Metric.h"
 
 namespace persistence {
 
 /**
  * @brief This class is responsible for calling the update mechanisms for the single components of each player.
  * It will collect all database actions in prepared statements to write delta values into the database.
+ *
+ * The database is written behind: @c update() only snapshots the dirty models of the registered @c ISavable
+ * instances into a queue. A worker thread merges the snapshots of the same database entry and writes them in
+ * one transaction. @c shutdown() and @c flush() wait until everything that was queued is written.
+ *
  * @note Your @c ISavable instances must be registered and unregistered.
  */
 class PersistenceMgr : public core::IComponent {
 private:
 	static constexpr uint32_t logid = FourCC('P','E','R','M');
+	/**
+	 * @brief The amount of queued models that is considered as backpressure - the database is slower than the
+	 * models get dirty.
+	 */
+	static constexpr size_t QueueWarnSize = 10000u;
 	using Savables = std::unordered_set<ISavable*>;
 	using Map = std::map<uint32_t, Savables>;
+	using Models = std::vector<const Model*>;
 	Map _savables;
 	core::ReadWriteLock _lock;
 	const DBHandlerPtr _dbHandler;
+	const metric::MetricPtr _metric;
+	metric::MetricHandle _queueSize;
+	metric::MetricHandle _mergedModels;
+	metric::MetricHandle _writtenModels;
+	metric::MetricHandle _failedModels;
+	metric::MetricHandle _writeMillis;
+
+	// the models that are handed over from getDirtyModels() - only used under the _queueLock
+	Models _dirtyModels;
+
+	core::Lock _queueLock;
+	core::ConditionVariable _queueCondition;
+	core::ConditionVariable _flushedCondition;
+	// the snapshots of the dirty models - owned by the queue until the worker wrote them
+	std::vector<Model*> _queue;
+	// the amount of queues the worker picked up and the amount it has written - flush() waits for the write
+	// that picked up its snapshots
+	uint64_t _queued = 0u;
+	uint64_t _written = 0u;
+	bool _stop = false;
+	std::thread _worker;
+
+	/**
+	 * @brief Snapshots the dirty models of the given savable into the queue
+	 * @note The caller must hold the @c _queueLock
+	 */
+	void enqueue(ISavable* savable);
+	void workerLoop();
+	/**
+	 * @brief Stops the worker thread after it wrote the queued snapshots
+	 */
+	void stopWorker();
+	/**
+	 * @brief Merges the snapshots of the same database entry and writes them in one transaction
+	 */
+	void write(std::vector<Model*>& snapshots);
 public:
-	PersistenceMgr(const DBHandlerPtr& dbHandler);
-	virtual ~PersistenceMgr() {}
+	PersistenceMgr(const DBHandlerPtr& dbHandler, const metric::MetricPtr& metric = metric::MetricPtr());
+	virtual ~PersistenceMgr();
 
 	virtual bool registerSavable(uint32_t fourcc, ISavable *savable);
 	virtual bool unregisterSavable(uint32_t fourcc, ISavable *savable);
 
+	/**
+	 * @brief Starts the worker thread that writes the queued models
+	 */
 	bool init() override;
 	/**
+	 * @brief Snapshots the remaining dirty models and waits until all of them are written.
 	 * @note You have to make sure, that the update is not called anymore and also not called currently.
 	 */
 	void shutdown() override;
 
+	/**
+	 * @brief Snapshots the dirty models of all registered savables. This doesn't touch the database if the
+	 * worker thread is running - otherwise the models are written directly.
+	 */
 	void update(long dt);
+
+	/**
+	 * @brief Blocks until all models that were queued before this call are written
+	 */
+	void flush();
 };
 
 typedef std::shared_ptr<PersistenceMgr> PersistenceMgrPtr;
@@ -58,6 +58,20 @@ static inline void createSequenceIdentifier(core::String& stmt, const Model& tab
 	stmt += "_seq\"";
 }
 
+/**
+ * @return @c true if the @c placeholder() for the field adds a parameter
+ */
+static inline bool hasPlaceholder(const Model& table, const Field& field) {
+	if (table.isNull(field)) {
+		return false;
+	}
+	if (field.type == FieldType::TIMESTAMP) {
+		const Timestamp& ts = table.getValue<Timestamp>(field);
+		return !ts.isNow();
+	}
+	return true;
+}
+
 static inline bool placeholder(const Model& table, const Field& field, core::String& ss, int count, bool select) {
 	if (table.isNull(field)) {
 		core_assert(!field.isNotNull());
@@ -900,6 +914,38 @@ core::String createInsertStatement(const Model& model, BindParam* params, int* p
 	return createInsertStatement({&model}, params, parameterCount);
 }
 
+void createInsertParameters(const Model& model, BindParam& params) {
+	for (const persistence::Field& f : model.fields()) {
+		if (!model.isValid(f) || !hasPlaceholder(model, f)) {
+			continue;
+		}
+		params.push(model, f);
+	}
+}
+
+void createDeleteParameters(const Model& model, BindParam& params) {
+	for (const persistence::Field& f : model.fields()) {
+		if (!model.isValid(f) || !f.isPrimaryKey() || !hasPlaceholder(model, f)) {
+			continue;
+		}
+		params.push(model, f);
+	}
+}
+
+void createStatementKey(const Model& model, core::String& key) {
+	for (const persistence::Field& f : model.fields()) {
+		if (!model.isValid(f)) {
+			key += '-';
+		} else if (model.isNull(f)) {
+			key += 'n';
+		} else if (!hasPlaceholder(model, f)) {
+			key += 't';
+		} else {
+			key += 'v';
+		}
+	}
+}
+
 // https://www.postgresql.org/docs/current/static/functions-formatting.html
 // https://www.postgresql.org/docs/current/static/functions-datetime.html
 core::String createSelect(const Model& model, BindParam* params) {
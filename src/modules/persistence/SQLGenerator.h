@@ -28,6 +28,20 @@ extern core::String createInsertBaseStatement(const Model& table, bool& primaryK
 extern core::String createInsertValuesStatement(const Model& table, BindParam* params, int& insertValueIndex);
 extern core::String createInsertStatement(const Model& model, BindParam* params = nullptr, int* parameterCount = nullptr);
 extern core::String createInsertStatement(const std::vector<const Model*>& tables, BindParam* params = nullptr, int* parameterCount = nullptr);
+/**
+ * @brief Pushes the parameters of the model in the order of the placeholders of @c createInsertStatement() - used to
+ * execute a cached prepared statement without generating the sql again
+ */
+extern void createInsertParameters(const Model& model, BindParam& params);
+/**
+ * @brief Pushes the parameters of the model in the order of the placeholders of @c createDeleteStatement()
+ */
+extern void createDeleteParameters(const Model& model, BindParam& params);
+/**
+ * @brief Appends everything of the model to the given key that has an influence on the generated insert and delete
+ * statements. Models with the same key get the same statement.
+ */
+extern void createStatementKey(const Model& model, core::String& key);
 
 extern core::String createSelect(const Model& model, BindParam* params = nullptr);
 extern const char* createTransactionBegin();
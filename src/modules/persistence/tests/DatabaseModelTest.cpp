@@ -368,4 +368,33 @@ TEST_F(DatabaseModelTest, testNullField) {
 	ASSERT_TRUE(_dbHandler.update(mdl));
 }
 
+TEST_F(DatabaseModelTest, testMerge) {
+	db::TestModel older = m("foo@b.ar", "123");
+	older.setId(1);
+	older.setPoints(5);
+	db::TestModel newer;
+	newer.setId(1);
+	newer.setEmail("bar@b.ar");
+	newer.setPoints(-2);
+	EXPECT_EQ(older.primaryKeyValues(), newer.primaryKeyValues());
+	older.merge(newer);
+	EXPECT_EQ("bar@b.ar", older.email());
+	EXPECT_EQ("123", older.password()) << "Fields that are not valid in the newer model must be kept";
+	ASSERT_NE(nullptr, older.points());
+	EXPECT_EQ(3, *older.points()) << "Relative updates must be summed up";
+}
+
+TEST_F(DatabaseModelTest, testClone) {
+	db::TestModel mdl = m("foo@b.ar", "123");
+	mdl.setId(2);
+	mdl.flagForDelete();
+	Model* clone = mdl.clone();
+	EXPECT_TRUE(clone->shouldBeDeleted());
+	EXPECT_EQ(mdl.primaryKeyValues(), clone->primaryKeyValues());
+	db::TestModel other;
+	other.setId(3);
+	EXPECT_NE(other.primaryKeyValues(), clone->primaryKeyValues());
+	delete clone;
+}
+
 }
@@ -0,0 +1,105 @@
+/**
+ * @file
+ * @brief Measures the rows per second that are written with single inserts and with the multi row statements
+ * of @c DBHandler::persist(). Needs a running database - see @c AbstractDatabaseTest for the settings.
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "core/Var.h"
+#include "core/GameConfig.h"
+#include "core/StringUtil.h"
+#include "persistence/DBHandler.h"
+#include "TestModels.h"
+#include <vector>
+
+class PersistenceBenchmark: public core::AbstractBenchmark {
+private:
+	using Super = core::AbstractBenchmark;
+protected:
+	persistence::DBHandlerPtr _dbHandler;
+	bool _supported = false;
+	int _counter = 0;
+
+	bool onInitApp() override {
+		core::Var::get(cfg::DatabaseMinConnections, "1");
+		core::Var::get(cfg::DatabaseMaxConnections, "2");
+		core::Var::get(cfg::DatabaseName, "enginetest");
+		core::Var::get(cfg::DatabaseHost, "localhost");
+		core::Var::get(cfg::DatabaseUser, "vengi");
+		core::Var::get(cfg::DatabasePassword, "engine");
+		_dbHandler = std::make_shared<persistence::DBHandler>();
+		_supported = _dbHandler->init();
+		if (_supported) {
+			_supported = _dbHandler->createOrUpdateTable(persistence::db::TestModel());
+		}
+		return true;
+	}
+
+	void onCleanupApp() override {
+		_dbHandler->shutdown();
+		_dbHandler = persistence::DBHandlerPtr();
+	}
+
+	void fill(std::vector<persistence::db::TestModel>& models, int n) {
+		models.clear();
+		models.resize(n);
+		for (persistence::db::TestModel& model : models) {
+			const int id = _counter++;
+			model.setEmail(core::string::format("benchmark%i@localhost", id));
+			model.setName(core::string::format("benchmark%i", id));
+			model.setPassword("secret");
+			model.setPoints(id);
+		}
+	}
+
+	void prepare() {
+		if (_supported) {
+			_dbHandler->truncate(persistence::db::TestModel());
+		}
+	}
+};
+
+BENCHMARK_DEFINE_F(PersistenceBenchmark, insertSingle) (benchmark::State& state) {
+	prepare();
+	std::vector<persistence::db::TestModel> models;
+	for (auto _ : state) {
+		if (!_supported) {
+			state.SkipWithError("No database connection");
+			break;
+		}
+		state.PauseTiming();
+		fill(models, (int)state.range(0));
+		state.ResumeTiming();
+		for (persistence::db::TestModel& model : models) {
+			if (!_dbHandler->insert(model)) {
+				state.SkipWithError("Failed to insert");
+				break;
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_DEFINE_F(PersistenceBenchmark, insertBatched) (benchmark::State& state) {
+	prepare();
+	std::vector<persistence::db::TestModel> models;
+	for (auto _ : state) {
+		if (!_supported) {
+			state.SkipWithError("No database connection");
+			break;
+		}
+		state.PauseTiming();
+		fill(models, (int)state.range(0));
+		state.ResumeTiming();
+		if (!_dbHandler->insert(models)) {
+			state.SkipWithError("Failed to insert");
+			break;
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_REGISTER_F(PersistenceBenchmark, insertSingle)->RangeMultiplier(8)->Range(8, 512)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(PersistenceBenchmark, insertBatched)->RangeMultiplier(8)->Range(8, 512)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -139,4 +139,28 @@ TEST_F(PersistenceMgrTest, testSavableRelativeUpdateNegative) {
 	relativeUpdate(mgr, create(), 100, -110);
 }
 
+TEST_F(PersistenceMgrTest, testWriteBehindMergesRelativeUpdates) {
+	if (!_supported) {
+		return;
+	}
+	PersistenceMgr mgr(_dbHandler);
+	ASSERT_TRUE(mgr.init());
+	ASSERT_TRUE(mgr.registerSavable(FourCC('F','O','O','O'), this));
+	db::TestModel mdl = create();
+	mdl.setPoints(1);
+	_dirtyModels.push_back(&mdl);
+	mgr.update(0l);
+	// the first state was snapshotted - changing the model doesn't influence the queued state
+	mdl.setPoints(2);
+	_dirtyModels.push_back(&mdl);
+	mgr.update(0l);
+	mgr.flush();
+	ASSERT_TRUE(mgr.unregisterSavable(FourCC('F','O','O','O'), this));
+	mgr.shutdown();
+	db::TestModel out;
+	EXPECT_TRUE(_dbHandler->select(out, DBConditionOne()));
+	ASSERT_NE(nullptr, out.points());
+	EXPECT_EQ(3, *out.points());
+}
+
 }
@@ -81,6 +81,14 @@ public:
 
 	bool update(int32_t idx, const void* data, size_t size);
 
+	/**
+	 * @brief Only uploads the given range - the buffer keeps its size.
+	 * @return @c false if the range exceeds the size of the buffer.
+	 * @note Use @c update(idx, nullptr, size) to reserve the gpu memory first.
+	 * @sa BufferRangeAllocator
+	 */
+	bool update(int32_t idx, size_t offset, const void* data, size_t size);
+
 	/**
 	 * @return -1 on error - otherwise the index [0,n) of the created buffer (not the Id)
 	 */
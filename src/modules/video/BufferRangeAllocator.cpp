@@ -0,0 +1,85 @@
+/**
+ * @file
+ */
+
+#include "BufferRangeAllocator.h"
+#include <iterator>
+
+namespace video {
+
+BufferRangeAllocator::BufferRangeAllocator(size_t capacity) {
+	reset(capacity);
+}
+
+void BufferRangeAllocator::reset(size_t capacity) {
+	_free.clear();
+	_capacity = capacity;
+	_used = 0u;
+	if (capacity > 0u) {
+		_free.emplace(0u, capacity);
+	}
+}
+
+bool BufferRangeAllocator::alloc(size_t size, size_t& offset) {
+	if (size == 0u) {
+		return false;
+	}
+	for (auto i = _free.begin(); i != _free.end(); ++i) {
+		if (i->second < size) {
+			continue;
+		}
+		offset = i->first;
+		const size_t remaining = i->second - size;
+		_free.erase(i);
+		if (remaining > 0u) {
+			_free.emplace(offset + size, remaining);
+		}
+		_used += size;
+		return true;
+	}
+	return false;
+}
+
+bool BufferRangeAllocator::free(size_t offset, size_t size) {
+	if (size == 0u || offset + size > _capacity) {
+		return false;
+	}
+	auto next = _free.lower_bound(offset);
+	if (next != _free.end() && next->first < offset + size) {
+		// overlaps with a free range
+		return false;
+	}
+	size_t start = offset;
+	size_t length = size;
+	if (next != _free.begin()) {
+		auto prev = std::prev(next);
+		if (prev->first + prev->second > offset) {
+			return false;
+		}
+		if (prev->first + prev->second == offset) {
+			start = prev->first;
+			length += prev->second;
+			_free.erase(prev);
+		}
+	}
+	if (next != _free.end() && next->first == offset + size) {
+		length += next->second;
+		_free.erase(next);
+	}
+	_free.emplace(start, length);
+	_used -= size;
+	return true;
+}
+
+size_t BufferRangeAllocator::end() const {
+	if (_free.empty()) {
+		return _capacity;
+	}
+	auto last = std::prev(_free.end());
+	if (last->first + last->second == _capacity) {
+		return last->first;
+	}
+	return _capacity;
+}
+
+}
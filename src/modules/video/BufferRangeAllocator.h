@@ -0,0 +1,68 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <map>
+
+namespace video {
+
+/**
+ * @brief Sub allocates ranges of a buffer with a fixed capacity. This doesn't touch the gpu at all, it only
+ * keeps track of the free ranges - the unit is up to the caller (bytes, vertices, indices, ...).
+ *
+ * Freed ranges are merged with their free neighbours. New ranges are taken from the first free range that
+ * is big enough, so the used ranges are kept close to the start of the buffer.
+ *
+ * @sa Buffer::update()
+ * @ingroup Video
+ */
+class BufferRangeAllocator {
+private:
+	// offset to size of the free ranges
+	std::map<size_t, size_t> _free;
+	size_t _capacity = 0u;
+	size_t _used = 0u;
+public:
+	BufferRangeAllocator(size_t capacity = 0u);
+
+	/**
+	 * @brief Drops all ranges and sets the new capacity
+	 */
+	void reset(size_t capacity);
+
+	/**
+	 * @param[out] offset The start of the allocated range
+	 * @return @c false if there is no free range of the given size left. @c offset is not modified in that case.
+	 */
+	bool alloc(size_t size, size_t& offset);
+
+	/**
+	 * @brief Hands back a range that was returned by @c alloc() before.
+	 * @return @c false if the given range is not in use.
+	 */
+	bool free(size_t offset, size_t size);
+
+	size_t capacity() const;
+	/**
+	 * @return The sum of all used ranges
+	 */
+	size_t used() const;
+	/**
+	 * @return The end of the last used range - everything after this is free. This is e.g. the amount
+	 * of indices that must be drawn if the freed ranges in between are filled with degenerated triangles.
+	 */
+	size_t end() const;
+};
+
+inline size_t BufferRangeAllocator::capacity() const {
+	return _capacity;
+}
+
+inline size_t BufferRangeAllocator::used() const {
+	return _used;
+}
+
+}
@@ -0,0 +1,71 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "video/BufferRangeAllocator.h"
+
+namespace video {
+
+class BufferRangeAllocatorTest : public core::AbstractTest {
+};
+
+TEST_F(BufferRangeAllocatorTest, testAlloc) {
+	BufferRangeAllocator allocator(100u);
+	size_t offset1 = 0u;
+	size_t offset2 = 0u;
+	ASSERT_TRUE(allocator.alloc(40u, offset1));
+	ASSERT_TRUE(allocator.alloc(40u, offset2));
+	EXPECT_EQ(0u, offset1);
+	EXPECT_EQ(40u, offset2);
+	EXPECT_EQ(80u, allocator.used());
+	EXPECT_EQ(80u, allocator.end());
+	size_t offset3 = 0u;
+	EXPECT_FALSE(allocator.alloc(21u, offset3));
+	EXPECT_FALSE(allocator.alloc(0u, offset3));
+}
+
+TEST_F(BufferRangeAllocatorTest, testFreeReusesRange) {
+	BufferRangeAllocator allocator(100u);
+	size_t offset1 = 0u;
+	size_t offset2 = 0u;
+	ASSERT_TRUE(allocator.alloc(30u, offset1));
+	ASSERT_TRUE(allocator.alloc(30u, offset2));
+	ASSERT_TRUE(allocator.free(offset1, 30u));
+	// the range at the start is reused
+	size_t offset3 = 100u;
+	ASSERT_TRUE(allocator.alloc(20u, offset3));
+	EXPECT_EQ(0u, offset3);
+	EXPECT_EQ(60u, allocator.end());
+	EXPECT_FALSE(allocator.free(offset1, 30u)) << "Range overlaps with a free range";
+}
+
+TEST_F(BufferRangeAllocatorTest, testFreeMergesRanges) {
+	BufferRangeAllocator allocator(90u);
+	size_t offsets[3];
+	for (int i = 0; i < 3; ++i) {
+		ASSERT_TRUE(allocator.alloc(30u, offsets[i]));
+	}
+	ASSERT_TRUE(allocator.free(offsets[0], 30u));
+	ASSERT_TRUE(allocator.free(offsets[2], 30u));
+	EXPECT_EQ(60u, allocator.end());
+	ASSERT_TRUE(allocator.free(offsets[1], 30u));
+	EXPECT_EQ(0u, allocator.end());
+	EXPECT_EQ(0u, allocator.used());
+	// only possible if all three ranges were merged again
+	size_t offset = 1u;
+	ASSERT_TRUE(allocator.alloc(90u, offset));
+	EXPECT_EQ(0u, offset);
+}
+
+TEST_F(BufferRangeAllocatorTest, testReset) {
+	BufferRangeAllocator allocator;
+	size_t offset = 0u;
+	EXPECT_FALSE(allocator.alloc(1u, offset));
+	allocator.reset(10u);
+	EXPECT_TRUE(allocator.alloc(10u, offset));
+	EXPECT_EQ(10u, allocator.capacity());
+	EXPECT_FALSE(allocator.free(5u, 10u)) << "Range exceeds the capacity";
+}
+
+}
@@ -3,10 +3,20 @@
  */
 
 #include "CubicSurfaceExtractor.h"
+#include "PagedVolume.h"
+#include "PagedVolumeWrapper.h"
 #include <SDL.h>
 
 namespace voxel {
 
+bool isUniformRegion(const PagedVolume* volData, const Region& region, Voxel& voxel) {
+	return volData->isUniform(region, voxel);
+}
+
+bool isUniformRegion(const PagedVolumeWrapper* volData, const Region& region, Voxel& voxel) {
+	return volData->volume()->isUniform(region, voxel);
+}
+
 SDL_FORCE_INLINE bool isSameVertex(const VoxelVertex& v1, const VoxelVertex& v2) {
 	return v1.colorIndex == v2.colorIndex && v1.ambientOcclusion == v2.ambientOcclusion;
 }
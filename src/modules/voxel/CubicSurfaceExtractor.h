@@ -110,6 +110,20 @@ SDL_FORCE_INLINE bool isQuadFlipped(const VoxelVertex& v00, const VoxelVertex& v
 
 extern void meshify(Mesh* result, bool mergeQuads, QuadListVector& vecListQuads);
 
+class PagedVolume;
+class PagedVolumeWrapper;
+
+/**
+ * @brief Allows the extractor to skip regions where all voxels have the same value without looking at the
+ * single voxels. Volumes that don't support this just return @c false.
+ */
+template<typename VolumeType>
+inline bool isUniformRegion(const VolumeType* volData, const Region& region, Voxel& voxel) {
+	return false;
+}
+extern bool isUniformRegion(const PagedVolume* volData, const Region& region, Voxel& voxel);
+extern bool isUniformRegion(const PagedVolumeWrapper* volData, const Region& region, Voxel& voxel);
+
 /**
  * The CubicSurfaceExtractor creates a mesh in which each voxel appears to be rendered as a cube
  * Introduction
@@ -208,6 +222,23 @@ void extractCubicMesh(VolumeType* volData, const Region& region, Mesh* result, I
 	const glm::ivec3& upper = region.getUpperCorner();
 	result->setOffset(offset);
 
+	// The voxels at the lower corner are compared to their neighbours outside of the region. If all of
+	// them have the same value, there is nothing to extract if no quad is needed between two of them.
+	Voxel uniformVoxel;
+	if (isUniformRegion(volData, Region(offset - 1, upper), uniformVoxel)) {
+		const VoxelType material = uniformVoxel.getMaterial();
+		bool quadNeeded = false;
+		for (int face = 0; face < NoOfFaces; ++face) {
+			if (isQuadNeeded(material, material, (FaceNames)face)) {
+				quadNeeded = true;
+				break;
+			}
+		}
+		if (!quadNeeded) {
+			return;
+		}
+	}
+
 	// Used to avoid creating duplicate vertices.
 	const int widthInCells = upper.x - offset.x;
 	const int heightInCells = upper.y - offset.y;
@@ -7,11 +7,69 @@
 #include "Utility.h"
 #include "core/Log.h"
 #include "core/Common.h"
+#include "core/concurrent/Lock.h"
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtc/round.hpp>
 
 namespace voxel {
 
+namespace {
+
+/**
+ * @brief Hands out the thread cache slot indices and takes them back once a thread exits
+ */
+class ThreadCacheSlotPool {
+private:
+	core::Lock _lock;
+	core::DynamicArray<int> _free;
+	int _next = 0;
+public:
+	int acquire(int maxSlots) {
+		core::ScopedLock lock(_lock);
+		if (!_free.empty()) {
+			const int slot = _free.back();
+			_free.pop();
+			return slot;
+		}
+		if (_next >= maxSlots) {
+			return -1;
+		}
+		return _next++;
+	}
+
+	void release(int slot) {
+		if (slot == -1) {
+			return;
+		}
+		core::ScopedLock lock(_lock);
+		_free.push_back(slot);
+	}
+};
+
+ThreadCacheSlotPool& threadCacheSlotPool() {
+	static ThreadCacheSlotPool pool;
+	return pool;
+}
+
+struct ThreadCacheSlot {
+	const int slot;
+	ThreadCacheSlot(int maxSlots) : slot(threadCacheSlotPool().acquire(maxSlots)) {
+	}
+	~ThreadCacheSlot() {
+		threadCacheSlotPool().release(slot);
+	}
+};
+
+/**
+ * @return The per thread cache slot index or @c -1 if the thread doesn't get a slot
+ */
+int threadCacheSlot(int maxSlots) {
+	thread_local const ThreadCacheSlot slot(maxSlots);
+	return slot.slot;
+}
+
+}
+
 /**
  * This constructor creates a volume with a fixed size which is specified as a parameter. By default this constructor will not enable paging
  * but you can override this if desired. If you do wish to enable
@@ -20,8 +78,10 @@ namespace voxel {
  * @param targetMemoryUsageInBytes The upper limit to how much memory this PagedVolume should aim to use.
  * @param chunkSideLength The size of the chunks making up the volume. Small chunks will compress/decompress faster, but there will also be
  * more of them meaning voxel access could be slower.
+ * @param compressedMemoryUsageInBytes The upper limit of memory for the evicted chunks that are kept in memory in a compressed form. @c 0
+ * disables the compressed tier and evicted chunks are paged out immediately.
  */
-PagedVolume::PagedVolume(Pager* pager, uint32_t targetMemoryUsageInBytes, uint16_t chunkSideLength) :
+PagedVolume::PagedVolume(Pager* pager, uint32_t targetMemoryUsageInBytes, uint16_t chunkSideLength, uint32_t compressedMemoryUsageInBytes) :
 		_chunkSideLength(chunkSideLength), _pager(pager), _region(0, 0, 0, -1, -1, -1) {
 	// Validation of parameters
 	core_assert_msg(_pager, "You must provide a valid pager when constructing a PagedVolume");
@@ -37,19 +97,32 @@ PagedVolume::PagedVolume(Pager* pager, uint32_t targetMemoryUsageInBytes, uint16
 
 	// Calculate the number of chunks based on the memory limit and the size of each chunk.
 	uint32_t chunkSizeInBytes = PagedVolume::Chunk::calculateSizeInBytes(_chunkSideLength);
-	_chunkCountLimit = targetMemoryUsageInBytes / chunkSizeInBytes;
+	uint32_t chunkCountLimit = targetMemoryUsageInBytes / chunkSizeInBytes;
 
 	// Enforce sensible limits on the number of chunks.
-	const uint32_t minPracticalNoOfChunks = 32; // Enough to make sure a chunks and it's neighbours can be loaded, with a few to spare.
-	if (_chunkCountLimit < minPracticalNoOfChunks) {
+	const uint32_t minPracticalNoOfChunks = 64; // Enough to make sure a chunks and it's neighbours can be loaded in each shard, with a few to spare.
+	if (chunkCountLimit < minPracticalNoOfChunks) {
 		Log::warn("Requested memory usage limit of %uMb is too low and cannot be adhered to. Chunk limit is at %i, Chunk size: %uKb",
-				targetMemoryUsageInBytes / (1024 * 1024), _chunkCountLimit, chunkSizeInBytes / 1024);
+				targetMemoryUsageInBytes / (1024 * 1024), chunkCountLimit, chunkSizeInBytes / 1024);
+	}
+	chunkCountLimit = core_max(chunkCountLimit, minPracticalNoOfChunks);
+	// The limit is enforced per shard - the neighbours of a chunk are distributed over different shards
+	_chunkCountLimit = (chunkCountLimit + ChunkShards - 1) / ChunkShards;
+
+	_compressedMemoryLimit = compressedMemoryUsageInBytes / ChunkShards;
+	if (_compressedMemoryLimit > 0u) {
+		// A compressed chunk is at least one run
+		const uint32_t maxCompressedChunks = _compressedMemoryLimit / (uint32_t)sizeof(CompressedChunk);
+		_compressedChunkCountLimit = core_max(2u, maxCompressedChunks);
 	}
-	_chunkCountLimit = core_max(_chunkCountLimit, minPracticalNoOfChunks);
 
 	// Inform the user about the chosen memory configuration.
-	Log::info("Memory usage limit for volume now set to %uMb (%u chunks of %uKb each).",
-			(_chunkCountLimit * chunkSizeInBytes) / (1024 * 1024), _chunkCountLimit, chunkSizeInBytes / 1024);
+	Log::info("Memory usage limit for volume now set to %uMb (%u chunks of %uKb each in %i shards).",
+			(_chunkCountLimit * ChunkShards * chunkSizeInBytes) / (1024 * 1024), _chunkCountLimit * ChunkShards, chunkSizeInBytes / 1024, ChunkShards);
+	if (_compressedChunkCountLimit > 0u) {
+		Log::info("Memory usage limit for compressed chunks now set to %uMb (max %u chunks).",
+				compressedMemoryUsageInBytes / (1024 * 1024), _compressedChunkCountLimit * ChunkShards);
+	}
 }
 
 /**
@@ -79,6 +152,15 @@ PagedVolume::ChunkPtr PagedVolume::chunk(const glm::ivec3& pos) const {
 	return chunk(chunkX, chunkY, chunkZ);
 }
 
+PagedVolume::ChunkPtr PagedVolume::loadedChunk(const glm::ivec3& pos) const {
+	const int32_t chunkX = pos.x >> _chunkSideLengthPower;
+	const int32_t chunkY = pos.y >> _chunkSideLengthPower;
+	const int32_t chunkZ = pos.z >> _chunkSideLengthPower;
+	ChunkShard& chunkShard = shard(chunkX, chunkZ);
+	core::ScopedWriteLock writeLock(chunkShard.lock);
+	return existingChunk(chunkShard, chunkX, chunkY, chunkZ);
+}
+
 /**
  * This version of the function is provided so that the wrap mode does not need
  * to be specified as a template parameter, as it may be confusing to some users.
@@ -164,84 +246,310 @@ void PagedVolume::setVoxels(int32_t uXPos, int32_t uYPos, int32_t uZPos, int nx,
 	}
 }
 
+size_t PagedVolume::chunkCount() const {
+	size_t count = 0u;
+	for (int i = 0; i < ChunkShards; ++i) {
+		ChunkShard& shard = _shards[i];
+		core::ScopedReadLock readLock(shard.lock);
+		count += shard.chunks.size();
+	}
+	return count;
+}
+
+bool PagedVolume::isUniform(const Region& region, Voxel& voxel) const {
+	const glm::ivec3& mins = chunkPos(region.getLowerCorner());
+	const glm::ivec3& maxs = chunkPos(region.getUpperCorner());
+	bool first = true;
+	for (int32_t z = mins.z; z <= maxs.z; ++z) {
+		for (int32_t y = mins.y; y <= maxs.y; ++y) {
+			for (int32_t x = mins.x; x <= maxs.x; ++x) {
+				Voxel chunkVoxel;
+				if (!chunk(x, y, z)->isUniform(chunkVoxel)) {
+					return false;
+				}
+				if (first) {
+					voxel = chunkVoxel;
+					first = false;
+				} else if (!voxel.isSame(chunkVoxel)) {
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+size_t PagedVolume::compressedChunkCount() const {
+	size_t count = 0u;
+	for (int i = 0; i < ChunkShards; ++i) {
+		ChunkShard& shard = _shards[i];
+		core::ScopedReadLock readLock(shard.lock);
+		count += shard.compressedChunks.size();
+	}
+	return count;
+}
+
+size_t PagedVolume::compressedMemoryUsageInBytes() const {
+	size_t bytes = 0u;
+	for (int i = 0; i < ChunkShards; ++i) {
+		ChunkShard& shard = _shards[i];
+		core::ScopedReadLock readLock(shard.lock);
+		bytes += shard.compressedBytes;
+	}
+	return bytes;
+}
+
 /**
  * Removes all voxels from memory by removing all chunks. The application has the chance to persist the data via @c Pager::pageOut
  */
 void PagedVolume::flushAll() {
-	// must not be recursive at this point
-	core::ScopedWriteLock writeLock(_volumeLock);
-	// Clear this pointer as all chunks are about to be removed.
-	_lastAccessedChunk = ChunkPtr();
-	_lastAccessedChunkX = 0;
-	_lastAccessedChunkY = 0;
-	_lastAccessedChunkZ = 0;
+	for (int i = 0; i < ChunkShards; ++i) {
+		ChunkShard& shard = _shards[i];
+		// must not be recursive at this point
+		core::ScopedWriteLock writeLock(shard.lock);
+		// Invalidate the per thread caches as all chunks are about to be removed.
+		++shard.generation;
+		shard.lruHead = nullptr;
+		shard.lruTail = nullptr;
+		shard.chunks.clear();
+		shard.compressedLruHead = nullptr;
+		shard.compressedLruTail = nullptr;
+		shard.compressedBytes = 0u;
+		shard.compressedChunks.clear();
+	}
+	releaseThreadCaches(nullptr);
+}
 
-	// Erase all the most recently used chunks.
-	_chunks.clear();
+void PagedVolume::releaseThreadCaches(const Chunk* chunk) const {
+	for (int i = 0; i < ThreadCacheSlots; ++i) {
+		ThreadCache& cache = _threadCaches[i];
+		ChunkPtr released;
+		SDL_AtomicLock(&cache.lock);
+		if (cache.chunk && (chunk == nullptr || cache.chunk.get() == chunk)) {
+			// don't release the chunk while holding the spin lock - it might get paged out
+			released = cache.chunk;
+			cache.chunk = ChunkPtr();
+			cache.generation = -1;
+		}
+		SDL_AtomicUnlock(&cache.lock);
+	}
 }
 
 /**
- * Starting at the position indicated by the hash, and then search through the whole array looking for a chunk with the correct
- * position. In most cases we expect to find it in the first place we look. Note that this algorithm is slow in the case that
- * the chunk is not found because the whole array has to be searched, but in this case we are going to have to page the data in
- * from an external source which is likely to be slow anyway.
+ * The shard is selected by the lower bits of the x and z chunk coordinates. This distributes the
+ * neighbours of a chunk (which are usually accessed together - e.g. by the mesh extractor) over
+ * different shards.
  */
-PagedVolume::ChunkPtr PagedVolume::existingChunk(int32_t chunkX, int32_t chunkY, int32_t chunkZ) const {
+PagedVolume::ChunkShard& PagedVolume::shard(int32_t chunkX, int32_t chunkZ) const {
+	const int index = (chunkX & 3) | ((chunkZ & 3) << 2);
+	static_assert(ChunkShards == 16, "Shard index calculation doesn't match the amount of shards");
+	return _shards[index];
+}
+
+void PagedVolume::lruLinkFront(ChunkShard& shard, Chunk* chunk) const {
+	chunk->_lruPrev = nullptr;
+	chunk->_lruNext = shard.lruHead;
+	if (shard.lruHead != nullptr) {
+		shard.lruHead->_lruPrev = chunk;
+	}
+	shard.lruHead = chunk;
+	if (shard.lruTail == nullptr) {
+		shard.lruTail = chunk;
+	}
+}
+
+void PagedVolume::lruUnlink(ChunkShard& shard, Chunk* chunk) const {
+	if (chunk->_lruPrev != nullptr) {
+		chunk->_lruPrev->_lruNext = chunk->_lruNext;
+	} else {
+		shard.lruHead = chunk->_lruNext;
+	}
+	if (chunk->_lruNext != nullptr) {
+		chunk->_lruNext->_lruPrev = chunk->_lruPrev;
+	} else {
+		shard.lruTail = chunk->_lruPrev;
+	}
+	chunk->_lruPrev = nullptr;
+	chunk->_lruNext = nullptr;
+}
+
+void PagedVolume::lruLinkFront(ChunkShard& shard, CompressedChunk* chunk) const {
+	chunk->_lruPrev = nullptr;
+	chunk->_lruNext = shard.compressedLruHead;
+	if (shard.compressedLruHead != nullptr) {
+		shard.compressedLruHead->_lruPrev = chunk;
+	}
+	shard.compressedLruHead = chunk;
+	if (shard.compressedLruTail == nullptr) {
+		shard.compressedLruTail = chunk;
+	}
+}
+
+void PagedVolume::lruUnlink(ChunkShard& shard, CompressedChunk* chunk) const {
+	if (chunk->_lruPrev != nullptr) {
+		chunk->_lruPrev->_lruNext = chunk->_lruNext;
+	} else {
+		shard.compressedLruHead = chunk->_lruNext;
+	}
+	if (chunk->_lruNext != nullptr) {
+		chunk->_lruNext->_lruPrev = chunk->_lruPrev;
+	} else {
+		shard.compressedLruTail = chunk->_lruPrev;
+	}
+	chunk->_lruPrev = nullptr;
+	chunk->_lruNext = nullptr;
+}
+
+/**
+ * Looks up the chunk in the given shard and marks it as the most recently used one. The shard lock must be held by the caller.
+ */
+PagedVolume::ChunkPtr PagedVolume::existingChunk(ChunkShard& shard, int32_t chunkX, int32_t chunkY, int32_t chunkZ) const {
 	const glm::ivec3 pos(chunkX, chunkY, chunkZ);
-	auto i = _chunks.find(pos);
-	if (i == _chunks.end()) {
+	auto i = shard.chunks.find(pos);
+	if (i == shard.chunks.end()) {
 		return ChunkPtr();
 	}
 	const PagedVolume::ChunkPtr& chunk = i->second;
-	chunk->_chunkLastAccessed = ++_timestamper;
+	if (shard.lruHead != chunk.get()) {
+		lruUnlink(shard, chunk.get());
+		lruLinkFront(shard, chunk.get());
+	}
 	return chunk;
 }
 
 /**
- * As we have added a chunk we may have exceeded our target chunk limit. Search through the array to
- * determine how many chunks we have, as well as finding the oldest timestamp. Note that this is potentially
- * wasteful and we may instead wish to track how many chunks we have and/or delete a chunk at random (or
- * just check e.g. 10 and delete the oldest of those) but we'll see if this is a bottleneck first. Paging
- * the data in is probably more expensive.
+ * As we have added a chunk we may have exceeded our target chunk limit. The least recently used chunk is the
+ * tail of the lru list of the shard - so there is no need to search for it. The shard lock must be held by the caller.
  */
-void PagedVolume::deleteOldestChunkIfNeeded() const {
-	const std::size_t chunkCount = _chunks.size();
-	if (chunkCount < _chunkCountLimit) {
-		return;
-	}
-	glm::ivec3 oldestChunkPos(0);
-	bool foundOldestChunk = false;
-	uint32_t oldestChunkTimestamp = (std::numeric_limits<uint32_t>::max)();
-	for (ChunkMap::iterator i = _chunks.begin(); i != _chunks.end(); ++i) {
-		const glm::ivec3& pos = i->first;
-		const ChunkPtr& chunk = i->second;
-		if (chunk->_chunkLastAccessed < oldestChunkTimestamp) {
-			oldestChunkTimestamp = chunk->_chunkLastAccessed;
-			foundOldestChunk = true;
-			oldestChunkPos = pos;
+PagedVolume::ChunkPtr PagedVolume::deleteOldestChunkIfNeeded(ChunkShard& shard) const {
+	if (shard.chunks.size() <= _chunkCountLimit) {
+		return ChunkPtr();
+	}
+	Chunk* oldest = shard.lruTail;
+	if (oldest == nullptr) {
+		return ChunkPtr();
+	}
+	auto i = shard.chunks.find(oldest->_chunkSpacePosition);
+	core_assert(i != shard.chunks.end());
+	// keep a reference - the chunk is released by the caller outside of the shard lock
+	ChunkPtr chunk = i->second;
+	lruUnlink(shard, oldest);
+	shard.chunks.erase(i);
+	++shard.generation;
+	return chunk;
+}
+
+/**
+ * The shard lock must be held by the caller.
+ */
+PagedVolume::CompressedChunkPtr PagedVolume::takeCompressedChunk(ChunkShard& shard, const glm::ivec3& pos) const {
+	auto i = shard.compressedChunks.find(pos);
+	if (i == shard.compressedChunks.end()) {
+		return CompressedChunkPtr();
+	}
+	CompressedChunkPtr compressed = i->second;
+	lruUnlink(shard, compressed.get());
+	shard.compressedBytes -= compressed->_accountedBytes;
+	compressed->_accountedBytes = 0u;
+	shard.compressedChunks.erase(i);
+	return compressed;
+}
+
+/**
+ * The shard lock must be held by the caller.
+ */
+void PagedVolume::deleteOldestCompressedChunksIfNeeded(ChunkShard& shard, core::DynamicArray<CompressedChunkPtr>& removed) const {
+	while (shard.compressedLruTail != nullptr
+			&& (shard.compressedBytes > _compressedMemoryLimit || shard.compressedChunks.size() > _compressedChunkCountLimit)) {
+		removed.push_back(takeCompressedChunk(shard, shard.compressedLruTail->_chunkSpacePosition));
+	}
+}
+
+void PagedVolume::compressChunk(ChunkShard& shard, const ChunkPtr& evicted) const {
+	CompressedChunkPtr compressed;
+	{
+		core::ScopedReadLock readLock(shard.lock);
+		auto i = shard.compressedChunks.find(evicted->_chunkSpacePosition);
+		if (i == shard.compressedChunks.end() || i->second->_pending != evicted) {
+			// the chunk was requested again in the meantime
+			return;
 		}
+		compressed = i->second;
 	}
-	if (foundOldestChunk) {
-		ChunkMap::iterator i = _chunks.find(oldestChunkPos);
-		_chunks.erase(i);
+
+	// this is the expensive part and is done without holding the shard lock
+	compressed->compress();
+
+	core::DynamicArray<CompressedChunkPtr> removed;
+	{
+		core::ScopedWriteLock writeLock(shard.lock);
+		auto i = shard.compressedChunks.find(evicted->_chunkSpacePosition);
+		if (i == shard.compressedChunks.end() || i->second != compressed) {
+			// the chunk was requested again or removed from the compressed tier in the meantime - the evicted chunk is
+			// responsible for paging out the data.
+			return;
+		}
+		// hand over the modified state - the compressed chunk is paged out once it's removed from the compressed tier
+		compressed->_dataModified = evicted->_dataModified;
+		evicted->_dataModified = false;
+		compressed->_pending = ChunkPtr();
+		shard.compressedBytes -= compressed->_accountedBytes;
+		compressed->_accountedBytes = compressed->sizeInBytes();
+		shard.compressedBytes += compressed->_accountedBytes;
+		deleteOldestCompressedChunksIfNeeded(shard, removed);
 	}
+	// the removed chunks are paged out here - this is done outside of the shard lock
 }
 
-PagedVolume::ChunkPtr PagedVolume::createNewChunk(int32_t chunkX, int32_t chunkY, int32_t chunkZ) const {
+PagedVolume::ChunkPtr PagedVolume::createNewChunk(ChunkShard& shard, int32_t chunkX, int32_t chunkY, int32_t chunkZ, ChunkPtr& evicted) const {
 	// The chunk was not found so we will create a new one.
 	glm::ivec3 pos(chunkX, chunkY, chunkZ);
 	Log::debug("create new chunk at %i:%i:%i", chunkX, chunkY, chunkZ);
-	ChunkPtr chunk = core::make_shared<Chunk>(pos, _chunkSideLength, _pager);
-	chunk->_chunkLastAccessed = ++_timestamper; // Important, as we may soon delete the oldest chunk
-
+	const ChunkPtr newChunk = core::make_shared<Chunk>(pos, _chunkSideLength, _pager);
+
+	// Lock the chunk before it gets visible to other threads - they have to wait until the chunk was paged in.
+	core::ScopedWriteLock chunkWriteLock(newChunk->_chunkLock);
+	ChunkPtr chunk = newChunk;
+	CompressedChunkPtr compressed;
+	bool pending = false;
+	core::DynamicArray<CompressedChunkPtr> removed;
 	{
-		core::ScopedWriteLock volumeWriteLock(_volumeLock);
-		auto i = _chunks.find(pos);
-		if (i != _chunks.end()) {
-			return i->value;
+		core::ScopedWriteLock shardWriteLock(shard.lock);
+		ChunkPtr existing = existingChunk(shard, chunkX, chunkY, chunkZ);
+		if (existing) {
+			return existing;
+		}
+		compressed = takeCompressedChunk(shard, pos);
+		if (compressed && compressed->_pending) {
+			// the chunk was evicted but not yet compressed - just take it back. The
+			// compression result is dropped because the entry is no longer in the map.
+			chunk = compressed->_pending;
+			pending = true;
+		}
+		shard.chunks.put(pos, chunk);
+		lruLinkFront(shard, chunk.get());
+		evicted = deleteOldestChunkIfNeeded(shard);
+		if (evicted && _compressedChunkCountLimit > 0u) {
+			// put the evicted chunk into the compressed tier before the shard lock is released - the
+			// data is compressed later by the caller. The memory budget is enforced in compressChunk()
+			// once the compressed size is known.
+			CompressedChunkPtr evictedCompressed = core::make_shared<CompressedChunk>(evicted);
+			evictedCompressed->_accountedBytes = evictedCompressed->sizeInBytes();
+			shard.compressedBytes += evictedCompressed->_accountedBytes;
+			shard.compressedChunks.put(evictedCompressed->_chunkSpacePosition, evictedCompressed);
+			lruLinkFront(shard, evictedCompressed.get());
+			deleteOldestCompressedChunksIfNeeded(shard, removed);
 		}
-		_chunks.put(pos, chunk);
-		deleteOldestChunkIfNeeded();
+	}
+
+	if (pending) {
+		return chunk;
+	}
+	if (compressed) {
+		// Decompress the data from the compressed tier instead of paging it in again
+		compressed->decompress(*chunk.get());
+		Log::debug("decompressed chunk at %i:%i:%i", chunkX, chunkY, chunkZ);
+		return chunk;
 	}
 
 	// Pass the chunk to the Pager to give it a chance to initialise it with any data
@@ -252,34 +560,63 @@ PagedVolume::ChunkPtr PagedVolume::createNewChunk(int32_t chunkX, int32_t chunkY
 
 	// Page the data in
 	// We'll use this later to decide if data needs to be paged out again.
-	core::ScopedWriteLock chunkWriteLock(chunk->_chunkLock);
+	// Uniform chunks (e.g. all air) don't allocate any voxel data - the mesh extractor skips them, too.
 	chunk->_dataModified = _pager->pageIn(pctx);
-	// TODO: if this is empty, we can optimize the mesh extractor a lot
 	Log::debug("finished creating new chunk at %i:%i:%i", chunkX, chunkY, chunkZ);
 
 	return chunk;
 }
 
 PagedVolume::ChunkPtr PagedVolume::chunk(int32_t chunkX, int32_t chunkY, int32_t chunkZ) const {
+	ChunkShard& chunkShard = shard(chunkX, chunkZ);
+	const int slot = threadCacheSlot(ThreadCacheSlots);
+	ThreadCache* cache = slot == -1 ? nullptr : &_threadCaches[slot];
+	const int generation = chunkShard.generation;
+	if (cache != nullptr) {
+		// only contended if another thread releases the cached chunk right now
+		SDL_AtomicLock(&cache->lock);
+		if (cache->generation == generation && cache->x == chunkX && cache->y == chunkY && cache->z == chunkZ && cache->chunk) {
+			ChunkPtr chunk = cache->chunk;
+			SDL_AtomicUnlock(&cache->lock);
+			return chunk;
+		}
+		SDL_AtomicUnlock(&cache->lock);
+	}
+
 	ChunkPtr chunk;
 	{
-		core::ScopedReadLock readLock(_volumeLock);
-		if (chunkX == _lastAccessedChunkX && chunkY == _lastAccessedChunkY && chunkZ == _lastAccessedChunkZ && _lastAccessedChunk) {
-			return _lastAccessedChunk;
-		}
-		chunk = existingChunk(chunkX, chunkY, chunkZ);
+		core::ScopedWriteLock writeLock(chunkShard.lock);
+		chunk = existingChunk(chunkShard, chunkX, chunkY, chunkZ);
 	}
 
 	// If we still haven't found the chunk then it's time to create a new one and page it in from disk.
 	if (!chunk) {
-		chunk = createNewChunk(chunkX, chunkY, chunkZ);
+		ChunkPtr evicted;
+		chunk = createNewChunk(chunkShard, chunkX, chunkY, chunkZ, evicted);
+		if (evicted) {
+			releaseThreadCaches(evicted.get());
+			if (_compressedChunkCountLimit > 0u) {
+				compressChunk(chunkShard, evicted);
+			}
+		}
+		// if not compressed, the evicted chunk might get paged out here - outside of any lock
 	}
 
-	core::ScopedWriteLock writeLock(_volumeLock);
-	_lastAccessedChunk = chunk;
-	_lastAccessedChunkX = chunkX;
-	_lastAccessedChunkY = chunkY;
-	_lastAccessedChunkZ = chunkZ;
+	if (cache != nullptr) {
+		ChunkPtr released;
+		SDL_AtomicLock(&cache->lock);
+		// Only cache the chunk if nothing was evicted from the shard since the lookup started. Otherwise
+		// this might be the evicted chunk and the eviction already released the thread caches.
+		if (chunkShard.generation == generation) {
+			released = cache->chunk;
+			cache->chunk = chunk;
+			cache->x = chunkX;
+			cache->y = chunkY;
+			cache->z = chunkZ;
+			cache->generation = generation;
+		}
+		SDL_AtomicUnlock(&cache->lock);
+	}
 
 	return chunk;
 }
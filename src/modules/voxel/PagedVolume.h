@@ -11,7 +11,8 @@
 #include "core/concurrent/ReadWriteLock.h"
 #include "core/concurrent/Atomic.h"
 #include "core/collection/Array.h"
-#include "core/collection/Map.h"
+#include "core/collection/FlatMap.h"
+#include "core/collection/DynamicArray.h"
 #include "core/SharedPtr.h"
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
@@ -38,26 +39,68 @@ public:
 	class Chunk;
 	/// The Pager class is responsible for the loading and unloading of Chunks, and can be subclassed by the user.
 	class Pager;
+	/// Evicted chunks are kept in memory in a compressed form before they are paged out.
+	class CompressedChunk;
+
+	/**
+	 * @brief The way the voxels of a chunk are stored. A chunk starts as uniform chunk and is upgraded as voxels are written.
+	 */
+	enum class ChunkStorage : uint8_t {
+		/** all voxels have the same value - nothing is allocated */
+		Uniform,
+		/** up to @c Chunk::MaxPaletteEntries different voxels with bit-packed indices into the palette */
+		Palette,
+		/** one voxel per position */
+		Dense
+	};
 
 	class Chunk {
 		friend class PagedVolume;
 		friend class PagedVolumeWrapper;
+		friend class CompressedChunk;
 
 	public:
+		static constexpr int MaxPaletteEntries = 16;
+
 		Chunk(const glm::ivec3& v3dPosition, uint16_t uSideLength, Pager* pPager = nullptr);
 		~Chunk();
 
 		bool setData(const Voxel* voxels, size_t sizeInBytes);
-		Voxel* data() const;
+		/**
+		 * @note This converts the chunk into the dense storage mode
+		 */
+		Voxel* data();
 		uint32_t dataSizeInBytes() const;
 		uint32_t voxels() const;
 
+		ChunkStorage storage() const;
+		/**
+		 * @return The memory that is currently allocated for the voxels of this chunk
+		 */
+		uint32_t storageSizeInBytes() const;
+		/**
+		 * @brief Check in O(1) whether all voxels of this chunk have the same value
+		 * @param[out] voxel The voxel value of the uniform chunk
+		 */
+		bool isUniform(Voxel& voxel) const;
+		/**
+		 * @brief Sets all voxels of the chunk to the given value and releases the allocated memory
+		 * @note Samplers that still reference the released memory notice this and resolve the storage again.
+		 * Sampling the chunk from another thread while it's filled is not supported.
+		 */
+		void fill(const Voxel& voxel);
+
 		bool containsPoint(const glm::ivec3& pos) const;
 		bool containsPoint(int32_t x, int32_t y, int32_t z) const;
 		Region region() const;
 
 		const Voxel& voxel(uint32_t uXPos, uint32_t uYPos, uint32_t uZPos) const;
 		const Voxel& voxel(const glm::i16vec3& v3dPos) const;
+		/**
+		 * @param mortonIndex The index of the voxel in morton order
+		 */
+		const Voxel& voxelAtIndex(uint32_t mortonIndex) const;
+		void setVoxelAtIndex(uint32_t mortonIndex, const Voxel& voxel);
 
 		void setVoxel(uint32_t uXPos, uint32_t uYPos, uint32_t uZPos, const Voxel& tValue);
 		void setVoxels(uint32_t uXPos, uint32_t uZPos, const Voxel* tValues, int amount);
@@ -66,13 +109,50 @@ public:
 
 		glm::ivec3 chunkPos() const;
 
+		/**
+		 * @return The local y coordinate above the highest voxel of the column that is not enterable (see
+		 * @c isEnterable()) - or @c 0 if all voxels of the column are enterable.
+		 * @note The heights of all columns are computed on the first call and maintained by the setters afterwards.
+		 */
+		int columnHeight(uint32_t uXPos, uint32_t uZPos);
+		/**
+		 * @brief Computes the heights of all columns if this wasn't done yet - see @c columnHeight()
+		 */
+		void buildColumnHeights();
+
 	private:
-		// This is updated by the PagedVolume and used to discard the least recently used chunks.
-		uint32_t _chunkLastAccessed = 0u;
+		// Intrusive links into the lru list of the shard this chunk lives in. They are
+		// maintained by the PagedVolume under the shard lock and used to discard the least
+		// recently used chunks in O(1).
+		Chunk* _lruPrev = nullptr;
+		Chunk* _lruNext = nullptr;
 
 		static uint32_t calculateSizeInBytes(uint32_t uSideLength);
 
+		// these don't lock the chunk - the caller has to hold the chunk lock
+		const Voxel& voxelByIndex(uint32_t index) const;
+		void setVoxelByIndex(uint32_t index, const Voxel& voxel);
+		void repackIndices(uint8_t bitsPerIndex);
+		void convertToDense();
+		void freeStorage();
+		// these don't lock the chunk either
+		void buildColumnHeightsUnlocked();
+		void updateColumnHeight(uint32_t uXPos, uint32_t uYPos, uint32_t uZPos, const Voxel& voxel);
+		uint16_t scanColumnHeight(uint32_t uXPos, uint32_t uZPos, int topY) const;
+
+		// only allocated in ChunkStorage::Dense mode
 		Voxel* _data = nullptr;
+		// incremented whenever the storage is released or reallocated - the samplers resolve their
+		// view on the storage again if this changed
+		uint32_t _storageGeneration = 0u;
+		// only allocated in ChunkStorage::Palette mode - the bit-packed indices into the palette
+		uint8_t* _indices = nullptr;
+		// the first entry is the voxel of a uniform chunk. Entries are only appended - this keeps
+		// references to voxels valid while the chunk is upgraded.
+		core::Array<Voxel, MaxPaletteEntries> _palette;
+		uint8_t _paletteSize = 1u;
+		// 0 for uniform chunks, 1, 2 or 4 for palette chunks
+		uint8_t _bitsPerIndex = 0u;
 		uint16_t _sideLength = 0u;
 
 		// This is so we can tell whether a uncompressed chunk has to be recompressed and whether
@@ -82,6 +162,10 @@ public:
 		uint8_t _sideLengthPower = 0b0;
 		Pager* _pager;
 
+		// the column heights indexed by x + z * side length - only valid if _columnHeightsValid is set
+		uint16_t* _columnHeights = nullptr;
+		bool _columnHeightsValid = false;
+
 		// Note: Do we really need to store this position here as well as in the block maps?
 		glm::ivec3 _chunkSpacePosition;
 
@@ -89,6 +173,60 @@ public:
 	};
 	typedef core::SharedPtr<Chunk> ChunkPtr;
 
+	/**
+	 * @brief Second in-memory tier for evicted chunks. The voxels are run-length encoded in morton order - most of the
+	 * terrain chunks are air above the surface and compress very well. A request for such a chunk is served by
+	 * decompressing it instead of paging it in again. Modified chunks are paged out once they are evicted from
+	 * this tier, too.
+	 */
+	class CompressedChunk {
+		friend class PagedVolume;
+	public:
+		/**
+		 * @param chunk The evicted chunk - it's kept until @c compress() was called.
+		 */
+		CompressedChunk(const ChunkPtr& chunk);
+		~CompressedChunk();
+
+		/**
+		 * @brief Run-length encodes the voxels of the evicted chunk.
+		 * @note The evicted chunk is still referenced after this call - the volume releases it.
+		 */
+		void compress();
+		/**
+		 * @brief Writes the voxels into the given chunk and hands over the modified state - the chunk is
+		 * responsible for paging out the data now.
+		 */
+		void decompress(Chunk& chunk);
+
+		/**
+		 * @return The memory that is used by this instance - only the size of the instance itself as long as the
+		 * data wasn't compressed yet.
+		 */
+		uint32_t sizeInBytes() const;
+
+	private:
+		struct Run {
+			uint16_t length;
+			Voxel voxel;
+		};
+
+		CompressedChunk* _lruPrev = nullptr;
+		CompressedChunk* _lruNext = nullptr;
+
+		// the evicted chunk - set until the compressed data was committed to the tier
+		ChunkPtr _pending;
+		Run* _runs = nullptr;
+		uint32_t _runCount = 0u;
+		// the memory that is accounted in the budget of the shard - guarded by the shard lock
+		uint32_t _accountedBytes = 0u;
+		uint16_t _sideLength = 0u;
+		bool _dataModified = false;
+		Pager* _pager;
+		glm::ivec3 _chunkSpacePosition;
+	};
+	typedef core::SharedPtr<CompressedChunk> CompressedChunkPtr;
+
 	struct PagerContext {
 		Region region;
 		ChunkPtr chunk;
@@ -174,6 +312,43 @@ public:
 		const Voxel& peekVoxel1px1py1pz() const;
 
 	protected:
+		/**
+		 * @brief The storage of the current chunk as it was when it was resolved - this allows to read the
+		 * voxels without locking the chunk for every access.
+		 */
+		struct StorageView {
+			// only set for dense chunks
+			Voxel* data = nullptr;
+			// only set for palette chunks
+			const uint8_t* indices = nullptr;
+			const Voxel* palette = nullptr;
+			uint8_t bitsPerIndex = 0u;
+			// the storage generation of the chunk the view belongs to
+			uint32_t generation = 0u;
+		};
+
+		/**
+		 * @brief Updates the current voxel after the current chunk was changed
+		 */
+		void updateCurrentVoxel(uint32_t voxelIndexInChunk);
+		/**
+		 * @brief Resolves the storage view of the current chunk under the chunk lock
+		 */
+		void updateStorageView() const;
+		/**
+		 * @brief Resolves the storage view again if the current chunk released or reallocated its storage
+		 * since it was resolved (e.g. by @c Chunk::fill() or a storage upgrade)
+		 */
+		const StorageView& storageView() const;
+		/**
+		 * @brief Moves the current voxel inside the current chunk
+		 */
+		void moveCurrentVoxel(int32_t delta);
+		/**
+		 * @return The voxel relative to the current voxel inside the current chunk
+		 */
+		const Voxel& voxelInChunk(int32_t delta) const;
+
 		const PagedVolume* _volume;
 
 		//The current position in the volume
@@ -182,7 +357,8 @@ public:
 		int32_t _zPosInVolume;
 
 		//Other current position information
-		Voxel* _currentVoxel = nullptr;
+		mutable StorageView _storageView;
+		uint32_t _currentIndex = 0u;
 		ChunkPtr _currentChunk	;
 
 		uint16_t _xPosInChunk = 0u;
@@ -197,7 +373,7 @@ public:
 
 public:
 	/// Constructor for creating a fixed size volume.
-	PagedVolume(Pager* pager, uint32_t targetMemoryUsageInBytes = 256 * 1024 * 1024, uint16_t chunkSideLength = 32);
+	PagedVolume(Pager* pager, uint32_t targetMemoryUsageInBytes = 256 * 1024 * 1024, uint16_t chunkSideLength = 32, uint32_t compressedMemoryUsageInBytes = 0u);
 	/// Destructor
 	~PagedVolume();
 
@@ -219,10 +395,39 @@ public:
 	/// Removes all voxels from memory
 	void flushAll();
 
+	/**
+	 * @brief Checks whether all voxels in the given region have the same value. This only looks at the storage
+	 * mode of the chunks that intersect the region and not at the single voxels.
+	 * @param[out] voxel The voxel value if the region is uniform
+	 * @return @c false if any of the chunks is not uniform or the uniform chunks have different voxel values
+	 */
+	bool isUniform(const Region& region, Voxel& voxel) const;
+
 	ChunkPtr chunk(const glm::ivec3& pos) const;
+	/**
+	 * @brief Looks up the chunk for the given world position without paging it in
+	 * @return The chunk if it is held in memory (uncompressed) - an empty pointer otherwise
+	 * @note The chunk might still get paged in by another thread - accessing its voxels blocks until that is done
+	 */
+	ChunkPtr loadedChunk(const glm::ivec3& pos) const;
 
 	glm::ivec3 chunkPos(int x, int y, int z) const;
 
+	/**
+	 * @return The amount of chunks that are currently held in memory
+	 */
+	size_t chunkCount() const;
+
+	/**
+	 * @return The amount of evicted chunks that are held in memory in a compressed form
+	 */
+	size_t compressedChunkCount() const;
+
+	/**
+	 * @return The memory that is used by the compressed chunks
+	 */
+	size_t compressedMemoryUsageInBytes() const;
+
 	inline glm::ivec3 chunkPos(const glm::ivec3& worldPos) const {
 		return chunkPos(worldPos.x, worldPos.y, worldPos.z);
 	}
@@ -239,26 +444,99 @@ protected:
 	PagedVolume& operator=(const PagedVolume& rhs);
 
 private:
+	typedef core::FlatMap<glm::ivec3, ChunkPtr, std::hash<glm::ivec3>> ChunkMap;
+	typedef core::FlatMap<glm::ivec3, CompressedChunkPtr, std::hash<glm::ivec3>> CompressedChunkMap;
+
+	/**
+	 * @brief The chunks are distributed over several shards - each with its own lock and lru list. This
+	 * allows several threads (e.g. mesh extractors and the server world) to look up and create chunks
+	 * without contending on one volume wide lock.
+	 */
+	struct ChunkShard {
+		ChunkShard() : lock("chunkshard") {
+		}
+		core::ReadWriteLock lock;
+		ChunkMap chunks;
+		// most recently used chunk
+		Chunk* lruHead = nullptr;
+		// least recently used chunk - this is the one that is evicted first
+		Chunk* lruTail = nullptr;
+		// incremented whenever a chunk is removed from this shard - invalidates the per thread caches
+		core::AtomicInt generation { 0 };
+
+		CompressedChunkMap compressedChunks;
+		CompressedChunk* compressedLruHead = nullptr;
+		CompressedChunk* compressedLruTail = nullptr;
+		uint32_t compressedBytes = 0u;
+	};
+	static constexpr int ChunkShards = 16;
+
+	/**
+	 * @brief Per thread cache of the last accessed chunk. The slot is only valid as long as the
+	 * generation of the shard the chunk belongs to didn't change.
+	 * @note The slot is written by the owning thread only - but evicting or flushing chunks clears
+	 * the slots that still reference them, so the spin lock guards the chunk pointer.
+	 */
+	struct alignas(64) ThreadCache {
+		SDL_SpinLock lock = 0;
+		int32_t x = 0;
+		int32_t y = 0;
+		int32_t z = 0;
+		int generation = -1;
+		ChunkPtr chunk;
+	};
+	/**
+	 * The slots are handed out to the threads that access a volume and recycled when the thread exits.
+	 * Threads that are alive while all slots are taken don't use a cache.
+	 */
+	static constexpr int ThreadCacheSlots = 64;
+
 	ChunkPtr chunk(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ) const;
-	ChunkPtr existingChunk(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ) const;
-	ChunkPtr createNewChunk(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ) const;
-	void deleteOldestChunkIfNeeded() const;
+	ChunkPtr existingChunk(ChunkShard& shard, int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ) const;
+	/**
+	 * @param[out] evicted The chunk that was evicted to make room for the new one. The caller should release it after the
+	 * shard lock was released, as the chunk might get paged out in the destructor - or hand it over to @c compressChunk().
+	 */
+	ChunkPtr createNewChunk(ChunkShard& shard, int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ, ChunkPtr& evicted) const;
+	/**
+	 * @return The chunk that was removed from the shard (or an empty pointer).
+	 */
+	ChunkPtr deleteOldestChunkIfNeeded(ChunkShard& shard) const;
 
-	// Storing these properties individually has proved to be faster than keeping
-	// them in a glm::ivec3 as it avoids constructions and comparison overheads.
-	// They are also at the start of the class in the hope that they will be pulled
-	// into cache - I've got no idea if this actually makes a difference.
-	mutable int32_t _lastAccessedChunkX = 0;
-	mutable int32_t _lastAccessedChunkY = 0;
-	mutable int32_t _lastAccessedChunkZ = 0;
-	mutable ChunkPtr _lastAccessedChunk = nullptr;
+	/**
+	 * @brief Compresses an evicted chunk outside of the shard lock and commits it to the compressed tier
+	 */
+	void compressChunk(ChunkShard& shard, const ChunkPtr& evicted) const;
+	/**
+	 * @brief Releases the references of the thread caches to the given chunk - or to all chunks if @c nullptr
+	 * is given. Must not be called while holding a shard lock, the chunks might get paged out.
+	 */
+	void releaseThreadCaches(const Chunk* chunk) const;
+	/**
+	 * @brief Removes the compressed chunk for the given position from the compressed tier (if any)
+	 */
+	CompressedChunkPtr takeCompressedChunk(ChunkShard& shard, const glm::ivec3& pos) const;
+	/**
+	 * @brief Removes the least recently used compressed chunks until the shard is within its budget again
+	 * @param[out] removed The removed chunks - release them after the shard lock was released, modified chunks are paged out.
+	 */
+	void deleteOldestCompressedChunksIfNeeded(ChunkShard& shard, core::DynamicArray<CompressedChunkPtr>& removed) const;
 
-	mutable core::AtomicInt _timestamper { 0 };
+	ChunkShard& shard(int32_t uChunkX, int32_t uChunkZ) const;
+	void lruLinkFront(ChunkShard& shard, Chunk* chunk) const;
+	void lruUnlink(ChunkShard& shard, Chunk* chunk) const;
+	void lruLinkFront(ChunkShard& shard, CompressedChunk* chunk) const;
+	void lruUnlink(ChunkShard& shard, CompressedChunk* chunk) const;
 
-	uint32_t _chunkCountLimit = 0u;
+	mutable ChunkShard _shards[ChunkShards];
+	mutable ThreadCache _threadCaches[ThreadCacheSlots];
 
-	typedef core::Map<glm::ivec3, ChunkPtr, 64, std::hash<glm::ivec3>> ChunkMap;
-	mutable ChunkMap _chunks;
+	// The max amount of chunks per shard
+	uint32_t _chunkCountLimit = 0u;
+	// The max amount of compressed chunks per shard - 0 disables the compressed tier
+	uint32_t _compressedChunkCountLimit = 0u;
+	// The max memory of the compressed chunks per shard
+	uint32_t _compressedMemoryLimit = 0u;
 
 	// The size of the chunks
 	uint16_t _chunkSideLength;
@@ -268,12 +546,36 @@ private:
 	Pager* _pager = nullptr;
 
 	Region _region;
-
-	mutable core::ReadWriteLock _volumeLock{"pagedvolume"};
 };
 
+inline const PagedVolume::Sampler::StorageView& PagedVolume::Sampler::storageView() const {
+	if (_storageView.generation != _currentChunk->_storageGeneration) {
+		updateStorageView();
+	}
+	return _storageView;
+}
+
+inline const Voxel& PagedVolume::Sampler::voxelInChunk(int32_t delta) const {
+	const StorageView& view = storageView();
+	const uint32_t index = _currentIndex + delta;
+	if (view.data != nullptr) {
+		return view.data[index];
+	}
+	if (view.bitsPerIndex == 0u) {
+		return view.palette[0];
+	}
+	// the bits per index are a divisor of 8 - an index never spans two bytes
+	const uint32_t bit = index * view.bitsPerIndex;
+	const uint8_t mask = (uint8_t)((1u << view.bitsPerIndex) - 1u);
+	return view.palette[(view.indices[bit >> 3] >> (bit & 7u)) & mask];
+}
+
+inline void PagedVolume::Sampler::moveCurrentVoxel(int32_t delta) {
+	_currentIndex += delta;
+}
+
 inline const Voxel& PagedVolume::Sampler::voxel() const {
-	return *_currentVoxel;
+	return voxelInChunk(0);
 }
 
 inline void PagedVolume::Sampler::setPosition(const glm::ivec3& v3dNewPos) {
@@ -322,186 +624,186 @@ static const core::Array<int32_t, 256> deltaZ = {{ 4, 28, 4, 220, 4, 28, 4, 1756
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel1nx1ny1nz() const {
 	if (CAN_GO_NEG_X(this->_xPosInChunk) && CAN_GO_NEG_Y(this->_yPosInChunk) && CAN_GO_NEG_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + NEG_X_DELTA + NEG_Y_DELTA + NEG_Z_DELTA);
+		return voxelInChunk(NEG_X_DELTA + NEG_Y_DELTA + NEG_Z_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume - 1, this->_yPosInVolume - 1, this->_zPosInVolume - 1);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel1nx1ny0pz() const {
 	if (CAN_GO_NEG_X(this->_xPosInChunk) && CAN_GO_NEG_Y(this->_yPosInChunk)) {
-		return *(_currentVoxel + NEG_X_DELTA + NEG_Y_DELTA);
+		return voxelInChunk(NEG_X_DELTA + NEG_Y_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume - 1, this->_yPosInVolume - 1, this->_zPosInVolume);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel1nx1ny1pz() const {
 	if (CAN_GO_NEG_X(this->_xPosInChunk) && CAN_GO_NEG_Y(this->_yPosInChunk) && CAN_GO_POS_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + NEG_X_DELTA + NEG_Y_DELTA + POS_Z_DELTA);
+		return voxelInChunk(NEG_X_DELTA + NEG_Y_DELTA + POS_Z_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume - 1, this->_yPosInVolume - 1, this->_zPosInVolume + 1);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel1nx0py1nz() const {
 	if (CAN_GO_NEG_X(this->_xPosInChunk) && CAN_GO_NEG_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + NEG_X_DELTA + NEG_Z_DELTA);
+		return voxelInChunk(NEG_X_DELTA + NEG_Z_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume - 1, this->_yPosInVolume, this->_zPosInVolume - 1);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel1nx0py0pz() const {
 	if (CAN_GO_NEG_X(this->_xPosInChunk)) {
-		return *(_currentVoxel + NEG_X_DELTA);
+		return voxelInChunk(NEG_X_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume - 1, this->_yPosInVolume, this->_zPosInVolume);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel1nx0py1pz() const {
 	if (CAN_GO_NEG_X(this->_xPosInChunk) && CAN_GO_POS_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + NEG_X_DELTA + POS_Z_DELTA);
+		return voxelInChunk(NEG_X_DELTA + POS_Z_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume - 1, this->_yPosInVolume, this->_zPosInVolume + 1);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel1nx1py1nz() const {
 	if (CAN_GO_NEG_X(this->_xPosInChunk) && CAN_GO_POS_Y(this->_yPosInChunk) && CAN_GO_NEG_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + NEG_X_DELTA + POS_Y_DELTA + NEG_Z_DELTA);
+		return voxelInChunk(NEG_X_DELTA + POS_Y_DELTA + NEG_Z_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume - 1, this->_yPosInVolume + 1, this->_zPosInVolume - 1);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel1nx1py0pz() const {
 	if (CAN_GO_NEG_X(this->_xPosInChunk) && CAN_GO_POS_Y(this->_yPosInChunk)) {
-		return *(_currentVoxel + NEG_X_DELTA + POS_Y_DELTA);
+		return voxelInChunk(NEG_X_DELTA + POS_Y_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume - 1, this->_yPosInVolume + 1, this->_zPosInVolume);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel1nx1py1pz() const {
 	if (CAN_GO_NEG_X(this->_xPosInChunk) && CAN_GO_POS_Y(this->_yPosInChunk) && CAN_GO_POS_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + NEG_X_DELTA + POS_Y_DELTA + POS_Z_DELTA);
+		return voxelInChunk(NEG_X_DELTA + POS_Y_DELTA + POS_Z_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume - 1, this->_yPosInVolume + 1, this->_zPosInVolume + 1);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel0px1ny1nz() const {
 	if (CAN_GO_NEG_Y(this->_yPosInChunk) && CAN_GO_NEG_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + NEG_Y_DELTA + NEG_Z_DELTA);
+		return voxelInChunk(NEG_Y_DELTA + NEG_Z_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume, this->_yPosInVolume - 1, this->_zPosInVolume - 1);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel0px1ny0pz() const {
 	if (CAN_GO_NEG_Y(this->_yPosInChunk)) {
-		return *(_currentVoxel + NEG_Y_DELTA);
+		return voxelInChunk(NEG_Y_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume, this->_yPosInVolume - 1, this->_zPosInVolume);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel0px1ny1pz() const {
 	if (CAN_GO_NEG_Y(this->_yPosInChunk) && CAN_GO_POS_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + NEG_Y_DELTA + POS_Z_DELTA);
+		return voxelInChunk(NEG_Y_DELTA + POS_Z_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume, this->_yPosInVolume - 1, this->_zPosInVolume + 1);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel0px0py1nz() const {
 	if (CAN_GO_NEG_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + NEG_Z_DELTA);
+		return voxelInChunk(NEG_Z_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume, this->_yPosInVolume, this->_zPosInVolume - 1);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel0px0py0pz() const {
-	return *_currentVoxel;
+	return voxelInChunk(0);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel0px0py1pz() const {
 	if (CAN_GO_POS_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + POS_Z_DELTA);
+		return voxelInChunk(POS_Z_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume, this->_yPosInVolume, this->_zPosInVolume + 1);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel0px1py1nz() const {
 	if (CAN_GO_POS_Y(this->_yPosInChunk) && CAN_GO_NEG_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + POS_Y_DELTA + NEG_Z_DELTA);
+		return voxelInChunk(POS_Y_DELTA + NEG_Z_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume, this->_yPosInVolume + 1, this->_zPosInVolume - 1);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel0px1py0pz() const {
 	if (CAN_GO_POS_Y(this->_yPosInChunk)) {
-		return *(_currentVoxel + POS_Y_DELTA);
+		return voxelInChunk(POS_Y_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume, this->_yPosInVolume + 1, this->_zPosInVolume);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel0px1py1pz() const {
 	if (CAN_GO_POS_Y(this->_yPosInChunk) && CAN_GO_POS_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + POS_Y_DELTA + POS_Z_DELTA);
+		return voxelInChunk(POS_Y_DELTA + POS_Z_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume, this->_yPosInVolume + 1, this->_zPosInVolume + 1);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel1px1ny1nz() const {
 	if (CAN_GO_POS_X(this->_xPosInChunk) && CAN_GO_NEG_Y(this->_yPosInChunk) && CAN_GO_NEG_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + POS_X_DELTA + NEG_Y_DELTA + NEG_Z_DELTA);
+		return voxelInChunk(POS_X_DELTA + NEG_Y_DELTA + NEG_Z_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume + 1, this->_yPosInVolume - 1, this->_zPosInVolume - 1);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel1px1ny0pz() const {
 	if (CAN_GO_POS_X(this->_xPosInChunk) && CAN_GO_NEG_Y(this->_yPosInChunk)) {
-		return *(_currentVoxel + POS_X_DELTA + NEG_Y_DELTA);
+		return voxelInChunk(POS_X_DELTA + NEG_Y_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume + 1, this->_yPosInVolume - 1, this->_zPosInVolume);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel1px1ny1pz() const {
 	if (CAN_GO_POS_X(this->_xPosInChunk) && CAN_GO_NEG_Y(this->_yPosInChunk) && CAN_GO_POS_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + POS_X_DELTA + NEG_Y_DELTA + POS_Z_DELTA);
+		return voxelInChunk(POS_X_DELTA + NEG_Y_DELTA + POS_Z_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume + 1, this->_yPosInVolume - 1, this->_zPosInVolume + 1);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel1px0py1nz() const {
 	if (CAN_GO_POS_X(this->_xPosInChunk) && CAN_GO_NEG_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + POS_X_DELTA + NEG_Z_DELTA);
+		return voxelInChunk(POS_X_DELTA + NEG_Z_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume + 1, this->_yPosInVolume, this->_zPosInVolume - 1);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel1px0py0pz() const {
 	if (CAN_GO_POS_X(this->_xPosInChunk)) {
-		return *(_currentVoxel + POS_X_DELTA);
+		return voxelInChunk(POS_X_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume + 1, this->_yPosInVolume, this->_zPosInVolume);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel1px0py1pz() const {
 	if (CAN_GO_POS_X(this->_xPosInChunk) && CAN_GO_POS_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + POS_X_DELTA + POS_Z_DELTA);
+		return voxelInChunk(POS_X_DELTA + POS_Z_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume + 1, this->_yPosInVolume, this->_zPosInVolume + 1);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel1px1py1nz() const {
 	if (CAN_GO_POS_X(this->_xPosInChunk) && CAN_GO_POS_Y(this->_yPosInChunk) && CAN_GO_NEG_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + POS_X_DELTA + POS_Y_DELTA + NEG_Z_DELTA);
+		return voxelInChunk(POS_X_DELTA + POS_Y_DELTA + NEG_Z_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume + 1, this->_yPosInVolume + 1, this->_zPosInVolume - 1);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel1px1py0pz() const {
 	if (CAN_GO_POS_X(this->_xPosInChunk) && CAN_GO_POS_Y(this->_yPosInChunk)) {
-		return *(_currentVoxel + POS_X_DELTA + POS_Y_DELTA);
+		return voxelInChunk(POS_X_DELTA + POS_Y_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume + 1, this->_yPosInVolume + 1, this->_zPosInVolume);
 }
 
 inline const Voxel& PagedVolume::Sampler::peekVoxel1px1py1pz() const {
 	if (CAN_GO_POS_X(this->_xPosInChunk) && CAN_GO_POS_Y(this->_yPosInChunk) && CAN_GO_POS_Z(this->_zPosInChunk)) {
-		return *(_currentVoxel + POS_X_DELTA + POS_Y_DELTA + POS_Z_DELTA);
+		return voxelInChunk(POS_X_DELTA + POS_Y_DELTA + POS_Z_DELTA);
 	}
 	return this->_volume->voxel(this->_xPosInVolume + 1, this->_yPosInVolume + 1, this->_zPosInVolume + 1);
 }
@@ -9,6 +9,15 @@
 
 namespace voxel {
 
+// extracts every third bit of the given morton index - this is the inverse of the morton256 tables
+static inline uint32_t mortonCompact(uint32_t index) {
+	uint32_t value = 0u;
+	for (uint32_t bit = 0u; bit < 8u; ++bit) {
+		value |= ((index >> (bit * 3u)) & 1u) << bit;
+	}
+	return value;
+}
+
 PagedVolume::Chunk::Chunk(const glm::ivec3& v3dPosition, uint16_t uSideLength, Pager* pPager) :
 		_pager(pPager), _chunkSpacePosition(v3dPosition) {
 	core_assert_msg(_pager, "No valid pager supplied to chunk constructor.");
@@ -18,10 +27,8 @@ PagedVolume::Chunk::Chunk(const glm::ivec3& v3dPosition, uint16_t uSideLength, P
 	_sideLength = uSideLength;
 	_sideLengthPower = logBase2(uSideLength);
 
-	// Allocate the data
-	const uint32_t uNoOfVoxels = _sideLength * _sideLength * _sideLength;
-	_data = (Voxel*)core_malloc(uNoOfVoxels * sizeof(Voxel));
-	core_memset(_data, 0, uNoOfVoxels * sizeof(Voxel));
+	// The chunk starts as uniform chunk - nothing is allocated until different voxels are written
+	_palette[0] = Voxel();
 }
 
 PagedVolume::Chunk::~Chunk() {
@@ -29,8 +36,19 @@ PagedVolume::Chunk::~Chunk() {
 		_pager->pageOut(this);
 	}
 
+	freeStorage();
+	core_free(_columnHeights);
+}
+
+void PagedVolume::Chunk::freeStorage() {
+	if (_data != nullptr || _indices != nullptr) {
+		// invalidate the storage views of the samplers
+		++_storageGeneration;
+	}
 	core_free(_data);
 	_data = nullptr;
+	core_free(_indices);
+	_indices = nullptr;
 }
 
 bool PagedVolume::Chunk::setData(const Voxel* voxels, size_t sizeInBytes) {
@@ -39,14 +57,153 @@ bool PagedVolume::Chunk::setData(const Voxel* voxels, size_t sizeInBytes) {
 	}
 	core::ScopedWriteLock writeLock(_chunkLock);
 	_dataModified = true;
+	convertToDense();
 	core_memcpy((uint8_t*)_data, (const uint8_t*)voxels, sizeInBytes);
+	_columnHeightsValid = false;
 	return true;
 }
 
-Voxel* PagedVolume::Chunk::data() const {
+Voxel* PagedVolume::Chunk::data() {
+	core::ScopedWriteLock writeLock(_chunkLock);
+	convertToDense();
+	// the caller might modify the voxels
+	_columnHeightsValid = false;
 	return _data;
 }
 
+PagedVolume::ChunkStorage PagedVolume::Chunk::storage() const {
+	core::ScopedReadLock readLock(_chunkLock);
+	if (_data != nullptr) {
+		return ChunkStorage::Dense;
+	}
+	if (_bitsPerIndex == 0u) {
+		return ChunkStorage::Uniform;
+	}
+	return ChunkStorage::Palette;
+}
+
+uint32_t PagedVolume::Chunk::storageSizeInBytes() const {
+	core::ScopedReadLock readLock(_chunkLock);
+	if (_data != nullptr) {
+		return dataSizeInBytes();
+	}
+	return voxels() * _bitsPerIndex / 8u;
+}
+
+bool PagedVolume::Chunk::isUniform(Voxel& voxel) const {
+	core::ScopedReadLock readLock(_chunkLock);
+	if (_data != nullptr || _bitsPerIndex != 0u) {
+		return false;
+	}
+	voxel = _palette[0];
+	return true;
+}
+
+void PagedVolume::Chunk::fill(const Voxel& voxel) {
+	core::ScopedWriteLock writeLock(_chunkLock);
+	freeStorage();
+	_palette[0] = voxel;
+	_paletteSize = 1u;
+	_bitsPerIndex = 0u;
+	_dataModified = true;
+	_columnHeightsValid = false;
+}
+
+const Voxel& PagedVolume::Chunk::voxelByIndex(uint32_t index) const {
+	if (_data != nullptr) {
+		return _data[index];
+	}
+	if (_bitsPerIndex == 0u) {
+		return _palette[0];
+	}
+	// the bits per index are a divisor of 8 - an index never spans two bytes
+	const uint32_t bit = index * _bitsPerIndex;
+	const uint8_t mask = (uint8_t)((1u << _bitsPerIndex) - 1u);
+	const uint8_t paletteIndex = (_indices[bit >> 3] >> (bit & 7u)) & mask;
+	return _palette[paletteIndex];
+}
+
+void PagedVolume::Chunk::setVoxelByIndex(uint32_t index, const Voxel& voxel) {
+	if (_data != nullptr) {
+		_data[index] = voxel;
+		return;
+	}
+	uint8_t paletteIndex = 0u;
+	while (paletteIndex < _paletteSize && !_palette[paletteIndex].isSame(voxel)) {
+		++paletteIndex;
+	}
+	if (paletteIndex == _paletteSize) {
+		if (_paletteSize == MaxPaletteEntries) {
+			convertToDense();
+			_data[index] = voxel;
+			return;
+		}
+		_palette[_paletteSize++] = voxel;
+		const uint8_t bitsPerIndex = _paletteSize <= 2 ? 1u : (_paletteSize <= 4 ? 2u : 4u);
+		if (bitsPerIndex != _bitsPerIndex) {
+			repackIndices(bitsPerIndex);
+		}
+	}
+	if (_bitsPerIndex == 0u) {
+		// still uniform - the voxel is the same
+		return;
+	}
+	const uint32_t bit = index * _bitsPerIndex;
+	const uint8_t shift = bit & 7u;
+	const uint8_t mask = (uint8_t)(((1u << _bitsPerIndex) - 1u) << shift);
+	uint8_t& byte = _indices[bit >> 3];
+	byte = (byte & ~mask) | ((paletteIndex << shift) & mask);
+}
+
+void PagedVolume::Chunk::repackIndices(uint8_t bitsPerIndex) {
+	const uint32_t amount = voxels();
+	const uint32_t sizeInBytes = amount * bitsPerIndex / 8u;
+	uint8_t* indices = (uint8_t*)core_malloc(sizeInBytes);
+	core_memset(indices, 0, sizeInBytes);
+	if (_bitsPerIndex != 0u) {
+		const uint8_t oldMask = (uint8_t)((1u << _bitsPerIndex) - 1u);
+		for (uint32_t i = 0u; i < amount; ++i) {
+			const uint32_t oldBit = i * _bitsPerIndex;
+			const uint8_t paletteIndex = (_indices[oldBit >> 3] >> (oldBit & 7u)) & oldMask;
+			const uint32_t bit = i * bitsPerIndex;
+			indices[bit >> 3] |= (uint8_t)(paletteIndex << (bit & 7u));
+		}
+	}
+	core_free(_indices);
+	_indices = indices;
+	_bitsPerIndex = bitsPerIndex;
+	++_storageGeneration;
+}
+
+void PagedVolume::Chunk::convertToDense() {
+	if (_data != nullptr) {
+		return;
+	}
+	const uint32_t amount = voxels();
+	Voxel* data = (Voxel*)core_malloc(amount * sizeof(Voxel));
+	for (uint32_t i = 0u; i < amount; ++i) {
+		data[i] = voxelByIndex(i);
+	}
+	core_free(_indices);
+	_indices = nullptr;
+	_data = data;
+	++_storageGeneration;
+}
+
+const Voxel& PagedVolume::Chunk::voxelAtIndex(uint32_t mortonIndex) const {
+	core_assert_msg(mortonIndex < voxels(), "Supplied index is outside of the chunk");
+	core::ScopedReadLock readLock(_chunkLock);
+	return voxelByIndex(mortonIndex);
+}
+
+void PagedVolume::Chunk::setVoxelAtIndex(uint32_t mortonIndex, const Voxel& voxel) {
+	core_assert_msg(mortonIndex < voxels(), "Supplied index is outside of the chunk");
+	core::ScopedWriteLock writeLock(_chunkLock);
+	setVoxelByIndex(mortonIndex, voxel);
+	updateColumnHeight(mortonCompact(mortonIndex), mortonCompact(mortonIndex >> 1), mortonCompact(mortonIndex >> 2), voxel);
+	_dataModified = true;
+}
+
 uint32_t PagedVolume::Chunk::dataSizeInBytes() const {
 	return voxels() * sizeof(Voxel);
 }
@@ -61,11 +218,10 @@ const Voxel& PagedVolume::Chunk::voxel(uint32_t uXPos, uint32_t uYPos, uint32_t
 	core_assert_msg(uXPos < _sideLength, "Supplied position is outside of the chunk. asserted %u > %u", uXPos, _sideLength);
 	core_assert_msg(uYPos < _sideLength, "Supplied position is outside of the chunk. asserted %u > %u", uYPos, _sideLength);
 	core_assert_msg(uZPos < _sideLength, "Supplied position is outside of the chunk. asserted %u > %u", uZPos, _sideLength);
-	core_assert_msg(_data, "No uncompressed data - chunk must be decompressed before accessing voxels.");
 
 	const uint32_t index = morton256_x[uXPos] | morton256_y[uYPos] | morton256_z[uZPos];
 	core::ScopedReadLock readLock(_chunkLock);
-	return _data[index];
+	return voxelByIndex(index);
 }
 
 const Voxel& PagedVolume::Chunk::voxel(const glm::i16vec3& v3dPos) const {
@@ -78,11 +234,11 @@ void PagedVolume::Chunk::setVoxel(uint32_t uXPos, uint32_t uYPos, uint32_t uZPos
 	core_assert_msg(uXPos < _sideLength, "Supplied position is outside of the chunk");
 	core_assert_msg(uYPos < _sideLength, "Supplied position is outside of the chunk");
 	core_assert_msg(uZPos < _sideLength, "Supplied position is outside of the chunk");
-	core_assert_msg(_data, "No uncompressed data - chunk must be decompressed before accessing voxels.");
 
 	const uint32_t index = morton256_x[uXPos] | morton256_y[uYPos] | morton256_z[uZPos];
 	core::ScopedWriteLock writeLock(_chunkLock);
-	_data[index] = tValue;
+	setVoxelByIndex(index, tValue);
+	updateColumnHeight(uXPos, uYPos, uZPos, tValue);
 	_dataModified = true;
 }
 
@@ -97,12 +253,14 @@ void PagedVolume::Chunk::setVoxels(uint32_t uXPos, uint32_t uYPos, uint32_t uZPo
 	core_assert_msg(uXPos < _sideLength, "Supplied x position is outside of the chunk");
 	core_assert_msg(uYPos < _sideLength, "Supplied y position is outside of the chunk");
 	core_assert_msg(uZPos < _sideLength, "Supplied z position is outside of the chunk");
-	core_assert_msg(_data, "No uncompressed data - chunk must be decompressed before accessing voxels.");
 
 	core::ScopedWriteLock writeLock(_chunkLock);
 	for (int y = uYPos; y < amount; ++y) {
 		const uint32_t index = morton256_x[uXPos] | morton256_y[y] | morton256_z[uZPos];
-		_data[index] = tValues[y];
+		setVoxelByIndex(index, tValues[y]);
+	}
+	if (_columnHeightsValid) {
+		_columnHeights[uXPos + uZPos * _sideLength] = scanColumnHeight(uXPos, uZPos, _sideLength - 1);
 	}
 	_dataModified = true;
 }
@@ -119,6 +277,69 @@ void PagedVolume::Chunk::setVoxel(const glm::i16vec3& v3dPos, const Voxel& tValu
 	setVoxel(v3dPos.x, v3dPos.y, v3dPos.z, tValue);
 }
 
+uint16_t PagedVolume::Chunk::scanColumnHeight(uint32_t uXPos, uint32_t uZPos, int topY) const {
+	const uint32_t columnIndex = morton256_x[uXPos] | morton256_z[uZPos];
+	for (int y = topY; y >= 0; --y) {
+		const Voxel& voxel = voxelByIndex(columnIndex | morton256_y[y]);
+		if (!isEnterable(voxel.getMaterial())) {
+			return (uint16_t)(y + 1);
+		}
+	}
+	return 0u;
+}
+
+void PagedVolume::Chunk::updateColumnHeight(uint32_t uXPos, uint32_t uYPos, uint32_t uZPos, const Voxel& voxel) {
+	if (!_columnHeightsValid) {
+		return;
+	}
+	uint16_t& height = _columnHeights[uXPos + uZPos * _sideLength];
+	if (!isEnterable(voxel.getMaterial())) {
+		if (uYPos >= height) {
+			height = (uint16_t)(uYPos + 1u);
+		}
+	} else if (uYPos + 1u == height) {
+		// the highest voxel was removed - look for the next one below
+		height = scanColumnHeight(uXPos, uZPos, (int)uYPos - 1);
+	}
+}
+
+void PagedVolume::Chunk::buildColumnHeightsUnlocked() {
+	if (_columnHeightsValid) {
+		return;
+	}
+	const uint32_t columns = _sideLength * _sideLength;
+	if (_columnHeights == nullptr) {
+		_columnHeights = (uint16_t*)core_malloc(columns * sizeof(uint16_t));
+	}
+	if (_data == nullptr && _bitsPerIndex == 0u) {
+		// all columns of a uniform chunk have the same height
+		const uint16_t height = isEnterable(_palette[0].getMaterial()) ? 0u : _sideLength;
+		for (uint32_t i = 0u; i < columns; ++i) {
+			_columnHeights[i] = height;
+		}
+	} else {
+		for (uint32_t z = 0u; z < _sideLength; ++z) {
+			for (uint32_t x = 0u; x < _sideLength; ++x) {
+				_columnHeights[x + z * _sideLength] = scanColumnHeight(x, z, _sideLength - 1);
+			}
+		}
+	}
+	_columnHeightsValid = true;
+}
+
+void PagedVolume::Chunk::buildColumnHeights() {
+	core::ScopedWriteLock writeLock(_chunkLock);
+	buildColumnHeightsUnlocked();
+}
+
+int PagedVolume::Chunk::columnHeight(uint32_t uXPos, uint32_t uZPos) {
+	core_assert_msg(uXPos < _sideLength, "Supplied position is outside of the chunk");
+	core_assert_msg(uZPos < _sideLength, "Supplied position is outside of the chunk");
+	core::ScopedWriteLock writeLock(_chunkLock);
+	buildColumnHeightsUnlocked();
+	return _columnHeights[uXPos + uZPos * _sideLength];
+}
+
 uint32_t PagedVolume::Chunk::calculateSizeInBytes(uint32_t sideLength) {
 	// Note: We disregard the size of the other class members as they are likely to be very small compared to the size of the
 	// allocated voxel data. This also keeps the reported size as a power of two, which makes other memory calculations easier.
@@ -0,0 +1,86 @@
+/**
+ * @file
+ */
+
+#include "PagedVolume.h"
+#include "core/Common.h"
+
+namespace voxel {
+
+PagedVolume::CompressedChunk::CompressedChunk(const ChunkPtr& chunk) :
+		_pending(chunk), _sideLength(chunk->_sideLength), _pager(chunk->_pager), _chunkSpacePosition(chunk->_chunkSpacePosition) {
+}
+
+PagedVolume::CompressedChunk::~CompressedChunk() {
+	if (_dataModified && _runs != nullptr && _pager != nullptr) {
+		// the chunk will page out the data in its destructor
+		Chunk chunk(_chunkSpacePosition, _sideLength, _pager);
+		decompress(chunk);
+	}
+	core_free(_runs);
+	_runs = nullptr;
+}
+
+void PagedVolume::CompressedChunk::compress() {
+	core_assert_msg(_pending, "The chunk was already compressed");
+	const Chunk& chunk = *_pending.get();
+	core::ScopedReadLock readLock(chunk._chunkLock);
+	const uint32_t voxels = chunk.voxels();
+
+	// the first pass counts the runs to only allocate the needed amount of memory
+	uint32_t runCount = 0u;
+	for (uint32_t i = 0u; i < voxels;) {
+		uint32_t n = 1u;
+		const Voxel& voxel = chunk.voxelByIndex(i);
+		while (i + n < voxels && n < 0xFFFF && chunk.voxelByIndex(i + n).isSame(voxel)) {
+			++n;
+		}
+		++runCount;
+		i += n;
+	}
+
+	core_free(_runs);
+	_runs = (Run*)core_malloc(runCount * sizeof(Run));
+	_runCount = runCount;
+
+	Run* run = _runs;
+	for (uint32_t i = 0u; i < voxels;) {
+		uint32_t n = 1u;
+		const Voxel& voxel = chunk.voxelByIndex(i);
+		while (i + n < voxels && n < 0xFFFF && chunk.voxelByIndex(i + n).isSame(voxel)) {
+			++n;
+		}
+		run->length = (uint16_t)n;
+		run->voxel = voxel;
+		++run;
+		i += n;
+	}
+}
+
+void PagedVolume::CompressedChunk::decompress(Chunk& chunk) {
+	core_assert_msg(_runs != nullptr, "The chunk wasn't compressed yet");
+	core_assert(chunk._sideLength == _sideLength);
+	core::ScopedWriteLock writeLock(chunk._chunkLock);
+	// the chunk picks the storage mode while the voxels are written
+	uint32_t index = 0u;
+	for (uint32_t i = 0u; i < _runCount; ++i) {
+		const Run& run = _runs[i];
+		for (uint16_t n = 0u; n < run.length; ++n) {
+			chunk.setVoxelByIndex(index++, run.voxel);
+		}
+	}
+	core_assert(index == chunk.voxels());
+	chunk._dataModified = _dataModified;
+	_dataModified = false;
+}
+
+uint32_t PagedVolume::CompressedChunk::sizeInBytes() const {
+	if (_runs == nullptr) {
+		// the evicted chunk is still accounted in the chunk budget until it's released - the
+		// real size is known and enforced once the data was compressed
+		return (uint32_t)sizeof(CompressedChunk);
+	}
+	return (uint32_t)sizeof(CompressedChunk) + _runCount * (uint32_t)sizeof(Run);
+}
+
+}
@@ -51,16 +51,37 @@ void PagedVolume::Sampler::setPosition(int32_t xPos, int32_t yPos, int32_t zPos)
 	const uint32_t voxelIndexInChunk = morton256_x[_xPosInChunk] | morton256_y[_yPosInChunk] | morton256_z[_zPosInChunk];
 
 	_currentChunk = _volume->chunk(xChunk, yChunk, zChunk);
-	_currentVoxel = _currentChunk->_data + voxelIndexInChunk;
+	updateCurrentVoxel(voxelIndexInChunk);
+}
+
+void PagedVolume::Sampler::updateCurrentVoxel(uint32_t voxelIndexInChunk) {
+	_currentIndex = voxelIndexInChunk;
+	updateStorageView();
+}
+
+void PagedVolume::Sampler::updateStorageView() const {
+	const Chunk* chunk = _currentChunk.get();
+	core::ScopedReadLock readLock(chunk->_chunkLock);
+	_storageView.generation = chunk->_storageGeneration;
+	_storageView.data = chunk->_data;
+	_storageView.indices = chunk->_indices;
+	_storageView.palette = &chunk->_palette[0];
+	_storageView.bitsPerIndex = chunk->_bitsPerIndex;
 }
 
 bool PagedVolume::Sampler::setVoxel(const Voxel& tValue) {
-	if (_currentVoxel == nullptr) {
+	if (!_currentChunk) {
 		return false;
 	}
+	const StorageView& view = storageView();
+	if (view.data == nullptr) {
+		// uniform and palette chunks might get upgraded by this - the view is resolved again on the next access
+		_currentChunk->setVoxelAtIndex(_currentIndex, tValue);
+		return true;
+	}
 	//Need to think what effect this has on any existing iterators.
 	//core_assert_msg(false, "This function cannot be used on PagedVolume samplers.");
-	*_currentVoxel = tValue;
+	view.data[_currentIndex] = tValue;
 	return true;
 }
 
@@ -70,7 +91,7 @@ void PagedVolume::Sampler::movePositiveX() {
 	// Then we update the voxel pointer
 	if (CAN_GO_POS_X(_xPosInChunk)) {
 		//No need to compute new chunk.
-		_currentVoxel += POS_X_DELTA;
+		moveCurrentVoxel(POS_X_DELTA);
 		_xPosInChunk++;
 	} else {
 		//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -84,7 +105,7 @@ void PagedVolume::Sampler::movePositiveY() {
 	// Then we update the voxel pointer
 	if (CAN_GO_POS_Y(_yPosInChunk)) {
 		//No need to compute new chunk.
-		_currentVoxel += POS_Y_DELTA;
+		moveCurrentVoxel(POS_Y_DELTA);
 		_yPosInChunk++;
 	} else {
 		//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -98,7 +119,7 @@ void PagedVolume::Sampler::movePositiveZ() {
 	// Then we update the voxel pointer
 	if (CAN_GO_POS_Z(_zPosInChunk)) {
 		//No need to compute new chunk.
-		_currentVoxel += POS_Z_DELTA;
+		moveCurrentVoxel(POS_Z_DELTA);
 		_zPosInChunk++;
 	} else {
 		//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -112,7 +133,7 @@ void PagedVolume::Sampler::moveNegativeX() {
 	// Then we update the voxel pointer
 	if (CAN_GO_NEG_X(_xPosInChunk)) {
 		//No need to compute new chunk.
-		_currentVoxel += NEG_X_DELTA;
+		moveCurrentVoxel(NEG_X_DELTA);
 		_xPosInChunk--;
 	} else {
 		//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -126,7 +147,7 @@ void PagedVolume::Sampler::moveNegativeY() {
 	// Then we update the voxel pointer
 	if (CAN_GO_NEG_Y(_yPosInChunk)) {
 		//No need to compute new chunk.
-		_currentVoxel += NEG_Y_DELTA;
+		moveCurrentVoxel(NEG_Y_DELTA);
 		_yPosInChunk--;
 	} else {
 		//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -140,7 +161,7 @@ void PagedVolume::Sampler::moveNegativeZ() {
 	// Then we update the voxel pointer
 	if (CAN_GO_NEG_Z(_zPosInChunk)) {
 		//No need to compute new chunk.
-		_currentVoxel += NEG_Z_DELTA;
+		moveCurrentVoxel(NEG_Z_DELTA);
 		_zPosInChunk--;
 	} else {
 		//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this.
@@ -0,0 +1,281 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "voxel/PagedVolume.h"
+#include "core/ArrayLength.h"
+#include <thread>
+
+namespace voxel {
+
+class PagedVolumeTest: public core::AbstractTest {
+protected:
+	class Pager: public PagedVolume::Pager {
+	public:
+		int pageIns = 0;
+		int pageOuts = 0;
+
+		bool pageIn(PagedVolume::PagerContext& ctx) override {
+			++pageIns;
+			ctx.chunk->setVoxel(0, 0, 0, createVoxel(VoxelType::Grass, 0));
+			return true;
+		}
+
+		void pageOut(PagedVolume::Chunk* chunk) override {
+			++pageOuts;
+		}
+	};
+
+	Pager _pager;
+	// 1MB with a chunk side length of 16 are 128 chunks - 8 per shard
+	const uint32_t _memory = 1 * 1024 * 1024;
+	const uint16_t _chunkSideLength = 16;
+	const int _chunksPerShard = 8;
+};
+
+TEST_F(PagedVolumeTest, testChunkLimit) {
+	PagedVolume volume(&_pager, _memory, _chunkSideLength);
+	// all of these chunks end up in the same shard
+	for (int i = 0; i < _chunksPerShard * 4; ++i) {
+		const glm::ivec3 pos(i * 4 * _chunkSideLength, 0, 0);
+		EXPECT_EQ(VoxelType::Grass, volume.voxel(pos).getMaterial());
+	}
+	EXPECT_EQ((size_t)_chunksPerShard, volume.chunkCount());
+	EXPECT_EQ(_chunksPerShard * 4, _pager.pageIns);
+	EXPECT_EQ(_chunksPerShard * 3, _pager.pageOuts);
+}
+
+TEST_F(PagedVolumeTest, testLeastRecentlyUsedIsEvicted) {
+	PagedVolume volume(&_pager, _memory, _chunkSideLength);
+	const glm::ivec3 keep(0);
+	const PagedVolume::ChunkPtr& chunk = volume.chunk(keep);
+	for (int i = 1; i < _chunksPerShard * 4; ++i) {
+		const glm::ivec3 pos(i * 4 * _chunkSideLength, 0, 0);
+		volume.voxel(pos);
+		// touch the chunk again to keep it alive
+		volume.voxel(keep);
+		volume.voxel(keep + glm::ivec3(_chunkSideLength, 0, 0));
+	}
+	EXPECT_EQ(chunk.get(), volume.chunk(keep).get());
+	const int pageIns = _pager.pageIns;
+	volume.voxel(glm::ivec3(4 * _chunkSideLength, 0, 0));
+	EXPECT_EQ(pageIns + 1, _pager.pageIns) << "The least recently used chunk should have been evicted";
+}
+
+TEST_F(PagedVolumeTest, testFlushAll) {
+	PagedVolume volume(&_pager, _memory, _chunkSideLength);
+	for (int i = 0; i < 16; ++i) {
+		volume.voxel(glm::ivec3(i * _chunkSideLength, 0, 0));
+	}
+	EXPECT_EQ(16u, volume.chunkCount());
+	volume.flushAll();
+	EXPECT_EQ(0u, volume.chunkCount());
+	const int pageIns = _pager.pageIns;
+	volume.voxel(glm::ivec3(0));
+	EXPECT_EQ(pageIns + 1, _pager.pageIns) << "The per thread cache must not return a flushed chunk";
+}
+
+TEST_F(PagedVolumeTest, testFlushAllReleasesThreadCaches) {
+	PagedVolume volume(&_pager, _memory, _chunkSideLength);
+	// more threads than cache slots - the slots of the finished threads are reused
+	for (int i = 0; i < 128; ++i) {
+		std::thread thread([&] () {
+			volume.voxel(glm::ivec3((i % 16) * _chunkSideLength, 0, 0));
+		});
+		thread.join();
+	}
+	EXPECT_EQ(16u, volume.chunkCount());
+	volume.flushAll();
+	EXPECT_EQ(16, _pager.pageOuts) << "The thread caches must not keep flushed chunks alive";
+}
+
+TEST_F(PagedVolumeTest, testCompressedChunkIsReused) {
+	PagedVolume volume(&_pager, _memory, _chunkSideLength, _memory);
+	for (int i = 0; i < _chunksPerShard * 2; ++i) {
+		const glm::ivec3 pos(i * 4 * _chunkSideLength, 0, 0);
+		volume.setVoxel(pos + glm::ivec3(1), createVoxel(VoxelType::Rock, 1));
+	}
+	EXPECT_EQ((size_t)_chunksPerShard, volume.chunkCount());
+	EXPECT_EQ((size_t)_chunksPerShard, volume.compressedChunkCount());
+	EXPECT_GT(volume.compressedMemoryUsageInBytes(), 0u);
+	EXPECT_EQ(0, _pager.pageOuts) << "Evicted chunks should be kept in the compressed tier";
+
+	const int pageIns = _pager.pageIns;
+	EXPECT_EQ(VoxelType::Grass, volume.voxel(glm::ivec3(0)).getMaterial());
+	EXPECT_EQ(VoxelType::Rock, volume.voxel(glm::ivec3(1)).getMaterial());
+	EXPECT_EQ(pageIns, _pager.pageIns) << "The chunk should have been restored from the compressed tier";
+}
+
+TEST_F(PagedVolumeTest, testCompressedChunkIsPagedOut) {
+	PagedVolume volume(&_pager, _memory, _chunkSideLength, _memory);
+	for (int i = 0; i < _chunksPerShard * 2; ++i) {
+		const glm::ivec3 pos(i * 4 * _chunkSideLength, 0, 0);
+		volume.voxel(pos);
+	}
+	EXPECT_EQ(0, _pager.pageOuts);
+	volume.flushAll();
+	EXPECT_EQ(0u, volume.compressedChunkCount());
+	EXPECT_EQ(0u, volume.compressedMemoryUsageInBytes());
+	EXPECT_EQ(_chunksPerShard * 2, _pager.pageOuts) << "Modified chunks must be paged out - compressed or not";
+}
+
+TEST_F(PagedVolumeTest, testCompressedTierWithMapChunkSize) {
+	class EmptyPager: public PagedVolume::Pager {
+	public:
+		bool pageIn(PagedVolume::PagerContext& ctx) override {
+			// keep the chunks uniform - there is no need to allocate the voxels
+			return true;
+		}
+		void pageOut(PagedVolume::Chunk* chunk) override {
+		}
+	};
+	EmptyPager pager;
+	// the defaults of the map - the uncompressed chunk size exceeds the compressed budget of a shard
+	const uint16_t chunkSideLength = 256;
+	const uint32_t compressedMemory = 256 * 1024 * 1024;
+	// the budget is split over 16 shards
+	const uint32_t compressedMemoryPerShard = compressedMemory / 16;
+	const uint32_t chunkSizeInBytes = chunkSideLength * chunkSideLength * chunkSideLength * (uint32_t)sizeof(Voxel);
+	ASSERT_GT(chunkSizeInBytes, compressedMemoryPerShard);
+	PagedVolume volume(&pager, 512 * 1024 * 1024, chunkSideLength, compressedMemory);
+	// 64 chunks are the minimum - 4 per shard. All of these chunks end up in the same shard.
+	for (int i = 0; i < 5; ++i) {
+		const glm::ivec3 pos(i * 4 * chunkSideLength, 0, 0);
+		volume.voxel(pos);
+	}
+	EXPECT_EQ(4u, volume.chunkCount());
+	EXPECT_EQ(1u, volume.compressedChunkCount()) << "The evicted chunk should be kept in the compressed tier";
+	EXPECT_GT(volume.compressedMemoryUsageInBytes(), 0u);
+	EXPECT_LE(volume.compressedMemoryUsageInBytes(), compressedMemoryPerShard);
+}
+
+TEST_F(PagedVolumeTest, testChunkStorageUpgrade) {
+	PagedVolume::Chunk chunk(glm::ivec3(0), _chunkSideLength, &_pager);
+	EXPECT_EQ(PagedVolume::ChunkStorage::Uniform, chunk.storage());
+	EXPECT_EQ(0u, chunk.storageSizeInBytes());
+	chunk.setVoxel(0, 0, 0, Voxel());
+	EXPECT_EQ(PagedVolume::ChunkStorage::Uniform, chunk.storage()) << "Writing the uniform voxel should not upgrade the chunk";
+
+	for (int i = 0; i < PagedVolume::Chunk::MaxPaletteEntries - 1; ++i) {
+		chunk.setVoxel(i, i, i, createVoxel(VoxelType::Rock, i));
+		EXPECT_EQ(PagedVolume::ChunkStorage::Palette, chunk.storage());
+	}
+	EXPECT_LT(chunk.storageSizeInBytes(), chunk.dataSizeInBytes());
+	for (int i = 0; i < PagedVolume::Chunk::MaxPaletteEntries - 1; ++i) {
+		EXPECT_TRUE(chunk.voxel(i, i, i).isSame(createVoxel(VoxelType::Rock, i)));
+	}
+	EXPECT_EQ(VoxelType::Air, chunk.voxel(1, 0, 0).getMaterial());
+
+	chunk.setVoxel(1, 0, 0, createVoxel(VoxelType::Grass, 0));
+	EXPECT_EQ(PagedVolume::ChunkStorage::Dense, chunk.storage());
+	EXPECT_EQ(chunk.dataSizeInBytes(), chunk.storageSizeInBytes());
+	for (int i = 0; i < PagedVolume::Chunk::MaxPaletteEntries - 1; ++i) {
+		EXPECT_TRUE(chunk.voxel(i, i, i).isSame(createVoxel(VoxelType::Rock, i)));
+	}
+	EXPECT_EQ(VoxelType::Grass, chunk.voxel(1, 0, 0).getMaterial());
+	EXPECT_EQ(VoxelType::Air, chunk.voxel(0, 1, 0).getMaterial());
+
+	chunk.fill(createVoxel(VoxelType::Water, 0));
+	Voxel voxel;
+	EXPECT_TRUE(chunk.isUniform(voxel));
+	EXPECT_EQ(VoxelType::Water, voxel.getMaterial());
+}
+
+TEST_F(PagedVolumeTest, testSamplerOnPaletteChunk) {
+	PagedVolume volume(&_pager, _memory, _chunkSideLength);
+	const PagedVolume::ChunkPtr& chunk = volume.chunk(glm::ivec3(0));
+	EXPECT_EQ(PagedVolume::ChunkStorage::Palette, chunk->storage());
+	PagedVolume::Sampler sampler(volume);
+	sampler.setPosition(1, 0, 0);
+	EXPECT_EQ(VoxelType::Air, sampler.voxel().getMaterial());
+	EXPECT_EQ(VoxelType::Grass, sampler.peekVoxel1nx0py0pz().getMaterial());
+	sampler.moveNegativeX();
+	EXPECT_EQ(VoxelType::Grass, sampler.voxel().getMaterial());
+	EXPECT_TRUE(sampler.setVoxel(createVoxel(VoxelType::Rock, 0)));
+	EXPECT_EQ(VoxelType::Rock, volume.voxel(0, 0, 0).getMaterial());
+}
+
+TEST_F(PagedVolumeTest, testSamplerAfterFill) {
+	PagedVolume volume(&_pager, _memory, _chunkSideLength);
+	const PagedVolume::ChunkPtr& chunk = volume.chunk(glm::ivec3(0));
+	for (int i = 0; i < PagedVolume::Chunk::MaxPaletteEntries; ++i) {
+		chunk->setVoxel(i, 1, 1, createVoxel(VoxelType::Rock, i));
+	}
+	ASSERT_EQ(PagedVolume::ChunkStorage::Dense, chunk->storage());
+	PagedVolume::Sampler sampler(volume);
+	sampler.setPosition(1, 1, 1);
+	EXPECT_EQ(VoxelType::Rock, sampler.voxel().getMaterial());
+	chunk->fill(createVoxel(VoxelType::Sand, 0));
+	EXPECT_EQ(VoxelType::Sand, sampler.voxel().getMaterial()) << "The sampler must not use the released dense data";
+	sampler.movePositiveX();
+	EXPECT_EQ(VoxelType::Sand, sampler.peekVoxel1nx0py0pz().getMaterial());
+	EXPECT_TRUE(sampler.setVoxel(createVoxel(VoxelType::Rock, 0)));
+	EXPECT_EQ(VoxelType::Rock, volume.voxel(2, 1, 1).getMaterial());
+	EXPECT_EQ(VoxelType::Sand, volume.voxel(1, 1, 1).getMaterial());
+}
+
+TEST_F(PagedVolumeTest, testSamplerAfterStorageUpgrade) {
+	PagedVolume volume(&_pager, _memory, _chunkSideLength);
+	const PagedVolume::ChunkPtr& chunk = volume.chunk(glm::ivec3(0));
+	chunk->fill(createVoxel(VoxelType::Sand, 0));
+	PagedVolume::Sampler sampler(volume);
+	sampler.setPosition(1, 1, 1);
+	EXPECT_EQ(VoxelType::Sand, sampler.voxel().getMaterial());
+
+	// uniform to palette - the sampler resolves the storage again
+	chunk->setVoxel(2, 1, 1, createVoxel(VoxelType::Rock, 0));
+	ASSERT_EQ(PagedVolume::ChunkStorage::Palette, chunk->storage());
+	EXPECT_EQ(VoxelType::Rock, sampler.peekVoxel1px0py0pz().getMaterial());
+	EXPECT_EQ(VoxelType::Sand, sampler.voxel().getMaterial());
+
+	// palette to dense
+	for (int i = 0; i < PagedVolume::Chunk::MaxPaletteEntries; ++i) {
+		chunk->setVoxel(i, 2, 1, createVoxel(VoxelType::Grass, i));
+	}
+	ASSERT_EQ(PagedVolume::ChunkStorage::Dense, chunk->storage());
+	EXPECT_EQ(VoxelType::Grass, sampler.peekVoxel0px1py0pz().getMaterial());
+	EXPECT_EQ(VoxelType::Rock, sampler.peekVoxel1px0py0pz().getMaterial());
+	EXPECT_TRUE(sampler.setVoxel(createVoxel(VoxelType::Wood, 0)));
+	EXPECT_EQ(VoxelType::Wood, volume.voxel(1, 1, 1).getMaterial());
+}
+
+TEST_F(PagedVolumeTest, testUniformRegion) {
+	PagedVolume volume(&_pager, _memory, _chunkSideLength);
+	const Region region(glm::ivec3(_chunkSideLength), glm::ivec3(_chunkSideLength * 3 - 1));
+	for (int32_t z = 1; z < 3; ++z) {
+		for (int32_t y = 1; y < 3; ++y) {
+			for (int32_t x = 1; x < 3; ++x) {
+				volume.chunk(glm::ivec3(x, y, z) * (int)_chunkSideLength)->fill(Voxel());
+			}
+		}
+	}
+	Voxel voxel;
+	EXPECT_TRUE(volume.isUniform(region, voxel));
+	EXPECT_EQ(VoxelType::Air, voxel.getMaterial());
+	volume.setVoxel(region.getUpperCorner(), createVoxel(VoxelType::Rock, 0));
+	EXPECT_FALSE(volume.isUniform(region, voxel));
+}
+
+TEST_F(PagedVolumeTest, testColumnHeight) {
+	PagedVolume::Chunk chunk(glm::ivec3(0), _chunkSideLength, &_pager);
+	EXPECT_EQ(0, chunk.columnHeight(0, 0)) << "An empty column has no height";
+	chunk.setVoxel(2, 5, 3, createVoxel(VoxelType::Rock, 0));
+	EXPECT_EQ(6, chunk.columnHeight(2, 3));
+	EXPECT_EQ(0, chunk.columnHeight(3, 2));
+	chunk.setVoxel(2, 9, 3, createVoxel(VoxelType::Water, 0));
+	EXPECT_EQ(6, chunk.columnHeight(2, 3)) << "Water is enterable";
+	chunk.setVoxel(2, 2, 3, createVoxel(VoxelType::Grass, 0));
+	EXPECT_EQ(6, chunk.columnHeight(2, 3));
+	chunk.setVoxel(2, 5, 3, Voxel());
+	EXPECT_EQ(3, chunk.columnHeight(2, 3)) << "Removing the highest voxel should reveal the one below";
+
+	const Voxel column[] = { createVoxel(VoxelType::Dirt, 0), createVoxel(VoxelType::Grass, 0), Voxel() };
+	chunk.setVoxels(4, 4, column, (int)lengthof(column));
+	EXPECT_EQ(2, chunk.columnHeight(4, 4));
+
+	chunk.fill(createVoxel(VoxelType::Rock, 0));
+	EXPECT_EQ((int)_chunkSideLength, chunk.columnHeight(7, 7));
+}
+
+}
@@ -33,8 +33,6 @@ bool CubFormat::loadGroups(const io::FilePtr& file, VoxelVolumes& volumes) {
 
 	// TODO: support loading own palette
 
-	const MaterialColorArray& materialColors = getMaterialColors();
-
 	for (uint32_t h = 0u; h < height; ++h) {
 		for (uint32_t d = 0u; d < depth; ++d) {
 			for (uint32_t w = 0u; w < width; ++w) {
@@ -47,7 +45,7 @@ bool CubFormat::loadGroups(const io::FilePtr& file, VoxelVolumes& volumes) {
 					continue;
 				}
 				const glm::vec4& color = core::Color::fromRGBA(r, g, b, 255);
-				int index = core::Color::getClosestMatch(color, materialColors);
+				const uint8_t index = findClosestIndex(color);
 				voxel::VoxelType voxelType = voxel::VoxelType::Generic;
 				const voxel::Voxel& voxel = voxel::createVoxel(voxelType, index);
 				// we have to flip depth with height for our own coordinate system
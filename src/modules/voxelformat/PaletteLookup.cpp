@@ -0,0 +1,56 @@
+/**
+ * @file
+ */
+
+#include "PaletteLookup.h"
+#include "core/Color.h"
+#include "core/Trace.h"
+#include <float.h>
+#include <glm/glm.hpp>
+
+namespace voxel {
+
+void PaletteLookup::init(const std::vector<glm::vec4>& colors) {
+	core_trace_scoped(PaletteLookupInit);
+	_cache.clear();
+	_hsb.resize(colors.size());
+	for (size_t i = 0; i < colors.size(); ++i) {
+		core::Color::getHSB(colors[i], _hsb[i].x, _hsb[i].y, _hsb[i].z);
+	}
+}
+
+uint8_t PaletteLookup::findClosestIndex(const glm::vec4& color) {
+	auto i = _cache.find(color);
+	if (i != _cache.end()) {
+		return i->second;
+	}
+	// keep this in sync with core::Color::getClosestMatch()
+	const float weightHue = 0.8f;
+	const float weightSaturation = 0.1f;
+	const float weightValue = 0.1f;
+
+	float minDistance = FLT_MAX;
+	int minIndex = 0;
+
+	float hue;
+	float saturation;
+	float brightness;
+	core::Color::getHSB(color, hue, saturation, brightness);
+
+	for (size_t n = 0; n < _hsb.size(); ++n) {
+		const float dH = _hsb[n].x - hue;
+		const float dS = _hsb[n].y - saturation;
+		const float dV = _hsb[n].z - brightness;
+		const float val = weightHue * glm::pow(dH, 2) +
+				weightValue * glm::pow(dV, 2) +
+				weightSaturation * glm::pow(dS, 2);
+		if (val < minDistance) {
+			minDistance = val;
+			minIndex = (int)n;
+		}
+	}
+	_cache.emplace(color, (uint8_t)minIndex);
+	return (uint8_t)minIndex;
+}
+
+}
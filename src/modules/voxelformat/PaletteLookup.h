@@ -0,0 +1,42 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+namespace voxel {
+
+/**
+ * @brief Maps colors to the closest entry of a palette.
+ *
+ * Gives the same results as @c core::Color::getClosestMatch() - but the palette is only converted to
+ * HSB once and the results are cached per color. The importers usually only use a few distinct colors
+ * for a lot of voxels.
+ *
+ * @note The palette is copied - the lookup must be rebuilt if the palette changes.
+ */
+class PaletteLookup {
+private:
+	// hue, saturation and brightness of each palette entry
+	std::vector<glm::vec3> _hsb;
+	std::unordered_map<glm::vec4, uint8_t> _cache;
+public:
+	void init(const std::vector<glm::vec4>& colors);
+	bool empty() const;
+
+	uint8_t findClosestIndex(const glm::vec4& color);
+};
+
+inline bool PaletteLookup::empty() const {
+	return _hsb.empty();
+}
+
+}
@@ -23,16 +23,17 @@ uint8_t VoxFileFormat::convertPaletteIndex(uint32_t paletteIndex) const {
 	return _palette[paletteIndex];
 }
 
-glm::vec4 VoxFileFormat::findClosestMatch(const glm::vec4& color) const {
+glm::vec4 VoxFileFormat::findClosestMatch(const glm::vec4& color) {
 	const int index = findClosestIndex(color);
 	voxel::MaterialColorArray materialColors = voxel::getMaterialColors();
 	return materialColors[index];
 }
 
-uint8_t VoxFileFormat::findClosestIndex(const glm::vec4& color) const {
-	const voxel::MaterialColorArray& materialColors = voxel::getMaterialColors();
-	//materialColors.erase(materialColors.begin());
-	return core::Color::getClosestMatch(color, materialColors);
+uint8_t VoxFileFormat::findClosestIndex(const glm::vec4& color) {
+	if (_paletteLookup.empty()) {
+		_paletteLookup.init(voxel::getMaterialColors());
+	}
+	return _paletteLookup.findClosestIndex(color);
 }
 
 RawVolume* VoxFileFormat::merge(const VoxelVolumes& volumes) const {
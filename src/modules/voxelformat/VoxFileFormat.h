@@ -7,6 +7,7 @@
 #include "voxel/RawVolume.h"
 #include "core/io/File.h"
 #include "VoxelVolumes.h"
+#include "PaletteLookup.h"
 #include <glm/fwd.hpp>
 #include <vector>
 
@@ -16,10 +17,18 @@ class VoxFileFormat {
 protected:
 	std::vector<uint8_t> _palette;
 	size_t _paletteSize = 0;
+	/**
+	 * @brief Built from the material colors with the first lookup - a format instance is only used for one load
+	 * with the same material colors.
+	 */
+	PaletteLookup _paletteLookup;
 
 	const glm::vec4& getColor(const Voxel& voxel) const;
-	glm::vec4 findClosestMatch(const glm::vec4& color) const;
-	uint8_t findClosestIndex(const glm::vec4& color) const;
+	glm::vec4 findClosestMatch(const glm::vec4& color);
+	/**
+	 * @brief Maps the color to the closest entry of our own 256 color palette
+	 */
+	uint8_t findClosestIndex(const glm::vec4& color);
 	/**
 	 * @brief Maps a custum palette index to our own 256 color palette by a closest match
 	 */
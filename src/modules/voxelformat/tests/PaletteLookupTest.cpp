@@ -0,0 +1,52 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "voxelformat/PaletteLookup.h"
+#include "core/Color.h"
+
+namespace voxel {
+
+class PaletteLookupTest: public core::AbstractTest {
+protected:
+	std::vector<glm::vec4> _colors;
+
+	void SetUp() override {
+		core::AbstractTest::SetUp();
+		_colors.clear();
+		for (int i = 0; i < 256; ++i) {
+			_colors.push_back(core::Color::fromRGBA((uint8_t)(i * 37), (uint8_t)(i * 91), (uint8_t)(i * 13), 255));
+		}
+	}
+};
+
+TEST_F(PaletteLookupTest, testSameAsClosestMatch) {
+	PaletteLookup lookup;
+	EXPECT_TRUE(lookup.empty());
+	lookup.init(_colors);
+	EXPECT_FALSE(lookup.empty());
+	for (int r = 0; r < 256; r += 15) {
+		for (int g = 0; g < 256; g += 15) {
+			for (int b = 0; b < 256; b += 15) {
+				const glm::vec4& color = core::Color::fromRGBA(r, g, b, 255);
+				const int expected = core::Color::getClosestMatch(color, _colors);
+				ASSERT_EQ(expected, lookup.findClosestIndex(color)) << "rgb: " << r << ":" << g << ":" << b;
+				// now from the cache
+				ASSERT_EQ(expected, lookup.findClosestIndex(color)) << "rgb: " << r << ":" << g << ":" << b;
+			}
+		}
+	}
+}
+
+TEST_F(PaletteLookupTest, testInitResetsCache) {
+	PaletteLookup lookup;
+	lookup.init(_colors);
+	const glm::vec4 color = _colors[42];
+	EXPECT_EQ(core::Color::getClosestMatch(color, _colors), lookup.findClosestIndex(color));
+	std::vector<glm::vec4> colors(_colors.rbegin(), _colors.rend());
+	lookup.init(colors);
+	EXPECT_EQ(core::Color::getClosestMatch(color, colors), lookup.findClosestIndex(color));
+}
+
+}
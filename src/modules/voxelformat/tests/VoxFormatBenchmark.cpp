@@ -0,0 +1,64 @@
+/**
+ * @file
+ * @brief Measures the import of the test models - the palette color matching is a big part of it.
+ */
+
+#include "core/benchmark/AbstractBenchmark.h"
+#include "voxelformat/VoxFormat.h"
+#include "voxelformat/QBTFormat.h"
+#include "voxelformat/QBFormat.h"
+#include "voxelformat/CubFormat.h"
+#include "voxelformat/VXMFormat.h"
+#include "voxelformat/BinVoxFormat.h"
+#include "voxel/MaterialColor.h"
+#include "core/io/Filesystem.h"
+#include <memory>
+
+class VoxFormatBenchmark: public core::AbstractBenchmark {
+protected:
+	bool onInitApp() override {
+		return voxel::initDefaultMaterialColors();
+	}
+
+	template<class FORMAT>
+	void load(benchmark::State& state, const char *filename) {
+		if (!io::filesystem()->open(filename)->exists()) {
+			state.SkipWithError("Could not open the model");
+			return;
+		}
+		for (auto _ : state) {
+			// the streams share the read position of the file handle
+			const io::FilePtr& file = io::filesystem()->open(filename);
+			// a new instance for each load - just like the loader does it
+			FORMAT format;
+			std::unique_ptr<voxel::RawVolume> volume(format.load(file));
+			benchmark::DoNotOptimize(volume.get());
+		}
+	}
+};
+
+BENCHMARK_F(VoxFormatBenchmark, loadVox) (benchmark::State& state) {
+	load<voxel::VoxFormat>(state, "magicavoxel.vox");
+}
+
+BENCHMARK_F(VoxFormatBenchmark, loadQBT) (benchmark::State& state) {
+	load<voxel::QBTFormat>(state, "qubicle.qbt");
+}
+
+BENCHMARK_F(VoxFormatBenchmark, loadQB) (benchmark::State& state) {
+	load<voxel::QBFormat>(state, "qubicle.qb");
+}
+
+BENCHMARK_F(VoxFormatBenchmark, loadCub) (benchmark::State& state) {
+	load<voxel::CubFormat>(state, "cw.cub");
+}
+
+BENCHMARK_F(VoxFormatBenchmark, loadVXM) (benchmark::State& state) {
+	load<voxel::VXMFormat>(state, "test.vxm");
+}
+
+BENCHMARK_F(VoxFormatBenchmark, loadBinVox) (benchmark::State& state) {
+	load<voxel::BinVoxFormat>(state, "test.binvox");
+}
+
+BENCHMARK_MAIN();
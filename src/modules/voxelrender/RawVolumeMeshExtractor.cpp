@@ -0,0 +1,187 @@
+/**
+ * @file
+ */
+
+#include "RawVolumeMeshExtractor.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/RawVolume.h"
+#include "core/concurrent/Concurrency.h"
+#include "core/SharedPtr.h"
+#include "core/Trace.h"
+#include <unordered_set>
+
+namespace voxelrender {
+
+namespace raw {
+/// implementation of a function object for deciding when
+/// the cubic surface extractor should insert a face between two voxels.
+///
+/// The criteria used here are that the voxel in front of the potential
+/// quad should have a value of zero (which would typically indicate empty
+/// space) while the voxel behind the potential quad would have a value
+/// greater than zero (typically indicating it is solid).
+struct CustomIsQuadNeeded {
+	inline bool operator()(const voxel::VoxelType& back, const voxel::VoxelType& front, voxel::FaceNames face) const {
+		if (isBlocked(back) && !isBlocked(front)) {
+			return true;
+		}
+		return false;
+	}
+};
+}
+
+RawVolumeMeshExtractor::RawVolumeMeshExtractor(size_t threads) :
+		_threadPool(threads > 0u ? threads : core::halfcpus(), "RawVolumeMeshExtractor") {
+}
+
+RawVolumeMeshExtractor::~RawVolumeMeshExtractor() {
+	shutdown();
+}
+
+void RawVolumeMeshExtractor::init() {
+	_cancelThreads = false;
+	_extracted.reset();
+	_threadPool.init();
+}
+
+void RawVolumeMeshExtractor::shutdown() {
+	_cancelThreads = true;
+	_extracted.abortWait();
+	// wait for the running extractions - the queued ones are skipped
+	_threadPool.shutdown(true);
+	Result result;
+	while (_extracted.pop(result)) {
+		delete result.mesh;
+	}
+	_generations.clear();
+	_pending = 0;
+}
+
+void RawVolumeMeshExtractor::extract(voxel::RawVolume* volume, const voxel::Region& region, voxel::Mesh* mesh) {
+	voxel::Region reg = region;
+	reg.shiftUpperCorner(1, 1, 1);
+	voxel::extractCubicMesh(volume, reg, mesh, raw::CustomIsQuadNeeded());
+}
+
+void RawVolumeMeshExtractor::cells(const voxel::Region& region, const voxel::Region& volumeRegion, int meshSize,
+		std::vector<glm::ivec3>& dirty, std::vector<glm::ivec3>& removed) {
+	const glm::ivec3 size(meshSize);
+	const glm::vec3 fsize(size);
+
+	const glm::ivec3& lower = region.getLowerCorner();
+	const glm::ivec3& upper = region.getUpperCorner();
+
+	const int border = 1;
+	const int xGap = lower.x % size.x;
+	const int yGap = lower.y % size.y;
+	const int zGap = lower.z % size.z;
+	const int lowerX = lower.x - ((xGap == 0) ? border : 0);
+	const int lowerY = lower.y - ((yGap == 0) ? border : 0);
+	const int lowerZ = lower.z - ((zGap == 0) ? border : 0);
+
+	const int upperX = upper.x + ((xGap == size.x - 1) ? border : 0);
+	const int upperY = upper.y + ((yGap == size.y - 1) ? border : 0);
+	const int upperZ = upper.z + ((zGap == size.z - 1) ? border : 0);
+
+	std::unordered_set<glm::ivec3, std::hash<glm::ivec3> > visited;
+
+	for (int cx = lowerX; cx <= upperX; ++cx) {
+		const int x = glm::floor(cx / fsize.x);
+		for (int cy = lowerY; cy <= upperY; ++cy) {
+			const int y = glm::floor(cy / fsize.y);
+			for (int cz = lowerZ; cz <= upperZ; ++cz) {
+				const int z = glm::floor(cz / fsize.z);
+				const glm::ivec3 mins(x * size.x, y * size.y, z * size.z);
+				if (!visited.insert(mins).second) {
+					continue;
+				}
+				const voxel::Region cell(mins, mins + size - 1);
+				if (!voxel::intersects(volumeRegion, cell)) {
+					removed.push_back(mins);
+					continue;
+				}
+				dirty.push_back(mins);
+			}
+		}
+	}
+}
+
+bool RawVolumeMeshExtractor::schedule(int idx, const voxel::RawVolume* volume, const glm::ivec3& mins, int meshSize) {
+	if (_cancelThreads) {
+		return false;
+	}
+	core_trace_scoped(RawVolumeMeshExtractorSchedule);
+	// the extractor looks at the neighbours of the cell voxels
+	voxel::Region copyRegion(mins - 1, mins + meshSize + 1);
+	copyRegion.cropTo(volume->region());
+
+	core::SharedPtr<voxel::RawVolume> copy = core::make_shared<voxel::RawVolume>(copyRegion);
+	copy->setBorderValue(volume->borderValue());
+	const glm::ivec3& lower = copyRegion.getLowerCorner();
+	const glm::ivec3& upper = copyRegion.getUpperCorner();
+	for (int z = lower.z; z <= upper.z; ++z) {
+		for (int y = lower.y; y <= upper.y; ++y) {
+			for (int x = lower.x; x <= upper.x; ++x) {
+				copy->setVoxel(x, y, z, volume->voxel(x, y, z));
+			}
+		}
+	}
+
+	Result job;
+	job.idx = idx;
+	job.mins = mins;
+	job.generation = ++_generations[glm::ivec4(mins, idx)];
+	job.sequence = ++_sequence;
+	auto future = _threadPool.enqueue([this, job, copy, meshSize] () mutable {
+		if (!_cancelThreads) {
+			core_trace_scoped(RawVolumeMeshExtraction);
+			const voxel::Region region(job.mins, job.mins + meshSize - 1);
+			job.mesh = new voxel::Mesh(128, 128, true);
+			extract(copy.get(), region, job.mesh);
+		}
+		// always hand back the job - otherwise the pending extractions would never reach zero
+		_extracted.push(std::move(job));
+	});
+	if (!future.valid()) {
+		return false;
+	}
+	++_pending;
+	return true;
+}
+
+void RawVolumeMeshExtractor::cancel(int idx) {
+	for (auto& i : _generations) {
+		if (i.first.w == idx) {
+			++i.second;
+		}
+	}
+}
+
+bool RawVolumeMeshExtractor::current(const Result& result) const {
+	if (result.mesh == nullptr) {
+		return false;
+	}
+	auto i = _generations.find(glm::ivec4(result.mins, result.idx));
+	return i != _generations.end() && i->second == result.generation;
+}
+
+bool RawVolumeMeshExtractor::pop(Result& result, bool wait) {
+	while (_pending > 0) {
+		if (wait) {
+			if (!_extracted.waitAndPop(result)) {
+				return false;
+			}
+		} else if (!_extracted.pop(result)) {
+			return false;
+		}
+		--_pending;
+		if (current(result)) {
+			return true;
+		}
+		delete result.mesh;
+		result.mesh = nullptr;
+	}
+	return false;
+}
+
+}
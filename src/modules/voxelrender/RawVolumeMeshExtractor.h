@@ -0,0 +1,117 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "voxel/Mesh.h"
+#include "voxel/Region.h"
+#include "core/concurrent/ThreadPool.h"
+#include "core/concurrent/Atomic.h"
+#include "core/collection/ConcurrentQueue.h"
+
+#include <unordered_map>
+#include <vector>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+namespace voxel {
+class RawVolume;
+}
+
+namespace voxelrender {
+
+/**
+ * @brief Extracts the mesh cells of @c voxel::RawVolume instances on a worker pool.
+ *
+ * The voxels of a cell (and its border) are copied on the calling thread - so the volume can be modified
+ * while the extraction is running. Scheduling the same cell again invalidates the results of the previous
+ * extractions for that cell - @c pop() only hands out the latest mesh of a cell.
+ *
+ * @note Except for the workers this is not thread safe - schedule and pop from the same thread.
+ * @sa RawVolumeRenderer
+ */
+class RawVolumeMeshExtractor {
+public:
+	struct Result {
+		int idx = -1;
+		glm::ivec3 mins { 0 };
+		/**
+		 * @brief The extracted mesh - the ownership is handed over with @c pop()
+		 */
+		voxel::Mesh* mesh = nullptr;
+		uint32_t generation = 0u;
+		uint64_t sequence = 0u;
+	};
+private:
+	struct OlderFirst {
+		inline bool operator()(const Result& lhs, const Result& rhs) const {
+			return lhs.sequence > rhs.sequence;
+		}
+	};
+	core::ThreadPool _threadPool;
+	core::ConcurrentPriorityQueue<Result, OlderFirst> _extracted;
+	// the latest generation of each cell - xyz is the cell, w the volume index
+	std::unordered_map<glm::ivec4, uint32_t> _generations;
+	uint64_t _sequence = 0u;
+	int _pending = 0;
+	// set until init() was called - there are no workers that could handle the extractions
+	core::AtomicBool _cancelThreads { true };
+
+	bool current(const Result& result) const;
+public:
+	RawVolumeMeshExtractor(size_t threads = 0u);
+	~RawVolumeMeshExtractor();
+
+	/**
+	 * @brief Extracts the given region of the volume into the given mesh on the calling thread
+	 */
+	static void extract(voxel::RawVolume* volume, const voxel::Region& region, voxel::Mesh* mesh);
+
+	/**
+	 * @brief Collects the cells that must be extracted again if the given region of a volume was modified.
+	 *
+	 * The cells at the border of the region are included, too - their faces depend on the modified voxels.
+	 * @param[out] dirty The lower corners of the cells that intersect the volume region
+	 * @param[out] removed The lower corners of the cells that are outside of the volume region and whose meshes
+	 * must be removed
+	 */
+	static void cells(const voxel::Region& region, const voxel::Region& volumeRegion, int meshSize,
+			std::vector<glm::ivec3>& dirty, std::vector<glm::ivec3>& removed);
+
+	/**
+	 * @brief Copies the voxels of the cell and hands the extraction over to the workers
+	 * @param[in] idx The volume index that is handed back with the result
+	 * @param[in] mins The lower corner of the cell
+	 * @return @c false if the workers are not running
+	 */
+	bool schedule(int idx, const voxel::RawVolume* volume, const glm::ivec3& mins, int meshSize);
+
+	/**
+	 * @brief Invalidates all scheduled extractions of the given volume index.
+	 */
+	void cancel(int idx);
+
+	/**
+	 * @brief Hands out the next extracted mesh. Outdated results are skipped and deleted.
+	 * @param[in] wait Block until a result is ready if there are still pending extractions.
+	 * @return @c false if there is no result
+	 */
+	bool pop(Result& result, bool wait = false);
+
+	/**
+	 * @return The amount of scheduled extractions that were not yet popped.
+	 */
+	int pending() const;
+
+	void init();
+	void shutdown();
+};
+
+inline int RawVolumeMeshExtractor::pending() const {
+	return _pending;
+}
+
+}
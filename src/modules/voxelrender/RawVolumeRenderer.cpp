@@ -3,7 +3,6 @@
  */
 
 #include "RawVolumeRenderer.h"
-#include "voxel/CubicSurfaceExtractor.h"
 #include "voxelutil/VolumeMerger.h"
 #include "voxel/MaterialColor.h"
 #include "video/ScopedLineWidth.h"
@@ -21,28 +20,9 @@
 #include "core/GameConfig.h"
 #include "core/Log.h"
 #include "VoxelShaderConstants.h"
-#include <unordered_set>
 
 namespace voxelrender {
 
-namespace raw {
-/// implementation of a function object for deciding when
-/// the cubic surface extractor should insert a face between two voxels.
-///
-/// The criteria used here are that the voxel in front of the potential
-/// quad should have a value of zero (which would typically indicate empty
-/// space) while the voxel behind the potential quad would have a value
-/// greater than zero (typically indicating it is solid).
-struct CustomIsQuadNeeded {
-	inline bool operator()(const voxel::VoxelType& back, const voxel::VoxelType& front, voxel::FaceNames face) const {
-		if (isBlocked(back) && !isBlocked(front)) {
-			return true;
-		}
-		return false;
-	}
-};
-}
-
 RawVolumeRenderer::RawVolumeRenderer() :
 		_voxelShader(shader::VoxelShader::getInstance()),
 		_shadowMapShader(shader::ShadowmapShader::getInstance()) {
@@ -76,6 +56,9 @@ bool RawVolumeRenderer::init() {
 			Log::error("Could not create the vertex buffer object for the indices");
 			return false;
 		}
+		// the cells are updated in place
+		_vertexBuffer[idx].setMode(_vertexBufferIndex[idx], video::BufferMode::Dynamic);
+		_vertexBuffer[idx].setMode(_indexBufferIndex[idx], video::BufferMode::Dynamic);
 	}
 
 	const int shaderMaterialColorsArraySize = lengthof(shader::VoxelData::MaterialblockData::materialcolor);
@@ -109,6 +92,7 @@ bool RawVolumeRenderer::init() {
 	_materialBlock.create(materialBlock);
 
 	_meshSize = core::Var::getSafe(cfg::VoxelMeshSize);
+	_extractor.init();
 
 	return true;
 }
@@ -118,35 +102,67 @@ bool RawVolumeRenderer::update(int idx) {
 		return false;
 	}
 	core_trace_scoped(RawVolumeRendererUpdate);
-	voxel::VertexArray vertices;
-	voxel::IndexArray indices;
+	_rebuild[idx] = false;
+	clearCellRanges(idx);
 
-	voxel::IndexType offset = (voxel::IndexType)0;
+	size_t vertexCount = 0u;
+	size_t indexCount = 0u;
 	for (auto& i : _meshes) {
-		const Meshes& meshes = i.second;
-		const voxel::Mesh* mesh = meshes[idx];
+		const voxel::Mesh* mesh = i.second[idx];
+		if (mesh == nullptr || mesh->getNoOfIndices() <= 0) {
+			continue;
+		}
+		vertexCount += mesh->getNoOfVertices();
+		indexCount += mesh->getNoOfIndices();
+	}
+
+	// leave some space for the cells to grow - otherwise every modification would lead to a full upload
+	_vertexRanges[idx].reset(vertexCount + vertexCount / 2u);
+	_indexRanges[idx].reset(indexCount + indexCount / 2u);
+	voxel::VertexArray vertices(_vertexRanges[idx].capacity());
+	// the unused indices are degenerated triangles
+	voxel::IndexArray indices(_indexRanges[idx].capacity(), (voxel::IndexType)0);
+
+	for (auto& i : _meshes) {
+		CellRange& range = _cellRanges[i.first][idx];
+		range = CellRange();
+		const voxel::Mesh* mesh = i.second[idx];
 		if (mesh == nullptr || mesh->getNoOfIndices() <= 0) {
 			continue;
 		}
 		const voxel::VertexArray& vertexVector = mesh->getVertexVector();
 		const voxel::IndexArray& indexVector = mesh->getIndexVector();
-		std::copy(vertexVector.begin(), vertexVector.end(), std::back_inserter(vertices));
-
-		for (const auto& iv : indexVector) {
-			indices.push_back(iv + offset);
+		range.vertexCount = vertexVector.size();
+		range.indexCount = indexVector.size();
+		_vertexRanges[idx].alloc(range.vertexCount, range.vertexOffset);
+		_indexRanges[idx].alloc(range.indexCount, range.indexOffset);
+		std::copy(vertexVector.begin(), vertexVector.end(), vertices.begin() + range.vertexOffset);
+
+		const voxel::IndexType offset = (voxel::IndexType)range.vertexOffset;
+		for (size_t n = 0u; n < indexVector.size(); ++n) {
+			indices[range.indexOffset + n] = indexVector[n] + offset;
 		}
-
-		offset += vertexVector.size();
 	}
 
-	return update(idx, vertices, indices);
+	return upload(idx, vertices, indices);
 }
 
 bool RawVolumeRenderer::update(int idx, const voxel::VertexArray& vertices, const voxel::IndexArray& indices) {
 	if (idx < 0 || idx >= MAX_VOLUMES) {
 		return false;
 	}
-	core_trace_scoped(RawVolumeRendererUpdate);
+	// the buffers are no longer in sync with the cells
+	clearCellRanges(idx);
+	_vertexRanges[idx].reset(vertices.size());
+	_indexRanges[idx].reset(indices.size());
+	size_t offset;
+	_vertexRanges[idx].alloc(vertices.size(), offset);
+	_indexRanges[idx].alloc(indices.size(), offset);
+	return upload(idx, vertices, indices);
+}
+
+bool RawVolumeRenderer::upload(int idx, const voxel::VertexArray& vertices, const voxel::IndexArray& indices) {
+	core_trace_scoped(RawVolumeRendererUpload);
 
 	if (indices.empty()) {
 		_vertexBuffer[idx].update(_vertexBufferIndex[idx], nullptr, 0);
@@ -165,6 +181,103 @@ bool RawVolumeRenderer::update(int idx, const voxel::VertexArray& vertices, cons
 	return true;
 }
 
+bool RawVolumeRenderer::updateCell(int idx, const glm::ivec3& mins) {
+	core_trace_scoped(RawVolumeRendererUpdateCell);
+	CellRange& range = _cellRanges[mins][idx];
+	if (range.indexCount > 0u) {
+		// turn the old triangles into degenerated ones - they are still in the drawn range
+		const voxel::IndexArray zero(range.indexCount, (voxel::IndexType)0);
+		_vertexBuffer[idx].update(_indexBufferIndex[idx], range.indexOffset * sizeof(voxel::IndexType),
+				zero.data(), zero.size() * sizeof(voxel::IndexType));
+		_indexRanges[idx].free(range.indexOffset, range.indexCount);
+	}
+	if (range.vertexCount > 0u) {
+		_vertexRanges[idx].free(range.vertexOffset, range.vertexCount);
+	}
+	range = CellRange();
+
+	auto i = _meshes.find(mins);
+	if (i == _meshes.end()) {
+		return true;
+	}
+	const voxel::Mesh* mesh = i->second[idx];
+	if (mesh == nullptr || mesh->getNoOfIndices() <= 0) {
+		return true;
+	}
+	const voxel::VertexArray& vertexVector = mesh->getVertexVector();
+	const voxel::IndexArray& indexVector = mesh->getIndexVector();
+	size_t vertexOffset;
+	if (!_vertexRanges[idx].alloc(vertexVector.size(), vertexOffset)) {
+		return false;
+	}
+	size_t indexOffset;
+	if (!_indexRanges[idx].alloc(indexVector.size(), indexOffset)) {
+		_vertexRanges[idx].free(vertexOffset, vertexVector.size());
+		return false;
+	}
+	range.vertexOffset = vertexOffset;
+	range.vertexCount = vertexVector.size();
+	range.indexOffset = indexOffset;
+	range.indexCount = indexVector.size();
+
+	voxel::IndexArray indices(indexVector.size());
+	const voxel::IndexType offset = (voxel::IndexType)vertexOffset;
+	for (size_t n = 0u; n < indexVector.size(); ++n) {
+		indices[n] = indexVector[n] + offset;
+	}
+	if (!_vertexBuffer[idx].update(_vertexBufferIndex[idx], vertexOffset * sizeof(voxel::VoxelVertex),
+			vertexVector.data(), vertexVector.size() * sizeof(voxel::VoxelVertex))) {
+		Log::error("Failed to update the vertex buffer range");
+		return false;
+	}
+	if (!_vertexBuffer[idx].update(_indexBufferIndex[idx], indexOffset * sizeof(voxel::IndexType),
+			indices.data(), indices.size() * sizeof(voxel::IndexType))) {
+		Log::error("Failed to update the index buffer range");
+		return false;
+	}
+	return true;
+}
+
+void RawVolumeRenderer::clearCellRanges(int idx) {
+	for (auto& i : _cellRanges) {
+		i.second[idx] = CellRange();
+	}
+}
+
+void RawVolumeRenderer::deleteMeshes(int idx) {
+	// results of running extractions would bring back the old meshes
+	_extractor.cancel(idx);
+	for (auto& i : _meshes) {
+		Meshes& meshes = i.second;
+		delete meshes[idx];
+		meshes[idx] = nullptr;
+	}
+	_rebuild[idx] = true;
+}
+
+void RawVolumeRenderer::processExtracted(bool wait) {
+	core_trace_scoped(RawVolumeRendererProcessExtracted);
+	RawVolumeMeshExtractor::Result result;
+	while (_extractor.pop(result, wait)) {
+		const int idx = result.idx;
+		Meshes& meshes = _meshes[result.mins];
+		delete meshes[idx];
+		meshes[idx] = result.mesh;
+		if (_rebuild[idx]) {
+			continue;
+		}
+		if (!updateCell(idx, result.mins)) {
+			Log::debug("Cell doesn't fit into the buffers of volume %i - upload all cells", idx);
+			_rebuild[idx] = true;
+		}
+	}
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		if (_rebuild[idx] && !update(idx)) {
+			Log::error("Failed to update the mesh at index %i", idx);
+		}
+	}
+}
+
 void RawVolumeRenderer::setAmbientColor(const glm::vec3& color) {
 	_ambientColor = color;
 	// force updating the cached uniform values
@@ -187,6 +300,8 @@ bool RawVolumeRenderer::swap(int idx1, int idx2) {
 	if (idx1 == idx2) {
 		return true;
 	}
+	// the scheduled extractions know the old indices
+	processExtracted(true);
 	for (auto& i : _meshes) {
 		Meshes& meshes = i.second;
 		std::swap(meshes[idx1], meshes[idx2]);
@@ -230,7 +345,7 @@ bool RawVolumeRenderer::toMesh(voxel::Mesh* mesh) {
 	if (mergedVolume == nullptr) {
 		return false;
 	}
-	extract(mergedVolume, mergedVolume->region(), mesh);
+	RawVolumeMeshExtractor::extract(mergedVolume, mergedVolume->region(), mesh);
 	delete mergedVolume;
 	return true;
 }
@@ -244,7 +359,7 @@ bool RawVolumeRenderer::toMesh(int idx, voxel::Mesh* mesh) {
 		return false;
 	}
 
-	extract(volume, volume->region(), mesh);
+	RawVolumeMeshExtractor::extract(volume, volume->region(), mesh);
 	return true;
 }
 
@@ -257,14 +372,7 @@ bool RawVolumeRenderer::translate(int idx, const glm::ivec3& m) {
 		return false;
 	}
 	volume->translate(m);
-	for (auto& i : _meshes) {
-		Meshes& meshes = i.second;
-		if (meshes[idx] == nullptr) {
-			continue;
-		}
-		delete meshes[idx];
-		meshes[idx] = nullptr;
-	}
+	deleteMeshes(idx);
 	return true;
 }
 
@@ -276,73 +384,37 @@ bool RawVolumeRenderer::extract(int idx, const voxel::Region& region, bool updat
 	if (volume == nullptr) {
 		return false;
 	}
+	core_trace_scoped(RawVolumeRendererExtract);
 
-	const int s = _meshSize->intVal();
-	glm::ivec3 meshSize(s, s, s);
-	const glm::vec3& size = meshSize;
-
-	const glm::ivec3& lower = region.getLowerCorner();
-	const glm::ivec3& upper = region.getUpperCorner();
-
-	const int border = 1;
-	const voxel::Region& completeRegion = volume->region();
-	const int xGap = lower.x % meshSize.x;
-	const int yGap = lower.y % meshSize.y;
-	const int zGap = lower.z % meshSize.z;
-	const int lowerX = lower.x - ((xGap == 0) ? border : 0);
-	const int lowerY = lower.y - ((yGap == 0) ? border : 0);
-	const int lowerZ = lower.z - ((zGap == 0) ? border : 0);
-
-	const int upperX = upper.x + ((xGap == meshSize.x - 1) ? border : 0);
-	const int upperY = upper.y + ((yGap == meshSize.y - 1) ? border : 0);
-	const int upperZ = upper.z + ((zGap == meshSize.z - 1) ? border : 0);
-
-	std::unordered_set<glm::ivec3, std::hash<glm::ivec3> > extracted;
-
-	for (int cx = lowerX; cx <= upperX; ++cx) {
-		const int x = glm::floor(cx / size.x);
-		for (int cy = lowerY; cy <= upperY; ++cy) {
-			const int y = glm::floor(cy / size.y);
-			for (int cz = lowerZ; cz <= upperZ; ++cz) {
-				const int z = glm::floor(cz / size.z);
-				const glm::ivec3 mins(x * meshSize.x, y * meshSize.y, z * meshSize.z);
-				const glm::ivec3 maxs = mins + meshSize - 1;
-				const voxel::Region region(mins, maxs);
-				if (!voxel::intersects(completeRegion, region)) {
-					auto i = _meshes.find(mins);
-					if (i != _meshes.end()) {
-						Meshes& meshes = i->second;
-						delete meshes[idx];
-						meshes[idx] = nullptr;
-					}
-					continue;
-				}
+	const int meshSize = _meshSize->intVal();
+	std::vector<glm::ivec3> dirty;
+	std::vector<glm::ivec3> removed;
+	RawVolumeMeshExtractor::cells(region, volume->region(), meshSize, dirty, removed);
 
-				auto i = extracted.insert(mins);
-				if (!i.second) {
-					continue;
-				}
-
-				Meshes& meshes = _meshes[mins];
-				if (meshes[idx] == nullptr) {
-					meshes[idx] = new voxel::Mesh(128, 128, true);
-				}
-				extract(volume, region, meshes[idx]);
-			}
+	for (const glm::ivec3& mins : removed) {
+		auto i = _meshes.find(mins);
+		if (i == _meshes.end() || i->second[idx] == nullptr) {
+			continue;
+		}
+		Meshes& meshes = i->second;
+		delete meshes[idx];
+		meshes[idx] = nullptr;
+		if (!_rebuild[idx]) {
+			updateCell(idx, mins);
+		}
+	}
+	for (const glm::ivec3& mins : dirty) {
+		if (!_extractor.schedule(idx, volume, mins, meshSize)) {
+			Log::error("Failed to schedule the extraction for volume %i", idx);
+			return false;
 		}
 	}
-	if (updateBuffers && !update(idx)) {
-		Log::error("Failed to update the mesh at index %i", idx);
+	if (updateBuffers) {
+		processExtracted(true);
 	}
 	return true;
 }
 
-void RawVolumeRenderer::extract(voxel::RawVolume* volume, const voxel::Region& region, voxel::Mesh* mesh) const {
-	voxel::Region reg = region;
-	reg.shiftUpperCorner(1, 1, 1);
-	voxel::extractCubicMesh(volume, reg, mesh, raw::CustomIsQuadNeeded());
-}
-
 bool RawVolumeRenderer::hiddenState(int idx) const {
 	if (idx < 0 || idx >= MAX_VOLUMES) {
 		return true;
@@ -359,6 +431,7 @@ void RawVolumeRenderer::hide(int idx, bool hide) {
 
 void RawVolumeRenderer::render(const video::Camera& camera, bool shadow) {
 	core_trace_scoped(RawVolumeRendererRender);
+	processExtracted();
 
 	if (voxel::materialColorChanged()) {
 		shader::VoxelData::MaterialblockData materialBlock;
@@ -373,7 +446,7 @@ void RawVolumeRenderer::render(const video::Camera& camera, bool shadow) {
 		if (_hidden[idx]) {
 			continue;
 		}
-		numIndices += _vertexBuffer[idx].elements(_indexBufferIndex[idx], 1, sizeof(voxel::IndexType));
+		numIndices += (uint32_t)_indexRanges[idx].end();
 		if (numIndices > 0) {
 			break;
 		}
@@ -396,7 +469,8 @@ void RawVolumeRenderer::render(const video::Camera& camera, bool shadow) {
 					if (_hidden[idx]) {
 						continue;
 					}
-					const uint32_t nIndices = _vertexBuffer[idx].elements(_indexBufferIndex[idx], 1, sizeof(voxel::IndexType));
+					// the freed ranges in between are degenerated triangles
+					const uint32_t nIndices = (uint32_t)_indexRanges[idx].end();
 					if (nIndices == 0) {
 						continue;
 					}
@@ -439,7 +513,7 @@ void RawVolumeRenderer::render(const video::Camera& camera, bool shadow) {
 		if (_hidden[idx]) {
 			continue;
 		}
-		const uint32_t nIndices = _vertexBuffer[idx].elements(_indexBufferIndex[idx], 1, sizeof(voxel::IndexType));
+		const uint32_t nIndices = (uint32_t)_indexRanges[idx].end();
 		if (nIndices == 0) {
 			continue;
 		}
@@ -489,11 +563,7 @@ voxel::RawVolume* RawVolumeRenderer::setVolume(int idx, voxel::RawVolume* volume
 	voxel::RawVolume* old = _rawVolume[idx];
 	_rawVolume[idx] = volume;
 	if (deleteMesh) {
-		for (auto& i : _meshes) {
-			Meshes& meshes = i.second;
-			delete meshes[idx];
-			meshes[idx] = nullptr;
-		}
+		deleteMeshes(idx);
 	}
 	return old;
 }
@@ -506,17 +576,22 @@ std::vector<voxel::RawVolume*> RawVolumeRenderer::shutdown() {
 	_voxelShader.shutdown();
 	_shadowMapShader.shutdown();
 	_materialBlock.shutdown();
+	_extractor.shutdown();
 	for (auto& iter : _meshes) {
 		for (auto& mesh : iter.second) {
 			delete mesh;
 		}
 	}
 	_meshes.clear();
+	_cellRanges.clear();
 	std::vector<voxel::RawVolume*> old(MAX_VOLUMES);
 	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
 		_vertexBuffer[idx].shutdown();
 		_vertexBufferIndex[idx] = -1;
 		_indexBufferIndex[idx] = -1;
+		_vertexRanges[idx].reset(0u);
+		_indexRanges[idx].reset(0u);
+		_rebuild[idx] = false;
 		// hand over the ownership to the caller
 		old.push_back(_rawVolume[idx]);
 		_rawVolume[idx] = nullptr;
@@ -8,6 +8,8 @@
 #include "voxel/RawVolume.h"
 #include "voxel/Region.h"
 #include "video/Buffer.h"
+#include "video/BufferRangeAllocator.h"
+#include "RawVolumeMeshExtractor.h"
 #include "VoxelrenderShaders.h"
 #include "voxel/Mesh.h"
 #include "render/Shadow.h"
@@ -30,6 +32,10 @@ namespace voxelrender {
 /**
  * @brief Handles the shaders, vertex buffers and rendering of a voxel::RawVolume
  *
+ * The volumes are split into cells of @c cfg::VoxelMeshSize voxels. Modified cells are extracted on
+ * worker threads - the finished meshes are uploaded into their own ranges of the vertex and index buffers,
+ * so only the modified cells are transferred to the gpu again.
+ *
  * @sa voxel::RawVolume
  */
 class RawVolumeRenderer {
@@ -45,6 +51,23 @@ protected:
 	typedef std::unordered_map<glm::ivec3, Meshes> MeshesMap;
 	MeshesMap _meshes;
 
+	/**
+	 * @brief The buffer ranges (in vertices and indices) of the mesh of a cell
+	 */
+	struct CellRange {
+		size_t vertexOffset = 0u;
+		size_t vertexCount = 0u;
+		size_t indexOffset = 0u;
+		size_t indexCount = 0u;
+	};
+	typedef core::Array<CellRange, MAX_VOLUMES> CellRanges;
+	std::unordered_map<glm::ivec3, CellRanges> _cellRanges;
+	video::BufferRangeAllocator _vertexRanges[MAX_VOLUMES];
+	video::BufferRangeAllocator _indexRanges[MAX_VOLUMES];
+	// the cells don't fit into the buffers anymore or the meshes were removed - upload everything again
+	core::Array<bool, MAX_VOLUMES> _rebuild {{ false }};
+	RawVolumeMeshExtractor _extractor;
+
 	video::Buffer _vertexBuffer[MAX_VOLUMES];
 	shader::VoxelData _materialBlock;
 	shader::VoxelShader& _voxelShader;
@@ -57,7 +80,14 @@ protected:
 	glm::vec3 _diffuseColor = frontend::diffuseColor;
 	glm::vec3 _ambientColor = frontend::ambientColor;
 
-	void extract(voxel::RawVolume* volume, const voxel::Region& region, voxel::Mesh* mesh) const;
+	/**
+	 * @brief Uploads the mesh of the given cell into a free range of the buffers
+	 * @return @c false if there was no free range left
+	 */
+	bool updateCell(int idx, const glm::ivec3& mins);
+	bool upload(int idx, const voxel::VertexArray& vertices, const voxel::IndexArray& indices);
+	void clearCellRanges(int idx);
+	void deleteMeshes(int idx);
 
 public:
 	RawVolumeRenderer();
@@ -71,14 +101,28 @@ public:
 
 	/**
 	 * @brief Updates the vertex buffers manually
+	 * @note This uploads all cells of the volume
 	 * @sa extract()
 	 */
 	bool update(int idx);
 
 	bool update(int idx, const voxel::VertexArray& vertices, const voxel::IndexArray& indices);
 
+	/**
+	 * @brief Schedules the extraction of all cells that are touched by the given region
+	 * @param[in] updateBuffers Wait for the extraction and upload the meshes. Otherwise the meshes are uploaded
+	 * in one of the next @c render() calls.
+	 * @sa processExtracted()
+	 */
 	bool extract(int idx, const voxel::Region& region, bool updateBuffers = true);
 
+	/**
+	 * @brief Uploads the meshes of the cells whose extraction is finished
+	 * @param[in] wait Wait for all scheduled extractions
+	 * @note This is called by @c render()
+	 */
+	void processExtracted(bool wait = false);
+
 	bool translate(int idx, const glm::ivec3& m);
 
 	bool toMesh(voxel::Mesh* mesh);
@@ -93,6 +137,9 @@ public:
 	voxel::RawVolume* setVolume(int idx, voxel::RawVolume* volume, bool deleteMesh = true);
 	bool setModelMatrix(int idx, const glm::mat4& model);
 
+	/**
+	 * @note Cells that are still being extracted are not taken into account
+	 */
 	bool empty(int idx = 0) const;
 	bool swap(int idx1, int idx2);
 	/**
@@ -16,6 +16,8 @@ WorldMeshExtractor::WorldMeshExtractor() :
 
 bool WorldMeshExtractor::init(voxel::PagedVolume *volume) {
 	_volume = volume;
+	_pendingExtraction.reset();
+	_extracted.reset();
 	_threadPool.init();
 	_meshSize = core::Var::getSafe(cfg::VoxelMeshSize);
 	for (size_t i = 0u; i < _threadPool.size(); ++i) {
@@ -112,8 +114,8 @@ void WorldMeshExtractor::extractScheduledMesh() {
 		const int vertices = region.getWidthInVoxels() * region.getDepthInVoxels() * factor;
 		voxel::Mesh mesh(vertices, vertices);
 		voxel::extractCubicMesh(_volume, region, &mesh, voxel::IsQuadNeeded());
-		if (!mesh.isEmpty()) {
-			_extracted.push(std::move(mesh));
+		if (!mesh.isEmpty() && !_extracted.waitAndPush(std::move(mesh))) {
+			break;
 		}
 	}
 }
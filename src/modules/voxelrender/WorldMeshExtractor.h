@@ -8,6 +8,7 @@
 #include "core/concurrent/ThreadPool.h"
 #include "core/Var.h"
 #include "core/collection/ConcurrentQueue.h"
+#include "core/collection/ConcurrentRingQueue.h"
 #include "voxel/PagedVolume.h"
 #include "core/concurrent/Atomic.h"
 
@@ -23,7 +24,8 @@ typedef std::unordered_set<glm::ivec3, std::hash<glm::ivec3> > PositionSet;
 class WorldMeshExtractor {
 private:
 	core::ThreadPool _threadPool;
-	core::ConcurrentQueue<voxel::Mesh> _extracted;
+	// the workers block if the meshes are not collected fast enough
+	core::ConcurrentRingQueue<voxel::Mesh> _extracted { 256u };
 	glm::ivec3 _pendingExtractionSortPosition { 0, 0, 0 };
 	struct CloseToPoint {
 		glm::ivec3 _refPoint;
@@ -38,7 +40,7 @@ private:
 		}
 	};
 
-	core::ConcurrentQueue<glm::ivec3, CloseToPoint> _pendingExtraction { CloseToPoint(_pendingExtractionSortPosition) };
+	core::ConcurrentPriorityQueue<glm::ivec3, CloseToPoint> _pendingExtraction { CloseToPoint(_pendingExtractionSortPosition) };
 	// fast lookup for positions that are already extracted
 	PositionSet _positionsExtracted;
 	core::VarPtr _meshSize;
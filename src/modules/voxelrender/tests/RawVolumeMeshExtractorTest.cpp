@@ -0,0 +1,98 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "voxelrender/RawVolumeMeshExtractor.h"
+#include "voxel/RawVolume.h"
+#include <algorithm>
+
+namespace voxelrender {
+
+class RawVolumeMeshExtractorTest: public core::AbstractTest {
+protected:
+	static constexpr int MeshSize = 16;
+	voxel::RawVolume _volume { voxel::Region(0, 31) };
+
+	bool contains(const std::vector<glm::ivec3>& cells, const glm::ivec3& mins) const {
+		return std::find(cells.begin(), cells.end(), mins) != cells.end();
+	}
+};
+
+TEST_F(RawVolumeMeshExtractorTest, testCellsInside) {
+	std::vector<glm::ivec3> dirty;
+	std::vector<glm::ivec3> removed;
+	RawVolumeMeshExtractor::cells(voxel::Region(glm::ivec3(5), glm::ivec3(5)), _volume.region(), MeshSize, dirty, removed);
+	ASSERT_EQ(1u, dirty.size());
+	EXPECT_EQ(glm::ivec3(0), dirty[0]);
+	EXPECT_TRUE(removed.empty());
+}
+
+TEST_F(RawVolumeMeshExtractorTest, testCellsBorder) {
+	std::vector<glm::ivec3> dirty;
+	std::vector<glm::ivec3> removed;
+	// the voxel is at the border of its cell - the faces of the neighbours might change, too
+	RawVolumeMeshExtractor::cells(voxel::Region(glm::ivec3(16), glm::ivec3(16)), _volume.region(), MeshSize, dirty, removed);
+	EXPECT_EQ(8u, dirty.size());
+	EXPECT_TRUE(contains(dirty, glm::ivec3(0)));
+	EXPECT_TRUE(contains(dirty, glm::ivec3(16)));
+	EXPECT_TRUE(removed.empty());
+
+	dirty.clear();
+	RawVolumeMeshExtractor::cells(voxel::Region(glm::ivec3(0), glm::ivec3(0)), _volume.region(), MeshSize, dirty, removed);
+	ASSERT_EQ(1u, dirty.size());
+	EXPECT_EQ(7u, removed.size()) << "The cells outside of the volume must be removed";
+	EXPECT_TRUE(contains(removed, glm::ivec3(-16)));
+}
+
+TEST_F(RawVolumeMeshExtractorTest, testExtract) {
+	_volume.setVoxel(glm::ivec3(20), voxel::createVoxel(voxel::VoxelType::Grass, 0));
+	RawVolumeMeshExtractor extractor(2);
+	extractor.init();
+	ASSERT_TRUE(extractor.schedule(0, &_volume, glm::ivec3(0), MeshSize));
+	ASSERT_TRUE(extractor.schedule(0, &_volume, glm::ivec3(16), MeshSize));
+	// the voxel copy is used - modifying the volume doesn't influence the extraction
+	_volume.setVoxel(glm::ivec3(20), voxel::createVoxel(voxel::VoxelType::Air, 0));
+	EXPECT_EQ(2, extractor.pending());
+	int meshes = 0;
+	RawVolumeMeshExtractor::Result result;
+	while (extractor.pop(result, true)) {
+		ASSERT_NE(nullptr, result.mesh);
+		EXPECT_EQ(0, result.idx);
+		if (result.mins == glm::ivec3(16)) {
+			EXPECT_FALSE(result.mesh->isEmpty());
+		} else {
+			EXPECT_TRUE(result.mesh->isEmpty());
+		}
+		delete result.mesh;
+		++meshes;
+	}
+	EXPECT_EQ(2, meshes);
+	EXPECT_EQ(0, extractor.pending());
+	extractor.shutdown();
+}
+
+TEST_F(RawVolumeMeshExtractorTest, testOutdatedResultsAreSkipped) {
+	RawVolumeMeshExtractor extractor(1);
+	extractor.init();
+	ASSERT_TRUE(extractor.schedule(0, &_volume, glm::ivec3(0), MeshSize));
+	ASSERT_TRUE(extractor.schedule(0, &_volume, glm::ivec3(0), MeshSize));
+	ASSERT_TRUE(extractor.schedule(1, &_volume, glm::ivec3(0), MeshSize));
+	extractor.cancel(1);
+	RawVolumeMeshExtractor::Result result;
+	ASSERT_TRUE(extractor.pop(result, true));
+	EXPECT_EQ(0, result.idx);
+	EXPECT_EQ(2u, result.generation) << "Only the latest extraction of a cell is handed out";
+	delete result.mesh;
+	EXPECT_FALSE(extractor.pop(result, true)) << "The extraction of the canceled volume is handed out";
+	EXPECT_EQ(0, extractor.pending());
+	extractor.shutdown();
+}
+
+TEST_F(RawVolumeMeshExtractorTest, testScheduleWithoutInit) {
+	RawVolumeMeshExtractor extractor(1);
+	EXPECT_FALSE(extractor.schedule(0, &_volume, glm::ivec3(0), MeshSize));
+	EXPECT_EQ(0, extractor.pending());
+}
+
+}
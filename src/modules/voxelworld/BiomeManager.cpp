@@ -10,6 +10,7 @@
 #include "core/GLM.h"
 #include "core/Log.h"
 #include "noise/Simplex.h"
+#include "noise/SimplexBatch.h"
 #include "voxel/Constants.h"
 #include "voxel/Region.h"
 #include "voxel/MaterialColor.h"
@@ -99,20 +100,50 @@ Biome* BiomeManager::addBiome(int lower, int upper, float humidity, float temper
 
 float BiomeManager::getHumidity(int x, int z) {
 	core_trace_scoped(BiomeGetHumidity);
-	const float frequency = 0.001f;
-	const glm::vec2 noisePos(x * frequency, z * frequency);
-	const float n = noise::noise(noisePos);
-	return noise::norm(n);
+	float humidity;
+	float temperature;
+	getHumidityAndTemperature(&x, &z, &humidity, &temperature, 1);
+	return humidity;
 }
 
 float BiomeManager::getTemperature(int x, int z) {
 	core_trace_scoped(BiomeGetTemperature);
-	const float frequency = 0.0001f;
-	// TODO: apply y value
-	// const float scaleY = pos.y / (float)MAX_HEIGHT;
-	const glm::vec2 noisePos(x * frequency, z * frequency);
-	const float n = noise::noise(noisePos);
-	return noise::norm(n);
+	float humidity;
+	float temperature;
+	getHumidityAndTemperature(&x, &z, &humidity, &temperature, 1);
+	return temperature;
+}
+
+void BiomeManager::getHumidityAndTemperature(const int* x, const int* z, float* humidity, float* temperature, int amount) {
+	core_trace_scoped(BiomeGetHumidityAndTemperature);
+	const float humidityFrequency = 0.001f;
+	const float temperatureFrequency = 0.0001f;
+	// TODO: apply y value to the temperature
+	// the positions are processed in blocks to not allocate memory for them
+	constexpr int BlockSize = 256;
+	float noiseX[BlockSize];
+	float noiseZ[BlockSize];
+	for (int offset = 0; offset < amount; offset += BlockSize) {
+		const int n = core_min(BlockSize, amount - offset);
+		const int* blockX = x + offset;
+		const int* blockZ = z + offset;
+		float* blockHumidity = humidity + offset;
+		float* blockTemperature = temperature + offset;
+		for (int i = 0; i < n; ++i) {
+			noiseX[i] = blockX[i] * humidityFrequency;
+			noiseZ[i] = blockZ[i] * humidityFrequency;
+		}
+		noise::batch::noise(noiseX, noiseZ, blockHumidity, n);
+		for (int i = 0; i < n; ++i) {
+			noiseX[i] = blockX[i] * temperatureFrequency;
+			noiseZ[i] = blockZ[i] * temperatureFrequency;
+		}
+		noise::batch::noise(noiseX, noiseZ, blockTemperature, n);
+		for (int i = 0; i < n; ++i) {
+			blockHumidity[i] = noise::norm(blockHumidity[i]);
+			blockTemperature[i] = noise::norm(blockTemperature[i]);
+		}
+	}
 }
 
 const Biome* BiomeManager::getBiome(const glm::ivec3& pos, bool underground) const {
@@ -134,12 +165,17 @@ const Biome* BiomeManager::getBiome(const glm::ivec3& pos, bool underground) con
 		humidity = last.humidity;
 		temperature = last.temperature;
 	} else {
-		last.humidity = humidity = getHumidity(pos.x, pos.z);
-		last.temperature = temperature = getTemperature(pos.x, pos.z);
+		getHumidityAndTemperature(&pos.x, &pos.z, &humidity, &temperature, 1);
+		last.humidity = humidity;
+		last.temperature = temperature;
 		last.pos = pos;
 		last.underground = underground;
 	}
+	return getBiome(pos, humidity, temperature, underground);
+}
 
+const Biome* BiomeManager::getBiome(const glm::ivec3& pos, float humidity, float temperature, bool underground) const {
+	core_assert_msg(_defaultBiome != nullptr, "BiomeManager is not yet initialized");
 	const Biome *biomeBestMatch = _defaultBiome;
 	float distMin = (std::numeric_limits<float>::max)();
 
@@ -86,6 +86,15 @@ public:
 		return getVoxel(glm::ivec3(x, y, z), underground);
 	}
 
+	/**
+	 * @brief Lookup with the humidity and temperature of the column already known - see @c getHumidityAndTemperature()
+	 */
+	inline voxel::Voxel getVoxel(const glm::ivec3& pos, float humidity, float temperature, bool underground = false) const {
+		core_trace_scoped(BiomeGetVoxel);
+		const Biome* biome = getBiome(pos, humidity, temperature, underground);
+		return biome->voxel();
+	}
+
 	bool hasCactus(const glm::ivec3& pos) const;
 	bool hasTrees(const glm::ivec3& pos) const;
 	bool hasCity(const glm::ivec3& pos) const;
@@ -110,10 +119,15 @@ public:
 	 * @return Temperature noise in the range [0-1]
 	 */
 	static float getTemperature(int x, int z);
+	/**
+	 * @brief Computes the humidity and temperature noise for @c amount columns in one batch
+	 */
+	static void getHumidityAndTemperature(const int* x, const int* z, float* humidity, float* temperature, int amount);
 
 	void setDefaultBiome(const Biome* biome);
 
 	const Biome* getBiome(const glm::ivec3& pos, bool underground = false) const;
+	const Biome* getBiome(const glm::ivec3& pos, float humidity, float temperature, bool underground = false) const;
 };
 
 typedef std::shared_ptr<BiomeManager> BiomeManagerPtr;
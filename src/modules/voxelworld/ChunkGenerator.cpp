@@ -0,0 +1,216 @@
+/**
+ * @file
+ */
+
+#include "ChunkGenerator.h"
+#include "core/Trace.h"
+#include "core/Log.h"
+#include <vector>
+
+namespace voxelworld {
+
+ChunkGenerator::ChunkGenerator(size_t threads) :
+		_threadPool(threads, "ChunkGenerator") {
+}
+
+ChunkGenerator::~ChunkGenerator() {
+	shutdown();
+}
+
+bool ChunkGenerator::init(voxel::PagedVolume *volume) {
+	if (volume == nullptr) {
+		return false;
+	}
+	_volume = volume;
+	_cancelThreads = false;
+	_pending.reset();
+	_threadPool.init();
+	for (size_t i = 0u; i < _threadPool.size(); ++i) {
+		_threadPool.enqueue([this] () {generateScheduledChunks();});
+	}
+	return true;
+}
+
+void ChunkGenerator::shutdown() {
+	if (_volume == nullptr) {
+		return;
+	}
+	_cancelThreads = true;
+	_pending.clear();
+	_pending.abortWait();
+	_threadPool.shutdown();
+	reset();
+	_volume = nullptr;
+}
+
+void ChunkGenerator::reset() {
+	core::ScopedLock lock(_lock);
+	_states.clear();
+	_pruneSize = MinPruneSize;
+}
+
+int ChunkGenerator::stateSize() {
+	core::ScopedLock lock(_lock);
+	return (int)_states.size();
+}
+
+void ChunkGenerator::prune() {
+	core_trace_scoped(ChunkGeneratorPrune);
+	const int size = _volume->chunkSideLength();
+	std::vector<glm::ivec3> generated;
+	{
+		core::ScopedLock lock(_lock);
+		generated.reserve(_states.size());
+		for (auto i = _states.begin(); i != _states.end(); ++i) {
+			if (i->second == ChunkState::Generated) {
+				generated.push_back(i->first);
+			}
+		}
+	}
+	// don't ask the volume while holding the lock - the workers need it to publish their chunks
+	std::vector<glm::ivec3> evicted;
+	for (const glm::ivec3& chunkPos : generated) {
+		if (!_volume->loadedChunk(chunkPos * size)) {
+			evicted.push_back(chunkPos);
+		}
+	}
+	core::ScopedLock lock(_lock);
+	for (const glm::ivec3& chunkPos : evicted) {
+		ChunkState state;
+		// a chunk might have been scheduled again in the meantime
+		if (_states.get(chunkPos, state) && state == ChunkState::Generated) {
+			_states.remove(chunkPos);
+		}
+	}
+	_pruneSize = core_max(MinPruneSize, _states.size() * 2u);
+	Log::debug("Pruned %i evicted chunk states", (int)evicted.size());
+}
+
+void ChunkGenerator::markGenerated(const glm::ivec3& chunkPos) {
+	core::ScopedLock lock(_lock);
+	_states.put(chunkPos, ChunkState::Generated);
+}
+
+bool ChunkGenerator::schedule(const glm::ivec3& pos, int priority) {
+	if (_cancelThreads || _volume == nullptr) {
+		return false;
+	}
+	const glm::ivec3& chunkPos = _volume->chunkPos(pos);
+	ChunkState state;
+	bool known;
+	{
+		core::ScopedLock lock(_lock);
+		known = _states.get(chunkPos, state);
+	}
+	if (known) {
+		if (state == ChunkState::Queued || _volume->loadedChunk(pos)) {
+			return false;
+		}
+		// the chunk was evicted - generate it again before anyone has to page it in synchronously
+	}
+	bool prune;
+	{
+		core::ScopedLock lock(_lock);
+		if (_states.get(chunkPos, state) && state == ChunkState::Queued) {
+			return false;
+		}
+		_states.put(chunkPos, ChunkState::Queued);
+		prune = _states.size() >= _pruneSize;
+	}
+	_pending.push(ChunkRequest{chunkPos, priority});
+	if (prune) {
+		this->prune();
+	}
+	return true;
+}
+
+int ChunkGenerator::prefetch(const glm::ivec3& pos, int radius, int priority) {
+	const int size = _volume == nullptr ? 0 : _volume->chunkSideLength();
+	int scheduled = 0;
+	for (int z = -radius; z <= radius; ++z) {
+		for (int x = -radius; x <= radius; ++x) {
+			const int distance = core_max(glm::abs(x), glm::abs(z));
+			const glm::ivec3 chunkWorldPos(pos.x + x * size, pos.y, pos.z + z * size);
+			if (schedule(chunkWorldPos, priority - distance)) {
+				++scheduled;
+			}
+		}
+	}
+	return scheduled;
+}
+
+voxel::PagedVolume::ChunkPtr ChunkGenerator::tryGet(const glm::ivec3& pos, int priority) {
+	if (_volume == nullptr) {
+		return voxel::PagedVolume::ChunkPtr();
+	}
+	const glm::ivec3& chunkPos = _volume->chunkPos(pos);
+	bool generated = false;
+	{
+		core::ScopedLock lock(_lock);
+		auto i = _states.find(chunkPos);
+		if (i != _states.end()) {
+			if (i->second == ChunkState::Queued) {
+				return voxel::PagedVolume::ChunkPtr();
+			}
+			generated = true;
+		}
+	}
+	if (generated) {
+		const voxel::PagedVolume::ChunkPtr& chunk = _volume->loadedChunk(pos);
+		if (chunk) {
+			return chunk;
+		}
+	}
+	// schedules the chunk again if it was evicted in the meantime
+	schedule(pos, priority);
+	return voxel::PagedVolume::ChunkPtr();
+}
+
+bool ChunkGenerator::generated(const glm::ivec3& mins, const glm::ivec3& maxs, int priority) {
+	if (_volume == nullptr) {
+		return false;
+	}
+	const int size = _volume->chunkSideLength();
+	const glm::ivec3& lower = _volume->chunkPos(mins);
+	const glm::ivec3& upper = _volume->chunkPos(maxs);
+	bool all = true;
+	for (int z = lower.z; z <= upper.z; ++z) {
+		for (int y = lower.y; y <= upper.y; ++y) {
+			for (int x = lower.x; x <= upper.x; ++x) {
+				if (!tryGet(glm::ivec3(x, y, z) * size, priority)) {
+					all = false;
+				}
+			}
+		}
+	}
+	return all;
+}
+
+voxel::PagedVolume::ChunkPtr ChunkGenerator::get(const glm::ivec3& pos) {
+	if (_volume == nullptr) {
+		return voxel::PagedVolume::ChunkPtr();
+	}
+	// blocks while a worker is paging in the chunk - or pages it in on this thread if no worker picked it up yet
+	const voxel::PagedVolume::ChunkPtr& chunk = _volume->chunk(pos);
+	markGenerated(_volume->chunkPos(pos));
+	return chunk;
+}
+
+void ChunkGenerator::generateScheduledChunks() {
+	while (!_cancelThreads) {
+		ChunkRequest request;
+		if (!_pending.waitAndPop(request)) {
+			break;
+		}
+		core_trace_scoped(ChunkGeneration);
+		const int size = _volume->chunkSideLength();
+		Log::trace("generate chunk %i:%i:%i", request.chunkPos.x, request.chunkPos.y, request.chunkPos.z);
+		// paging in the chunk publishes it into the volume
+		const voxel::PagedVolume::ChunkPtr& chunk = _volume->chunk(request.chunkPos * size);
+		// the floor queries shouldn't have to do this on the calling thread
+		chunk->buildColumnHeights();
+		markGenerated(request.chunkPos);
+	}
+}
+
+}
@@ -0,0 +1,126 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "voxel/PagedVolume.h"
+#include "core/concurrent/ThreadPool.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
+#include "core/collection/ConcurrentQueue.h"
+#include "core/collection/FlatMap.h"
+#include "core/GLM.h"
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+namespace voxelworld {
+
+/**
+ * @brief Generates the chunks of a voxel::PagedVolume on a worker pool
+ *
+ * The chunks are paged in through the volume - a finished chunk is published into the volume and accessing
+ * its voxels doesn't page anything in on the calling thread anymore. Requests with a higher priority are
+ * handled first.
+ *
+ * Use tryGet() if you can live without the chunk for now, and get() if you have to wait for it.
+ */
+class ChunkGenerator {
+public:
+	// the chunks around spawn points
+	static constexpr int PrioritySpawn = 1000;
+	// the chunks around the players
+	static constexpr int PriorityPlayer = 2000;
+
+private:
+	struct ChunkRequest {
+		glm::ivec3 chunkPos { 0 };
+		int priority = 0;
+
+		inline bool operator<(const ChunkRequest& other) const {
+			return priority < other.priority;
+		}
+	};
+
+	enum class ChunkState : uint8_t {
+		Queued,
+		Generated
+	};
+	typedef core::FlatMap<glm::ivec3, ChunkState, std::hash<glm::ivec3>> ChunkStates;
+
+	core::ThreadPool _threadPool;
+	core::ConcurrentPriorityQueue<ChunkRequest> _pending;
+	// the chunks that are queued or were already generated - key is the chunk position
+	core::Lock _lock;
+	ChunkStates _states;
+	// the states of evicted chunks are removed once the map reaches this size
+	size_t _pruneSize = MinPruneSize;
+	static constexpr size_t MinPruneSize = 1024u;
+	core::AtomicBool _cancelThreads { false };
+	voxel::PagedVolume *_volume = nullptr;
+
+	void generateScheduledChunks();
+	void markGenerated(const glm::ivec3& chunkPos);
+	/**
+	 * @brief Removes the states of the generated chunks that were evicted from the volume
+	 */
+	void prune();
+
+public:
+	ChunkGenerator(size_t threads);
+	~ChunkGenerator();
+
+	bool init(voxel::PagedVolume *volume);
+	void shutdown();
+	/**
+	 * @brief Forget about the generated chunks - call this after the volume was flushed
+	 */
+	void reset();
+
+	/**
+	 * @brief Schedules the generation of the chunk that contains the given world position
+	 * @return @c false if the chunk is already queued or was generated and is still loaded
+	 */
+	bool schedule(const glm::ivec3& pos, int priority);
+
+	/**
+	 * @brief Schedules the chunks in a ring of @c radius chunks around the chunk of the given world position.
+	 * The closer a chunk is to the center, the higher its priority.
+	 * @return The amount of newly scheduled chunks
+	 */
+	int prefetch(const glm::ivec3& pos, int radius, int priority);
+
+	/**
+	 * @return The chunk for the given world position if it was generated already. Otherwise the chunk is
+	 * scheduled with the given priority and an empty pointer is returned.
+	 */
+	voxel::PagedVolume::ChunkPtr tryGet(const glm::ivec3& pos, int priority = PriorityPlayer);
+
+	/**
+	 * @return @c true if all chunks that intersect the given world region are generated. The missing chunks
+	 * are scheduled with the given priority.
+	 */
+	bool generated(const glm::ivec3& mins, const glm::ivec3& maxs, int priority = PriorityPlayer);
+
+	/**
+	 * @brief Returns the chunk for the given world position and waits for it if it's not yet generated
+	 * @note If no worker picked up the chunk yet, it is generated on the calling thread
+	 */
+	voxel::PagedVolume::ChunkPtr get(const glm::ivec3& pos);
+
+	/**
+	 * @return The amount of chunks that are waiting for a worker
+	 */
+	int queueSize() const;
+
+	/**
+	 * @return The amount of chunks that are queued or generated
+	 */
+	int stateSize();
+};
+
+inline int ChunkGenerator::queueSize() const {
+	return (int)_pending.size();
+}
+
+}
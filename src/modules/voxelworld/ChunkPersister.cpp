@@ -12,8 +12,17 @@
 namespace voxelworld {
 
 #define WORLD_FILE_VERSION 1
+// all voxels of the chunk have the same value - only this voxel is stored
+#define WORLD_FILE_VERSION_UNIFORM 2
 
 bool ChunkPersister::saveCompressed(voxel::PagedVolume::Chunk* chunk, core::ByteStream& outStream) const {
+	voxel::Voxel uniformVoxel;
+	if (chunk->isUniform(uniformVoxel)) {
+		static_assert(sizeof(voxel::VoxelType) == sizeof(uint8_t), "Voxel type size changed");
+		outStream.addFormat("ibbb", 2, WORLD_FILE_VERSION_UNIFORM, core::enumVal(uniformVoxel.getMaterial()), uniformVoxel.getColor());
+		return true;
+	}
+
 	core::ByteStream voxelStream;
 	const voxel::Region& region = chunk->region();
 	const int width = region.getWidthInVoxels();
@@ -58,6 +67,17 @@ bool ChunkPersister::loadCompressed(voxel::PagedVolume::Chunk* chunk, const uint
 	int version;
 	bs.readFormat("ib", &len, &version);
 
+	if (version == WORLD_FILE_VERSION_UNIFORM) {
+		if (bs.getSize() < 2) {
+			Log::error("uniform chunk is truncated");
+			return false;
+		}
+		const voxel::VoxelType material = (voxel::VoxelType)bs.readByte();
+		const uint8_t colorIndex = bs.readByte();
+		chunk->fill(voxel::createVoxel(material, colorIndex));
+		return true;
+	}
+
 	if (version != WORLD_FILE_VERSION) {
 		Log::error("chunk has a wrong version number %i (expected %i)",
 				version, WORLD_FILE_VERSION);
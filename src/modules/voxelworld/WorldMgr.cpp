@@ -24,15 +24,20 @@ WorldMgr::~WorldMgr() {
 	shutdown();
 }
 
-glm::ivec3 WorldMgr::randomPos() const {
+glm::ivec3 WorldMgr::randomColumn() const {
 	int lowestX = -100;
 	int lowestZ = -100;
 	int highestX = 100;
 	int highestZ = 100;
 	const int x = _random.random(lowestX, highestX);
 	const int z = _random.random(lowestZ, highestZ);
-	const int y = findFloor(x, z, voxel::isFloor);
-	return glm::ivec3(x, y, z);
+	return glm::ivec3(x, 0, z);
+}
+
+glm::ivec3 WorldMgr::randomPos() const {
+	glm::ivec3 pos = randomColumn();
+	pos.y = findFloor(pos.x, pos.z, voxel::isFloor);
+	return pos;
 }
 
 void WorldMgr::reset() {
@@ -45,8 +50,9 @@ void WorldMgr::setSeed(unsigned int seed) {
 	_random.setSeed(seed);
 }
 
-bool WorldMgr::init(uint32_t volumeMemoryMegaBytes, uint16_t chunkSideLength) {
-	_volumeData = new voxel::PagedVolume(_pager.get(), volumeMemoryMegaBytes * 1024 * 1024, chunkSideLength);
+bool WorldMgr::init(uint32_t volumeMemoryMegaBytes, uint16_t chunkSideLength, uint32_t compressedVolumeMemoryMegaBytes) {
+	_volumeData = new voxel::PagedVolume(_pager.get(), volumeMemoryMegaBytes * 1024 * 1024, chunkSideLength,
+			compressedVolumeMemoryMegaBytes * 1024 * 1024);
 	return true;
 }
 
@@ -55,7 +61,64 @@ void WorldMgr::shutdown() {
 	_volumeData = nullptr;
 }
 
+int WorldMgr::columnHeight(int x, int z) const {
+	const voxel::PagedVolume::ChunkPtr& chunk = _volumeData->chunk(glm::ivec3(x, 0, z));
+	const int mask = _volumeData->chunkSideLength() - 1;
+	return chunk->columnHeight(x & mask, z & mask);
+}
+
+bool WorldMgr::findWalkableFloorFromColumnHeight(const glm::vec3& position, float maxDistanceY, int& y) const {
+	// one chunk must cover the whole column
+	if (_volumeData->chunkSideLength() <= voxel::MAX_HEIGHT) {
+		return false;
+	}
+	if (position.y < 0.0f || position.y > (float)voxel::MAX_HEIGHT) {
+		return false;
+	}
+	// material() truncates the coordinates - the position must be above the highest solid voxel to be enterable
+	const int materialX = (int)position.x;
+	const int materialZ = (int)position.z;
+	const int materialHeight = columnHeight(materialX, materialZ);
+	if ((int)position.y < materialHeight) {
+		return false;
+	}
+	// the raycast floors the coordinates - this is a different column for negative coordinates
+	const int rayX = (int)glm::floor(position.x);
+	const int rayZ = (int)glm::floor(position.z);
+	const int height = (rayX == materialX && rayZ == materialZ) ? materialHeight : columnHeight(rayX, rayZ);
+	const int startY = (int)glm::floor(position.y);
+	if (height > startY) {
+		// the ray starts below the highest solid voxel of its column
+		return false;
+	}
+	const int endY = (int)glm::floor(position.y - (glm::min)(maxDistanceY, position.y));
+	if (height > 0 && height - 1 >= endY) {
+		y = height;
+	} else {
+		y = voxel::NO_FLOOR_FOUND;
+	}
+	return true;
+}
+
 int WorldMgr::findWalkableFloor(const glm::vec3& position, float maxDistanceY) const {
+	core_trace_scoped(FindWalkableFloor);
+	int y;
+	if (findWalkableFloorFromColumnHeight(position, maxDistanceY, y)) {
+		return y;
+	}
+	return findWalkableFloorRaycast(position, maxDistanceY);
+}
+
+void WorldMgr::findWalkableFloors(const glm::vec3* positions, int* floors, int amount, float maxDistanceY) const {
+	core_trace_scoped(FindWalkableFloors);
+	for (int i = 0; i < amount; ++i) {
+		if (!findWalkableFloorFromColumnHeight(positions[i], maxDistanceY, floors[i])) {
+			floors[i] = findWalkableFloorRaycast(positions[i], maxDistanceY);
+		}
+	}
+}
+
+int WorldMgr::findWalkableFloorRaycast(const glm::vec3& position, float maxDistanceY) const {
 	const voxel::VoxelType type = material(position.x, position.y, position.z);
 	int y = voxel::NO_FLOOR_FOUND;
 	if (voxel::isEnterable(type)) {
@@ -57,7 +57,17 @@ public:
 	 */
 	int findWalkableFloor(const glm::vec3& position, float maxDistanceY = (float)voxel::MAX_HEIGHT) const;
 
-	bool init(uint32_t volumeMemoryMegaBytes = 512, uint16_t chunkSideLength = 256);
+	/**
+	 * @brief Batch version of @c findWalkableFloor()
+	 * @param[out] floors Must have space for @c amount values
+	 */
+	void findWalkableFloors(const glm::vec3* positions, int* floors, int amount, float maxDistanceY = (float)voxel::MAX_HEIGHT) const;
+
+	/**
+	 * @param compressedVolumeMemoryMegaBytes The memory for evicted chunks that are kept compressed in memory
+	 * before they are paged out. @c 0 disables this.
+	 */
+	bool init(uint32_t volumeMemoryMegaBytes = 512, uint16_t chunkSideLength = 256, uint32_t compressedVolumeMemoryMegaBytes = 0);
 	void shutdown();
 	void reset();
 
@@ -68,6 +78,12 @@ public:
 	 */
 	glm::ivec3 randomPos() const;
 
+	/**
+	 * @brief Returns a random column inside the boundaries of the world - the y component is @c 0
+	 * @sa randomPos()
+	 */
+	glm::ivec3 randomColumn() const;
+
 	unsigned int seed() const;
 
 	void setSeed(unsigned int seed);
@@ -86,6 +102,15 @@ private:
 	 */
 	glm::ivec3 chunkPos(const glm::ivec3& pos) const;
 
+	/**
+	 * @brief Answers the floor query from the column heights of the chunks - this works for all positions
+	 * above the highest solid voxel of their column.
+	 * @return @c false if the raycast is needed to answer the query
+	 */
+	bool findWalkableFloorFromColumnHeight(const glm::vec3& position, float maxDistanceY, int& y) const;
+	int findWalkableFloorRaycast(const glm::vec3& position, float maxDistanceY) const;
+	int columnHeight(int x, int z) const;
+
 	voxel::PagedVolume::PagerPtr _pager;
 	voxel::PagedVolume *_volumeData = nullptr;
 	mutable std::mt19937 _engine;
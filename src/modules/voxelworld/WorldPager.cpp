@@ -7,9 +7,11 @@
 #include "voxel/PagedVolumeWrapper.h"
 #include "voxelutil/Raycast.h"
 #include "noise/Simplex.h"
+#include "noise/SimplexBatch.h"
 #include "core/Common.h"
 #include "core/StringUtil.h"
 #include "core/collection/Array.h"
+#include <vector>
 
 namespace voxelworld {
 
@@ -92,50 +94,110 @@ void WorldPager::createWorld(voxel::PagedVolumeWrapper& volume) const {
 	const int minsY = region.getLowerY();
 	const int lowerZ = region.getLowerZ();
 	core_assert(region.getLowerY() >= 0);
-	voxel::Voxel voxels[voxel::MAX_TERRAIN_HEIGHT];
 
-	// TODO: store voxel data in local buffer and transfer in one step into the volume to reduce locking
 	const int size = 2;
 	core_assert(depth % size == 0);
 	core_assert(width % size == 0);
-	for (int z = lowerZ; z < lowerZ + depth; z += size) {
-		for (int x = lowerX; x < lowerX + width; x += size) {
-			const int ni = fillVoxels(x, minsY, z, voxels);
-			volume.setVoxels(x, minsY, z, size, size, voxels, ni);
-			memset(voxels, 0, ni * sizeof(voxel::Voxel));
-		}
+	const int columnsX = width / size;
+	const int columns = columnsX * (depth / size);
+
+	// the 2d noise values of all columns of the chunk are computed in one batch
+	std::vector<int> columnPos(columns * 2);
+	std::vector<float> columnNoise(columns * 3);
+	int* columnX = columnPos.data();
+	int* columnZ = columnX + columns;
+	float* n = columnNoise.data();
+	float* humidity = n + columns;
+	float* temperature = humidity + columns;
+	for (int i = 0; i < columns; ++i) {
+		columnX[i] = lowerX + (i % columnsX) * size;
+		columnZ[i] = lowerZ + (i / columnsX) * size;
+	}
+	getNoiseValues(columnX, columnZ, n, columns);
+	BiomeManager::getHumidityAndTemperature(columnX, columnZ, humidity, temperature, columns);
+
+	voxel::Voxel voxels[voxel::MAX_TERRAIN_HEIGHT];
+	for (int i = 0; i < columns; ++i) {
+		const int x = columnX[i];
+		const int z = columnZ[i];
+		const int ni = fillVoxels(x, minsY, z, n[i], humidity[i], temperature[i], voxels);
+		volume.setVoxels(x, minsY, z, size, size, voxels, ni);
+		memset(voxels, 0, ni * sizeof(voxel::Voxel));
 	}
 }
 
-float WorldPager::getNoiseValue(float x, float z) const {
-	const glm::vec2 noisePos2d(_noiseSeedOffset.x + x, _noiseSeedOffset.y + z);
-	// TODO: move the noise settings into the biome
-	const float landscapeNoise = noise::fBm(noisePos2d * _worldCtx.landscapeNoiseFrequency, _worldCtx.landscapeNoiseOctaves,
-			_worldCtx.landscapeNoiseLacunarity, _worldCtx.landscapeNoiseGain);
-	const float noiseNormalized = noise::norm(landscapeNoise);
-	const float mountainNoise = noise::fBm(noisePos2d * _worldCtx.mountainNoiseFrequency, _worldCtx.mountainNoiseOctaves,
-			_worldCtx.mountainNoiseLacunarity, _worldCtx.mountainNoiseGain);
-	const float mountainNoiseNormalized = noise::norm(mountainNoise);
-	const float mountainMultiplier = mountainNoiseNormalized * (mountainNoiseNormalized + 0.5f);
-	const float n = glm::clamp(noiseNormalized * mountainMultiplier, 0.0f, 1.0f);
+float WorldPager::getNoiseValue(int x, int z) const {
+	float n;
+	getNoiseValues(&x, &z, &n, 1);
 	return n;
 }
 
-float WorldPager::getDensity(float x, float y, float z, float n) const {
-	const glm::vec3 noisePos3d(_noiseSeedOffset.x + x, y, _noiseSeedOffset.y + z);
+void WorldPager::getNoiseValues(const int* x, const int* z, float* out, int amount) const {
+	// the columns are processed in blocks to not allocate memory for them
+	constexpr int BlockSize = 256;
+	float noiseX[BlockSize];
+	float noiseZ[BlockSize];
+	float mountainNoise[BlockSize];
+	for (int offset = 0; offset < amount; offset += BlockSize) {
+		const int n = core_min(BlockSize, amount - offset);
+		const int* blockX = x + offset;
+		const int* blockZ = z + offset;
+		float* blockOut = out + offset;
+		// TODO: move the noise settings into the biome
+		for (int i = 0; i < n; ++i) {
+			noiseX[i] = (_noiseSeedOffset.x + blockX[i]) * _worldCtx.landscapeNoiseFrequency;
+			noiseZ[i] = (_noiseSeedOffset.y + blockZ[i]) * _worldCtx.landscapeNoiseFrequency;
+		}
+		noise::batch::fBm(noiseX, noiseZ, blockOut, n, _worldCtx.landscapeNoiseOctaves,
+				_worldCtx.landscapeNoiseLacunarity, _worldCtx.landscapeNoiseGain);
+		for (int i = 0; i < n; ++i) {
+			noiseX[i] = (_noiseSeedOffset.x + blockX[i]) * _worldCtx.mountainNoiseFrequency;
+			noiseZ[i] = (_noiseSeedOffset.y + blockZ[i]) * _worldCtx.mountainNoiseFrequency;
+		}
+		noise::batch::fBm(noiseX, noiseZ, mountainNoise, n, _worldCtx.mountainNoiseOctaves,
+				_worldCtx.mountainNoiseLacunarity, _worldCtx.mountainNoiseGain);
+		for (int i = 0; i < n; ++i) {
+			const float noiseNormalized = noise::norm(blockOut[i]);
+			const float mountainNoiseNormalized = noise::norm(mountainNoise[i]);
+			const float mountainMultiplier = mountainNoiseNormalized * (mountainNoiseNormalized + 0.5f);
+			blockOut[i] = glm::clamp(noiseNormalized * mountainMultiplier, 0.0f, 1.0f);
+		}
+	}
+}
+
+void WorldPager::getDensities(int x, int z, int minY, int maxY, float n, float* densities) const {
+	const int amount = maxY - minY;
+	if (amount <= 0) {
+		return;
+	}
+	core_assert(minY >= 0 && maxY <= voxel::MAX_TERRAIN_HEIGHT);
+	float noiseX[voxel::MAX_TERRAIN_HEIGHT];
+	float noiseY[voxel::MAX_TERRAIN_HEIGHT];
+	float noiseZ[voxel::MAX_TERRAIN_HEIGHT];
 	// TODO: move the noise settings into the biome
-	const float noiseVal = noise::norm(
-			noise::fBm(noisePos3d * _worldCtx.caveNoiseFrequency, _worldCtx.caveNoiseOctaves, _worldCtx.caveNoiseLacunarity, _worldCtx.caveNoiseGain));
-	const float finalDensity = n + noiseVal;
-	return finalDensity;
+	const float frequency = _worldCtx.caveNoiseFrequency;
+	const float columnX = (_noiseSeedOffset.x + x) * frequency;
+	const float columnZ = (_noiseSeedOffset.y + z) * frequency;
+	for (int i = 0; i < amount; ++i) {
+		noiseX[i] = columnX;
+		noiseY[i] = (float)(minY + i) * frequency;
+		noiseZ[i] = columnZ;
+	}
+	float* out = densities + minY;
+	noise::batch::fBm(noiseX, noiseY, noiseZ, out, amount, _worldCtx.caveNoiseOctaves,
+			_worldCtx.caveNoiseLacunarity, _worldCtx.caveNoiseGain);
+	for (int i = 0; i < amount; ++i) {
+		out[i] = n + noise::norm(out[i]);
+	}
 }
 
 int WorldPager::terrainHeight(int x, int y, int z) const {
 	const float n = getNoiseValue(x, z);
-	return terrainHeight(x, y, z, n);
+	float densities[voxel::MAX_TERRAIN_HEIGHT];
+	return terrainHeight(x, y, z, n, densities);
 }
 
-int WorldPager::terrainHeight(int x, int minsY, int z, float n) const {
+int WorldPager::terrainHeight(int x, int minsY, int z, float n, float* densities) const {
 	const int maxHeight = voxel::MAX_TERRAIN_HEIGHT - 1;
 	int centerHeight;
 	// the center of a city should make the terrain more even
@@ -147,9 +209,9 @@ int WorldPager::terrainHeight(int x, int minsY, int z, float n) const {
 	} else {
 		ni = n * maxHeight;
 	}
+	getDensities(x, z, minsY + 1, ni, n, densities);
 	for (int y = ni - 1; y >= minsY + 1; --y) {
-		const float density = getDensity(x, y, z, n);
-		if (density > _worldCtx.caveDensityThreshold) {
+		if (densities[y] > _worldCtx.caveDensityThreshold) {
 			break;
 		}
 		--ni;
@@ -157,9 +219,9 @@ int WorldPager::terrainHeight(int x, int minsY, int z, float n) const {
 	return ni;
 }
 
-int WorldPager::fillVoxels(int x, int minsY, int z, voxel::Voxel* voxels) const {
-	const float n = getNoiseValue(x, z);
-	const int ni = terrainHeight(x, minsY, z, n);
+int WorldPager::fillVoxels(int x, int minsY, int z, float n, float humidity, float temperature, voxel::Voxel* voxels) const {
+	float densities[voxel::MAX_TERRAIN_HEIGHT];
+	const int ni = terrainHeight(x, minsY, z, n, densities);
 	if (ni < minsY) {
 		return 0;
 	}
@@ -171,11 +233,10 @@ int WorldPager::fillVoxels(int x, int minsY, int z, voxel::Voxel* voxels) const
 	voxels[0] = dirt;
 	glm::ivec3 pos(x, 0, z);
 	for (int y = ni - 1; y >= minsY + 1; --y) {
-		const float density = getDensity(x, y, z, n);
-		if (density > _worldCtx.caveDensityThreshold) {
+		if (densities[y] > _worldCtx.caveDensityThreshold) {
 			const bool cave = y < ni - 1;
 			pos.y = y;
-			const voxel::Voxel& voxel = _biomeManager.getVoxel(pos, cave);
+			const voxel::Voxel& voxel = _biomeManager.getVoxel(pos, humidity, temperature, cave);
 			voxels[y] = voxel;
 		} else {
 			if (y < voxel::MAX_WATER_HEIGHT) {
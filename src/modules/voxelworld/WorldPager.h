@@ -46,14 +46,26 @@ private:
 	void addVolumeToPosition(voxel::PagedVolumeWrapper& target, const voxelutil::RawVolumeRotateWrapper& source, const glm::ivec3& pos);
 
 	int terrainHeight(int x, int minsY, int z) const;
-	int terrainHeight(int x, int minsY, int z, float n) const;
-	int fillVoxels(int x, int minsY, int z, voxel::Voxel* voxels) const;
+	/**
+	 * @param[out] densities Indexed by the y coordinate - filled for the heights the returned terrain height
+	 * is derived from. Must have space for @c voxel::MAX_TERRAIN_HEIGHT values.
+	 */
+	int terrainHeight(int x, int minsY, int z, float n, float* densities) const;
+	int fillVoxels(int x, int minsY, int z, float n, float humidity, float temperature, voxel::Voxel* voxels) const;
 
 	/**
 	 * @return A float value between [0.0-1.0]
 	 */
-	float getNoiseValue(float x, float z) const;
-	float getDensity(float x, float y, float z, float n) const;
+	float getNoiseValue(int x, int z) const;
+	/**
+	 * @brief Computes the noise values of @c amount columns in one batch - see @c getNoiseValue()
+	 */
+	void getNoiseValues(const int* x, const int* z, float* out, int amount) const;
+	/**
+	 * @brief Computes the densities of the column for the heights [minY, maxY) in one batch
+	 * @param[out] densities Indexed by the y coordinate
+	 */
+	void getDensities(int x, int z, int minY, int maxY, float n, float* densities) const;
 
 public:
 	WorldPager(const voxelformat::VolumeCachePtr& volumeCache, const ChunkPersisterPtr& chunkPersister);
@@ -49,4 +49,88 @@ BENCHMARK_DEFINE_F(PagedVolumeBenchmark, pageIn) (benchmark::State& state) {
 
 BENCHMARK_REGISTER_F(PagedVolumeBenchmark, pageIn)->RangeMultiplier(2)->Range(8, 256);
 
+/**
+ * @brief Several threads are sharing one volume - like the mesh extractor threads or the server world.
+ * The pager is cheap here to measure the chunk lookup and eviction and not the world generation.
+ */
+class PagedVolumeThreadBenchmark: public core::AbstractBenchmark {
+private:
+	using Super = core::AbstractBenchmark;
+
+	class Pager: public voxel::PagedVolume::Pager {
+	public:
+		bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+			const voxel::Region& region = ctx.chunk->region();
+			const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Grass, 0);
+			for (int x = 0; x < region.getWidthInVoxels(); ++x) {
+				for (int z = 0; z < region.getDepthInVoxels(); ++z) {
+					const int height = (region.getLowerX() + x + region.getLowerZ() + z) & 15;
+					for (int y = 0; y < region.getHeightInVoxels() && region.getLowerY() + y < height; ++y) {
+						ctx.chunk->setVoxel(x, y, z, voxel);
+					}
+				}
+			}
+			return false;
+		}
+
+		void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+		}
+	};
+
+protected:
+	Pager _pager;
+	voxel::PagedVolume *_volume = nullptr;
+
+	void run(benchmark::State& state, int worldSize) {
+		if (state.thread_index == 0) {
+			// 4MB - 64 chunks with a side length of 32
+			_volume = new voxel::PagedVolume(&_pager, 4 * 1024 * 1024, 32);
+		}
+		uint32_t seed = 1 + state.thread_index * 7919;
+		for (auto _ : state) {
+			for (int i = 0; i < 1024; ++i) {
+				seed = seed * 1664525u + 1013904223u;
+				const int x = (int)(seed >> 8) % worldSize;
+				seed = seed * 1664525u + 1013904223u;
+				const int y = (int)(seed >> 8) % 64;
+				seed = seed * 1664525u + 1013904223u;
+				const int z = (int)(seed >> 8) % worldSize;
+				benchmark::DoNotOptimize(_volume->voxel(x, y, z));
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * 1024);
+		if (state.thread_index == 0) {
+			delete _volume;
+			_volume = nullptr;
+		}
+	}
+
+public:
+	// only one app instance for all threads - the other threads are waiting for the first in the benchmark loop
+	void SetUp(benchmark::State& state) override {
+		if (state.thread_index == 0) {
+			Super::SetUp(state);
+		}
+	}
+
+	void TearDown(benchmark::State& state) override {
+		if (state.thread_index == 0) {
+			Super::TearDown(state);
+		}
+	}
+};
+
+BENCHMARK_DEFINE_F(PagedVolumeThreadBenchmark, chunkLookup) (benchmark::State& state) {
+	// fits into the memory limit - no chunks are evicted
+	run(state, 64);
+}
+
+BENCHMARK_DEFINE_F(PagedVolumeThreadBenchmark, chunkEviction) (benchmark::State& state) {
+	// exceeds the memory limit - chunks are evicted and paged in again all the time
+	run(state, 512);
+}
+
+BENCHMARK_REGISTER_F(PagedVolumeThreadBenchmark, chunkLookup)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_REGISTER_F(PagedVolumeThreadBenchmark, chunkEviction)->ThreadRange(1, 8)->UseRealTime();
+
 BENCHMARK_MAIN();
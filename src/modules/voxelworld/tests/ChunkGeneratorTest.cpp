@@ -0,0 +1,121 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "voxelworld/ChunkGenerator.h"
+#include "voxel/PagedVolume.h"
+#include "core/concurrent/Atomic.h"
+#include <thread>
+#include <chrono>
+
+namespace voxelworld {
+
+class ChunkGeneratorTest: public core::AbstractTest {
+protected:
+	class Pager: public voxel::PagedVolume::Pager {
+	public:
+		core::AtomicInt pageIns { 0 };
+
+		bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+			++pageIns;
+			ctx.chunk->setVoxel(0, 0, 0, voxel::createVoxel(voxel::VoxelType::Grass, 0));
+			return true;
+		}
+
+		void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+		}
+	};
+
+	static constexpr uint16_t ChunkSideLength = 16;
+	Pager _pager;
+	voxel::PagedVolume _volume { &_pager, 16 * 1024 * 1024, ChunkSideLength };
+
+	voxel::PagedVolume::ChunkPtr waitForChunk(ChunkGenerator& generator, const glm::ivec3& pos) {
+		for (int i = 0; i < 5000; ++i) {
+			const voxel::PagedVolume::ChunkPtr& chunk = generator.tryGet(pos);
+			if (chunk) {
+				return chunk;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return voxel::PagedVolume::ChunkPtr();
+	}
+};
+
+TEST_F(ChunkGeneratorTest, testTryGet) {
+	ChunkGenerator generator(2);
+	ASSERT_TRUE(generator.init(&_volume));
+	const glm::ivec3 pos(3 * ChunkSideLength, 0, -2 * ChunkSideLength);
+	const voxel::PagedVolume::ChunkPtr& chunk = waitForChunk(generator, pos);
+	ASSERT_TRUE(chunk);
+	EXPECT_EQ(_volume.chunkPos(pos), chunk->chunkPos());
+	EXPECT_EQ(voxel::VoxelType::Grass, _volume.voxel(pos).getMaterial());
+	EXPECT_EQ(1, _pager.pageIns);
+	generator.shutdown();
+}
+
+TEST_F(ChunkGeneratorTest, testGet) {
+	ChunkGenerator generator(1);
+	ASSERT_TRUE(generator.init(&_volume));
+	const glm::ivec3 pos(0);
+	const voxel::PagedVolume::ChunkPtr& chunk = generator.get(pos);
+	ASSERT_TRUE(chunk);
+	EXPECT_EQ(voxel::VoxelType::Grass, chunk->voxel(0, 0, 0).getMaterial());
+	EXPECT_EQ(chunk.get(), generator.tryGet(pos).get()) << "The chunk should be available without waiting";
+	EXPECT_FALSE(generator.schedule(pos, ChunkGenerator::PriorityPlayer)) << "The chunk was already generated";
+	EXPECT_EQ(1, _pager.pageIns);
+	generator.shutdown();
+}
+
+TEST_F(ChunkGeneratorTest, testPrefetch) {
+	ChunkGenerator generator(2);
+	ASSERT_TRUE(generator.init(&_volume));
+	const glm::ivec3 pos(0);
+	EXPECT_EQ(9, generator.prefetch(pos, 1, ChunkGenerator::PriorityPlayer));
+	EXPECT_EQ(0, generator.prefetch(pos, 1, ChunkGenerator::PriorityPlayer)) << "The chunks are already scheduled";
+	EXPECT_EQ(16, generator.prefetch(pos, 2, ChunkGenerator::PrioritySpawn)) << "Only the outer ring should get scheduled";
+	for (int z = -2; z <= 2; ++z) {
+		for (int x = -2; x <= 2; ++x) {
+			const glm::ivec3 chunkPos(x * ChunkSideLength, 0, z * ChunkSideLength);
+			ASSERT_TRUE(waitForChunk(generator, chunkPos)) << "Chunk at " << x << ":" << z << " wasn't generated";
+		}
+	}
+	EXPECT_EQ(25, _pager.pageIns);
+	EXPECT_EQ(0, generator.queueSize());
+	generator.shutdown();
+}
+
+TEST_F(ChunkGeneratorTest, testScheduleEvictedChunk) {
+	ChunkGenerator generator(1);
+	ASSERT_TRUE(generator.init(&_volume));
+	const glm::ivec3 pos(0);
+	ASSERT_TRUE(generator.get(pos));
+	EXPECT_FALSE(generator.schedule(pos, ChunkGenerator::PriorityPlayer)) << "The chunk is still loaded";
+	_volume.flushAll();
+	ASSERT_FALSE(_volume.loadedChunk(pos));
+	EXPECT_TRUE(generator.schedule(pos, ChunkGenerator::PriorityPlayer)) << "The evicted chunk must be generated again";
+	ASSERT_TRUE(waitForChunk(generator, pos));
+	generator.shutdown();
+}
+
+TEST_F(ChunkGeneratorTest, testGenerated) {
+	ChunkGenerator generator(2);
+	ASSERT_TRUE(generator.init(&_volume));
+	const glm::ivec3 mins(0);
+	const glm::ivec3 maxs(ChunkSideLength, 0, 0);
+	bool generated = false;
+	for (int i = 0; i < 5000 && !generated; ++i) {
+		generated = generator.generated(mins, maxs);
+		if (!generated) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+	ASSERT_TRUE(generated);
+	EXPECT_TRUE(_volume.loadedChunk(mins));
+	EXPECT_TRUE(_volume.loadedChunk(maxs));
+	EXPECT_EQ(2, generator.stateSize());
+	generator.shutdown();
+}
+
+}
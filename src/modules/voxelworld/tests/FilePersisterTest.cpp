@@ -19,4 +19,17 @@ TEST_F(WorldPersisterTest, testSaveLoad) {
 	ASSERT_EQ(voxel::VoxelType::Grass, _volData.voxel(32, 32, 32).getMaterial());
 }
 
+TEST_F(WorldPersisterTest, testSaveLoadUniform) {
+	FilePersister persister;
+	const voxel::PagedVolume::ChunkPtr& chunk = _ctx.chunk();
+	chunk->fill(voxel::createVoxel(voxel::VoxelType::Rock, 1));
+	ASSERT_TRUE(persister.save(chunk.get(), _seed)) << "Could not save volume chunk";
+	chunk->fill(voxel::Voxel());
+	ASSERT_TRUE(persister.load(chunk.get(), _seed)) << "Could not load volume chunk";
+	voxel::Voxel voxel;
+	ASSERT_TRUE(chunk->isUniform(voxel));
+	EXPECT_EQ(voxel::VoxelType::Rock, voxel.getMaterial());
+	EXPECT_EQ(1, voxel.getColor());
+}
+
 }
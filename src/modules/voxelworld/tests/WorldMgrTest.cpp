@@ -0,0 +1,94 @@
+/**
+ * @file
+ */
+
+#include "core/tests/AbstractTest.h"
+#include "voxelworld/WorldMgr.h"
+#include "voxel/PagedVolume.h"
+#include "voxel/Voxel.h"
+#include "math/Random.h"
+#include "core/SharedPtr.h"
+#include "core/ArrayLength.h"
+
+namespace voxelworld {
+
+class WorldMgrTest: public core::AbstractTest {
+protected:
+	// generates hills with caves and water - the terrain is at most MaxTerrainHeight voxels high
+	class Pager: public voxel::PagedVolume::Pager {
+	public:
+		static constexpr int MaxTerrainHeight = 48;
+
+		bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+			const voxel::Region& region = ctx.region;
+			const voxel::Voxel rock = voxel::createVoxel(voxel::VoxelType::Rock, 0);
+			const voxel::Voxel water = voxel::createVoxel(voxel::VoxelType::Water, 0);
+			voxel::Voxel column[MaxTerrainHeight];
+			for (int z = 0; z < region.getDepthInVoxels(); ++z) {
+				for (int x = 0; x < region.getWidthInVoxels(); ++x) {
+					const int wx = region.getLowerX() + x;
+					const int wz = region.getLowerZ() + z;
+					const int height = 8 + ((wx * 7 + wz * 13) & 31);
+					for (int y = 0; y < MaxTerrainHeight; ++y) {
+						if (y >= height) {
+							column[y] = y < 20 ? water : voxel::Voxel();
+						} else if (y > 4 && y < 8 && ((wx ^ wz) & 3) == 0) {
+							// cave
+							column[y] = voxel::Voxel();
+						} else {
+							column[y] = rock;
+						}
+					}
+					ctx.chunk->setVoxels(x, z, column, MaxTerrainHeight);
+				}
+			}
+			return true;
+		}
+
+		void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+		}
+	};
+
+	WorldMgr* _worldMgr = nullptr;
+
+	int findWalkableFloorRaycast(const glm::vec3& position, float maxDistanceY) const {
+		return _worldMgr->findWalkableFloorRaycast(position, maxDistanceY);
+	}
+
+public:
+	void SetUp() override {
+		core::AbstractTest::SetUp();
+		const core::SharedPtr<Pager>& pager = core::make_shared<Pager>();
+		_worldMgr = new WorldMgr(pager);
+		ASSERT_TRUE(_worldMgr->init(1024, 256));
+	}
+
+	void TearDown() override {
+		delete _worldMgr;
+		_worldMgr = nullptr;
+		core::AbstractTest::TearDown();
+	}
+};
+
+TEST_F(WorldMgrTest, testFindWalkableFloor) {
+	math::Random random(1);
+	const float maxDistances[] = { 0.0f, 1.5f, 5.0f, 20.0f, (float)voxel::MAX_HEIGHT };
+	for (int i = 0; i < 20000; ++i) {
+		const glm::vec3 pos(random.randomf(-40.0f, 40.0f), random.randomf(0.0f, (float)Pager::MaxTerrainHeight + 8.0f), random.randomf(-40.0f, 40.0f));
+		for (float maxDistance : maxDistances) {
+			ASSERT_EQ(findWalkableFloorRaycast(pos, maxDistance), _worldMgr->findWalkableFloor(pos, maxDistance))
+				<< "position " << pos.x << ":" << pos.y << ":" << pos.z << " with max distance " << maxDistance;
+		}
+	}
+}
+
+TEST_F(WorldMgrTest, testFindWalkableFloors) {
+	const glm::vec3 positions[] = { glm::vec3(0.5f, 60.0f, 0.5f), glm::vec3(-3.5f, 2.0f, 7.25f), glm::vec3(10.0f, 40.0f, -10.0f) };
+	int floors[lengthof(positions)];
+	_worldMgr->findWalkableFloors(positions, floors, (int)lengthof(positions));
+	for (size_t i = 0; i < lengthof(positions); ++i) {
+		EXPECT_EQ(findWalkableFloorRaycast(positions[i], (float)voxel::MAX_HEIGHT), floors[i]);
+	}
+}
+
+}
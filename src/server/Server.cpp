@@ -53,6 +53,11 @@ core::AppState Server::onConstruct() {
 	core::Var::get(cfg::ServerHttpPort, HTTP_SERVER_PORT, core::CV_REPLICATE);
 	core::Var::get(cfg::ServerChunkBaseUrl, "http://" HTTP_SERVER_HOST ":" HTTP_SERVER_PORT "/chunk", core::CV_REPLICATE);
 	core::Var::get(cfg::ServerSeed, "1", core::CV_REPLICATE);
+	core::Var::get(cfg::ServerVolumeMemory, "512");
+	core::Var::get(cfg::ServerVolumeCompressedMemory, "256");
+	core::Var::get(cfg::ServerChunkGeneratorThreads, "2");
+	core::Var::get(cfg::ServerChunkPrefetchRadius, "1");
+	core::Var::get(cfg::ServerAIDebugStateRate, "10");
 	core::Var::get(cfg::VoxelMeshSize, "16", core::CV_READONLY);
 	core::Var::get(cfg::DatabaseMinConnections, "2");
 	core::Var::get(cfg::DatabaseMaxConnections, "100");
@@ -111,7 +116,7 @@ int main(int argc, char *argv[]) {
 
 	const stock::StockDataProviderPtr& stockDataProvider = std::make_shared<stock::StockDataProvider>();
 	const persistence::DBHandlerPtr& dbHandler = std::make_shared<persistence::DBHandler>();
-	const persistence::PersistenceMgrPtr& persistenceMgr = std::make_shared<persistence::PersistenceMgr>(dbHandler);
+	const persistence::PersistenceMgrPtr& persistenceMgr = std::make_shared<persistence::PersistenceMgr>(dbHandler, metric);
 	const backend::EntityStoragePtr& entityStorage = std::make_shared<backend::EntityStorage>(eventBus);
 	const voxelformat::VolumeCachePtr& volumeCache = std::make_shared<voxelformat::VolumeCache>();
 
@@ -18,6 +18,7 @@
 #include "voxel/Voxel.h"
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
+#include <unordered_map>
 #include <glm/vec4.hpp>
 
 namespace traze {
@@ -193,7 +194,7 @@ void Protocol::parseOwnPlayer(const core::String& json) {
 	_playerId = j["id"].get<int>();
 	const glm::ivec2& position = j["position"];
 	Log::info("Player token %s with id %u at pos %i:%i", _playerToken.c_str(), _playerId, position.x, position.y);
-	_eventBus->enqueue(std::make_shared<SpawnEvent>(Spawn{position, true}));
+	_eventBus->enqueue<SpawnEvent>(Spawn{position, true});
 }
 
 void Protocol::parsePlayers(const core::String& json) {
@@ -215,7 +216,7 @@ void Protocol::parsePlayers(const core::String& json) {
 		players.push_back(p);
 		Log::debug("Player %s with id %i", p.name.c_str(), p.id);
 	}
-	_eventBus->enqueue(std::make_shared<PlayerListEvent>(players));
+	_eventBus->enqueue<PlayerListEvent>(players);
 	std::unordered_map<uint32_t, Player> playerMap;
 	for (const auto& p : players) {
 		playerMap[p.id] = p;
@@ -238,7 +239,7 @@ void Protocol::parseTicker(const core::String& json) const {
 	}
 	ticker.casualty = j["casualty"].get<int>();
 	ticker.fragger = j["fragger"].get<int>();
-	_eventBus->enqueue(std::make_shared<TickerEvent>(ticker));
+	_eventBus->enqueue<TickerEvent>(ticker);
 }
 
 void Protocol::parseGames(const core::String& json) const {
@@ -258,7 +259,7 @@ void Protocol::parseGames(const core::String& json) const {
 		games.push_back(g);
 		Log::debug("%s with %i players", g.name.c_str(), g.activePlayers);
 	}
-	_eventBus->enqueue(std::make_shared<NewGamesEvent>(games));
+	_eventBus->enqueue<NewGamesEvent>(games);
 }
 
 void Protocol::parseScores(const core::String& json) {
@@ -278,7 +279,7 @@ void Protocol::parseScores(const core::String& json) {
 	for (const auto& e : entries) {
 		scores.push_back(e.second);
 	}
-	_eventBus->enqueue(std::make_shared<ScoreEvent>(scores));
+	_eventBus->enqueue<ScoreEvent>(scores);
 }
 
 void Protocol::parseGridAndUpdateVolume(const core::String& json) {
@@ -333,17 +334,17 @@ void Protocol::parseGridAndUpdateVolume(const core::String& json) {
 				b.direction = BikeDirection::S;
 			}
 			// TODO: "trail":[[2,0],[2,1]]
-			_eventBus->enqueue(std::make_shared<BikeEvent>(b));
+			_eventBus->enqueue<BikeEvent>(b);
 		}
 	}
 	if (j.find("spawns") != j.end()) {
 		const auto& spawns = j["spawns"];
 		for (const auto& spawn : spawns) {
 			const glm::ivec2 spawnPos(spawn[0].get<int>(), spawn[1].get<int>());
-			_eventBus->enqueue(std::make_shared<SpawnEvent>(Spawn{spawnPos, false}));
+			_eventBus->enqueue<SpawnEvent>(Spawn{spawnPos, false});
 		}
 	}
-	_eventBus->enqueue(std::make_shared<NewGridEvent>(v));
+	_eventBus->enqueue<NewGridEvent>(v);
 }
 
 void Protocol::onMessage(const struct mosquitto_message *msg) {
@@ -273,6 +273,16 @@ void createConstructor(const Table& table, core::String& src) {
 	src += "\t\t_membersPointer = (uint8_t*)&_m;\n";
 	src += "\t\treturn *this;\n";
 	src += "\t}\n\n";
+
+	src += "\tpersistence::Model* clone() const override {\n";
+	src += "\t\t";
+	src += table.classname;
+	src += "* model = new ";
+	src += table.classname;
+	src += "(*this);\n";
+	src += "\t\tmodel->_flagToDelete = _flagToDelete;\n";
+	src += "\t\treturn model;\n";
+	src += "\t}\n\n";
 }
 
 static void createDBConditions(const Table& table, core::String& src) {
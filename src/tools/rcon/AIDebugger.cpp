@@ -10,6 +10,9 @@
 #include "Version.h"
 #include "ai/server/IProtocolHandler.h"
 #include "ai/server/AIStateMessage.h"
+#include "ai/server/AIStateDeltaMessage.h"
+#include "ai/server/AIStateAckMessage.h"
+#include "ai/server/AISubscribeMessage.h"
 #include "ai/server/AINamesMessage.h"
 #include "ai/server/AIPauseMessage.h"
 #include "ai/server/AISelectMessage.h"
@@ -42,6 +45,20 @@ public:
 	}
 };
 
+class StateDeltaHandler: public ProtocolHandler<AIStateDeltaMessage> {
+private:
+	AIDebugger& _aiDebugger;
+public:
+	StateDeltaHandler (AIDebugger& aiDebugger) :
+			_aiDebugger(aiDebugger) {
+	}
+
+	void execute(const ClientId& /*clientId*/, const AIStateDeltaMessage* msg) override {
+		_aiDebugger.applyStateDelta(*msg);
+		emit _aiDebugger.onEntitiesUpdated();
+	}
+};
+
 class CharacterHandler: public ProtocolHandler<AICharacterDetailsMessage> {
 private:
 	AIDebugger& _aiDebugger;
@@ -100,7 +117,7 @@ public:
 };
 
 AIDebugger::AIDebugger(AINodeStaticResolver& resolver) :
-		_stateHandler(new StateHandler(*this)), _characterHandler(new CharacterHandler(*this)), _characterStaticHandler(
+		_stateHandler(new StateHandler(*this)), _stateDeltaHandler(new StateDeltaHandler(*this)), _characterHandler(new CharacterHandler(*this)), _characterStaticHandler(
 				new CharacterStaticHandler(*this)), _pauseHandler(new PauseHandler(*this)), _namesHandler(new NamesHandler(*this)), _nopHandler(
 				new NopHandler()), _selectedId(AI_NOTHING_SELECTED), _socket(this), _pause(false), _resolver(resolver) {
 	connect(&_socket, SIGNAL(readyRead()), SLOT(readTcpData()));
@@ -108,6 +125,7 @@ AIDebugger::AIDebugger(AINodeStaticResolver& resolver) :
 
 	ai::ProtocolHandlerRegistry& r = ai::ProtocolHandlerRegistry::get();
 	r.registerHandler(ai::PROTO_STATE, _stateHandler);
+	r.registerHandler(ai::PROTO_STATEDELTA, _stateDeltaHandler);
 	r.registerHandler(ai::PROTO_CHARACTER_DETAILS, _characterHandler);
 	r.registerHandler(ai::PROTO_CHARACTER_STATIC, _characterStaticHandler);
 	r.registerHandler(ai::PROTO_PAUSE, _pauseHandler);
@@ -118,6 +136,7 @@ AIDebugger::AIDebugger(AINodeStaticResolver& resolver) :
 AIDebugger::~AIDebugger() {
 	disconnectFromAIServer();
 	delete _stateHandler;
+	delete _stateDeltaHandler;
 	delete _characterHandler;
 	delete _characterStaticHandler;
 	delete _pauseHandler;
@@ -203,6 +222,10 @@ void AIDebugger::unselect() {
 	qDebug() << "unselect entity";
 }
 
+void AIDebugger::subscribe(const AIStateSubscription& subscription) {
+	writeMessage(AISubscribeMessage(subscription));
+}
+
 void AIDebugger::step() {
 	writeMessage(AIStepMessage(1L));
 }
@@ -332,6 +355,24 @@ void AIDebugger::setNames(const std::vector<core::String>& names) {
 	}
 }
 
+void AIDebugger::applyStateDelta(const AIStateDeltaMessage& msg) {
+	if (msg.isFull()) {
+		_entities.clear();
+	}
+	for (const AIStateDelta& delta : msg.getChanges()) {
+		const CharacterId id = delta.getState().getId();
+		Iter i = _entities.find(id);
+		if (i == _entities.end()) {
+			i = _entities.insert(id, AIStateWorld(id, glm::vec3(0.0f), 0.0f));
+		}
+		delta.apply(i.value());
+	}
+	for (CharacterId id : msg.getRemoved()) {
+		_entities.remove(id);
+	}
+	writeMessage(AIStateAckMessage(msg.getSequence()));
+}
+
 void AIDebugger::setEntities(const std::vector<AIStateWorld>& entities) {
 	_entities.clear();
 	for (const AIStateWorld& state : entities) {
@@ -9,6 +9,7 @@
 #include "ai/server/IProtocolHandler.h"
 #include "ai/server/AICharacterStaticMessage.h"
 #include "ai/server/AICharacterDetailsMessage.h"
+#include "ai/server/AIStateDeltaMessage.h"
 #include <QTcpSocket>
 #include <QSettings>
 #include <QFile>
@@ -44,6 +45,7 @@ protected:
 
 	// the network protocol message handlers
 	ai::IProtocolHandler *_stateHandler;
+	ai::IProtocolHandler *_stateDeltaHandler;
 	ai::IProtocolHandler *_characterHandler;
 	ai::IProtocolHandler *_characterStaticHandler;
 	ai::IProtocolHandler *_pauseHandler;
@@ -81,6 +83,10 @@ public:
 	 */
 	const Entities& getEntities() const;
 	void setEntities(const std::vector<AIStateWorld>& entities);
+	/**
+	 * @brief Applies the changes of the subscribed entities and acknowledges the message
+	 */
+	void applyStateDelta(const AIStateDeltaMessage& msg);
 	void setCharacterDetails(const CharacterId& id, const AIStateAggro& aggro, const AIStateNode& node);
 	void addCharacterStaticData(const AICharacterStaticMessage& msg);
 	void setNames(const std::vector<core::String>& names);
@@ -106,6 +112,11 @@ public:
 	const CharacterId& getSelected() const;
 	void select(const ai::AIStateWorld& ai);
 	void select(ai::CharacterId id);
+	/**
+	 * @brief Only receive the changes of the entities in the given area or with the given ids instead
+	 * of the full world state. An empty subscription switches back to the full state.
+	 */
+	void subscribe(const AIStateSubscription& subscription);
 	void togglePause();
 	void unselect();
 	void step();
@@ -11,59 +11,186 @@
 #include "core/Assert.h"
 #include "core/Log.h"
 #include "core/Zip.h"
+#include "core/Trace.h"
+#include <memory>
+#include <string.h>
 
 namespace voxedit {
 
 static const MementoState InvalidMementoState{MementoType::Modification, MementoData(), -1, "", voxel::Region::InvalidRegion};
 const int MementoHandler::MaxStates = 64;
 
-MementoData::MementoData(const uint8_t* buf, size_t bufSize,
-		const voxel::Region& _region) :
-		_compressedSize(bufSize), _region(_region) {
-	if (buf != nullptr) {
-		core_assert(_compressedSize > 0);
-		_buffer = new uint8_t[_compressedSize];
-		memcpy(_buffer, buf, _compressedSize);
-	} else {
-		core_assert(_compressedSize == 0);
+namespace {
+
+void writeVarInt(MementoData::Buffer& out, size_t value) {
+	while (value >= 0x80u) {
+		out.push_back((uint8_t)(value | 0x80u));
+		value >>= 7;
+	}
+	out.push_back((uint8_t)value);
+}
+
+bool readVarInt(const MementoData::Buffer& in, size_t& pos, size_t& value) {
+	value = 0u;
+	for (int shift = 0; pos < in.size() && shift < 64; shift += 7) {
+		const uint8_t byte = in[pos++];
+		value |= (size_t)(byte & 0x7Fu) << shift;
+		if ((byte & 0x80u) == 0u) {
+			return true;
+		}
+	}
+	return false;
+}
+
+std::shared_future<MementoData::Buffer> ready(MementoData::Buffer&& buffer) {
+	std::promise<MementoData::Buffer> promise;
+	promise.set_value(std::move(buffer));
+	return promise.get_future().share();
+}
+
+inline size_t voxelOffset(const voxel::Region& region, int x, int y, int z) {
+	const glm::ivec3& mins = region.getLowerCorner();
+	const size_t w = region.getWidthInVoxels();
+	const size_t h = region.getHeightInVoxels();
+	return (((size_t)(z - mins.z) * h + (size_t)(y - mins.y)) * w + (size_t)(x - mins.x)) * sizeof(voxel::Voxel);
+}
+
+voxel::RawVolume* uncompressVolume(const MementoData::Buffer& compressed, const voxel::Region& region) {
+	if (compressed.empty()) {
+		return nullptr;
+	}
+	const size_t uncompressedBufferSize = region.voxels() * sizeof(voxel::Voxel);
+	uint8_t *uncompressedBuf = new uint8_t[uncompressedBufferSize];
+	if (!core::zip::uncompress(compressed.data(), compressed.size(), uncompressedBuf, uncompressedBufferSize)) {
+		delete[] uncompressedBuf;
+		return nullptr;
+	}
+	return voxel::RawVolume::createRaw((voxel::Voxel*)uncompressedBuf, region);
+}
+
+MementoData::Buffer compressVoxels(const uint8_t* voxels, size_t size) {
+	const uint32_t compressedBufferSize = core::zip::compressBound(size);
+	MementoData::Buffer compressed(compressedBufferSize);
+	size_t finalBufSize = 0u;
+	if (!core::zip::compress(voxels, size, compressed.data(), compressedBufferSize, &finalBufSize)) {
+		return MementoData::Buffer();
+	}
+	compressed.resize(finalBufSize);
+	Log::debug("Memento state. Volume: %i, compressed: %i", (int)size, (int)finalBufSize);
+	return compressed;
+}
+
+}
+
+MementoData::MementoData(std::shared_future<Buffer>&& buffer, const voxel::Region& region, bool delta) :
+		_buffer(std::move(buffer)), _region(region), _delta(delta) {
+}
+
+MementoData::MementoData(voxel::RawVolume* volume) :
+		_region(volume->region()), _volume(volume) {
+}
+
+size_t MementoData::compressedSize() const {
+	if (!_buffer.valid()) {
+		return 0u;
 	}
+	return _buffer.get().size();
 }
 
-MementoData::MementoData(MementoData&& o) :
-		_compressedSize(std::exchange(o._compressedSize, 0)),
-		_buffer(std::exchange(o._buffer, nullptr)),
-		_region(o._region) {
+MementoData::Buffer MementoData::compressVolume(const Buffer& voxels) {
+	return compressVoxels(voxels.data(), voxels.size());
 }
 
-MementoData::~MementoData() {
-	if (_buffer != nullptr) {
-		delete[] _buffer;
-		_buffer = nullptr;
+MementoData::Buffer MementoData::compressDelta(const Buffer& delta) {
+	// the delta is zero for all voxels that weren't modified - store the zero runs and the modified bytes
+	Buffer compressed;
+	writeVarInt(compressed, delta.size());
+	const size_t n = delta.size();
+	size_t i = 0u;
+	while (i < n) {
+		const size_t zeroStart = i;
+		while (i < n && delta[i] == 0u) {
+			++i;
+		}
+		const size_t literalStart = i;
+		while (i < n && delta[i] != 0u) {
+			++i;
+		}
+		writeVarInt(compressed, literalStart - zeroStart);
+		writeVarInt(compressed, i - literalStart);
+		compressed.insert(compressed.end(), delta.begin() + literalStart, delta.begin() + i);
 	}
+	Log::debug("Memento delta. Region: %i, compressed: %i", (int)n, (int)compressed.size());
+	return compressed;
 }
 
-MementoData::MementoData(const MementoData& o) :
-		_compressedSize(o._compressedSize),
-		_region(o._region) {
-	if (o._buffer != nullptr) {
-		core_assert(_compressedSize > 0);
-		_buffer = new uint8_t[_compressedSize];
-		memcpy(_buffer, o._buffer, _compressedSize);
-	} else {
-		core_assert(_compressedSize == 0);
+bool MementoData::uncompressDelta(const Buffer& compressed, Buffer& delta) {
+	size_t pos = 0u;
+	size_t size;
+	if (!readVarInt(compressed, pos, size)) {
+		return false;
+	}
+	delta.assign(size, 0u);
+	size_t i = 0u;
+	while (pos < compressed.size()) {
+		size_t zeros;
+		size_t literals;
+		if (!readVarInt(compressed, pos, zeros) || !readVarInt(compressed, pos, literals)) {
+			return false;
+		}
+		i += zeros;
+		if (i + literals > size || pos + literals > compressed.size()) {
+			return false;
+		}
+		memcpy(&delta[i], &compressed[pos], literals);
+		i += literals;
+		pos += literals;
 	}
+	return true;
 }
 
-MementoData& MementoData::operator=(MementoData &&o) {
-	if (this != &o) {
-		_compressedSize = std::exchange(o._compressedSize, 0);
-		if (_buffer) {
-			delete[] _buffer;
+bool MementoData::applyDelta(const Buffer& delta, const voxel::Region& region, voxel::RawVolume* volume) {
+	const voxel::Region& volumeRegion = volume->region();
+	if (!volumeRegion.containsRegion(region) || delta.size() != region.voxels() * sizeof(voxel::Voxel)) {
+		return false;
+	}
+	const uint8_t* data = volume->data();
+	const glm::ivec3& mins = region.getLowerCorner();
+	const glm::ivec3& maxs = region.getUpperCorner();
+	size_t d = 0u;
+	for (int z = mins.z; z <= maxs.z; ++z) {
+		for (int y = mins.y; y <= maxs.y; ++y) {
+			for (int x = mins.x; x <= maxs.x; ++x, d += sizeof(voxel::Voxel)) {
+				bool changed = false;
+				for (size_t b = 0u; b < sizeof(voxel::Voxel); ++b) {
+					changed |= delta[d + b] != 0u;
+				}
+				if (!changed) {
+					continue;
+				}
+				const uint8_t* current = data + voxelOffset(volumeRegion, x, y, z);
+				uint8_t bytes[sizeof(voxel::Voxel)];
+				for (size_t b = 0u; b < sizeof(voxel::Voxel); ++b) {
+					bytes[b] = current[b] ^ delta[d + b];
+				}
+				voxel::Voxel voxel;
+				memcpy(&voxel, bytes, sizeof(voxel));
+				volume->setVoxel(x, y, z, voxel);
+			}
 		}
-		_buffer = std::exchange(o._buffer, nullptr);
-		_region = o._region;
 	}
-	return *this;
+	return true;
+}
+
+bool MementoData::applyDelta(const MementoData& mementoData, voxel::RawVolume* volume) {
+	if (volume == nullptr || !mementoData.hasData() || !mementoData.isDelta()) {
+		return false;
+	}
+	Buffer delta;
+	if (!uncompressDelta(mementoData._buffer.get(), delta)) {
+		return false;
+	}
+	return applyDelta(delta, mementoData._region, volume);
 }
 
 MementoData MementoData::fromVolume(const voxel::RawVolume* volume) {
@@ -71,34 +198,21 @@ MementoData MementoData::fromVolume(const voxel::RawVolume* volume) {
 		return MementoData();
 	}
 	const size_t uncompressedBufferSize = volume->region().voxels() * sizeof(voxel::Voxel);
-	const uint32_t compressedBufferSize = core::zip::compressBound(uncompressedBufferSize);
-	uint8_t *compressedBuf = new uint8_t[compressedBufferSize];
-	size_t finalBufSize = 0u;
-	if (!core::zip::compress(volume->data(), uncompressedBufferSize, compressedBuf, compressedBufferSize, &finalBufSize)) {
-		delete[] compressedBuf;
-		return MementoData();
-	}
-	const MementoData data(compressedBuf, finalBufSize, volume->region());
-	delete[] compressedBuf;
-
-	Log::debug("Memento state. Volume: %i, compressed: %i",
-			(int)uncompressedBufferSize, (int)data._compressedSize);
-	return data;
+	return MementoData(ready(compressVoxels(volume->data(), uncompressedBufferSize)), volume->region(), false);
 }
 
 voxel::RawVolume* MementoData::toVolume(const MementoData& mementoData) {
-	if (mementoData._buffer == nullptr) {
+	if (!mementoData.hasData() || mementoData.isDelta()) {
 		return nullptr;
 	}
-	const size_t uncompressedBufferSize = mementoData._region.voxels() * sizeof(voxel::Voxel);
-	uint8_t *uncompressedBuf = new uint8_t[uncompressedBufferSize];
-	if (!core::zip::uncompress(mementoData._buffer, mementoData._compressedSize, uncompressedBuf, uncompressedBufferSize)) {
-		return nullptr;
+	if (mementoData._volume) {
+		return new voxel::RawVolume(mementoData._volume.get());
 	}
-	return voxel::RawVolume::createRaw((voxel::Voxel*)uncompressedBuf, mementoData._region);
+	return uncompressVolume(mementoData._buffer.get(), mementoData._region);
 }
 
-MementoHandler::MementoHandler() {
+MementoHandler::MementoHandler() :
+		_threadPool(1, "MementoHandler") {
 }
 
 MementoHandler::~MementoHandler() {
@@ -107,11 +221,13 @@ MementoHandler::~MementoHandler() {
 
 bool MementoHandler::init() {
 	_states.reserve(MaxStates);
+	_threadPool.init();
 	return true;
 }
 
 void MementoHandler::shutdown() {
 	clearStates();
+	_threadPool.shutdown(true);
 }
 
 void MementoHandler::lock() {
@@ -131,7 +247,7 @@ void MementoHandler::construct() {
 			const glm::ivec3& mins = state.region.getLowerCorner();
 			const glm::ivec3& maxs = state.region.getUpperCorner();
 			Log::info("%4i: %i - %s (%s) [mins(%i:%i:%i)/maxs(%i:%i:%i)]",
-					i++, state.layer, state.name.c_str(), state.data._buffer == nullptr ? "empty" : "volume",
+					i++, state.layer, state.name.c_str(), !state.data.hasData() ? "empty" : (state.data.isDelta() ? "delta" : "volume"),
 							mins.x, mins.y, mins.z, maxs.x, maxs.y, maxs.z);
 		}
 	});
@@ -140,6 +256,165 @@ void MementoHandler::construct() {
 void MementoHandler::clearStates() {
 	_states.clear();
 	_statePosition = 0u;
+	clearShadows();
+}
+
+void MementoHandler::clearShadows() {
+	for (auto& i : _shadows) {
+		delete i.second;
+	}
+	_shadows.clear();
+}
+
+void MementoHandler::removeShadow(int layer) {
+	auto i = _shadows.find(layer);
+	if (i == _shadows.end()) {
+		return;
+	}
+	delete i->second;
+	_shadows.erase(i);
+}
+
+void MementoHandler::markLayerVolumeReplaced(int layer) {
+	removeShadow(layer);
+}
+
+void MementoHandler::applyShadowDelta(const MementoState& state) {
+	auto i = _shadows.find(state.layer);
+	if (i == _shadows.end()) {
+		return;
+	}
+	if (!MementoData::applyDelta(state.data, i->second)) {
+		// the next state of this layer will be a full volume again
+		removeShadow(state.layer);
+	}
+}
+
+std::shared_future<MementoData::Buffer> MementoHandler::compress(MementoData::Buffer&& data, bool delta) {
+	std::shared_ptr<MementoData::Buffer> input = std::make_shared<MementoData::Buffer>(std::move(data));
+	auto future = _threadPool.enqueue([input, delta] () {
+		core_trace_scoped(MementoCompress);
+		if (delta) {
+			return MementoData::compressDelta(*input);
+		}
+		return MementoData::compressVolume(*input);
+	});
+	if (future.valid()) {
+		return future.share();
+	}
+	// the handler is not initialized
+	return ready(delta ? MementoData::compressDelta(*input) : MementoData::compressVolume(*input));
+}
+
+MementoData MementoHandler::markVolume(int layer, const voxel::RawVolume* volume, MementoType type, const voxel::Region& region) {
+	if (volume == nullptr) {
+		// the layer was deleted - a new layer with the same id must not build its deltas on this volume
+		removeShadow(layer);
+		return MementoData();
+	}
+	core_trace_scoped(MementoMarkVolume);
+	const voxel::Region& volumeRegion = volume->region();
+	auto i = _shadows.find(layer);
+	if (type == MementoType::Modification && region.isValid() && i != _shadows.end() && i->second->region() == volumeRegion) {
+		voxel::Region deltaRegion = region;
+		deltaRegion.cropTo(volumeRegion);
+		if (deltaRegion.isValid()) {
+			// xor the modified region with the previous state of the layer
+			MementoData::Buffer delta(deltaRegion.voxels() * sizeof(voxel::Voxel));
+			const uint8_t* current = volume->data();
+			const uint8_t* previous = i->second->data();
+			const glm::ivec3& mins = deltaRegion.getLowerCorner();
+			const glm::ivec3& maxs = deltaRegion.getUpperCorner();
+			const size_t rowSize = deltaRegion.getWidthInVoxels() * sizeof(voxel::Voxel);
+			size_t d = 0u;
+			for (int z = mins.z; z <= maxs.z; ++z) {
+				for (int y = mins.y; y <= maxs.y; ++y) {
+					const size_t offset = voxelOffset(volumeRegion, mins.x, y, z);
+					for (size_t b = 0u; b < rowSize; ++b) {
+						delta[d++] = current[offset + b] ^ previous[offset + b];
+					}
+				}
+			}
+			MementoData::applyDelta(delta, deltaRegion, i->second);
+			return MementoData(compress(std::move(delta), true), deltaRegion, true);
+		}
+	}
+	if (i != _shadows.end()) {
+		delete i->second;
+	}
+	_shadows[layer] = new voxel::RawVolume(volume);
+	const uint8_t* voxels = volume->data();
+	MementoData::Buffer buffer(voxels, voxels + volumeRegion.voxels() * sizeof(voxel::Voxel));
+	return MementoData(compress(std::move(buffer), false), volumeRegion, false);
+}
+
+MementoData MementoHandler::volumeData(int statePosition) const {
+	const MementoState& state = _states[statePosition];
+	if (!state.data.isDelta()) {
+		return state.data;
+	}
+	core_trace_scoped(MementoVolumeData);
+	// search the last full volume of the layer and apply the deltas that follow
+	int base = statePosition - 1;
+	for (; base >= 0; --base) {
+		const MementoState& s = _states[base];
+		if (s.layer == state.layer && s.hasVolumeData() && !s.data.isDelta()) {
+			break;
+		}
+	}
+	if (base < 0) {
+		Log::error("No full volume for layer %i found", state.layer);
+		return MementoData();
+	}
+	voxel::RawVolume* volume = MementoData::toVolume(_states[base].data);
+	if (volume == nullptr) {
+		return MementoData();
+	}
+	for (int i = base + 1; i <= statePosition; ++i) {
+		const MementoState& s = _states[i];
+		if (s.layer == state.layer && s.data.isDelta()) {
+			MementoData::applyDelta(s.data, volume);
+		}
+	}
+	// the volume is only used to restore the layer - don't compress it just to uncompress it again
+	return MementoData(volume);
+}
+
+void MementoHandler::removeFirstState() {
+	const MementoState& first = _states.front();
+	if (first.hasVolumeData() && !first.data.isDelta()) {
+		for (size_t i = 1; i < _states.size(); ++i) {
+			MementoState& next = _states[i];
+			if (next.layer != first.layer || !next.hasVolumeData()) {
+				continue;
+			}
+			if (next.data.isDelta()) {
+				// the delta loses its base - turn it into a full volume
+				const std::shared_future<MementoData::Buffer> base = first.data._buffer;
+				const std::shared_future<MementoData::Buffer> delta = next.data._buffer;
+				const voxel::Region volumeRegion = first.data._region;
+				const voxel::Region deltaRegion = next.data._region;
+				auto merge = [base, delta, volumeRegion, deltaRegion] () {
+					voxel::RawVolume* volume = uncompressVolume(base.get(), volumeRegion);
+					if (volume == nullptr) {
+						return MementoData::Buffer();
+					}
+					MementoData::Buffer uncompressed;
+					if (MementoData::uncompressDelta(delta.get(), uncompressed)) {
+						MementoData::applyDelta(uncompressed, deltaRegion, volume);
+					}
+					MementoData::Buffer compressed = compressVoxels(volume->data(), volumeRegion.voxels() * sizeof(voxel::Voxel));
+					delete volume;
+					return compressed;
+				};
+				// the worker handles the jobs in order - base and delta are compressed before this runs
+				auto future = _threadPool.enqueue(merge);
+				next.data = MementoData(future.valid() ? future.share() : ready(merge()), volumeRegion, false);
+			}
+			break;
+		}
+	}
+	_states.erase(_states.begin());
 }
 
 MementoState MementoHandler::undo() {
@@ -147,17 +422,25 @@ MementoState MementoHandler::undo() {
 		return InvalidMementoState;
 	}
 	core_assert(_statePosition >= 1);
+	const MementoState& undone = _states[_statePosition];
 	--_statePosition;
-	if (_states[_statePosition].data._buffer != nullptr
+	if (undone.data.isDelta()) {
+		// applying the delta of the undone state again restores the previous voxels
+		applyShadowDelta(undone);
+		voxel::logRegion("Undo", undone.region);
+		return MementoState{undone.type, undone.data, undone.layer, undone.name, undone.region};
+	}
+	if (_states[_statePosition].hasVolumeData()
 			&& _states[_statePosition].type == MementoType::LayerAdded
 			&& _states[_statePosition + 1].type != MementoType::Modification) {
 		--_statePosition;
 	}
 	Log::debug("Available states: %i, current index: %i", (int)_states.size(), _statePosition);
+	clearShadows();
 	const MementoState& s = state();
 	const voxel::Region region = _states[_statePosition + 1].region;
 	voxel::logRegion("Undo", region);
-	return MementoState{_states[_statePosition + 1].type, s.data, s.layer, s.name, region};
+	return MementoState{_states[_statePosition + 1].type, volumeData(_statePosition), s.layer, s.name, region};
 }
 
 MementoState MementoHandler::redo() {
@@ -166,14 +449,19 @@ MementoState MementoHandler::redo() {
 	}
 	Log::debug("Available states: %i, current index: %i", (int)_states.size(), _statePosition);
 	++_statePosition;
-	if (_states[_statePosition].data._buffer == nullptr && _states[_statePosition].type == MementoType::LayerAdded) {
+	if (!_states[_statePosition].hasVolumeData() && _states[_statePosition].type == MementoType::LayerAdded) {
 		++_statePosition;
 	}
-	if (_states[_statePosition].data._buffer != nullptr && _states[_statePosition].type == MementoType::LayerDeleted) {
+	if (_states[_statePosition].hasVolumeData() && _states[_statePosition].type == MementoType::LayerDeleted) {
 		++_statePosition;
 	}
 	const MementoState& s = state();
 	voxel::logRegion("Redo", s.region);
+	if (s.data.isDelta()) {
+		applyShadowDelta(s);
+		return MementoState{s.type, s.data, s.layer, s.name, s.region};
+	}
+	clearShadows();
 	return MementoState{s.type, s.data, s.layer, s.name, s.region};
 }
 
@@ -208,10 +496,10 @@ void MementoHandler::markUndo(int layer, const core::String& name, const voxel::
 	}
 	Log::debug("New undo state for layer %i with name %s (memento state index: %i)", layer, name.c_str(), (int)_states.size());
 	voxel::logRegion("MarkUndo", region);
-	const MementoData& data = MementoData::fromVolume(volume);
+	const MementoData& data = markVolume(layer, volume, type, region);
 	_states.emplace_back(type, data, layer, name, region);
 	while (_states.size() > MaxStates) {
-		_states.erase(_states.begin());
+		removeFirstState();
 	}
 	_statePosition = stateSize() - 1;
 }
@@ -5,12 +5,16 @@
 #pragma once
 
 #include "core/IComponent.h"
+#include "core/concurrent/ThreadPool.h"
 #include "voxel/Region.h"
 #include "voxel/Voxel.h"
 #include <vector>
 #include "core/String.h"
 #include <stdint.h>
 #include <stddef.h>
+#include <future>
+#include <memory>
+#include <unordered_map>
 
 namespace voxel {
 class RawVolume;
@@ -28,39 +32,63 @@ enum class MementoType {
 /**
  * @brief Holds the data of a memento state
  *
- * The given buffer is owned by this class and represents a compressed volume
+ * The data is either a compressed volume or a compressed delta for a region of the volume. The delta is
+ * the xor of the voxels with the previous state of the layer - so applying the delta again turns the volume
+ * into the other state. The compression might still run in the background - the buffer is shared between
+ * the copies of the data.
  */
 class MementoData {
 	friend struct MementoState;
 	friend class MementoHandler;
+public:
+	using Buffer = std::vector<uint8_t>;
 private:
 	/**
-	 * @brief How big is the buffer with the compressed volume data
-	 */
-	size_t _compressedSize = 0;
-	/**
-	 * @brief The compressed volume data
+	 * @brief The compressed data - accessing it waits for the compression
 	 */
-	uint8_t* _buffer = nullptr;
+	std::shared_future<Buffer> _buffer;
 	/**
 	 * The region the given volume data is for
 	 */
 	voxel::Region _region {};
+	/**
+	 * @brief The buffer doesn't hold a volume but the delta to the previous state of the region
+	 */
+	bool _delta = false;
+	/**
+	 * @brief The uncompressed volume if it was rebuilt from the deltas - there is no compressed buffer then
+	 */
+	std::shared_ptr<const voxel::RawVolume> _volume;
 
-	MementoData(const uint8_t* buf, size_t bufSize, const voxel::Region& _region);
+	MementoData(std::shared_future<Buffer>&& buffer, const voxel::Region& region, bool delta);
+	/**
+	 * @note Takes the ownership of the given volume
+	 */
+	MementoData(voxel::RawVolume* volume);
+
+	static Buffer compressVolume(const Buffer& voxels);
+	static Buffer compressDelta(const Buffer& delta);
+	static bool uncompressDelta(const Buffer& compressed, Buffer& delta);
+	/**
+	 * @brief Turns the given volume into the other state of the delta
+	 */
+	static bool applyDelta(const Buffer& delta, const voxel::Region& region, voxel::RawVolume* volume);
 public:
-	constexpr MementoData() {}
-	MementoData(MementoData&& o);
-	MementoData(const MementoData& o);
-	~MementoData();
+	MementoData() {}
 
-	MementoData& operator=(MementoData &&o);
+	bool hasData() const;
+	bool isDelta() const;
+	/**
+	 * @note Waits for the compression
+	 */
+	size_t compressedSize() const;
 
 	/**
 	 * @brief Converts the given @c mementoData into a volume
 	 * @note Keep in mind that you own the returned memory
 	 * @return The volume from the given memento data or @c null if the memento data
-	 * did not contain a valid volume buffer
+	 * did not contain a valid volume buffer - this is also the case for deltas
+	 * @sa applyDelta()
 	 */
 	static voxel::RawVolume* toVolume(const MementoData& mementoData);
 	/**
@@ -68,8 +96,22 @@ public:
 	 * @param[in] volume The volume to create the memento state for. This might be @c null.
 	 */
 	static MementoData fromVolume(const voxel::RawVolume* volume);
+	/**
+	 * @brief Applies the delta of the given memento data to the voxels of the given volume in place.
+	 * Applying it once more restores the previous voxels.
+	 * @return @c false if the data is no delta or doesn't fit to the volume
+	 */
+	static bool applyDelta(const MementoData& mementoData, voxel::RawVolume* volume);
 };
 
+inline bool MementoData::hasData() const {
+	return _buffer.valid() || _volume;
+}
+
+inline bool MementoData::isDelta() const {
+	return _delta;
+}
+
 struct MementoState {
 	MementoType type;
 	MementoData data;
@@ -97,7 +139,7 @@ struct MementoState {
 	 * Some types (@c MementoType) don't have a volume attached.
 	 */
 	inline bool hasVolumeData() const {
-		return data._buffer != nullptr;
+		return data.hasData();
 	}
 
 	inline const voxel::Region& dataRegion() const {
@@ -107,12 +149,33 @@ struct MementoState {
 
 /**
  * @brief Class that manages the undo and redo steps for the scene
+ *
+ * Modifications with a valid region only store the delta of that region. The previous state of each
+ * layer is kept uncompressed to build the deltas. The compression is done on a background thread.
  */
 class MementoHandler : public core::IComponent {
 private:
 	std::vector<MementoState> _states;
 	uint8_t _statePosition = 0u;
 	int _locked = 0;
+	core::ThreadPool _threadPool;
+	// the volume of each layer at the current state position - the base for the deltas
+	std::unordered_map<int, voxel::RawVolume*> _shadows;
+
+	std::shared_future<MementoData::Buffer> compress(MementoData::Buffer&& data, bool delta);
+	MementoData markVolume(int layer, const voxel::RawVolume* volume, MementoType type, const voxel::Region& region);
+	/**
+	 * @brief The full volume of the given state - deltas are applied to the last volume of the layer. The
+	 * rebuilt volume is handed over uncompressed.
+	 */
+	MementoData volumeData(int statePosition) const;
+	/**
+	 * @brief Apply the delta of the given state to the shadow volume of the layer
+	 */
+	void applyShadowDelta(const MementoState& state);
+	void clearShadows();
+	void removeShadow(int layer);
+	void removeFirstState();
 public:
 	static const int MaxStates;
 
@@ -148,6 +211,11 @@ public:
 	void markUndo(int layer, const core::String& name, const voxel::RawVolume* volume, MementoType type = MementoType::Modification, const voxel::Region& region = voxel::Region::InvalidRegion);
 	void markLayerDeleted(int layer, const core::String& name, const voxel::RawVolume* volume);
 	void markLayerAdded(int layer, const core::String& name, const voxel::RawVolume* volume);
+	/**
+	 * @brief Must be called if the volume of a layer was replaced without a new undo state (e.g. swapped with
+	 * another layer or resized). The next undo state of the layer stores the full volume instead of a delta.
+	 */
+	void markLayerVolumeReplaced(int layer);
 
 	/**
 	 * @note Keep in mind that the returned state contains memory for the voxel::RawVolume that you take ownership for
@@ -381,6 +381,7 @@ void SceneManager::resize(const glm::ivec3& size) {
 			return;
 		}
 		setNewVolume(layerId, newVolume, false);
+		_mementoHandler.markLayerVolumeReplaced(layerId);
 		if (glm::all(glm::greaterThanEqual(size, glm::zero<glm::ivec3>()))) {
 			// we don't have to reextract a mesh if only new empty voxels were added.
 			modified(layerId, voxel::Region::InvalidRegion);
@@ -408,6 +409,15 @@ void SceneManager::undo() {
 		_layerMgr.rename(s.layer, s.name);
 		return;
 	}
+	if (s.data.isDelta()) {
+		// the delta is applied in place - only the modified region must be extracted again
+		if (!MementoData::applyDelta(s.data, volume(s.layer))) {
+			Log::error("Failed to apply the undo delta to layer %i", s.layer);
+			return;
+		}
+		modified(s.layer, s.dataRegion(), false);
+		return;
+	}
 	voxel::RawVolume* v = MementoData::toVolume(s.data);
 	if (v == nullptr) {
 		_layerMgr.deleteLayer(s.layer, false);
@@ -473,6 +483,15 @@ void SceneManager::redo() {
 		_layerMgr.rename(s.layer, s.name);
 		return;
 	}
+	if (s.data.isDelta()) {
+		// the delta is applied in place - only the modified region must be extracted again
+		if (!MementoData::applyDelta(s.data, volume(s.layer))) {
+			Log::error("Failed to apply the redo delta to layer %i", s.layer);
+			return;
+		}
+		modified(s.layer, s.dataRegion(), false);
+		return;
+	}
 	voxel::RawVolume* v = MementoData::toVolume(s.data);
 	if (v == nullptr) {
 		_layerMgr.deleteLayer(s.layer, false);
@@ -1633,22 +1652,20 @@ bool SceneManager::extractVolume() {
 		// extract n regions max per frame
 		const size_t MaxPerFrame = 4;
 		const size_t x = core_min(MaxPerFrame, n);
-		int lastLayer = -1;
 		size_t i;
 		for (i = 0; i < x; ++i) {
 			const voxel::Region& region = _extractRegions[i].region;
 			const bool bigRegion = glm::all(glm::greaterThan(region.getDimensionsInVoxels(), glm::ivec3(64)));
-			const bool updateBuffers = bigRegion || i == x - 1 || lastLayer != _extractRegions[i].layer;
-			if (!_volumeRenderer.extract(_extractRegions[i].layer, region, updateBuffers)) {
+			// the meshes are extracted in the background and uploaded by the renderer once they are ready
+			if (!_volumeRenderer.extract(_extractRegions[i].layer, region, false)) {
 				Log::error("Failed to extract the model mesh");
 			}
-			Log::debug("Extract layer %i with update buffers set to %i", _extractRegions[i].layer, (int)updateBuffers);
+			Log::debug("Extract layer %i", _extractRegions[i].layer);
 			voxel::logRegion("Extraction", region);
 			if (bigRegion) {
 				++i;
 				break;
 			}
-			lastLayer = _extractRegions[i].layer;
 		}
 		// delete the first n entries and compact the memory of the buffer
 		RegionQueue(_extractRegions.begin() + i, _extractRegions.end()).swap(_extractRegions);
@@ -1891,7 +1908,10 @@ void SceneManager::onLayerSwapped(int layerId1, int layerId2) {
 	// TODO: mementohandler
 	if (!_volumeRenderer.swap(layerId1, layerId2)) {
 		Log::error("Failed to swap volumes for layer %i and layer %i", layerId1, layerId2);
+		return;
 	}
+	_mementoHandler.markLayerVolumeReplaced(layerId1);
+	_mementoHandler.markLayerVolumeReplaced(layerId2);
 }
 
 void SceneManager::onLayerHide(int layerId) {
@@ -5,6 +5,8 @@
 #include "core/tests/AbstractTest.h"
 #include "../MementoHandler.h"
 #include "voxel/RawVolume.h"
+#include "core/TimeProvider.h"
+#include "core/Log.h"
 #include <memory>
 
 namespace voxedit {
@@ -661,4 +663,145 @@ TEST_F(MementoHandlerTest, testAddNewLayerEdit) {
 	EXPECT_FALSE(mementoHandler.canRedo());
 }
 
+TEST_F(MementoHandlerTest, testDeltaUndoRedo) {
+	std::shared_ptr<voxel::RawVolume> volume = create(32);
+	mementoHandler.markUndo(0, "Layer", volume.get());
+	const voxel::Region modified(glm::ivec3(4), glm::ivec3(6));
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	volume->setVoxel(glm::ivec3(5), voxel);
+	mementoHandler.markUndo(0, "Layer", volume.get(), MementoType::Modification, modified);
+	ASSERT_TRUE(mementoHandler.state().data.isDelta());
+	EXPECT_EQ(modified, mementoHandler.state().dataRegion());
+
+	MementoState state = mementoHandler.undo();
+	ASSERT_TRUE(state.data.isDelta());
+	EXPECT_EQ(0, state.layer);
+	EXPECT_EQ(nullptr, MementoData::toVolume(state.data));
+	ASSERT_TRUE(MementoData::applyDelta(state.data, volume.get()));
+	EXPECT_TRUE(voxel::isAir(volume->voxel(glm::ivec3(5)).getMaterial()));
+
+	state = mementoHandler.redo();
+	ASSERT_TRUE(state.data.isDelta());
+	ASSERT_TRUE(MementoData::applyDelta(state.data, volume.get()));
+	EXPECT_EQ(voxel, volume->voxel(glm::ivec3(5)));
+}
+
+TEST_F(MementoHandlerTest, testDeltaNeedsSameVolumeRegion) {
+	std::shared_ptr<voxel::RawVolume> first = create(8);
+	std::shared_ptr<voxel::RawVolume> second = create(16);
+	mementoHandler.markUndo(0, "Layer", first.get());
+	mementoHandler.markUndo(0, "Layer", second.get(), MementoType::Modification, voxel::Region(glm::ivec3(0), glm::ivec3(1)));
+	EXPECT_FALSE(mementoHandler.state().data.isDelta()) << "A resized volume must be stored completely";
+	mementoHandler.markUndo(0, "Layer", second.get(), MementoType::Modification, voxel::Region(glm::ivec3(0), glm::ivec3(1)));
+	EXPECT_TRUE(mementoHandler.state().data.isDelta());
+	// undoing the full volume restores the previous volume even if the state before is a delta
+	mementoHandler.markUndo(0, "Layer", first.get(), MementoType::Modification, voxel::Region(glm::ivec3(0), glm::ivec3(1)));
+	const MementoState& state = mementoHandler.undo();
+	ASSERT_FALSE(state.data.isDelta());
+	EXPECT_EQ(16, state.dataRegion().getWidthInVoxels());
+}
+
+TEST_F(MementoHandlerTest, testUndoToDeltaReturnsVolume) {
+	std::shared_ptr<voxel::RawVolume> first = create(8);
+	std::shared_ptr<voxel::RawVolume> second = create(16);
+	const voxel::Region modified(glm::ivec3(1), glm::ivec3(1));
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	mementoHandler.markUndo(0, "Layer", first.get());
+	first->setVoxel(modified.getLowerCorner(), voxel);
+	mementoHandler.markUndo(0, "Layer", first.get(), MementoType::Modification, modified);
+	ASSERT_TRUE(mementoHandler.state().data.isDelta());
+	// a resized volume is stored completely - undoing it rebuilds the volume from the delta
+	mementoHandler.markUndo(0, "Layer", second.get(), MementoType::Modification, modified);
+	const MementoState& state = mementoHandler.undo();
+	ASSERT_TRUE(state.hasVolumeData());
+	ASSERT_FALSE(state.data.isDelta());
+	EXPECT_EQ(0u, state.data.compressedSize()) << "The rebuilt volume should not be compressed";
+	voxel::RawVolume* volume = MementoData::toVolume(state.data);
+	ASSERT_NE(nullptr, volume);
+	EXPECT_EQ(first->region(), volume->region());
+	EXPECT_EQ(voxel, volume->voxel(modified.getLowerCorner()));
+	delete volume;
+}
+
+TEST_F(MementoHandlerTest, testDeltaAfterVolumeReplaced) {
+	std::shared_ptr<voxel::RawVolume> first = create(8);
+	std::shared_ptr<voxel::RawVolume> second = create(8);
+	const voxel::Region modified(glm::ivec3(0), glm::ivec3(1));
+	mementoHandler.markUndo(0, "Layer", first.get());
+	// e.g. swapped with another layer
+	mementoHandler.markLayerVolumeReplaced(0);
+	mementoHandler.markUndo(0, "Layer", second.get(), MementoType::Modification, modified);
+	EXPECT_FALSE(mementoHandler.state().data.isDelta()) << "The replaced volume must be stored completely";
+	mementoHandler.markUndo(0, "Layer", second.get(), MementoType::Modification, modified);
+	EXPECT_TRUE(mementoHandler.state().data.isDelta());
+
+	mementoHandler.markLayerDeleted(0, "Layer", second.get());
+	mementoHandler.markUndo(0, "Layer", first.get(), MementoType::Modification, modified);
+	EXPECT_FALSE(mementoHandler.state().data.isDelta()) << "The volume of a deleted layer must not be the base for a delta";
+}
+
+TEST_F(MementoHandlerTest, testDeltaMaxUndoStates) {
+	std::shared_ptr<voxel::RawVolume> volume = create(MementoHandler::MaxStates * 2);
+	mementoHandler.markUndo(0, "Layer", volume.get());
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	const int n = MementoHandler::MaxStates + 5;
+	for (int i = 0; i < n; ++i) {
+		const glm::ivec3 pos(i, 0, 0);
+		volume->setVoxel(pos, voxel);
+		mementoHandler.markUndo(0, "Layer", volume.get(), MementoType::Modification, voxel::Region(pos, pos));
+	}
+	ASSERT_EQ(MementoHandler::MaxStates, (int)mementoHandler.stateSize());
+	while (mementoHandler.canUndo()) {
+		const MementoState& state = mementoHandler.undo();
+		ASSERT_TRUE(MementoData::applyDelta(state.data, volume.get()));
+	}
+	// the first remaining state lost its base and was turned into a full volume
+	const MementoState& first = mementoHandler.state();
+	ASSERT_FALSE(first.data.isDelta());
+	voxel::RawVolume* firstVolume = MementoData::toVolume(first.data);
+	ASSERT_NE(nullptr, firstVolume);
+	const int setVoxels = n - (MementoHandler::MaxStates - 1);
+	for (int i = 0; i < n; ++i) {
+		const glm::ivec3 pos(i, 0, 0);
+		EXPECT_EQ(i < setVoxels, !voxel::isAir(volume->voxel(pos).getMaterial())) << "voxel " << i;
+		EXPECT_EQ(volume->voxel(pos), firstVolume->voxel(pos)) << "voxel " << i;
+	}
+	delete firstVolume;
+}
+
+TEST_F(MementoHandlerTest, testDeltaLargeVolume) {
+	std::shared_ptr<voxel::RawVolume> volume = create(256);
+	mementoHandler.markUndo(0, "Layer", volume.get());
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	const int strokes = 32;
+	const uint64_t start = core::TimeProvider::systemNanos();
+	for (int i = 0; i < strokes; ++i) {
+		const voxel::Region region(glm::ivec3(i * 4), glm::ivec3(i * 4 + 3));
+		const glm::ivec3& mins = region.getLowerCorner();
+		const glm::ivec3& maxs = region.getUpperCorner();
+		for (int z = mins.z; z <= maxs.z; ++z) {
+			for (int y = mins.y; y <= maxs.y; ++y) {
+				for (int x = mins.x; x <= maxs.x; ++x) {
+					volume->setVoxel(x, y, z, voxel);
+				}
+			}
+		}
+		mementoHandler.markUndo(0, "Layer", volume.get(), MementoType::Modification, region);
+	}
+	const uint64_t markNanos = core::TimeProvider::systemNanos() - start;
+	size_t deltaSize = 0u;
+	while (mementoHandler.canUndo()) {
+		const MementoState& state = mementoHandler.undo();
+		ASSERT_TRUE(state.data.isDelta());
+		deltaSize += state.data.compressedSize();
+		ASSERT_TRUE(MementoData::applyDelta(state.data, volume.get()));
+	}
+	Log::info("%i strokes on a 256^3 volume: %.3f ms for marking the undo states, %i bytes for the deltas",
+			strokes, (double)markNanos / 1000000.0, (int)deltaSize);
+	// every stroke modified 4^3 voxels - the deltas must not contain anything but those voxels
+	EXPECT_LE(deltaSize, (size_t)(strokes * (4 * 4 * 4 * sizeof(voxel::Voxel) + 64)));
+	EXPECT_EQ(0, volume->voxel(glm::ivec3(0)).getColor());
+	EXPECT_TRUE(voxel::isAir(volume->voxel(glm::ivec3(0)).getMaterial()));
+}
+
 }